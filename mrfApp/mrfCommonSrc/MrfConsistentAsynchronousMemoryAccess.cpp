@@ -27,6 +27,10 @@
  * of the GNU LGPL version 3 or newer.
  */
 
+#include <algorithm>
+#include <limits>
+#include <string>
+
 #include "MrfConsistentAsynchronousMemoryAccess.h"
 
 namespace anka {
@@ -108,6 +112,77 @@ void MrfConsistentAsynchronousMemoryAccess::Impl::writeUInt32(
   }
 }
 
+void MrfConsistentAsynchronousMemoryAccess::Impl::writeUInt16Block(
+    std::uint32_t address, const std::vector<std::uint16_t> &values,
+    std::uint32_t elementDistance,
+    std::shared_ptr<BlockCallbackUInt16> callback) {
+  writeBlock(OperationType::writeUInt16Block, address, values,
+      elementDistance, callback, writeUInt16BlockInfos);
+}
+
+void MrfConsistentAsynchronousMemoryAccess::Impl::writeUInt32Block(
+    std::uint32_t address, const std::vector<std::uint32_t> &values,
+    std::uint32_t elementDistance,
+    std::shared_ptr<BlockCallbackUInt32> callback) {
+  writeBlock(OperationType::writeUInt32Block, address, values,
+      elementDistance, callback, writeUInt32BlockInfos);
+}
+
+template<typename T>
+void MrfConsistentAsynchronousMemoryAccess::Impl::writeBlock(
+    OperationType type, std::uint32_t address, const std::vector<T> &values,
+    std::uint32_t elementDistance, std::shared_ptr<BlockCallback<T>> callback,
+    std::unordered_map<unsigned long, WriteBlockInfo<T>> &blockInfos) {
+  // An empty block does not touch any registers, so we do not have to
+  // coordinate it with other operations. A block that would extend beyond
+  // the end of the address space is invalid and would also make the length
+  // overflow.
+  std::uint32_t effectiveElementDistance =
+      elementDistance ? elementDistance : sizeof(T);
+  if (values.empty()) {
+    callback->success(address, values);
+    return;
+  }
+  std::uint64_t length = static_cast<std::uint64_t>(values.size() - 1)
+      * effectiveElementDistance + sizeof(T);
+  if (length > std::numeric_limits<std::uint32_t>::max() - address + 1ULL) {
+    callback->failure(address, ErrorCode::invalidAddress, std::string());
+    return;
+  }
+  bool canRun;
+  OperationInfo info;
+  info.type = type;
+  info.address = address;
+  info.length = static_cast<std::uint32_t>(length);
+  // We have to hold the mutex while operating on the internal data structures.
+  {
+    std::lock_guard<std::recursive_mutex> lock(mutex);
+    info.id = nextId;
+    ++nextId;
+    std::shared_ptr<WriteBlockCallback<T>> wrappingCallback =
+        std::make_shared<WriteBlockCallback<T>>();
+    wrappingCallback->operationInfo = info;
+    wrappingCallback->impl = shared_from_this();
+    wrappingCallback->delegate = callback;
+    WriteBlockInfo<T> blockInfo;
+    blockInfo.callback = wrappingCallback;
+    blockInfo.values = values;
+    blockInfo.elementDistance = elementDistance;
+    blockInfos.insert(std::make_pair(info.id, std::move(blockInfo)));
+    canRun = canRunOperation(info);
+    if (canRun) {
+      markRunOperation(info);
+    } else {
+      insertOperationInfo(info);
+    }
+  }
+  // We do not want to hold the mutex when processing the operations because we
+  // want to avoid possible dead locks.
+  if (canRun) {
+    runOperation(info);
+  }
+}
+
 void MrfConsistentAsynchronousMemoryAccess::Impl::updateUInt16(
     std::uint32_t address, std::shared_ptr<UpdatingCallbackUInt16> callback) {
   bool canRun;
@@ -170,55 +245,157 @@ void MrfConsistentAsynchronousMemoryAccess::Impl::updateUInt32(
   }
 }
 
+void MrfConsistentAsynchronousMemoryAccess::Impl::writeUInt32Sequence(
+    std::uint32_t address, const std::vector<std::uint32_t> &values,
+    std::uint32_t mask, std::size_t pipelineDepth,
+    std::shared_ptr<CallbackUInt32> callback) {
+  // Without any elements, there is nothing to write, so we simply read the
+  // register in order to have a value that we can pass to the callback.
+  if (values.empty()) {
+    delegate.readUInt32(address, callback);
+    return;
+  }
+  bool canRun;
+  OperationInfo info;
+  info.type = OperationType::writeUInt32Sequence;
+  info.address = address;
+  // We have to hold the mutex while operating on the internal data structures.
+  {
+    std::lock_guard<std::recursive_mutex> lock(mutex);
+    info.id = nextId;
+    ++nextId;
+    std::shared_ptr<WriteSequenceCallback> wrappingCallback =
+        std::make_shared<WriteSequenceCallback>();
+    wrappingCallback->operationInfo = info;
+    wrappingCallback->impl = shared_from_this();
+    wrappingCallback->delegate = callback;
+    wrappingCallback->values = values;
+    wrappingCallback->mask = mask;
+    wrappingCallback->pipelineDepth = pipelineDepth ? pipelineDepth : 1;
+    writeUInt32SequenceCallbacks.insert(
+        std::make_pair(info.id, wrappingCallback));
+    canRun = canRunOperation(info);
+    if (canRun) {
+      markRunOperation(info);
+    } else {
+      insertOperationInfo(info);
+    }
+  }
+  // We do not want to hold the mutex when processing the operations because we
+  // want to avoid possible dead locks.
+  if (canRun) {
+    runOperation(info);
+  }
+}
+
+void MrfConsistentAsynchronousMemoryAccess::Impl::addWriteListener(
+    std::shared_ptr<WriteListener> writeListener) {
+  // We have to hold the mutex while accessing the list of listeners.
+  std::lock_guard<std::mutex> lock(writeListenersMutex);
+  // Before trying to add a listener, we iterate over all existing listeners
+  // and remove those that have become invalid. This ensures that our list does
+  // not grow without bounds when listeners are added but never removed.
+  // We do not increment the iterator in the header of the for loop because we
+  // should not increment it when we replace it after deleting an element.
+  bool listenerMissing = true;
+  for (auto listenerIterator = writeListeners.begin();
+      listenerIterator != writeListeners.end();) {
+    if (listenerIterator->expired()) {
+      listenerIterator = writeListeners.erase(listenerIterator);
+    } else {
+      if (listenerIterator->lock() == writeListener) {
+        listenerMissing = false;
+      }
+      ++listenerIterator;
+    }
+  }
+  if (listenerMissing) {
+    writeListeners.emplace_back(writeListener);
+  }
+}
+
+void MrfConsistentAsynchronousMemoryAccess::Impl::removeWriteListener(
+    std::shared_ptr<WriteListener> writeListener) {
+  // We have to hold the mutex while accessing the list of listeners.
+  std::lock_guard<std::mutex> lock(writeListenersMutex);
+  // We do not increment the iterator in the header of the for loop because we
+  // should not increment it when we replace it after deleting an element.
+  for (auto listenerIterator = writeListeners.begin();
+      listenerIterator != writeListeners.end();) {
+    std::shared_ptr<WriteListener> foundListener = listenerIterator->lock();
+    if (!foundListener || foundListener == writeListener) {
+      listenerIterator = writeListeners.erase(listenerIterator);
+    } else {
+      ++listenerIterator;
+    }
+  }
+}
+
 void MrfConsistentAsynchronousMemoryAccess::Impl::insertOperationInfo(
     const OperationInfo &operationInfo) {
-  std::uint32_t address = operationInfo.address;
-  std::uint32_t width = operationInfo.width();
-  for (std::uint32_t byteIndex = 0; byteIndex < width; ++byteIndex) {
-    pendingOperations.insert(
-        std::make_pair(address + byteIndex, operationInfo));
-  }
+  // Block operations can span thousands of bytes, so we store one entry per
+  // operation instead of one entry per byte.
+  pendingOperations.insert(
+      std::make_pair(operationInfo.address, operationInfo));
+  maxPendingOperationWidth = std::max(maxPendingOperationWidth,
+      operationInfo.width());
 }
 
 void MrfConsistentAsynchronousMemoryAccess::Impl::removeOperationInfo(
     const OperationInfo &operationInfo) {
-  std::uint32_t address = operationInfo.address;
-  std::uint32_t width = operationInfo.width();
-  for (std::uint32_t byteIndex = 0; byteIndex < width; ++byteIndex) {
-    auto range = pendingOperations.equal_range(address + byteIndex);
-    for (auto iterator = range.first; iterator != range.second; iterator++) {
-      if (iterator->second.id == operationInfo.id) {
-        pendingOperations.erase(iterator);
-        // We have found the operation info that we were looking for, so there
-        // is no need to keep looking at the current position.
-        break;
-      }
+  auto range = pendingOperations.equal_range(operationInfo.address);
+  for (auto iterator = range.first; iterator != range.second; ++iterator) {
+    if (iterator->second.id == operationInfo.id) {
+      pendingOperations.erase(iterator);
+      break;
     }
   }
+  if (pendingOperations.empty()) {
+    maxPendingOperationWidth = 0;
+  }
 }
 
 std::forward_list<MrfConsistentAsynchronousMemoryAccess::Impl::OperationInfo> MrfConsistentAsynchronousMemoryAccess::Impl::prepareNextOperations(
     const OperationInfo &operationInfo) {
-  std::forward_list<OperationInfo> runnableOperations;
-  std::uint32_t address = operationInfo.address;
-  std::uint32_t width = operationInfo.width();
-  for (std::uint32_t byteIndex = 0; byteIndex < width; ++byteIndex) {
-    auto range = pendingOperations.equal_range(address + byteIndex);
-    for (auto operationIterator = range.first;
-        operationIterator != range.second; ++operationIterator) {
-      OperationInfo &pendingOperationInfo = operationIterator->second;
-      if (canRunOperation(pendingOperationInfo)) {
-        markRunOperation(pendingOperationInfo);
-        runnableOperations.push_front(pendingOperationInfo);
-        removeOperationInfo(pendingOperationInfo);
-        // We can stop looking for pending operations at the current address
-        // because we know that the current address is now in use. Due to the
-        // remove operation, the operationIterator has become invalid anyway.
-        break;
-      }
+  // We look for all pending operations that overlap with the operation that
+  // has just finished. An operation that starts more than
+  // maxPendingOperationWidth bytes before the finished operation cannot
+  // overlap with it.
+  std::uint32_t searchStart = operationInfo.address;
+  if (searchStart > maxPendingOperationWidth) {
+    searchStart -= maxPendingOperationWidth;
+  } else {
+    searchStart = 0;
+  }
+  std::uint64_t end = operationInfo.end();
+  std::vector<OperationInfo> candidates;
+  for (auto iterator = pendingOperations.lower_bound(searchStart);
+      iterator != pendingOperations.end() && iterator->first < end;
+      ++iterator) {
+    if (iterator->second.end() > operationInfo.address) {
+      candidates.push_back(iterator->second);
+    }
+  }
+  // We check the operations in the order in which they were queued. An
+  // operation that cannot run yet stays in the list of pending operations, so
+  // canRunOperation keeps the operations queued after it that overlap it from
+  // running. Once an operation has been marked as running, the operations
+  // overlapping it cannot run any longer, so each byte is still only used by
+  // one operation at a time.
+  std::sort(candidates.begin(), candidates.end(),
+      [](const OperationInfo &info1, const OperationInfo &info2) {
+        return info1.id < info2.id;
+      });
+  std::vector<OperationInfo> runnableOperations;
+  for (auto &candidate : candidates) {
+    if (canRunOperation(candidate)) {
+      markRunOperation(candidate);
+      removeOperationInfo(candidate);
+      runnableOperations.push_back(candidate);
     }
   }
-  return runnableOperations;
+  return std::forward_list<OperationInfo>(runnableOperations.begin(),
+      runnableOperations.end());
 }
 
 void MrfConsistentAsynchronousMemoryAccess::Impl::runOperation(
@@ -280,6 +457,66 @@ void MrfConsistentAsynchronousMemoryAccess::Impl::runOperation(
     }
     break;
   }
+  case OperationType::writeUInt16Block: {
+    // Each operation is only run once, so we can move the values instead of
+    // copying them.
+    WriteBlockInfo<std::uint16_t> blockInfo = std::move(
+        writeUInt16BlockInfos.at(operationInfo.id));
+    std::shared_ptr<BlockCallbackUInt16> callback = blockInfo.callback;
+    // We have to catch exceptions and call the failure callback to make sure
+    // that things get cleaned up.
+    try {
+      delegate.writeUInt16Block(operationInfo.address, blockInfo.values,
+          blockInfo.elementDistance, callback);
+    } catch (std::exception &e) {
+      try {
+        callback->failure(operationInfo.address, ErrorCode::unknown,
+            std::string("The write operation failed: ") + e.what());
+      } catch (...) {
+        // The callback itself might also throw. We simply ignore such an
+        // exception
+      }
+    } catch (...) {
+      try {
+        callback->failure(operationInfo.address, ErrorCode::unknown,
+            std::string("The write operation failed."));
+      } catch (...) {
+        // The callback itself might also throw. We simply ignore such an
+        // exception
+      }
+    }
+    break;
+  }
+  case OperationType::writeUInt32Block: {
+    // Each operation is only run once, so we can move the values instead of
+    // copying them.
+    WriteBlockInfo<std::uint32_t> blockInfo = std::move(
+        writeUInt32BlockInfos.at(operationInfo.id));
+    std::shared_ptr<BlockCallbackUInt32> callback = blockInfo.callback;
+    // We have to catch exceptions and call the failure callback to make sure
+    // that things get cleaned up.
+    try {
+      delegate.writeUInt32Block(operationInfo.address, blockInfo.values,
+          blockInfo.elementDistance, callback);
+    } catch (std::exception &e) {
+      try {
+        callback->failure(operationInfo.address, ErrorCode::unknown,
+            std::string("The write operation failed: ") + e.what());
+      } catch (...) {
+        // The callback itself might also throw. We simply ignore such an
+        // exception
+      }
+    } catch (...) {
+      try {
+        callback->failure(operationInfo.address, ErrorCode::unknown,
+            std::string("The write operation failed."));
+      } catch (...) {
+        // The callback itself might also throw. We simply ignore such an
+        // exception
+      }
+    }
+    break;
+  }
   case OperationType::updateUInt16: {
     std::shared_ptr<CallbackUInt16> callback = updateUInt16Callbacks.at(
         operationInfo.id);
@@ -332,17 +569,68 @@ void MrfConsistentAsynchronousMemoryAccess::Impl::runOperation(
     }
     break;
   }
+  case OperationType::writeUInt32Sequence: {
+    std::shared_ptr<WriteSequenceCallback> callback =
+        writeUInt32SequenceCallbacks.at(operationInfo.id);
+    // We have to catch exceptions and call the failure callback to make sure
+    // that things get cleaned up.
+    try {
+      delegate.readUInt32(operationInfo.address, callback);
+    } catch (std::exception &e) {
+      try {
+        callback->failure(operationInfo.address, ErrorCode::unknown,
+            std::string("The read operation failed: ") + e.what());
+      } catch (...) {
+        // The callback itself might also throw. We simply ignore such an
+        // exception
+      }
+    } catch (...) {
+      try {
+        callback->failure(operationInfo.address, ErrorCode::unknown,
+            std::string("The read operation failed."));
+      } catch (...) {
+        // The callback itself might also throw. We simply ignore such an
+        // exception
+      }
+    }
+    break;
+  }
   }
 }
 
 bool MrfConsistentAsynchronousMemoryAccess::Impl::canRunOperation(
     const OperationInfo &operationInfo) {
-  std::uint32_t address = operationInfo.address;
-  std::uint32_t width = operationInfo.width();
-  for (std::uint32_t byteIndex = 0; byteIndex < width; ++byteIndex) {
-    if (operationRunning.count(address + byteIndex)) {
-      // There is another operation running that overlaps with the
-      // requested operation.
+  std::uint64_t end = operationInfo.end();
+  // The running operations do not overlap, so if any of them overlaps with the
+  // requested operation, the last one starting before the end of the
+  // requested operation does.
+  auto iterator = runningOperations.lower_bound(operationInfo.address);
+  if (iterator != runningOperations.end() && iterator->first < end) {
+    return false;
+  }
+  if (iterator != runningOperations.begin()) {
+    --iterator;
+    if (iterator->second > operationInfo.address) {
+      return false;
+    }
+  }
+  // An operation must not overtake an overlapping operation that has been
+  // queued earlier and is still waiting. Otherwise, an older write could
+  // overwrite the value of a newer one when it runs later. The IDs are
+  // assigned in the order in which the operations are queued, so we compare
+  // them. The operation itself might be in the list of pending operations, but
+  // its ID is not less than its own ID, so it does not block itself.
+  std::uint32_t searchStart = operationInfo.address;
+  if (searchStart > maxPendingOperationWidth) {
+    searchStart -= maxPendingOperationWidth;
+  } else {
+    searchStart = 0;
+  }
+  for (auto pendingIterator = pendingOperations.lower_bound(searchStart);
+      pendingIterator != pendingOperations.end()
+          && pendingIterator->first < end; ++pendingIterator) {
+    if (pendingIterator->second.end() > operationInfo.address
+        && pendingIterator->second.id < operationInfo.id) {
       return false;
     }
   }
@@ -351,20 +639,13 @@ bool MrfConsistentAsynchronousMemoryAccess::Impl::canRunOperation(
 
 void MrfConsistentAsynchronousMemoryAccess::Impl::markRunOperation(
     const OperationInfo &operationInfo) {
-  std::uint32_t address = operationInfo.address;
-  std::uint32_t width = operationInfo.width();
-  for (std::uint32_t byteIndex = 0; byteIndex < width; ++byteIndex) {
-    operationRunning.insert(address + byteIndex);
-  }
+  runningOperations.insert(
+      std::make_pair(operationInfo.address, operationInfo.end()));
 }
 
 void MrfConsistentAsynchronousMemoryAccess::Impl::unmarkRunOperation(
     const OperationInfo &operationInfo) {
-  std::uint32_t address = operationInfo.address;
-  std::uint32_t width = operationInfo.width();
-  for (std::uint32_t byteIndex = 0; byteIndex < width; ++byteIndex) {
-    operationRunning.erase(address + byteIndex);
-  }
+  runningOperations.erase(operationInfo.address);
 }
 
 void MrfConsistentAsynchronousMemoryAccess::Impl::operationFinished(
@@ -387,6 +668,15 @@ void MrfConsistentAsynchronousMemoryAccess::Impl::operationFinished(
     case OperationType::updateUInt32:
       updateUInt32Callbacks.erase(operationInfo.id);
       break;
+    case OperationType::writeUInt16Block:
+      writeUInt16BlockInfos.erase(operationInfo.id);
+      break;
+    case OperationType::writeUInt32Block:
+      writeUInt32BlockInfos.erase(operationInfo.id);
+      break;
+    case OperationType::writeUInt32Sequence:
+      writeUInt32SequenceCallbacks.erase(operationInfo.id);
+      break;
     }
     runnableOperations = prepareNextOperations(operationInfo);
   }
@@ -398,5 +688,206 @@ void MrfConsistentAsynchronousMemoryAccess::Impl::operationFinished(
   }
 }
 
+std::vector<std::shared_ptr<MrfConsistentMemoryAccess::WriteListener>> MrfConsistentAsynchronousMemoryAccess::Impl::getWriteListeners() {
+  std::vector<std::shared_ptr<WriteListener>> listeners;
+  // We copy the listeners, so that we do not hold the mutex while calling
+  // them.
+  std::lock_guard<std::mutex> lock(writeListenersMutex);
+  listeners.reserve(writeListeners.size());
+  for (auto &weakListener : writeListeners) {
+    auto listener = weakListener.lock();
+    if (listener) {
+      listeners.push_back(std::move(listener));
+    }
+  }
+  return listeners;
+}
+
+void MrfConsistentAsynchronousMemoryAccess::Impl::notifyWriteInvalidated(
+    std::uint32_t address, std::uint32_t length) {
+  for (auto &listener : getWriteListeners()) {
+    try {
+      listener->writeInvalidated(address, length);
+    } catch (...) {
+      // A listener should not throw, but if it does, we still want to notify
+      // the other listeners and finish the operation.
+    }
+  }
+}
+
+void MrfConsistentAsynchronousMemoryAccess::Impl::notifyWriteSucceeded(
+    std::uint32_t address, std::uint16_t value) {
+  for (auto &listener : getWriteListeners()) {
+    try {
+      listener->writeSucceededUInt16(address, value);
+    } catch (...) {
+      // A listener should not throw, but if it does, we still want to notify
+      // the other listeners and finish the operation.
+    }
+  }
+}
+
+void MrfConsistentAsynchronousMemoryAccess::Impl::notifyWriteSucceeded(
+    std::uint32_t address, std::uint32_t value) {
+  for (auto &listener : getWriteListeners()) {
+    try {
+      listener->writeSucceededUInt32(address, value);
+    } catch (...) {
+      // A listener should not throw, but if it does, we still want to notify
+      // the other listeners and finish the operation.
+    }
+  }
+}
+
+void MrfConsistentAsynchronousMemoryAccess::Impl::WriteSequenceCallback::success(
+    std::uint32_t, std::uint32_t value) {
+  // This callback is only used for the initial read. The writes use their own
+  // element callbacks.
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    preservedBits = value & ~mask;
+  }
+  issueWrites();
+}
+
+void MrfConsistentAsynchronousMemoryAccess::Impl::WriteSequenceCallback::failure(
+    std::uint32_t, MrfMemoryAccess::ErrorCode errorCode,
+    const std::string &details) {
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    setFailed(errorCode, details);
+  }
+  issueWrites();
+}
+
+void MrfConsistentAsynchronousMemoryAccess::Impl::WriteSequenceCallback::ElementCallback::success(
+    std::uint32_t, std::uint32_t value) {
+  sequence->writeSucceeded(index, this->value, value);
+}
+
+void MrfConsistentAsynchronousMemoryAccess::Impl::WriteSequenceCallback::ElementCallback::failure(
+    std::uint32_t, MrfMemoryAccess::ErrorCode errorCode,
+    const std::string &details) {
+  sequence->writeFailed(errorCode, details);
+}
+
+void MrfConsistentAsynchronousMemoryAccess::Impl::WriteSequenceCallback::writeSucceeded(
+    std::size_t index, std::uint32_t expectedValue, std::uint32_t value) {
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    --writesInFlight;
+    // The delegate is supposed to execute the writes in the order in which
+    // they have been queued. If it does not (e.g. because a request has been
+    // retransmitted), the values might have been applied in the wrong order,
+    // so we treat this as an error.
+    if (index != writesCompleted) {
+      setFailed(MrfMemoryAccess::ErrorCode::unknown,
+          "The write operation for element " + std::to_string(index)
+              + " of the sequence completed out of order.");
+    } else if ((value ^ expectedValue) & mask) {
+      setFailed(MrfMemoryAccess::ErrorCode::unknown,
+          "Mismatch between the value written to the device and the value read back for element "
+              + std::to_string(index) + " of the sequence.");
+    } else {
+      ++writesCompleted;
+      lastValue = value;
+    }
+  }
+  issueWrites();
+}
+
+void MrfConsistentAsynchronousMemoryAccess::Impl::WriteSequenceCallback::writeFailed(
+    MrfMemoryAccess::ErrorCode errorCode, const std::string &details) {
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    --writesInFlight;
+    setFailed(errorCode, details);
+  }
+  issueWrites();
+}
+
+void MrfConsistentAsynchronousMemoryAccess::Impl::WriteSequenceCallback::setFailed(
+    MrfMemoryAccess::ErrorCode errorCode, const std::string &details) {
+  // We only keep the first error. The writes that are still in flight are
+  // allowed to finish, but no further writes are started. The caller has to
+  // hold the mutex.
+  if (!failed) {
+    failed = true;
+    this->errorCode = errorCode;
+    this->errorDetails = details;
+  }
+}
+
+void MrfConsistentAsynchronousMemoryAccess::Impl::WriteSequenceCallback::issueWrites() {
+  std::unique_lock<std::mutex> lock(mutex);
+  // If another call is already issuing writes, it will pick up the slot that
+  // has just become available, so we can return immediately.
+  if (issuing) {
+    return;
+  }
+  issuing = true;
+  while (!failed && nextIndex < values.size()
+      && writesInFlight < pipelineDepth) {
+    std::size_t index = nextIndex;
+    std::uint32_t value = preservedBits | (values[index] & mask);
+    ++nextIndex;
+    ++writesInFlight;
+    // We must not hold the mutex while calling the delegate because the
+    // delegate might call this callback from the calling thread.
+    lock.unlock();
+    try {
+      impl->delegate.writeUInt32(operationInfo.address, value,
+          std::make_shared<ElementCallback>(shared_from_this(), index, value));
+    } catch (std::exception &e) {
+      lock.lock();
+      --writesInFlight;
+      setFailed(MrfMemoryAccess::ErrorCode::unknown,
+          std::string("The write operation failed: ") + e.what());
+      continue;
+    } catch (...) {
+      lock.lock();
+      --writesInFlight;
+      setFailed(MrfMemoryAccess::ErrorCode::unknown,
+          "The write operation failed.");
+      continue;
+    }
+    lock.lock();
+  }
+  issuing = false;
+  if (finished || writesInFlight != 0
+      || (!failed && writesCompleted != values.size())) {
+    return;
+  }
+  finished = true;
+  lock.unlock();
+  finish();
+}
+
+void MrfConsistentAsynchronousMemoryAccess::Impl::WriteSequenceCallback::finish() {
+  // The operation info keeps a reference to this callback, so we have to make
+  // sure that this object stays alive until we have notified the delegate.
+  std::shared_ptr<WriteSequenceCallback> self = shared_from_this();
+  if (failed) {
+    impl->notifyWriteInvalidated(operationInfo.address, 4);
+  } else {
+    impl->notifyWriteSucceeded(operationInfo.address, lastValue);
+  }
+  try {
+    impl->operationFinished(operationInfo);
+  } catch (...) {
+    // The code should not throw, but if it does, we still want to call the
+    // delegate's method. We do not rethrow the exception because it would be
+    // discarded by the calling code anyway.
+  }
+  if (!delegate) {
+    return;
+  }
+  if (failed) {
+    delegate->failure(operationInfo.address, errorCode, errorDetails);
+  } else {
+    delegate->success(operationInfo.address, lastValue);
+  }
+}
+
 }
 }
@@ -30,11 +30,13 @@
 #ifndef ANKA_MRF_CONSISTENT_ASYNCHRONOUS_MEMORY_ACCESS_H
 #define ANKA_MRF_CONSISTENT_ASYNCHRONOUS_MEMORY_ACCESS_H
 
+#include <cstdint>
 #include <forward_list>
+#include <map>
 #include <memory>
 #include <mutex>
 #include <unordered_map>
-#include <unordered_set>
+#include <vector>
 
 #include "MrfConsistentMemoryAccess.h"
 
@@ -49,7 +51,8 @@ namespace mrf {
  * Therefore, this wrapper can be used without asynchronous memory-access
  * implementations where a write operation might block. It can also be used with
  * synchronous memory-access implementations, but a different implementation
- * might be more efficient.
+ * might be more efficient. Operations that use overlapping memory ranges are
+ * executed one after another, in the order in which they have been queued.
  */
 class MrfConsistentAsynchronousMemoryAccess: public MrfConsistentMemoryAccess {
 
@@ -184,6 +187,80 @@ public:
     return impl->writeUInt32(address, value, callback);
   }
 
+  /**
+   * Reads a block of unsigned 16-bit registers. The method blocks until the
+   * operation has finished (either successfully or unsuccessfully). This
+   * method delegates the read operation to the memory access which has been
+   * passed to the constructor.
+   */
+  inline std::vector<std::uint16_t> readUInt16Block(std::uint32_t address,
+      std::size_t count, std::uint32_t elementDistance) {
+    return impl->delegate.readUInt16Block(address, count, elementDistance);
+  }
+
+  /**
+   * Reads a block of unsigned 16-bit registers. This method does not block.
+   * The operation is queued and executed asynchronously. This method delegates
+   * the read operation to the memory access which has been passed to the
+   * constructor.
+   */
+  inline void readUInt16Block(std::uint32_t address, std::size_t count,
+      std::uint32_t elementDistance,
+      std::shared_ptr<BlockCallbackUInt16> callback) {
+    impl->delegate.readUInt16Block(address, count, elementDistance, callback);
+  }
+
+  /**
+   * Writes a block of unsigned 16-bit registers. This method does not block.
+   * The operation is queued and executed asynchronously. This method delegates
+   * the write operation to the memory access which has been passed to the
+   * constructor. However, the operation is delayed automatically, if a
+   * concurrent update operation to one of the registers in the block is in
+   * progress.
+   */
+  inline void writeUInt16Block(std::uint32_t address,
+      const std::vector<std::uint16_t> &values, std::uint32_t elementDistance,
+      std::shared_ptr<BlockCallbackUInt16> callback) {
+    impl->writeUInt16Block(address, values, elementDistance, callback);
+  }
+
+  /**
+   * Reads a block of unsigned 32-bit registers. The method blocks until the
+   * operation has finished (either successfully or unsuccessfully). This
+   * method delegates the read operation to the memory access which has been
+   * passed to the constructor.
+   */
+  inline std::vector<std::uint32_t> readUInt32Block(std::uint32_t address,
+      std::size_t count, std::uint32_t elementDistance) {
+    return impl->delegate.readUInt32Block(address, count, elementDistance);
+  }
+
+  /**
+   * Reads a block of unsigned 32-bit registers. This method does not block.
+   * The operation is queued and executed asynchronously. This method delegates
+   * the read operation to the memory access which has been passed to the
+   * constructor.
+   */
+  inline void readUInt32Block(std::uint32_t address, std::size_t count,
+      std::uint32_t elementDistance,
+      std::shared_ptr<BlockCallbackUInt32> callback) {
+    impl->delegate.readUInt32Block(address, count, elementDistance, callback);
+  }
+
+  /**
+   * Writes a block of unsigned 32-bit registers. This method does not block.
+   * The operation is queued and executed asynchronously. This method delegates
+   * the write operation to the memory access which has been passed to the
+   * constructor. However, the operation is delayed automatically, if a
+   * concurrent update operation to one of the registers in the block is in
+   * progress.
+   */
+  inline void writeUInt32Block(std::uint32_t address,
+      const std::vector<std::uint32_t> &values, std::uint32_t elementDistance,
+      std::shared_ptr<BlockCallbackUInt32> callback) {
+    impl->writeUInt32Block(address, values, elementDistance, callback);
+  }
+
   /**
    * Updates an unsigned 16-bit register in a consistent way. The register's
    * value is read, then the callback's update method is called, and finally
@@ -208,10 +285,38 @@ public:
     return impl->updateUInt32(address, callback);
   }
 
+  /**
+   * Writes a sequence of values to an unsigned 32-bit register using the
+   * specified mask. The register is read once and the bits that are not set in
+   * the mask are taken from this value for all elements. Other write or update
+   * operations to the same register are blocked until the whole sequence has
+   * been written. Up to the specified number of writes are queued with the
+   * underlying memory access at the same time. Each write is verified by comparing the value read back to the value
+   * written and by checking that the writes complete in order. This method
+   * does not block.
+   */
+  inline void writeUInt32Sequence(std::uint32_t address,
+      const std::vector<std::uint32_t> &values, std::uint32_t mask,
+      std::size_t pipelineDepth, std::shared_ptr<CallbackUInt32> callback) {
+    return impl->writeUInt32Sequence(address, values, mask, pipelineDepth,
+        callback);
+  }
+
   // We want the methods from the base class to participate in overload
   // resolution.
   using MrfConsistentMemoryAccess::writeUInt16;
   using MrfConsistentMemoryAccess::writeUInt32;
+  using MrfConsistentMemoryAccess::writeUInt16Block;
+  using MrfConsistentMemoryAccess::writeUInt32Block;
+
+  /**
+   * Returns the minimum time that passes between the execution of two write
+   * operations by the device. This is the value returned by the backing memory
+   * access.
+   */
+  inline std::chrono::nanoseconds getMinimumWriteInterval() const {
+    return impl->delegate.getMinimumWriteInterval();
+  }
 
   /**
    * Tells whether this memory access supports interrupts. If the memory access
@@ -259,6 +364,81 @@ public:
     return impl->delegate.removeInterruptListener(interruptListener);
   }
 
+  /**
+   * Tells whether this memory access can drain the event FIFO of an event
+   * receiver. This memory access supports this if (and only if) the backing
+   * memory access supports it.
+   */
+  inline bool supportsEventFifo() const {
+    return impl->delegate.supportsEventFifo();
+  }
+
+  /**
+   * Adds the specified listener to the list of listeners that are notified
+   * when entries have been read from the event FIFO. If the specified listener
+   * has already been registered with this memory access, calling this method
+   * has no effect.
+   *
+   * This method may only be called if this memory access supports draining
+   * the event FIFO ({@link supportsEventFifo()} returns {@code true}).
+   * Calling this method on a memory access that does not support this results
+   * in an exception being thrown.
+   */
+  inline void addEventFifoListener(
+      std::shared_ptr<EventFifoListener> eventFifoListener) {
+    return impl->delegate.addEventFifoListener(eventFifoListener);
+  }
+
+  /**
+   * Removes the specified listener from the list of listeners that are
+   * notified when entries have been read from the event FIFO. If the specified
+   * listener has already been removed (or has never been added), calling this
+   * method has no effect.
+   *
+   * This method may only be called if this memory access supports draining
+   * the event FIFO ({@link supportsEventFifo()} returns {@code true}).
+   * Calling this method on a memory access that does not support this results
+   * in an exception being thrown.
+   */
+  inline void removeEventFifoListener(
+      std::shared_ptr<EventFifoListener> eventFifoListener) {
+    return impl->delegate.removeEventFifoListener(eventFifoListener);
+  }
+
+  /**
+   * Tells whether this memory access notifies write listeners. This is always
+   * {@code true} because all write and update operations pass through this
+   * memory access. Writes that are made directly through the backing memory
+   * access are not seen by the listeners.
+   */
+  inline bool supportsWriteListeners() const {
+    return true;
+  }
+
+  /**
+   * Adds the specified listener to the list of listeners that are notified when
+   * a write or update operation has finished. If the specified listener has
+   * already been registered with this memory access, calling this method has no
+   * effect.
+   *
+   * The listeners are internally kept using weak pointers. This means that a
+   * listener will be destroyed if no other references to it are being hold.
+   */
+  inline void addWriteListener(std::shared_ptr<WriteListener> writeListener) {
+    impl->addWriteListener(writeListener);
+  }
+
+  /**
+   * Removes the specified listener from the list of listeners that are notified
+   * when a write or update operation has finished. If the specified listener
+   * has already been removed (or has never been added), calling this method has
+   * no effect.
+   */
+  inline void removeWriteListener(
+      std::shared_ptr<WriteListener> writeListener) {
+    impl->removeWriteListener(writeListener);
+  }
+
 private:
 
   /**
@@ -283,12 +463,30 @@ private:
     void writeUInt32(std::uint32_t address, std::uint32_t value,
         std::shared_ptr<CallbackUInt32> callback);
 
+    void writeUInt16Block(std::uint32_t address,
+        const std::vector<std::uint16_t> &values,
+        std::uint32_t elementDistance,
+        std::shared_ptr<BlockCallbackUInt16> callback);
+
+    void writeUInt32Block(std::uint32_t address,
+        const std::vector<std::uint32_t> &values,
+        std::uint32_t elementDistance,
+        std::shared_ptr<BlockCallbackUInt32> callback);
+
     void updateUInt16(std::uint32_t address,
         std::shared_ptr<UpdatingCallbackUInt16> callback);
 
     void updateUInt32(std::uint32_t address,
         std::shared_ptr<UpdatingCallbackUInt32> callback);
 
+    void writeUInt32Sequence(std::uint32_t address,
+        const std::vector<std::uint32_t> &values, std::uint32_t mask,
+        std::size_t pipelineDepth, std::shared_ptr<CallbackUInt32> callback);
+
+    void addWriteListener(std::shared_ptr<WriteListener> writeListener);
+
+    void removeWriteListener(std::shared_ptr<WriteListener> writeListener);
+
   private:
 
     /**
@@ -296,7 +494,8 @@ private:
      * do not interfere with update operations.
      */
     enum class OperationType {
-      writeUInt16, writeUInt32, updateUInt16, updateUInt32
+      writeUInt16, writeUInt32, updateUInt16, updateUInt32, writeUInt16Block,
+      writeUInt32Block, writeUInt32Sequence
     };
 
     /**
@@ -309,6 +508,19 @@ private:
       unsigned long id;
       OperationType type;
       std::uint32_t address;
+      // Only used for block operations, where it specifies the number of
+      // bytes between the first byte of the first element and the last byte
+      // of the last element.
+      std::uint32_t length;
+
+      /**
+       * Returns the address of the byte right after the last byte that is
+       * touched by the operation. A 64-bit integer is used so that an operation
+       * at the end of the address space does not overflow.
+       */
+      inline std::uint64_t end() const {
+        return static_cast<std::uint64_t>(address) + width();
+      }
 
       inline std::uint32_t width() const {
         switch (type) {
@@ -317,7 +529,11 @@ private:
           return 2;
         case OperationType::writeUInt32:
         case OperationType::updateUInt32:
+        case OperationType::writeUInt32Sequence:
           return 4;
+        case OperationType::writeUInt16Block:
+        case OperationType::writeUInt32Block:
+          return length;
         default:
           // This should never happen as we handle all operation types.
           return 0;
@@ -339,6 +555,30 @@ private:
           const std::string &details);
     };
 
+    /**
+     * Internal callback for block write operations.
+     */
+    template<typename T>
+    struct WriteBlockCallback: MrfMemoryAccess::BlockCallback<T> {
+      OperationInfo operationInfo;
+      std::shared_ptr<Impl> impl;
+      std::shared_ptr<MrfMemoryAccess::BlockCallback<T>> delegate;
+
+      void success(std::uint32_t address, const std::vector<T> &values);
+      void failure(std::uint32_t address, MrfMemoryAccess::ErrorCode errorCode,
+          const std::string &details);
+    };
+
+    /**
+     * Information needed for running a queued block write operation.
+     */
+    template<typename T>
+    struct WriteBlockInfo {
+      std::shared_ptr<MrfMemoryAccess::BlockCallback<T>> callback;
+      std::vector<T> values;
+      std::uint32_t elementDistance;
+    };
+
     /**
      * Internal callback for update operations. It is used for both stages of
      * the update operation (read and write).
@@ -360,17 +600,111 @@ private:
       void write(T newValue);
     };
 
+    /**
+     * Internal callback for write-sequence operations. It is used for the
+     * initial read, while each write gets its own element callback, so that
+     * the value read back can be compared to the value written and the order
+     * in which the writes complete can be checked. The writes are issued by at
+     * most one thread at a time, so that they are queued with the delegate in
+     * order, even if the delegate calls the callback from the calling thread.
+     */
+    class WriteSequenceCallback: public MrfMemoryAccess::CallbackUInt32,
+        public std::enable_shared_from_this<WriteSequenceCallback> {
+    public:
+      OperationInfo operationInfo;
+      std::shared_ptr<Impl> impl;
+      std::shared_ptr<CallbackUInt32> delegate;
+      std::vector<std::uint32_t> values;
+      std::uint32_t mask = 0;
+      std::size_t pipelineDepth = 1;
+
+      void success(std::uint32_t address, std::uint32_t value);
+      void failure(std::uint32_t address, MrfMemoryAccess::ErrorCode errorCode,
+          const std::string &details);
+
+    private:
+      /**
+       * Callback for a single write of the sequence.
+       */
+      class ElementCallback: public MrfMemoryAccess::CallbackUInt32 {
+      public:
+        ElementCallback(std::shared_ptr<WriteSequenceCallback> sequence,
+            std::size_t index, std::uint32_t value) :
+            sequence(sequence), index(index), value(value) {
+        }
+
+        void success(std::uint32_t address, std::uint32_t value);
+        void failure(std::uint32_t address,
+            MrfMemoryAccess::ErrorCode errorCode, const std::string &details);
+
+      private:
+        std::shared_ptr<WriteSequenceCallback> sequence;
+        std::size_t index;
+        std::uint32_t value;
+      };
+
+      std::mutex mutex;
+      bool issuing = false;
+      bool finished = false;
+      std::uint32_t preservedBits = 0;
+      std::size_t nextIndex = 0;
+      std::size_t writesInFlight = 0;
+      std::size_t writesCompleted = 0;
+      std::uint32_t lastValue = 0;
+      bool failed = false;
+      MrfMemoryAccess::ErrorCode errorCode = MrfMemoryAccess::ErrorCode::unknown;
+      std::string errorDetails;
+
+      void writeSucceeded(std::size_t index, std::uint32_t expectedValue,
+          std::uint32_t value);
+      void writeFailed(MrfMemoryAccess::ErrorCode errorCode,
+          const std::string &details);
+      void setFailed(MrfMemoryAccess::ErrorCode errorCode,
+          const std::string &details);
+      void issueWrites();
+      void finish();
+    };
+
     std::recursive_mutex mutex;
     unsigned long nextId = 0;
-    std::unordered_multimap<std::uint32_t, OperationInfo> pendingOperations;
-    std::unordered_set<std::uint32_t> operationRunning;
+    /**
+     * Operations that are waiting for an overlapping operation to finish,
+     * ordered by their start address. Pending operations may overlap each
+     * other, so when looking for operations that overlap a certain range, we
+     * also have to look at the operations that start up to
+     * maxPendingOperationWidth bytes before that range.
+     */
+    std::multimap<std::uint32_t, OperationInfo> pendingOperations;
+    std::uint32_t maxPendingOperationWidth = 0;
+    /**
+     * Address ranges used by the operations that are currently running,
+     * mapping the start address to the end address (exclusive). Running
+     * operations never overlap, so the ranges are disjoint.
+     */
+    std::map<std::uint32_t, std::uint64_t> runningOperations;
     std::unordered_map<unsigned long,
         std::pair<std::shared_ptr<CallbackUInt16>, std::uint16_t>> writeUInt16CallbacksAndValues;
     std::unordered_map<unsigned long,
         std::pair<std::shared_ptr<CallbackUInt32>, std::uint32_t>> writeUInt32CallbacksAndValues;
+    std::unordered_map<unsigned long, WriteBlockInfo<std::uint16_t>> writeUInt16BlockInfos;
+    std::unordered_map<unsigned long, WriteBlockInfo<std::uint32_t>> writeUInt32BlockInfos;
     std::unordered_map<unsigned long, std::shared_ptr<CallbackUInt16>> updateUInt16Callbacks;
     std::unordered_map<unsigned long, std::shared_ptr<CallbackUInt32>> updateUInt32Callbacks;
+    std::unordered_map<unsigned long, std::shared_ptr<WriteSequenceCallback>> writeUInt32SequenceCallbacks;
 
+    /**
+     * Mutex protecting the list of write listeners. This is separate from the
+     * main mutex because the listeners are notified from the callbacks, which
+     * might be called while the main mutex is being held.
+     */
+    std::mutex writeListenersMutex;
+    std::vector<std::weak_ptr<WriteListener>> writeListeners;
+
+    template<typename T>
+    void writeBlock(OperationType type, std::uint32_t address,
+        const std::vector<T> &values, std::uint32_t elementDistance,
+        std::shared_ptr<BlockCallback<T>> callback,
+        std::unordered_map<unsigned long, WriteBlockInfo<T>> &blockInfos);
     void insertOperationInfo(const OperationInfo &operationInfo);
     void removeOperationInfo(const OperationInfo &operationInfo);
     std::forward_list<OperationInfo> prepareNextOperations(
@@ -380,6 +714,10 @@ private:
     void markRunOperation(const OperationInfo &operationInfo);
     void unmarkRunOperation(const OperationInfo &operationInfo);
     void operationFinished(const OperationInfo &operationInfo);
+    std::vector<std::shared_ptr<WriteListener>> getWriteListeners();
+    void notifyWriteInvalidated(std::uint32_t address, std::uint32_t length);
+    void notifyWriteSucceeded(std::uint32_t address, std::uint16_t value);
+    void notifyWriteSucceeded(std::uint32_t address, std::uint32_t value);
 
   };
 
@@ -400,6 +738,9 @@ private:
 template<typename T>
 void MrfConsistentAsynchronousMemoryAccess::MrfConsistentAsynchronousMemoryAccess::Impl::WriteCallback<
     T>::success(std::uint32_t address, T value) {
+  // The write listeners have to be notified before the next operation for the
+  // same register can be started.
+  impl->notifyWriteSucceeded(address, value);
   try {
     impl->operationFinished(operationInfo);
   } catch (...) {
@@ -416,6 +757,43 @@ template<typename T>
 void MrfConsistentAsynchronousMemoryAccess::MrfConsistentAsynchronousMemoryAccess::Impl::WriteCallback<
     T>::failure(std::uint32_t address, MrfMemoryAccess::ErrorCode errorCode,
     const std::string &details) {
+  impl->notifyWriteInvalidated(address, sizeof(T));
+  try {
+    impl->operationFinished(operationInfo);
+  } catch (...) {
+    // The code should not throw, but if it does, we still want to call the
+    // delegate's method. We do not rethrow the exception because it would be
+    // discarded by the calling code anyway.
+  }
+  if (delegate) {
+    delegate->failure(address, errorCode, details);
+  }
+}
+
+template<typename T>
+void MrfConsistentAsynchronousMemoryAccess::MrfConsistentAsynchronousMemoryAccess::Impl::WriteBlockCallback<
+    T>::success(std::uint32_t address, const std::vector<T> &values) {
+  // The values passed to the callback are not necessarily the ones stored in
+  // the registers (e.g. when the elements are not contiguous), so we simply
+  // invalidate the whole range.
+  impl->notifyWriteInvalidated(operationInfo.address, operationInfo.length);
+  try {
+    impl->operationFinished(operationInfo);
+  } catch (...) {
+    // The code should not throw, but if it does, we still want to call the
+    // delegate's method. We do not rethrow the exception because it would be
+    // discarded by the calling code anyway.
+  }
+  if (delegate) {
+    delegate->success(address, values);
+  }
+}
+
+template<typename T>
+void MrfConsistentAsynchronousMemoryAccess::MrfConsistentAsynchronousMemoryAccess::Impl::WriteBlockCallback<
+    T>::failure(std::uint32_t address, MrfMemoryAccess::ErrorCode errorCode,
+    const std::string &details) {
+  impl->notifyWriteInvalidated(operationInfo.address, operationInfo.length);
   try {
     impl->operationFinished(operationInfo);
   } catch (...) {
@@ -432,6 +810,7 @@ template<typename T>
 void MrfConsistentAsynchronousMemoryAccess::MrfConsistentAsynchronousMemoryAccess::Impl::UpdateCallback<
     T>::success(std::uint32_t address, T value) {
   if (readFinished) {
+    impl->notifyWriteSucceeded(address, value);
     try {
       impl->operationFinished(operationInfo);
     } catch (...) {
@@ -466,6 +845,11 @@ template<typename T>
 void MrfConsistentAsynchronousMemoryAccess::MrfConsistentAsynchronousMemoryAccess::Impl::UpdateCallback<
     T>::failure(std::uint32_t address, MrfMemoryAccess::ErrorCode errorCode,
     const std::string &details) {
+  // If the read has finished, the write might have modified the register even
+  // though it failed.
+  if (readFinished) {
+    impl->notifyWriteInvalidated(address, sizeof(T));
+  }
   try {
     impl->operationFinished(operationInfo);
   } catch (...) {
@@ -28,6 +28,7 @@
  */
 
 #include <condition_variable>
+#include <memory>
 #include <mutex>
 #include <stdexcept>
 
@@ -120,6 +121,55 @@ public:
   }
 
 };
+
+class SequentialWriteCallbackImpl: public MrfMemoryAccess::CallbackUInt32,
+    public std::enable_shared_from_this<SequentialWriteCallbackImpl> {
+private:
+  MrfConsistentMemoryAccess &memoryAccess;
+  std::vector<std::uint32_t> values;
+  std::uint32_t mask;
+  std::size_t nextIndex = 0;
+  std::shared_ptr<MrfMemoryAccess::CallbackUInt32> notifyCallback;
+
+public:
+  SequentialWriteCallbackImpl(MrfConsistentMemoryAccess &memoryAccess,
+      const std::vector<std::uint32_t> &values, std::uint32_t mask,
+      std::shared_ptr<MrfMemoryAccess::CallbackUInt32> notifyCallback) :
+      memoryAccess(memoryAccess), values(values), mask(mask), notifyCallback(
+          notifyCallback) {
+  }
+
+  void writeNext(std::uint32_t address) {
+    std::uint32_t value = values[nextIndex];
+    ++nextIndex;
+    memoryAccess.writeUInt32(address, value, mask, shared_from_this());
+  }
+
+  void success(std::uint32_t address, std::uint32_t value) {
+    if ((value ^ values[nextIndex - 1]) & mask) {
+      failure(address, MrfMemoryAccess::ErrorCode::unknown,
+          "Mismatch between the value written to the device and the value read back for element "
+              + std::to_string(nextIndex - 1) + " of the sequence.");
+    } else if (nextIndex < values.size()) {
+      try {
+        writeNext(address);
+      } catch (std::exception &e) {
+        failure(address, MrfMemoryAccess::ErrorCode::unknown,
+            std::string("The write operation failed: ") + e.what());
+      }
+    } else if (notifyCallback) {
+      notifyCallback->success(address, value);
+    }
+  }
+
+  void failure(std::uint32_t address, MrfMemoryAccess::ErrorCode errorCode,
+      const std::string &details) {
+    if (notifyCallback) {
+      notifyCallback->failure(address, errorCode, details);
+    }
+  }
+};
+
 }
 
 void MrfConsistentMemoryAccess::writeUInt16(std::uint32_t address,
@@ -140,6 +190,21 @@ void MrfConsistentMemoryAccess::writeUInt32(std::uint32_t address,
   updateUInt32(address, internalCallback);
 }
 
+void MrfConsistentMemoryAccess::writeUInt32Sequence(std::uint32_t address,
+    const std::vector<std::uint32_t> &values, std::uint32_t mask,
+    std::size_t, std::shared_ptr<CallbackUInt32> callback) {
+  if (values.empty()) {
+    // Without any elements, we would not have a value to report, so we read
+    // the register instead.
+    readUInt32(address, callback);
+    return;
+  }
+  std::shared_ptr<SequentialWriteCallbackImpl> internalCallback =
+      std::make_shared<SequentialWriteCallbackImpl>(*this, values, mask,
+          callback);
+  internalCallback->writeNext(address);
+}
+
 std::uint16_t MrfConsistentMemoryAccess::writeUInt16(std::uint32_t address,
     std::uint16_t value, std::uint16_t mask) {
   auto callback = std::make_shared<SynchronousCallbackImpl<std::uint16_t>>();
@@ -154,5 +219,21 @@ std::uint32_t MrfConsistentMemoryAccess::writeUInt32(std::uint32_t address,
   return callback->getResult();
 }
 
+bool MrfConsistentMemoryAccess::supportsWriteListeners() const {
+  return false;
+}
+
+void MrfConsistentMemoryAccess::addWriteListener(
+    std::shared_ptr<WriteListener>) {
+  throw std::runtime_error(
+      "This memory access does not support write listeners.");
+}
+
+void MrfConsistentMemoryAccess::removeWriteListener(
+    std::shared_ptr<WriteListener>) {
+  throw std::runtime_error(
+      "This memory access does not support write listeners.");
+}
+
 }
 }
@@ -84,6 +84,64 @@ public:
 
   };
 
+  /**
+   * Listener that is notified when a write or update operation has finished.
+   * Such a listener can be registered with an {@link MrfConsistentMemoryAccess}
+   * that supports write listeners. It is used for keeping caches coherent with
+   * the values written to the device.
+   *
+   * The listener is called from the thread that finishes the operation, before
+   * the next write or update operation for the same register is started. It
+   * should return quickly and must not throw.
+   */
+  class WriteListener {
+
+  public:
+
+    /**
+     * Notifies the listener that the value of the specified range of registers
+     * is unknown because a write operation to the range has failed or has not
+     * provided the value that was read back. The length is specified in bytes.
+     */
+    virtual void writeInvalidated(std::uint32_t address,
+        std::uint32_t length) =0;
+
+    /**
+     * Notifies the listener that a write or update operation to an unsigned
+     * 16-bit register has finished successfully. The value read back after
+     * writing to the register is passed.
+     */
+    virtual void writeSucceededUInt16(std::uint32_t address,
+        std::uint16_t value) =0;
+
+    /**
+     * Notifies the listener that a write or update operation to an unsigned
+     * 32-bit register has finished successfully. The value read back after
+     * writing to the register is passed.
+     */
+    virtual void writeSucceededUInt32(std::uint32_t address,
+        std::uint32_t value) =0;
+
+    /**
+     * Default constructor.
+     */
+    WriteListener() {
+    }
+
+    /**
+     * Destructor. Virtual classes should have a virtual destructor.
+     */
+    virtual ~WriteListener() {
+    }
+
+    // We do not want to allow copy or move construction or assignment.
+    WriteListener(const WriteListener &) = delete;
+    WriteListener(WriteListener &&) = delete;
+    WriteListener &operator=(const WriteListener &) = delete;
+    WriteListener &operator=(WriteListener &&) = delete;
+
+  };
+
   /**
    * Default constructor.
    */
@@ -166,6 +224,75 @@ public:
   virtual void writeUInt32(std::uint32_t address, std::uint32_t value,
       std::uint32_t mask, std::shared_ptr<CallbackUInt32> callback);
 
+  /**
+   * Writes a sequence of values to an unsigned 32-bit register using the
+   * specified mask. This is intended for bit-banging a serial protocol through
+   * GPIO lines, where each value represents one state of the lines. Only those
+   * bits of the values that are set in mask are written to the register. The
+   * other bits are copied from the previous value of the register. This method
+   * does not block. The operation is queued and executed asynchronously. When
+   * the whole sequence has been written, the specified callback is called with
+   * the value read back after writing the last element. The value read back
+   * after each write is compared to the value that has been written (only
+   * considering the bits in the mask). If one of them does not match, or if the
+   * writes do not complete in the order in which they have been queued, no
+   * further writes are started and the callback's failure method is called.
+   *
+   * The pipeline depth specifies how many writes may be queued with the
+   * underlying memory access at the same time. A depth of one means that each
+   * write is only started after the previous one has finished. A larger depth
+   * avoids waiting for a round trip after each element, but relies on the
+   * underlying memory access executing queued writes in order.
+   *
+   * The default implementation ignores the pipeline depth and writes the
+   * elements one after another, each of them using {@link writeUInt32(
+   * std::uint32_t, std::uint32_t, std::uint32_t,
+   * std::shared_ptr<CallbackUInt32>)}. Subclasses should override this method
+   * if they can block other operations on the register for the whole sequence
+   * and read the register only once.
+   */
+  virtual void writeUInt32Sequence(std::uint32_t address,
+      const std::vector<std::uint32_t> &values, std::uint32_t mask,
+      std::size_t pipelineDepth, std::shared_ptr<CallbackUInt32> callback);
+
+  /**
+   * Tells whether this memory access notifies write listeners. The default
+   * implementation returns {@code false}.
+   *
+   * Subclasses that support write listeners must override this method along
+   * with the {@link addWriteListener(std::shared_ptr<WriteListener>)} and
+   * {@link removeWriteListener(std::shared_ptr<WriteListener>)} methods.
+   */
+  virtual bool supportsWriteListeners() const;
+
+  /**
+   * Adds the specified listener to the list of listeners that are notified when
+   * a write or update operation has finished. If the specified listener has
+   * already been registered with this memory access, calling this method has no
+   * effect.
+   *
+   * The listeners are internally kept using weak pointers. This means that a
+   * listener will be destroyed if no other references to it are being hold.
+   *
+   * This method may only be called if this memory access supports write
+   * listeners ({@link supportsWriteListeners()} returns {@code true}). The
+   * default implementation throws an exception.
+   */
+  virtual void addWriteListener(std::shared_ptr<WriteListener> writeListener);
+
+  /**
+   * Removes the specified listener from the list of listeners that are notified
+   * when a write or update operation has finished. If the specified listener
+   * has already been removed (or has never been added), calling this method has
+   * no effect.
+   *
+   * This method may only be called if this memory access supports write
+   * listeners ({@link supportsWriteListeners()} returns {@code true}). The
+   * default implementation throws an exception.
+   */
+  virtual void removeWriteListener(
+      std::shared_ptr<WriteListener> writeListener);
+
   // We want the methods from the base class to participate in overload
   // resolution.
   using MrfMemoryAccess::writeUInt16;
@@ -29,6 +29,7 @@
 
 #include <condition_variable>
 #include <cstdio>
+#include <limits>
 #include <mutex>
 #include <stdexcept>
 
@@ -98,6 +99,168 @@ public:
 
 };
 
+template<typename T>
+class BlockCallbackImpl: public MrfMemoryAccess::BlockCallback<T> {
+private:
+  std::mutex mutex;
+  std::condition_variable cv;
+  bool finished = false;
+  std::vector<T> values;
+  bool successful = false;
+  std::uint32_t address;
+  MrfMemoryAccess::ErrorCode errorCode;
+  std::string details;
+
+public:
+  BlockCallbackImpl() :
+      address(0), errorCode(MrfMemoryAccess::ErrorCode::unknown) {
+  }
+
+  void success(std::uint32_t, const std::vector<T> &values) {
+    std::unique_lock<std::mutex> lock(mutex);
+    this->finished = true;
+    this->values = values;
+    this->successful = true;
+    cv.notify_all();
+  }
+
+  void failure(std::uint32_t address, MrfMemoryAccess::ErrorCode errorCode,
+      const std::string &details) {
+    std::unique_lock<std::mutex> lock(mutex);
+    this->finished = true;
+    this->successful = false;
+    this->address = address;
+    this->errorCode = errorCode;
+    this->details = details;
+    cv.notify_all();
+  }
+
+  std::vector<T> getResult() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (!finished) {
+      cv.wait(lock);
+    }
+    if (!successful) {
+      throw std::runtime_error(
+          std::string("Block memory access operation for address ")
+              + mrfMemoryAddressToString(address) + " failed: "
+              + (details.empty() ? mrfErrorCodeToString(errorCode) : details));
+    }
+    return std::move(values);
+  }
+
+};
+
+/**
+ * Callback that is used when emulating a block operation with one operation
+ * per element. It collects the results of the individual operations and
+ * notifies the block callback when all of them have finished.
+ */
+template<typename T>
+class BlockEmulationCallback: public MrfMemoryAccess::Callback<T> {
+private:
+  std::mutex mutex;
+  const std::uint32_t address;
+  const std::uint32_t elementDistance;
+  std::vector<T> values;
+  std::size_t remaining;
+  bool failed = false;
+  MrfMemoryAccess::ErrorCode errorCode;
+  std::string details;
+  const std::shared_ptr<MrfMemoryAccess::BlockCallback<T>> delegate;
+
+  void elementFinished(std::unique_lock<std::mutex> &lock) {
+    --remaining;
+    if (remaining != 0) {
+      return;
+    }
+    // This was the last element, so no other thread is going to access the
+    // data any longer and we can release the mutex before calling the
+    // delegate.
+    lock.unlock();
+    if (failed) {
+      delegate->failure(address, errorCode, details);
+    } else {
+      delegate->success(address, values);
+    }
+  }
+
+public:
+  BlockEmulationCallback(std::uint32_t address, std::size_t count,
+      std::uint32_t elementDistance,
+      std::shared_ptr<MrfMemoryAccess::BlockCallback<T>> delegate) :
+      address(address), elementDistance(elementDistance), values(count),
+      remaining(count), errorCode(MrfMemoryAccess::ErrorCode::unknown),
+      delegate(delegate) {
+  }
+
+  void success(std::uint32_t address, T value) {
+    std::unique_lock<std::mutex> lock(mutex);
+    values[(address - this->address) / elementDistance] = value;
+    elementFinished(lock);
+  }
+
+  void failure(std::uint32_t address, MrfMemoryAccess::ErrorCode errorCode,
+      const std::string &details) {
+    std::unique_lock<std::mutex> lock(mutex);
+    // We only report the first error because the other ones are most likely
+    // caused by the same problem.
+    if (!failed) {
+      failed = true;
+      this->errorCode = errorCode;
+      this->details = std::string("Access to element at address ")
+          + mrfMemoryAddressToString(address) + " failed: "
+          + (details.empty() ? mrfErrorCodeToString(errorCode) : details);
+    }
+    elementFinished(lock);
+  }
+
+};
+
+/**
+ * Emulates a block operation by running one operation for each element. The
+ * specified function is called for each element, getting the element index,
+ * the element address, and the callback that has to be used.
+ */
+template<typename T, typename ElementOperation>
+void emulateBlockOperation(std::uint32_t address, std::size_t count,
+    std::uint32_t elementDistance,
+    std::shared_ptr<MrfMemoryAccess::BlockCallback<T>> callback,
+    ElementOperation elementOperation) {
+  if (elementDistance == 0) {
+    elementDistance = sizeof(T);
+  }
+  if (count == 0) {
+    callback->success(address, std::vector<T>());
+    return;
+  }
+  // The address of the last element must not overflow. The individual
+  // operations check whether an address is actually valid for the device.
+  if ((count - 1) > (std::numeric_limits<std::uint32_t>::max() - address)
+      / elementDistance) {
+    callback->failure(address, MrfMemoryAccess::ErrorCode::invalidAddress,
+        std::string());
+    return;
+  }
+  auto emulationCallback = std::make_shared<BlockEmulationCallback<T>>(
+      address, count, elementDistance, callback);
+  for (std::size_t index = 0; index < count; ++index) {
+    std::uint32_t elementAddress = address
+        + static_cast<std::uint32_t>(index) * elementDistance;
+    // Each element must be finished exactly once, so we have to fail it if
+    // the operation cannot even be started.
+    try {
+      elementOperation(index, elementAddress, emulationCallback);
+    } catch (std::exception &e) {
+      emulationCallback->failure(elementAddress,
+          MrfMemoryAccess::ErrorCode::unknown, e.what());
+    } catch (...) {
+      emulationCallback->failure(elementAddress,
+          MrfMemoryAccess::ErrorCode::unknown, std::string());
+    }
+  }
+}
+
 }
 
 std::uint16_t MrfMemoryAccess::readUInt16(std::uint32_t address) {
@@ -126,6 +289,80 @@ std::uint32_t MrfMemoryAccess::writeUInt32(std::uint32_t address,
   return callback->getResult();
 }
 
+std::vector<std::uint16_t> MrfMemoryAccess::readUInt16Block(
+    std::uint32_t address, std::size_t count, std::uint32_t elementDistance) {
+  auto callback = std::make_shared<BlockCallbackImpl<std::uint16_t>>();
+  this->readUInt16Block(address, count, elementDistance, callback);
+  return callback->getResult();
+}
+
+std::vector<std::uint16_t> MrfMemoryAccess::writeUInt16Block(
+    std::uint32_t address, const std::vector<std::uint16_t> &values,
+    std::uint32_t elementDistance) {
+  auto callback = std::make_shared<BlockCallbackImpl<std::uint16_t>>();
+  this->writeUInt16Block(address, values, elementDistance, callback);
+  return callback->getResult();
+}
+
+void MrfMemoryAccess::readUInt16Block(std::uint32_t address, std::size_t count,
+    std::uint32_t elementDistance,
+    std::shared_ptr<BlockCallbackUInt16> callback) {
+  emulateBlockOperation(address, count, elementDistance, callback,
+      [this](std::size_t, std::uint32_t elementAddress,
+          std::shared_ptr<CallbackUInt16> elementCallback) {
+        this->readUInt16(elementAddress, elementCallback);
+      });
+}
+
+void MrfMemoryAccess::writeUInt16Block(std::uint32_t address,
+    const std::vector<std::uint16_t> &values, std::uint32_t elementDistance,
+    std::shared_ptr<BlockCallbackUInt16> callback) {
+  emulateBlockOperation(address, values.size(), elementDistance, callback,
+      [this, &values](std::size_t index, std::uint32_t elementAddress,
+          std::shared_ptr<CallbackUInt16> elementCallback) {
+        this->writeUInt16(elementAddress, values[index], elementCallback);
+      });
+}
+
+std::vector<std::uint32_t> MrfMemoryAccess::readUInt32Block(
+    std::uint32_t address, std::size_t count, std::uint32_t elementDistance) {
+  auto callback = std::make_shared<BlockCallbackImpl<std::uint32_t>>();
+  this->readUInt32Block(address, count, elementDistance, callback);
+  return callback->getResult();
+}
+
+std::vector<std::uint32_t> MrfMemoryAccess::writeUInt32Block(
+    std::uint32_t address, const std::vector<std::uint32_t> &values,
+    std::uint32_t elementDistance) {
+  auto callback = std::make_shared<BlockCallbackImpl<std::uint32_t>>();
+  this->writeUInt32Block(address, values, elementDistance, callback);
+  return callback->getResult();
+}
+
+void MrfMemoryAccess::readUInt32Block(std::uint32_t address, std::size_t count,
+    std::uint32_t elementDistance,
+    std::shared_ptr<BlockCallbackUInt32> callback) {
+  emulateBlockOperation(address, count, elementDistance, callback,
+      [this](std::size_t, std::uint32_t elementAddress,
+          std::shared_ptr<CallbackUInt32> elementCallback) {
+        this->readUInt32(elementAddress, elementCallback);
+      });
+}
+
+void MrfMemoryAccess::writeUInt32Block(std::uint32_t address,
+    const std::vector<std::uint32_t> &values, std::uint32_t elementDistance,
+    std::shared_ptr<BlockCallbackUInt32> callback) {
+  emulateBlockOperation(address, values.size(), elementDistance, callback,
+      [this, &values](std::size_t index, std::uint32_t elementAddress,
+          std::shared_ptr<CallbackUInt32> elementCallback) {
+        this->writeUInt32(elementAddress, values[index], elementCallback);
+      });
+}
+
+std::chrono::nanoseconds MrfMemoryAccess::getMinimumWriteInterval() const {
+  return std::chrono::nanoseconds(0);
+}
+
 bool MrfMemoryAccess::supportsInterrupts() const {
   return false;
 }
@@ -139,6 +376,21 @@ void MrfMemoryAccess::removeInterruptListener(
   throw std::runtime_error("This memory access does not support interrupts.");
 }
 
+bool MrfMemoryAccess::supportsEventFifo() const {
+  return false;
+}
+
+void MrfMemoryAccess::addEventFifoListener(std::shared_ptr<EventFifoListener>) {
+  throw std::runtime_error(
+      "This memory access does not support draining the event FIFO.");
+}
+
+void MrfMemoryAccess::removeEventFifoListener(
+    std::shared_ptr<EventFifoListener>) {
+  throw std::runtime_error(
+      "This memory access does not support draining the event FIFO.");
+}
+
 std::string mrfMemoryAddressToString(std::uint32_t address) {
   char buffer[11];
   if (std::snprintf(buffer, 11, "0x%08x", address) < 0) {
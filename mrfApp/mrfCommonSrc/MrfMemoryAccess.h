@@ -30,9 +30,11 @@
 #ifndef ANKA_MRF_MEMORY_ACCESS_H
 #define ANKA_MRF_MEMORY_ACCESS_H
 
+#include <chrono>
 #include <cstdint>
 #include <memory>
 #include <string>
+#include <vector>
 
 namespace anka {
 namespace mrf {
@@ -125,6 +127,56 @@ public:
 
   };
 
+  /**
+   * Interface for a block memory-access callback. Such a callback is used for
+   * operations that read or write a whole range of registers with a single
+   * request.
+   */
+  template<typename T>
+  class BlockCallback {
+
+  public:
+
+    /**
+     * Called when a block read or write operation succeeds. The address passed
+     * is the start address specified in the request. The values passed are
+     * the values read from the device memory (even for write operations), in
+     * the order of ascending addresses.
+     */
+    virtual void success(std::uint32_t address,
+        const std::vector<T> &values) = 0;
+
+    /**
+     * Called when a block read or write operation fails finally. The address
+     * passed is the start address specified in the request. The error code
+     * gives information about the cause of the failure. The optional string
+     * may give additional information about the cause of the error (e.g. the
+     * system call that failed), but it may also be empty. When a block write
+     * operation fails, some of the registers might have been written anyway.
+     */
+    virtual void failure(std::uint32_t address, ErrorCode errorCode,
+        const std::string &details) =0;
+
+    /**
+     * Default constructor.
+     */
+    BlockCallback() {
+    }
+
+    /**
+     * Destructor. Virtual classes should have a virtual destructor.
+     */
+    virtual ~BlockCallback() {
+    }
+
+    // We do not want to allow copy or move construction or assignment.
+    BlockCallback(const BlockCallback &) = delete;
+    BlockCallback(BlockCallback &&) = delete;
+    BlockCallback &operator=(const BlockCallback &) = delete;
+    BlockCallback &operator=(BlockCallback &&) = delete;
+
+  };
+
   /**
    * Listener that is notified when a device generates an interrupt. Such a
    * listener can be registered with an {@link MrfMemoryAccess} that supports
@@ -144,6 +196,17 @@ public:
      */
     virtual void operator()(std::uint32_t interruptFlags) =0;
 
+    /**
+     * Returns the interrupt flags that this listener is interested in. A memory
+     * access may skip notifying the listener of interrupts that have none of
+     * these flags set. The mask must not change while the listener is
+     * registered. The default implementation returns a mask that has all bits
+     * set, so that the listener is notified of every interrupt.
+     */
+    virtual std::uint32_t getInterruptFlagsMask() const {
+      return 0xffffffff;
+    }
+
     /**
      * Default constructor.
      */
@@ -164,6 +227,78 @@ public:
 
   };
 
+  /**
+   * Entry of the event FIFO of an event receiver. Each entry represents an
+   * event that has been received by the event receiver.
+   */
+  struct EventFifoEntry {
+
+    /**
+     * Value of the seconds counter at the time when the event was received.
+     */
+    std::uint32_t seconds;
+
+    /**
+     * Value of the timestamp counter at the time when the event was received.
+     * Depending on the configuration of the event receiver, this is the number
+     * of event clock cycles or the number of timestamp clock cycles since the
+     * seconds counter was last incremented.
+     */
+    std::uint32_t timestamp;
+
+    /**
+     * Event code of the received event. This is never zero.
+     */
+    std::uint8_t eventCode;
+
+  };
+
+  /**
+   * Listener that is notified when entries have been read from the event FIFO
+   * of an event receiver. Such a listener can be registered with an
+   * {@link MrfMemoryAccess} that supports draining the event FIFO.
+   */
+  class EventFifoListener {
+
+  public:
+
+    /**
+     * Notifies the listener that entries have been read from the event FIFO.
+     * The entries are passed in the order in which they have been received by
+     * the device. The memory holding the entries is only valid while this
+     * method is running, so the listener has to copy the entries that it is
+     * interested in. This method is usually called from a thread that also
+     * handles the I/O for the device, so it should return as quickly as
+     * possible.
+     *
+     * The overflow flag is set when the event FIFO overflowed before it could
+     * be drained or when entries could not be read due to an I/O error. In
+     * this case, entries have been lost. The overflow flag might be set even
+     * if the number of entries passed is zero.
+     */
+    virtual void operator()(const EventFifoEntry *entries, std::size_t count,
+        bool overflow) =0;
+
+    /**
+     * Default constructor.
+     */
+    EventFifoListener() {
+    }
+
+    /**
+     * Destructor. Virtual classes should have a virtual destructor.
+     */
+    virtual ~EventFifoListener() {
+    }
+
+    // We do not want to allow copy or move construction or assignment.
+    EventFifoListener(const EventFifoListener &) = delete;
+    EventFifoListener(EventFifoListener &&) = delete;
+    EventFifoListener &operator=(const EventFifoListener &) = delete;
+    EventFifoListener &operator=(EventFifoListener &&) = delete;
+
+  };
+
   /**
    * Callback for reading from or writing to an unsigned 16-bit register.
    */
@@ -174,6 +309,18 @@ public:
    */
   using CallbackUInt32 = Callback<std::uint32_t>;
 
+  /**
+   * Callback for reading from or writing to a block of unsigned 16-bit
+   * registers.
+   */
+  using BlockCallbackUInt16 = BlockCallback<std::uint16_t>;
+
+  /**
+   * Callback for reading from or writing to a block of unsigned 32-bit
+   * registers.
+   */
+  using BlockCallbackUInt32 = BlockCallback<std::uint32_t>;
+
   /**
    * Default constructor.
    */
@@ -247,6 +394,139 @@ public:
   virtual void writeUInt32(std::uint32_t address, std::uint32_t value,
       std::shared_ptr<CallbackUInt32> callback) = 0;
 
+  /**
+   * Reads a block of unsigned 16-bit registers. The method blocks until the
+   * operation has finished (either successfully or unsuccessfully). On
+   * success, the values read from the device memory are returned. On failure,
+   * an exception is thrown.
+   *
+   * The element distance is the distance between the addresses of two
+   * consecutive elements (in bytes). Zero means that the registers are
+   * contiguous in memory.
+   */
+  virtual std::vector<std::uint16_t> readUInt16Block(std::uint32_t address,
+      std::size_t count, std::uint32_t elementDistance);
+
+  /**
+   * Writes a block of unsigned 16-bit registers. The method blocks until the
+   * operation has finished (either successfully or unsuccessfully). On
+   * success, the values read from the memory (after writing to it) are
+   * returned. On failure, an exception is thrown.
+   *
+   * The element distance is the distance between the addresses of two
+   * consecutive elements (in bytes). Zero means that the registers are
+   * contiguous in memory.
+   */
+  virtual std::vector<std::uint16_t> writeUInt16Block(std::uint32_t address,
+      const std::vector<std::uint16_t> &values, std::uint32_t elementDistance);
+
+  /**
+   * Reads a block of unsigned 16-bit registers. This method does not block.
+   * The operation is queued and executed asynchronously. When the operation
+   * finishes, the specified callback is called exactly once.
+   *
+   * The element distance is the distance between the addresses of two
+   * consecutive elements (in bytes). Zero means that the registers are
+   * contiguous in memory.
+   *
+   * The default implementation queues a separate read operation for each
+   * element and aggregates the results. Subclasses that can transfer a block
+   * of registers more efficiently should override this method.
+   */
+  virtual void readUInt16Block(std::uint32_t address, std::size_t count,
+      std::uint32_t elementDistance,
+      std::shared_ptr<BlockCallbackUInt16> callback);
+
+  /**
+   * Writes a block of unsigned 16-bit registers. This method does not block.
+   * The operation is queued and executed asynchronously. When the operation
+   * finishes, the specified callback is called exactly once.
+   *
+   * The element distance is the distance between the addresses of two
+   * consecutive elements (in bytes). Zero means that the registers are
+   * contiguous in memory.
+   *
+   * The default implementation queues a separate write operation for each
+   * element and aggregates the results. Subclasses that can transfer a block
+   * of registers more efficiently should override this method.
+   */
+  virtual void writeUInt16Block(std::uint32_t address,
+      const std::vector<std::uint16_t> &values, std::uint32_t elementDistance,
+      std::shared_ptr<BlockCallbackUInt16> callback);
+
+  /**
+   * Reads a block of unsigned 32-bit registers. The method blocks until the
+   * operation has finished (either successfully or unsuccessfully). On
+   * success, the values read from the device memory are returned. On failure,
+   * an exception is thrown.
+   *
+   * The element distance is the distance between the addresses of two
+   * consecutive elements (in bytes). Zero means that the registers are
+   * contiguous in memory.
+   */
+  virtual std::vector<std::uint32_t> readUInt32Block(std::uint32_t address,
+      std::size_t count, std::uint32_t elementDistance);
+
+  /**
+   * Writes a block of unsigned 32-bit registers. The method blocks until the
+   * operation has finished (either successfully or unsuccessfully). On
+   * success, the values read from the memory (after writing to it) are
+   * returned. On failure, an exception is thrown.
+   *
+   * The element distance is the distance between the addresses of two
+   * consecutive elements (in bytes). Zero means that the registers are
+   * contiguous in memory.
+   */
+  virtual std::vector<std::uint32_t> writeUInt32Block(std::uint32_t address,
+      const std::vector<std::uint32_t> &values, std::uint32_t elementDistance);
+
+  /**
+   * Reads a block of unsigned 32-bit registers. This method does not block.
+   * The operation is queued and executed asynchronously. When the operation
+   * finishes, the specified callback is called exactly once.
+   *
+   * The element distance is the distance between the addresses of two
+   * consecutive elements (in bytes). Zero means that the registers are
+   * contiguous in memory.
+   *
+   * The default implementation queues a separate read operation for each
+   * element and aggregates the results. Subclasses that can transfer a block
+   * of registers more efficiently should override this method.
+   */
+  virtual void readUInt32Block(std::uint32_t address, std::size_t count,
+      std::uint32_t elementDistance,
+      std::shared_ptr<BlockCallbackUInt32> callback);
+
+  /**
+   * Writes a block of unsigned 32-bit registers. This method does not block.
+   * The operation is queued and executed asynchronously. When the operation
+   * finishes, the specified callback is called exactly once.
+   *
+   * The element distance is the distance between the addresses of two
+   * consecutive elements (in bytes). Zero means that the registers are
+   * contiguous in memory.
+   *
+   * The default implementation queues a separate write operation for each
+   * element and aggregates the results. Subclasses that can transfer a block
+   * of registers more efficiently should override this method.
+   */
+  virtual void writeUInt32Block(std::uint32_t address,
+      const std::vector<std::uint32_t> &values, std::uint32_t elementDistance,
+      std::shared_ptr<BlockCallbackUInt32> callback);
+
+  /**
+   * Returns the minimum time that passes between the execution of two write
+   * operations by the device, even if they are queued at the same time. Code
+   * that needs a certain delay between consecutive writes (e.g. because they
+   * generate clock edges) can use this to decide whether it has to insert a
+   * delay itself.
+   *
+   * The default implementation returns zero, meaning that writes might be
+   * executed immediately one after another. Subclasses that are limited by the
+   * underlying transport should override this method.
+   */
+  virtual std::chrono::nanoseconds getMinimumWriteInterval() const;
+
   /**
    * Tells whether this memory access supports interrupts. If the memory access
    * is able to intercept interrupts generated by the device, this method
@@ -297,6 +577,56 @@ public:
   virtual void removeInterruptListener(
       std::shared_ptr<InterruptListener> interruptListener);
 
+  /**
+   * Tells whether this memory access can drain the event FIFO of an event
+   * receiver when the device generates an interrupt. If the memory access
+   * supports this, this method returns {@code true}, otherwise it returns
+   * {@code false}.
+   *
+   * Subclasses that support draining the event FIFO must override this method
+   * along with the {@link addEventFifoListener(
+   * std::shared_ptr<EventFifoListener> eventFifoListener)} and
+   * {@link removeEventFifoListener(std::shared_ptr<EventFifoListener>
+   * eventFifoListener)} methods.
+   */
+  virtual bool supportsEventFifo() const;
+
+  /**
+   * Adds the specified listener to the list of listeners that are notified
+   * when entries have been read from the event FIFO. If the specified listener
+   * has already been registered with this memory access, calling this method
+   * has no effect.
+   *
+   * The event FIFO is only drained while at least one listener is registered.
+   * The FIFO is drained when the device generates an interrupt that has the
+   * event or the FIFO full flag set, so these interrupts have to be enabled
+   * on the device.
+   *
+   * The listeners are internally kept using weak pointers. This means that a
+   * listener will be destroyed if no other references to it are being hold.
+   *
+   * This method may only be called if this memory access supports draining
+   * the event FIFO ({@link supportsEventFifo()} returns {@code true}).
+   * Calling this method on a memory access that does not support this results
+   * in an exception being thrown.
+   */
+  virtual void addEventFifoListener(
+      std::shared_ptr<EventFifoListener> eventFifoListener);
+
+  /**
+   * Removes the specified listener from the list of listeners that are
+   * notified when entries have been read from the event FIFO. If the specified
+   * listener has already been removed (or has never been added), calling this
+   * method has no effect.
+   *
+   * This method may only be called if this memory access supports draining
+   * the event FIFO ({@link supportsEventFifo()} returns {@code true}).
+   * Calling this method on a memory access that does not support this results
+   * in an exception being thrown.
+   */
+  virtual void removeEventFifoListener(
+      std::shared_ptr<EventFifoListener> eventFifoListener);
+
 protected:
 
   /**
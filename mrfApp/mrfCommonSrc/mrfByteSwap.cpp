@@ -0,0 +1,149 @@
+/*
+ * Copyright 2026 aquenos GmbH.
+ * Copyright 2026 Karlsruhe Institute of Technology.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * This software has been developed by aquenos GmbH on behalf of the
+ * Karlsruhe Institute of Technology's Institute for Beam Physics and
+ * Technology.
+ *
+ * This software contains code originally developed by aquenos GmbH for
+ * the s7nodave EPICS device support. aquenos GmbH has relicensed the
+ * affected poritions of code from the s7nodave EPICS device support
+ * (originally licensed under the terms of the GNU GPL) under the terms
+ * of the GNU LGPL version 3 or newer.
+ */
+
+// The intrinsics are only available when the compiler has been told that it
+// may use the respective instruction-set extensions (e.g. -mavx2). Otherwise,
+// we fall back to the SSE2 code (which is always available on x86_64) or to
+// the portable scalar code.
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSSE3__)
+#include <tmmintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "mrfByteSwap.h"
+
+namespace anka {
+namespace mrf {
+
+namespace {
+
+// GCC and Clang define __BYTE_ORDER__. If it is not defined, we assume that
+// we are running on a little-endian host, which is the case for all platforms
+// that are relevant in practice.
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+constexpr bool hostIsBigEndian = true;
+#else
+constexpr bool hostIsBigEndian = false;
+#endif
+
+inline std::uint16_t swapUInt16(std::uint16_t value) noexcept {
+  return static_cast<std::uint16_t>((value >> 8) | (value << 8));
+}
+
+inline std::uint32_t swapUInt32(std::uint32_t value) noexcept {
+  return (value >> 24) | ((value >> 8) & 0x0000ff00) | ((value << 8) & 0x00ff0000)
+      | (value << 24);
+}
+
+} // anonymous namespace
+
+void mrfSwapBigEndianUInt16(std::uint16_t *values, std::size_t count)
+    noexcept {
+  if (hostIsBigEndian) {
+    return;
+  }
+  std::size_t index = 0;
+  // The arrays passed to this function are not necessarily aligned, so we use
+  // unaligned loads and stores. On all CPUs that support AVX2, there is no
+  // penalty for unaligned access when the data happens to be aligned.
+#if defined(__AVX2__)
+  const __m256i shuffleMask = _mm256_setr_epi8(1, 0, 3, 2, 5, 4, 7, 6, 9, 8,
+      11, 10, 13, 12, 15, 14, 1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15,
+      14);
+  for (; index + 16 <= count; index += 16) {
+    __m256i *address = reinterpret_cast<__m256i *>(values + index);
+    _mm256_storeu_si256(address,
+        _mm256_shuffle_epi8(_mm256_loadu_si256(address), shuffleMask));
+  }
+#elif defined(__SSSE3__)
+  const __m128i shuffleMask = _mm_setr_epi8(1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11,
+      10, 13, 12, 15, 14);
+  for (; index + 8 <= count; index += 8) {
+    __m128i *address = reinterpret_cast<__m128i *>(values + index);
+    _mm_storeu_si128(address,
+        _mm_shuffle_epi8(_mm_loadu_si128(address), shuffleMask));
+  }
+#elif defined(__SSE2__)
+  for (; index + 8 <= count; index += 8) {
+    __m128i *address = reinterpret_cast<__m128i *>(values + index);
+    __m128i data = _mm_loadu_si128(address);
+    _mm_storeu_si128(address,
+        _mm_or_si128(_mm_slli_epi16(data, 8), _mm_srli_epi16(data, 8)));
+  }
+#endif
+  for (; index < count; ++index) {
+    values[index] = swapUInt16(values[index]);
+  }
+}
+
+void mrfSwapBigEndianUInt32(std::uint32_t *values, std::size_t count)
+    noexcept {
+  if (hostIsBigEndian) {
+    return;
+  }
+  std::size_t index = 0;
+#if defined(__AVX2__)
+  const __m256i shuffleMask = _mm256_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10,
+      9, 8, 15, 14, 13, 12, 3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13,
+      12);
+  for (; index + 8 <= count; index += 8) {
+    __m256i *address = reinterpret_cast<__m256i *>(values + index);
+    _mm256_storeu_si256(address,
+        _mm256_shuffle_epi8(_mm256_loadu_si256(address), shuffleMask));
+  }
+#elif defined(__SSSE3__)
+  const __m128i shuffleMask = _mm_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9,
+      8, 15, 14, 13, 12);
+  for (; index + 4 <= count; index += 4) {
+    __m128i *address = reinterpret_cast<__m128i *>(values + index);
+    _mm_storeu_si128(address,
+        _mm_shuffle_epi8(_mm_loadu_si128(address), shuffleMask));
+  }
+#elif defined(__SSE2__)
+  // Without SSSE3, there is no byte shuffle instruction, so we first swap the
+  // two 16-bit halves of each 32-bit word and then swap the bytes within each
+  // 16-bit half.
+  for (; index + 4 <= count; index += 4) {
+    __m128i *address = reinterpret_cast<__m128i *>(values + index);
+    __m128i data = _mm_loadu_si128(address);
+    data = _mm_shufflehi_epi16(_mm_shufflelo_epi16(data, 0xb1), 0xb1);
+    _mm_storeu_si128(address,
+        _mm_or_si128(_mm_slli_epi16(data, 8), _mm_srli_epi16(data, 8)));
+  }
+#endif
+  for (; index < count; ++index) {
+    values[index] = swapUInt32(values[index]);
+  }
+}
+
+} // namespace mrf
+} // namespace anka
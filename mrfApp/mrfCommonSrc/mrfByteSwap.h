@@ -0,0 +1,60 @@
+/*
+ * Copyright 2026 aquenos GmbH.
+ * Copyright 2026 Karlsruhe Institute of Technology.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * This software has been developed by aquenos GmbH on behalf of the
+ * Karlsruhe Institute of Technology's Institute for Beam Physics and
+ * Technology.
+ *
+ * This software contains code originally developed by aquenos GmbH for
+ * the s7nodave EPICS device support. aquenos GmbH has relicensed the
+ * affected poritions of code from the s7nodave EPICS device support
+ * (originally licensed under the terms of the GNU GPL) under the terms
+ * of the GNU LGPL version 3 or newer.
+ */
+
+#ifndef ANKA_MRF_BYTE_SWAP_H
+#define ANKA_MRF_BYTE_SWAP_H
+
+#include <cstddef>
+#include <cstdint>
+
+namespace anka {
+namespace mrf {
+
+/**
+ * Converts an array of 16-bit values between big-endian byte order (the byte
+ * order used by the MRF devices) and host byte order. The conversion is done
+ * in place and is symmetric, so the same function can be used for both
+ * directions. On big-endian hosts, this function does not do anything. On
+ * little-endian hosts, SIMD instructions are used when they are available.
+ */
+void mrfSwapBigEndianUInt16(std::uint16_t *values, std::size_t count) noexcept;
+
+/**
+ * Converts an array of 32-bit values between big-endian byte order (the byte
+ * order used by the MRF devices) and host byte order. The conversion is done
+ * in place and is symmetric, so the same function can be used for both
+ * directions. On big-endian hosts, this function does not do anything. On
+ * little-endian hosts, SIMD instructions are used when they are available.
+ */
+void mrfSwapBigEndianUInt32(std::uint32_t *values, std::size_t count) noexcept;
+
+} //namespace mrf
+} //namespace anka
+
+#endif // ANKA_MRF_BYTE_SWAP_H
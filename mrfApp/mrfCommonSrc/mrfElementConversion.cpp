@@ -0,0 +1,213 @@
+/*
+ * Copyright 2026 aquenos GmbH.
+ * Copyright 2026 Karlsruhe Institute of Technology.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * This software has been developed by aquenos GmbH on behalf of the
+ * Karlsruhe Institute of Technology's Institute for Beam Physics and
+ * Technology.
+ *
+ * This software contains code originally developed by aquenos GmbH for
+ * the s7nodave EPICS device support. aquenos GmbH has relicensed the
+ * affected poritions of code from the s7nodave EPICS device support
+ * (originally licensed under the terms of the GNU GPL) under the terms
+ * of the GNU LGPL version 3 or newer.
+ */
+
+// The intrinsics are only available when the compiler has been told that it
+// may use the respective instruction-set extensions (e.g. -mavx2). Otherwise,
+// we fall back to the SSE2 code (which is always available on x86_64) or to
+// the portable scalar code.
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "mrfElementConversion.h"
+
+namespace anka {
+namespace mrf {
+
+// The arrays passed to these functions are not necessarily aligned, so we use
+// unaligned loads and stores everywhere. The pack instructions saturate
+// instead of truncating, so we have to clear (or sign-extend) the upper bits
+// of each element before packing in order to get the same result as the
+// scalar code.
+
+void mrfNarrowUInt32ToUInt8(const std::uint32_t *source,
+    std::uint8_t *destination, std::size_t count) noexcept {
+  std::size_t index = 0;
+#if defined(__AVX2__)
+  const __m256i byteMask = _mm256_set1_epi32(0xff);
+  // The pack instructions work on each 128-bit lane separately, so the
+  // result has to be permuted to restore the original order.
+  const __m256i permutation = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+  for (; index + 32 <= count; index += 32) {
+    const __m256i *address = reinterpret_cast<const __m256i *>(
+        source + index);
+    __m256i a = _mm256_and_si256(_mm256_loadu_si256(address), byteMask);
+    __m256i b = _mm256_and_si256(_mm256_loadu_si256(address + 1), byteMask);
+    __m256i c = _mm256_and_si256(_mm256_loadu_si256(address + 2), byteMask);
+    __m256i d = _mm256_and_si256(_mm256_loadu_si256(address + 3), byteMask);
+    __m256i packed = _mm256_packus_epi16(_mm256_packs_epi32(a, b),
+        _mm256_packs_epi32(c, d));
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(destination + index),
+        _mm256_permutevar8x32_epi32(packed, permutation));
+  }
+#elif defined(__SSE2__)
+  const __m128i byteMask = _mm_set1_epi32(0xff);
+  for (; index + 16 <= count; index += 16) {
+    const __m128i *address = reinterpret_cast<const __m128i *>(
+        source + index);
+    __m128i a = _mm_and_si128(_mm_loadu_si128(address), byteMask);
+    __m128i b = _mm_and_si128(_mm_loadu_si128(address + 1), byteMask);
+    __m128i c = _mm_and_si128(_mm_loadu_si128(address + 2), byteMask);
+    __m128i d = _mm_and_si128(_mm_loadu_si128(address + 3), byteMask);
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(destination + index),
+        _mm_packus_epi16(_mm_packs_epi32(a, b), _mm_packs_epi32(c, d)));
+  }
+#endif
+  for (; index < count; ++index) {
+    destination[index] = static_cast<std::uint8_t>(source[index]);
+  }
+}
+
+void mrfNarrowUInt32ToUInt16(const std::uint32_t *source,
+    std::uint16_t *destination, std::size_t count) noexcept {
+  std::size_t index = 0;
+  // There is no unsigned 32-bit to 16-bit pack instruction in SSE2, so we
+  // sign-extend the lower 16 bits of each element and use the signed pack
+  // instruction, which then never saturates.
+#if defined(__AVX2__)
+  for (; index + 16 <= count; index += 16) {
+    const __m256i *address = reinterpret_cast<const __m256i *>(
+        source + index);
+    __m256i a = _mm256_srai_epi32(
+        _mm256_slli_epi32(_mm256_loadu_si256(address), 16), 16);
+    __m256i b = _mm256_srai_epi32(
+        _mm256_slli_epi32(_mm256_loadu_si256(address + 1), 16), 16);
+    // The pack instruction works on each 128-bit lane separately, so the
+    // result has to be permuted to restore the original order.
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(destination + index),
+        _mm256_permute4x64_epi64(_mm256_packs_epi32(a, b), 0xd8));
+  }
+#elif defined(__SSE2__)
+  for (; index + 8 <= count; index += 8) {
+    const __m128i *address = reinterpret_cast<const __m128i *>(
+        source + index);
+    __m128i a = _mm_srai_epi32(_mm_slli_epi32(_mm_loadu_si128(address), 16),
+        16);
+    __m128i b = _mm_srai_epi32(
+        _mm_slli_epi32(_mm_loadu_si128(address + 1), 16), 16);
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(destination + index),
+        _mm_packs_epi32(a, b));
+  }
+#endif
+  for (; index < count; ++index) {
+    destination[index] = static_cast<std::uint16_t>(source[index]);
+  }
+}
+
+void mrfWidenUInt8ToUInt32(const std::uint8_t *source,
+    std::uint32_t *destination, std::size_t count) noexcept {
+  std::size_t index = 0;
+#if defined(__AVX2__)
+  for (; index + 8 <= count; index += 8) {
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(destination + index),
+        _mm256_cvtepu8_epi32(_mm_loadl_epi64(
+            reinterpret_cast<const __m128i *>(source + index))));
+  }
+#elif defined(__SSE2__)
+  const __m128i zero = _mm_setzero_si128();
+  for (; index + 16 <= count; index += 16) {
+    __m128i data = _mm_loadu_si128(
+        reinterpret_cast<const __m128i *>(source + index));
+    __m128i low = _mm_unpacklo_epi8(data, zero);
+    __m128i high = _mm_unpackhi_epi8(data, zero);
+    __m128i *address = reinterpret_cast<__m128i *>(destination + index);
+    _mm_storeu_si128(address, _mm_unpacklo_epi16(low, zero));
+    _mm_storeu_si128(address + 1, _mm_unpackhi_epi16(low, zero));
+    _mm_storeu_si128(address + 2, _mm_unpacklo_epi16(high, zero));
+    _mm_storeu_si128(address + 3, _mm_unpackhi_epi16(high, zero));
+  }
+#endif
+  for (; index < count; ++index) {
+    destination[index] = source[index];
+  }
+}
+
+void mrfWidenUInt16ToUInt32(const std::uint16_t *source,
+    std::uint32_t *destination, std::size_t count) noexcept {
+  std::size_t index = 0;
+#if defined(__AVX2__)
+  for (; index + 8 <= count; index += 8) {
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(destination + index),
+        _mm256_cvtepu16_epi32(_mm_loadu_si128(
+            reinterpret_cast<const __m128i *>(source + index))));
+  }
+#elif defined(__SSE2__)
+  const __m128i zero = _mm_setzero_si128();
+  for (; index + 8 <= count; index += 8) {
+    __m128i data = _mm_loadu_si128(
+        reinterpret_cast<const __m128i *>(source + index));
+    __m128i *address = reinterpret_cast<__m128i *>(destination + index);
+    _mm_storeu_si128(address, _mm_unpacklo_epi16(data, zero));
+    _mm_storeu_si128(address + 1, _mm_unpackhi_epi16(data, zero));
+  }
+#endif
+  for (; index < count; ++index) {
+    destination[index] = source[index];
+  }
+}
+
+std::uint32_t mrfCompareUInt32(const std::uint32_t *first,
+    const std::uint32_t *second, std::size_t count) noexcept {
+  std::uint32_t differences = 0;
+  std::size_t index = 0;
+  // The comparison sets all bits of an element that is equal, and the move
+  // mask instruction collects the most significant bit of each element, so we
+  // get one bit per element that we only have to invert.
+#if defined(__AVX2__)
+  for (; index + 8 <= count; index += 8) {
+    __m256i equal = _mm256_cmpeq_epi32(
+        _mm256_loadu_si256(reinterpret_cast<const __m256i *>(first + index)),
+        _mm256_loadu_si256(
+            reinterpret_cast<const __m256i *>(second + index)));
+    std::uint32_t equalMask = static_cast<std::uint32_t>(
+        _mm256_movemask_ps(_mm256_castsi256_ps(equal)));
+    differences |= (~equalMask & 0xffu) << index;
+  }
+#elif defined(__SSE2__)
+  for (; index + 4 <= count; index += 4) {
+    __m128i equal = _mm_cmpeq_epi32(
+        _mm_loadu_si128(reinterpret_cast<const __m128i *>(first + index)),
+        _mm_loadu_si128(reinterpret_cast<const __m128i *>(second + index)));
+    std::uint32_t equalMask = static_cast<std::uint32_t>(
+        _mm_movemask_ps(_mm_castsi128_ps(equal)));
+    differences |= (~equalMask & 0xfu) << index;
+  }
+#endif
+  for (; index < count; ++index) {
+    if (first[index] != second[index]) {
+      differences |= 1u << index;
+    }
+  }
+  return differences;
+}
+
+} // namespace mrf
+} // namespace anka
@@ -0,0 +1,84 @@
+/*
+ * Copyright 2026 aquenos GmbH.
+ * Copyright 2026 Karlsruhe Institute of Technology.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * This software has been developed by aquenos GmbH on behalf of the
+ * Karlsruhe Institute of Technology's Institute for Beam Physics and
+ * Technology.
+ *
+ * This software contains code originally developed by aquenos GmbH for
+ * the s7nodave EPICS device support. aquenos GmbH has relicensed the
+ * affected poritions of code from the s7nodave EPICS device support
+ * (originally licensed under the terms of the GNU GPL) under the terms
+ * of the GNU LGPL version 3 or newer.
+ */
+
+#ifndef ANKA_MRF_ELEMENT_CONVERSION_H
+#define ANKA_MRF_ELEMENT_CONVERSION_H
+
+#include <cstddef>
+#include <cstdint>
+
+namespace anka {
+namespace mrf {
+
+/**
+ * Copies an array of 32-bit values into an array of 8-bit values, keeping the
+ * least significant byte of each value. The arrays must not overlap. SIMD
+ * instructions are used when they are available.
+ */
+void mrfNarrowUInt32ToUInt8(const std::uint32_t *source,
+    std::uint8_t *destination, std::size_t count) noexcept;
+
+/**
+ * Copies an array of 32-bit values into an array of 16-bit values, keeping the
+ * two least significant bytes of each value. The arrays must not overlap. SIMD
+ * instructions are used when they are available.
+ */
+void mrfNarrowUInt32ToUInt16(const std::uint32_t *source,
+    std::uint16_t *destination, std::size_t count) noexcept;
+
+/**
+ * Copies an array of 8-bit values into an array of 32-bit values, extending
+ * each value with zeros. The arrays must not overlap. SIMD instructions are
+ * used when they are available.
+ */
+void mrfWidenUInt8ToUInt32(const std::uint8_t *source,
+    std::uint32_t *destination, std::size_t count) noexcept;
+
+/**
+ * Copies an array of 16-bit values into an array of 32-bit values, extending
+ * each value with zeros. The arrays must not overlap. SIMD instructions are
+ * used when they are available.
+ */
+void mrfWidenUInt16ToUInt32(const std::uint16_t *source,
+    std::uint32_t *destination, std::size_t count) noexcept;
+
+/**
+ * Compares two arrays of 32-bit values and returns a bit mask that has a bit
+ * set for each element that differs between the two arrays. Bit zero
+ * corresponds to the first element. At most 32 elements can be compared with
+ * a single call, so the count must not be greater than 32. SIMD instructions
+ * are used when they are available.
+ */
+std::uint32_t mrfCompareUInt32(const std::uint32_t *first,
+    const std::uint32_t *second, std::size_t count) noexcept;
+
+} //namespace mrf
+} //namespace anka
+
+#endif // ANKA_MRF_ELEMENT_CONVERSION_H
@@ -35,20 +35,44 @@
  */
 
 #include <cstring>
+#include <map>
+#include <mutex>
 #include <string>
 
 #include <epicsExport.h>
+#include <epicsStdio.h>
 #include <epicsVersion.h>
 #include <iocsh.h>
 
 #include <MrfConsistentAsynchronousMemoryAccess.h>
 #include <MrfDeviceRegistry.h>
 #include <MrfMmapMemoryAccess.h>
+#include <MrfStartupProfiler.h>
 #include <mrfEpicsError.h>
 
 using namespace anka::mrf;
 using namespace anka::mrf::epics;
 
+namespace {
+
+// The device registry only stores the consistent memory access that wraps the
+// mmap memory access, so we keep a separate map of the raw devices. This map
+// is needed for injecting interrupts.
+std::map<std::string, std::shared_ptr<MrfMmapMemoryAccess>> rawDevices;
+std::mutex rawDevicesMutex;
+
+std::shared_ptr<MrfMmapMemoryAccess> findRawDevice(
+    const std::string &deviceId) {
+  std::lock_guard<std::mutex> lock(rawDevicesMutex);
+  auto deviceIterator = rawDevices.find(deviceId);
+  if (deviceIterator == rawDevices.end()) {
+    return std::shared_ptr<MrfMmapMemoryAccess>();
+  }
+  return deviceIterator->second;
+}
+
+} // anonymous namespace
+
 extern "C" {
 
 // Data structures shared by all iocsh mrfMmapXxxDevice functions.
@@ -183,14 +207,109 @@ static const iocshFuncDef iocshMrfMmapPxieEvr300DeviceFuncDef = {
 #endif // IOCSHFUNCDEF_HAS_USAGE
 };
 
+// Data structures needed for the iocsh mrfMmapMemoryDevice function.
+static const iocshArg iocshMrfMmapMemoryDeviceArg0 = { "device ID",
+    iocshArgString };
+static const iocshArg iocshMrfMmapMemoryDeviceArg1 = { "file path",
+    iocshArgString };
+static const iocshArg iocshMrfMmapMemoryDeviceArg2 = { "memory size",
+    iocshArgInt };
+static const iocshArg * const iocshMrfMmapMemoryDeviceArgs[] = {
+    &iocshMrfMmapMemoryDeviceArg0, &iocshMrfMmapMemoryDeviceArg1,
+    &iocshMrfMmapMemoryDeviceArg2 };
+static const iocshFuncDef iocshMrfMmapMemoryDeviceFuncDef = {
+  "mrfMmapMemoryDevice",
+  3,
+  iocshMrfMmapMemoryDeviceArgs,
+#ifdef IOCSHFUNCDEF_HAS_USAGE
+  "Define a simulated device that is backed by memory instead of hardware.\n"
+  "\nThe file path is the path to a regular file that is used as the backing\n"
+  "memory. If it is empty, an anonymous memory file is used. If the memory\n"
+  "size is zero, 0x40000 bytes are used. Interrupts can be simulated with\n"
+  "mrfMmapInjectInterrupt.\n",
+#endif // IOCSHFUNCDEF_HAS_USAGE
+};
+
+// Data structures needed for the iocsh mrfMmapInjectInterrupt function.
+static const iocshArg iocshMrfMmapInjectInterruptArg0 = { "device ID",
+    iocshArgString };
+static const iocshArg iocshMrfMmapInjectInterruptArg1 = { "interrupt flags",
+    iocshArgInt };
+static const iocshArg * const iocshMrfMmapInjectInterruptArgs[] = {
+    &iocshMrfMmapInjectInterruptArg0, &iocshMrfMmapInjectInterruptArg1 };
+static const iocshFuncDef iocshMrfMmapInjectInterruptFuncDef = {
+  "mrfMmapInjectInterrupt",
+  2,
+  iocshMrfMmapInjectInterruptArgs,
+#ifdef IOCSHFUNCDEF_HAS_USAGE
+  "Simulate an interrupt with the specified flags for an mmap device.\n\n"
+  "The interrupt listeners are notified as if the device had generated an\n"
+  "interrupt, but the device's registers are not accessed.\n",
+#endif // IOCSHFUNCDEF_HAS_USAGE
+};
+
+// Data structures needed for the iocsh mrfMmapInterruptCoalescing function.
+static const iocshArg iocshMrfMmapInterruptCoalescingArg0 = { "device ID",
+    iocshArgString };
+static const iocshArg iocshMrfMmapInterruptCoalescingArg1 = {
+    "hold-off time (us)", iocshArgInt };
+static const iocshArg iocshMrfMmapInterruptCoalescingArg2 = {
+    "storm threshold (interrupts/s)", iocshArgInt };
+static const iocshArg iocshMrfMmapInterruptCoalescingArg3 = {
+    "storm hold-off time (us)", iocshArgInt };
+static const iocshArg * const iocshMrfMmapInterruptCoalescingArgs[] = {
+    &iocshMrfMmapInterruptCoalescingArg0, &iocshMrfMmapInterruptCoalescingArg1,
+    &iocshMrfMmapInterruptCoalescingArg2, &iocshMrfMmapInterruptCoalescingArg3 };
+static const iocshFuncDef iocshMrfMmapInterruptCoalescingFuncDef = {
+  "mrfMmapInterruptCoalescing",
+  4,
+  iocshMrfMmapInterruptCoalescingArgs,
+#ifdef IOCSHFUNCDEF_HAS_USAGE
+  "Configure interrupt coalescing and storm protection for an mmap device.\n\n"
+  "After notifying the interrupt listeners, interrupts are not re-enabled\n"
+  "until the hold-off time has passed. Interrupts that occur in the meantime\n"
+  "are combined into a single notification. When more interrupts than the\n"
+  "storm threshold are received within one second, the storm hold-off time\n"
+  "is used instead. Zero disables coalescing or storm detection.\n",
+#endif // IOCSHFUNCDEF_HAS_USAGE
+};
+
+// Data structures needed for the iocsh mrfMmapInterruptStatistics function.
+static const iocshArg iocshMrfMmapInterruptStatisticsArg0 = { "device ID",
+    iocshArgString };
+static const iocshArg * const iocshMrfMmapInterruptStatisticsArgs[] = {
+    &iocshMrfMmapInterruptStatisticsArg0 };
+static const iocshFuncDef iocshMrfMmapInterruptStatisticsFuncDef = {
+  "mrfMmapInterruptStatistics",
+  1,
+  iocshMrfMmapInterruptStatisticsArgs,
+#ifdef IOCSHFUNCDEF_HAS_USAGE
+  "Print the number of interrupts received, coalesced, and dropped by an\n"
+  "mmap device.\n",
+#endif // IOCSHFUNCDEF_HAS_USAGE
+};
+
+// Data structures needed for the iocsh mrfMmapConnectionStatistics function.
+static const iocshArg iocshMrfMmapConnectionStatisticsArg0 = { "device ID",
+    iocshArgString };
+static const iocshArg * const iocshMrfMmapConnectionStatisticsArgs[] = {
+    &iocshMrfMmapConnectionStatisticsArg0 };
+static const iocshFuncDef iocshMrfMmapConnectionStatisticsFuncDef = {
+  "mrfMmapConnectionStatistics",
+  1,
+  iocshMrfMmapConnectionStatisticsArgs,
+#ifdef IOCSHFUNCDEF_HAS_USAGE
+  "Print how often an mmap device has been opened and lost and how long it\n"
+  "took to open it.\n",
+#endif // IOCSHFUNCDEF_HAS_USAGE
+};
+
 /**
  * Implementation that is shared by all the the iocsh mrfMmapXxxDevice
  * functions.
  */
-static int iocshMrfMmapDeviceFunc(const iocshArgBuf *args,
-    std::uint32_t memorySize) noexcept {
-  char *deviceId = args[0].sval;
-  char *devicePath = args[1].sval;
+static int createMmapDevice(const char *deviceId,
+    const char *devicePath, std::uint32_t memorySize) noexcept {
   // Verify and convert the parameters.
   if (!deviceId) {
     errorPrintf("Could not create device: Device ID must be specified.");
@@ -211,12 +330,31 @@ static int iocshMrfMmapDeviceFunc(const iocshArgBuf *args,
   // Until here our code does not throw. We put the rest of the function into a
   // try-catch statement, so that we handle all other exceptions.
   try {
+    MrfStartupProfiler::Span span("device", deviceId);
     std::shared_ptr<MrfMmapMemoryAccess> rawDevice = std::make_shared<
         MrfMmapMemoryAccess>(std::string(devicePath), memorySize);
+    // Interrupt storms are reported through the error log, so that they do
+    // not go unnoticed.
+    std::string deviceIdString(deviceId);
+    rawDevice->setInterruptStormHandler(
+        [deviceIdString](bool stormActive, std::uint32_t interruptRate) {
+          if (stormActive) {
+            errorPrintf(
+                "Interrupt storm detected for device %s (%u interrupts within one second). Interrupts are throttled.",
+                deviceIdString.c_str(), interruptRate);
+          } else {
+            errorPrintf("Interrupt storm for device %s has ended.",
+                deviceIdString.c_str());
+          }
+        });
     std::shared_ptr<MrfConsistentAsynchronousMemoryAccess> consistentDevice =
         std::make_shared<MrfConsistentAsynchronousMemoryAccess>(rawDevice);
     MrfDeviceRegistry::getInstance().registerDevice(std::string(deviceId),
         consistentDevice);
+    // The registry throws if the device ID is already in use, so when we get
+    // here, we know that we do not replace another device.
+    std::lock_guard<std::mutex> lock(rawDevicesMutex);
+    rawDevices[std::string(deviceId)] = rawDevice;
   } catch (std::exception &e) {
     anka::mrf::epics::errorPrintf("Could not create device %s: %s", deviceId,
         e.what());
@@ -229,6 +367,209 @@ static int iocshMrfMmapDeviceFunc(const iocshArgBuf *args,
   return 0;
 }
 
+/**
+ * Implementation that is shared by all the the iocsh mrfMmapXxxDevice
+ * functions for actual devices.
+ */
+static int iocshMrfMmapDeviceFunc(const iocshArgBuf *args,
+    std::uint32_t memorySize) noexcept {
+  return createMmapDevice(args[0].sval, args[1].sval, memorySize);
+}
+
+/**
+ * Implementation of the iocsh mrfMmapMemoryDevice function.
+ */
+static int iocshMrfMmapMemoryDeviceFuncInternal(const iocshArgBuf *args)
+    noexcept {
+  char *filePath = args[1].sval;
+  int memorySize = args[2].ival;
+  if (memorySize < 0) {
+    errorPrintf("Could not create device: Memory size must not be negative.");
+    return 1;
+  }
+  // By default, we use the largest memory size that is used by any of the
+  // actual devices, so that all registers are accessible.
+  if (memorySize == 0) {
+    memorySize = 0x00040000;
+  }
+  // If no file is specified, we use an anonymous memory file.
+  std::string devicePath = (filePath && std::strlen(filePath)) ?
+      std::string(filePath) : std::string("memfd:mrfMmapMemoryDevice");
+  return createMmapDevice(args[0].sval, devicePath.c_str(),
+      static_cast<std::uint32_t>(memorySize));
+}
+
+/**
+ * Implementation of the iocsh mrfMmapInjectInterrupt function.
+ */
+static int iocshMrfMmapInjectInterruptFuncInternal(const iocshArgBuf *args)
+    noexcept {
+  char *deviceId = args[0].sval;
+  std::uint32_t interruptFlags = static_cast<std::uint32_t>(args[1].ival);
+  if (!deviceId) {
+    errorPrintf("Device ID must be specified.");
+    return 1;
+  }
+  if (!std::strlen(deviceId)) {
+    errorPrintf("Device ID must not be empty.");
+    return 1;
+  }
+  try {
+    std::shared_ptr<MrfMmapMemoryAccess> rawDevice = findRawDevice(
+        std::string(deviceId));
+    if (!rawDevice) {
+      errorPrintf("Could not find mmap device with ID \"%s\".", deviceId);
+      return 1;
+    }
+    rawDevice->injectInterrupt(interruptFlags);
+  } catch (std::exception &e) {
+    errorPrintf("Could not inject interrupt: %s", e.what());
+    return 1;
+  } catch (...) {
+    errorPrintf("Could not inject interrupt: Unknown error.");
+    return 1;
+  }
+  return 0;
+}
+
+/**
+ * Implementation of the iocsh mrfMmapInterruptCoalescing function.
+ */
+static int iocshMrfMmapInterruptCoalescingFuncInternal(
+    const iocshArgBuf *args) noexcept {
+  char *deviceId = args[0].sval;
+  int holdOffMicroseconds = args[1].ival;
+  int stormThreshold = args[2].ival;
+  int stormHoldOffMicroseconds = args[3].ival;
+  if (!deviceId) {
+    errorPrintf("Device ID must be specified.");
+    return 1;
+  }
+  if (!std::strlen(deviceId)) {
+    errorPrintf("Device ID must not be empty.");
+    return 1;
+  }
+  if (holdOffMicroseconds < 0 || stormThreshold < 0
+      || stormHoldOffMicroseconds < 0) {
+    errorPrintf("The hold-off times and the storm threshold must not be negative.");
+    return 1;
+  }
+  try {
+    std::shared_ptr<MrfMmapMemoryAccess> rawDevice = findRawDevice(
+        std::string(deviceId));
+    if (!rawDevice) {
+      errorPrintf("Could not find mmap device with ID \"%s\".", deviceId);
+      return 1;
+    }
+    rawDevice->setInterruptCoalescing(holdOffMicroseconds, stormThreshold,
+        stormHoldOffMicroseconds);
+  } catch (std::exception &e) {
+    errorPrintf("Could not configure interrupt coalescing: %s", e.what());
+    return 1;
+  } catch (...) {
+    errorPrintf("Could not configure interrupt coalescing: Unknown error.");
+    return 1;
+  }
+  return 0;
+}
+
+/**
+ * Implementation of the iocsh mrfMmapInterruptStatistics function.
+ */
+static int iocshMrfMmapInterruptStatisticsFuncInternal(
+    const iocshArgBuf *args) noexcept {
+  char *deviceId = args[0].sval;
+  if (!deviceId) {
+    errorPrintf("Device ID must be specified.");
+    return 1;
+  }
+  if (!std::strlen(deviceId)) {
+    errorPrintf("Device ID must not be empty.");
+    return 1;
+  }
+  try {
+    std::shared_ptr<MrfMmapMemoryAccess> rawDevice = findRawDevice(
+        std::string(deviceId));
+    if (!rawDevice) {
+      errorPrintf("Could not find mmap device with ID \"%s\".", deviceId);
+      return 1;
+    }
+    MrfMmapMemoryAccess::InterruptStatistics statistics =
+        rawDevice->getInterruptStatistics();
+    ::epicsStdoutPrintf("Interrupts received:  %llu\n",
+        static_cast<unsigned long long>(statistics.received));
+    ::epicsStdoutPrintf("Notifications:        %llu\n",
+        static_cast<unsigned long long>(statistics.notified));
+    ::epicsStdoutPrintf("Interrupts coalesced: %llu\n",
+        static_cast<unsigned long long>(statistics.coalesced));
+    ::epicsStdoutPrintf("Interrupts dropped:   %llu\n",
+        static_cast<unsigned long long>(statistics.dropped));
+    ::epicsStdoutPrintf("Interrupt storms:     %llu%s\n",
+        static_cast<unsigned long long>(statistics.storms),
+        statistics.stormActive ? " (storm in progress)" : "");
+  } catch (std::exception &e) {
+    errorPrintf("Could not get interrupt statistics: %s", e.what());
+    return 1;
+  } catch (...) {
+    errorPrintf("Could not get interrupt statistics: Unknown error.");
+    return 1;
+  }
+  return 0;
+}
+
+/**
+ * Implementation of the iocsh mrfMmapConnectionStatistics function.
+ */
+static int iocshMrfMmapConnectionStatisticsFuncInternal(
+    const iocshArgBuf *args) noexcept {
+  char *deviceId = args[0].sval;
+  if (!deviceId) {
+    errorPrintf("Device ID must be specified.");
+    return 1;
+  }
+  if (!std::strlen(deviceId)) {
+    errorPrintf("Device ID must not be empty.");
+    return 1;
+  }
+  try {
+    std::shared_ptr<MrfMmapMemoryAccess> rawDevice = findRawDevice(
+        std::string(deviceId));
+    if (!rawDevice) {
+      errorPrintf("Could not find mmap device with ID \"%s\".", deviceId);
+      return 1;
+    }
+    MrfMmapMemoryAccess::ConnectionStatistics statistics =
+        rawDevice->getConnectionStatistics();
+    ::epicsStdoutPrintf("Device open:          %s\n",
+        statistics.open ? "yes" : "no");
+    ::epicsStdoutPrintf("Open attempts:        %llu\n",
+        static_cast<unsigned long long>(statistics.openAttempts));
+    ::epicsStdoutPrintf("Opened:               %llu\n",
+        static_cast<unsigned long long>(statistics.opened));
+    ::epicsStdoutPrintf("Lost:                 %llu\n",
+        static_cast<unsigned long long>(statistics.lost));
+    ::epicsStdoutPrintf("Requests failed:      %llu\n",
+        static_cast<unsigned long long>(statistics.requestsFailed));
+    ::epicsStdoutPrintf("Last open delay:      %llu us\n",
+        static_cast<unsigned long long>(
+            statistics.lastOpenDelayMicroseconds));
+    ::epicsStdoutPrintf("Max. open delay:      %llu us\n",
+        static_cast<unsigned long long>(statistics.maxOpenDelayMicroseconds));
+    if (!statistics.open) {
+      ::epicsStdoutPrintf("Next attempt within:  %llu ms\n",
+          static_cast<unsigned long long>(
+              statistics.currentBackoffMilliseconds));
+    }
+  } catch (std::exception &e) {
+    errorPrintf("Could not get connection statistics: %s", e.what());
+    return 1;
+  } catch (...) {
+    errorPrintf("Could not get connection statistics: Unknown error.");
+    return 1;
+  }
+  return 0;
+}
+
 /**
  * Implementation of the iocsh function used for most EVG devices
  * (regular memory size).
@@ -270,6 +611,64 @@ static void iocshMrfMmapEvrWithGtxDeviceFunc(const iocshArgBuf *args)
 #endif // EPICS_VERSION_INT >= VERSION_INT(7,0,3,1)
 }
 
+/**
+ * Implementation of the iocsh function for memory-backed devices.
+ */
+static void iocshMrfMmapMemoryDeviceFunc(const iocshArgBuf *args) noexcept {
+#if EPICS_VERSION_INT >= VERSION_INT(7,0,3,1)
+  iocshSetError(iocshMrfMmapMemoryDeviceFuncInternal(args));
+#else // EPICS_VERSION_INT >= VERSION_INT(7,0,3,1)
+  iocshMrfMmapMemoryDeviceFuncInternal(args);
+#endif // EPICS_VERSION_INT >= VERSION_INT(7,0,3,1)
+}
+
+/**
+ * Implementation of the iocsh function for injecting interrupts.
+ */
+static void iocshMrfMmapInjectInterruptFunc(const iocshArgBuf *args) noexcept {
+#if EPICS_VERSION_INT >= VERSION_INT(7,0,3,1)
+  iocshSetError(iocshMrfMmapInjectInterruptFuncInternal(args));
+#else // EPICS_VERSION_INT >= VERSION_INT(7,0,3,1)
+  iocshMrfMmapInjectInterruptFuncInternal(args);
+#endif // EPICS_VERSION_INT >= VERSION_INT(7,0,3,1)
+}
+
+/**
+ * Implementation of the iocsh function for configuring interrupt coalescing.
+ */
+static void iocshMrfMmapInterruptCoalescingFunc(const iocshArgBuf *args)
+    noexcept {
+#if EPICS_VERSION_INT >= VERSION_INT(7,0,3,1)
+  iocshSetError(iocshMrfMmapInterruptCoalescingFuncInternal(args));
+#else // EPICS_VERSION_INT >= VERSION_INT(7,0,3,1)
+  iocshMrfMmapInterruptCoalescingFuncInternal(args);
+#endif // EPICS_VERSION_INT >= VERSION_INT(7,0,3,1)
+}
+
+/**
+ * Implementation of the iocsh function for printing interrupt statistics.
+ */
+static void iocshMrfMmapInterruptStatisticsFunc(const iocshArgBuf *args)
+    noexcept {
+#if EPICS_VERSION_INT >= VERSION_INT(7,0,3,1)
+  iocshSetError(iocshMrfMmapInterruptStatisticsFuncInternal(args));
+#else // EPICS_VERSION_INT >= VERSION_INT(7,0,3,1)
+  iocshMrfMmapInterruptStatisticsFuncInternal(args);
+#endif // EPICS_VERSION_INT >= VERSION_INT(7,0,3,1)
+}
+
+/**
+ * Implementation of the iocsh function for printing connection statistics.
+ */
+static void iocshMrfMmapConnectionStatisticsFunc(const iocshArgBuf *args)
+    noexcept {
+#if EPICS_VERSION_INT >= VERSION_INT(7,0,3,1)
+  iocshSetError(iocshMrfMmapConnectionStatisticsFuncInternal(args));
+#else // EPICS_VERSION_INT >= VERSION_INT(7,0,3,1)
+  iocshMrfMmapConnectionStatisticsFuncInternal(args);
+#endif // EPICS_VERSION_INT >= VERSION_INT(7,0,3,1)
+}
+
 /*
  * Registrar that registers the iocsh commands.
  */
@@ -298,6 +697,16 @@ static void mrfRegistrarMmap() {
       iocshMrfMmapRegularEvrDeviceFunc);
   iocshRegister(&iocshMrfMmapPxieEvr300DeviceFuncDef,
       iocshMrfMmapRegularEvrDeviceFunc);
+  iocshRegister(&iocshMrfMmapMemoryDeviceFuncDef,
+      iocshMrfMmapMemoryDeviceFunc);
+  iocshRegister(&iocshMrfMmapInjectInterruptFuncDef,
+      iocshMrfMmapInjectInterruptFunc);
+  iocshRegister(&iocshMrfMmapInterruptCoalescingFuncDef,
+      iocshMrfMmapInterruptCoalescingFunc);
+  iocshRegister(&iocshMrfMmapInterruptStatisticsFuncDef,
+      iocshMrfMmapInterruptStatisticsFunc);
+  iocshRegister(&iocshMrfMmapConnectionStatisticsFuncDef,
+      iocshMrfMmapConnectionStatisticsFunc);
   // We have to register the SIGBUS signal handler that is used to catch I/O
   // errors that can happen when accessing devices. We do this here, because the
   // chances that this code is called before creating any threads are quite
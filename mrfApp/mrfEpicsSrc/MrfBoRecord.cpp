@@ -27,6 +27,9 @@
  * of the GNU LGPL version 3 or newer.
  */
 
+#include <caeventmask.h>
+#include <dbEvent.h>
+
 #include "MrfBoRecord.h"
 
 namespace anka {
@@ -38,6 +41,17 @@ MrfBoRecord::MrfBoRecord(::boRecord *record) :
   this->initializeValue();
 }
 
+bool MrfBoRecord::correctRecordValue(std::uint32_t value) {
+  writeRecordValue(value);
+  // The record support derives VAL from RVAL only when initializing the
+  // record, so we have to update it ourselves.
+  getRecord()->val = getRecord()->rval;
+  getRecord()->udf = false;
+  ::db_post_events(getRecord(), &getRecord()->val, DBE_VALUE | DBE_LOG);
+  ::db_post_events(getRecord(), &getRecord()->rval, DBE_VALUE | DBE_LOG);
+  return true;
+}
+
 std::uint32_t MrfBoRecord::readRecordValue() {
   return getRecord()->rval ? 1 : 0;
 }
@@ -0,0 +1,215 @@
+/*
+ * Copyright 2026 aquenos GmbH.
+ * Copyright 2026 Karlsruhe Institute of Technology.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * This software has been developed by aquenos GmbH on behalf of the
+ * Karlsruhe Institute of Technology's Institute for Beam Physics and
+ * Technology.
+ *
+ * This software contains code originally developed by aquenos GmbH for
+ * the s7nodave EPICS device support. aquenos GmbH has relicensed the
+ * affected poritions of code from the s7nodave EPICS device support
+ * (originally licensed under the terms of the GNU GPL) under the terms
+ * of the GNU LGPL version 3 or newer.
+ */
+
+#include <cstdint>
+#include <cstdlib>
+#include <map>
+#include <memory>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <dbAccess.h>
+#include <dbStaticLib.h>
+#include <initHooks.h>
+
+#include "MrfDeviceRegistry.h"
+#include "MrfMemoryCache.h"
+#include "MrfRecordAddress.h"
+#include "MrfStartupProfiler.h"
+#include "mrfEpicsError.h"
+
+#include "MrfCachePreheater.h"
+
+namespace anka {
+namespace mrf {
+namespace epics {
+
+namespace {
+
+/**
+ * Registers that have to be preheated for a device. Each entry consists of the
+ * memory address and a flag telling whether the register is a 32-bit register.
+ * The registers are kept in the order in which the records are going to be
+ * initialized, so that the reads are sent in the order in which their results
+ * are needed. A register might be listed more than once (e.g. when it is used
+ * as a bit field), but it is only read once.
+ */
+using RegisterList = std::vector<std::pair<std::uint32_t, bool>>;
+
+/**
+ * Output record types that use the "MRF Memory" device support and initialize
+ * their value through the cache.
+ */
+const std::set<std::string> outputRecordTypes {
+  "ao", "bo", "longout", "mbbo", "mbboDirect"
+};
+
+std::string getFieldString(DBENTRY *entry, const char *fieldName) {
+  if (::dbFindField(entry, fieldName)) {
+    return std::string();
+  }
+  const char *value = ::dbGetString(entry);
+  return value ? value : std::string();
+}
+
+void addRecordRegisters(DBENTRY *entry, bool waveform,
+    std::map<std::string, RegisterList> &registersByDevice) {
+  std::string deviceType = getFieldString(entry, "DTYP");
+  if (deviceType != (waveform ? "MRF Memory Output" : "MRF Memory")) {
+    return;
+  }
+  std::string link = getFieldString(entry, waveform ? "INP" : "OUT");
+  if (link.empty() || link[0] != '@') {
+    return;
+  }
+  try {
+    // The records parse the same strings when they are initialized, so we
+    // use the parse cache.
+    MrfRecordAddress address = MrfRecordAddress::parseCached(link.substr(1));
+    // Records that are initialized lazily do not read their registers while
+    // iocInit is running.
+    if (!address.isReadOnInit() || address.isLazyInit()) {
+      return;
+    }
+    RegisterList &registers = registersByDevice[address.getDeviceId()];
+    if (!waveform) {
+      registers.emplace_back(address.getMemoryAddress(),
+          address.getDataType() == MrfRecordAddress::DataType::uInt32);
+      return;
+    }
+    // The waveform record reads each element as a 32-bit register.
+    unsigned long numberOfElements = std::strtoul(
+        getFieldString(entry, "NELM").c_str(), nullptr, 0);
+    for (unsigned long arrayIndex = 0; arrayIndex < numberOfElements;
+        ++arrayIndex) {
+      registers.emplace_back(
+          address.getMemoryAddress()
+              + (sizeof(std::uint32_t) + address.getElementDistance())
+                  * arrayIndex, true);
+    }
+  } catch (...) {
+    // Errors in the record address are reported when the record is
+    // initialized, so we simply skip the record here.
+  }
+}
+
+void initHook(::initHookState state) {
+  if (state != initHookAtBeginning
+      || MrfCachePreheater::getMode() == MrfCachePreheater::Mode::none) {
+    return;
+  }
+  try {
+    MrfCachePreheater::preheatFromRecords();
+  } catch (std::exception &e) {
+    errorPrintf("Preheating the cache from the records failed: %s",
+        e.what());
+  } catch (...) {
+    errorPrintf("Preheating the cache from the records failed: Unknown error.");
+  }
+}
+
+} // anonymous namespace
+
+std::atomic<MrfCachePreheater::Mode> MrfCachePreheater::mode(
+    MrfCachePreheater::Mode::generated);
+std::atomic<bool> MrfCachePreheater::initHookRegistered(false);
+
+void MrfCachePreheater::preheatFromRecords() {
+  if (!::pdbbase) {
+    throw std::runtime_error("No database has been loaded.");
+  }
+  MrfStartupProfiler::Span span("preheat", "Walk records");
+  std::map<std::string, RegisterList> registersByDevice;
+  // iocInit initializes the records in the same order in which we walk them
+  // here (by record type and then in the order in which they were loaded).
+  DBENTRY entry;
+  ::dbInitEntry(::pdbbase, &entry);
+  for (long status = ::dbFirstRecordType(&entry); !status;
+      status = ::dbNextRecordType(&entry)) {
+    std::string recordType = ::dbGetRecordTypeName(&entry);
+    bool waveform = (recordType == "waveform");
+    if (!waveform && !outputRecordTypes.count(recordType)) {
+      continue;
+    }
+    for (long recordStatus = ::dbFirstRecord(&entry); !recordStatus;
+        recordStatus = ::dbNextRecord(&entry)) {
+      if (::dbIsAlias(&entry)) {
+        continue;
+      }
+      addRecordRegisters(&entry, waveform, registersByDevice);
+    }
+  }
+  ::dbFinishEntry(&entry);
+  for (auto &deviceAndRegisters : registersByDevice) {
+    auto cache = MrfDeviceRegistry::getInstance().getDeviceCache(
+        deviceAndRegisters.first);
+    if (!cache) {
+      // Record initialization reports the missing device.
+      continue;
+    }
+    auto registers = std::make_shared<RegisterList>(
+        std::move(deviceAndRegisters.second));
+    // We schedule the registers before returning, so that the record
+    // initialization, which runs right after this init hook, waits for the
+    // preheat reads instead of sending its own reads. Sending the reads only
+    // blocks when the limit of reads in flight has been reached, so we use a
+    // separate thread for each device. This way, the devices are preheated in
+    // parallel and iocInit can continue with the record initialization, which
+    // only waits for the registers it needs.
+    cache->schedulePreheat(*registers);
+    std::string deviceId = deviceAndRegisters.first;
+    std::thread preheatThread([deviceId, cache, registers]() {
+      MrfStartupProfiler::Span span("preheat", deviceId + " (records)");
+      cache->preheatScheduled(*registers);
+      cache->finishPreheating();
+    });
+    preheatThread.detach();
+  }
+}
+
+void MrfCachePreheater::registerInitHook() {
+  if (!initHookRegistered.exchange(true)) {
+    if (::initHookRegister(initHook)) {
+      initHookRegistered.store(false);
+      throw std::runtime_error("Could not register the init hook.");
+    }
+  }
+}
+
+void MrfCachePreheater::setMode(Mode mode) {
+  MrfCachePreheater::mode.store(mode, std::memory_order_relaxed);
+}
+
+}
+}
+}
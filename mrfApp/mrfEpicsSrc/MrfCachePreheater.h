@@ -0,0 +1,137 @@
+/*
+ * Copyright 2026 aquenos GmbH.
+ * Copyright 2026 Karlsruhe Institute of Technology.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * This software has been developed by aquenos GmbH on behalf of the
+ * Karlsruhe Institute of Technology's Institute for Beam Physics and
+ * Technology.
+ *
+ * This software contains code originally developed by aquenos GmbH for
+ * the s7nodave EPICS device support. aquenos GmbH has relicensed the
+ * affected poritions of code from the s7nodave EPICS device support
+ * (originally licensed under the terms of the GNU GPL) under the terms
+ * of the GNU LGPL version 3 or newer.
+ */
+
+#ifndef ANKA_MRF_EPICS_CACHE_PREHEATER_H
+#define ANKA_MRF_EPICS_CACHE_PREHEATER_H
+
+#include <atomic>
+
+namespace anka {
+namespace mrf {
+namespace epics {
+
+/**
+ * Decides how the memory caches of the devices are preheated and derives the
+ * registers that need to be preheated from the records that have been loaded.
+ *
+ * By default, device implementations that benefit from preheating (like the
+ * UDP/IP based devices) preheat a fixed set of registers that has been
+ * generated from the reference databases. In addition to that, the registers
+ * needed by the records that have actually been loaded are preheated at the
+ * beginning of iocInit. In the {@code records} mode, only the latter happens,
+ * so that exactly those registers are read that are needed for initializing
+ * the records.
+ *
+ * EPICS initializes the records one after the other, so without preheating,
+ * each register that is not cached yet would delay the IOC startup by one
+ * round trip to the device. Instead, initialization happens in two phases:
+ * First, the records are walked and the registers that they need are
+ * scheduled. Second, the reads are sent concurrently while the records are
+ * initialized, and each record only waits for the registers that it needs. As
+ * the registers are read in the order in which the records are initialized,
+ * the startup time is limited by the throughput of the device instead of its
+ * latency.
+ */
+class MrfCachePreheater {
+
+public:
+
+  /**
+   * Mode of cache preheating.
+   */
+  enum class Mode {
+    /**
+     * Devices preheat a fixed set of registers when they are created. The
+     * other registers that are read when initializing the loaded records are
+     * preheated at the beginning of iocInit.
+     */
+    generated,
+
+    /**
+     * The registers that are read when initializing the loaded records are
+     * preheated at the beginning of iocInit.
+     */
+    records,
+
+    /**
+     * The cache is not preheated.
+     */
+    none
+  };
+
+  /**
+   * Returns the current preheat mode. The default is {@code generated}.
+   */
+  inline static Mode getMode() {
+    return mode.load(std::memory_order_relaxed);
+  }
+
+  /**
+   * Walks all records that have been loaded and starts preheating the caches
+   * of their devices with the registers that these records read during
+   * initialization. This only considers output records using the
+   * "MRF Memory" device support and waveform records using the
+   * "MRF Memory Output" device support, because those are the records that
+   * use the cache. The registers are scheduled before this method returns, but
+   * the reads are sent asynchronously and this method does not wait for them
+   * to finish. Records with an invalid address are ignored here, because
+   * record initialization reports the error.
+   */
+  static void preheatFromRecords();
+
+  /**
+   * Registers the init hook that calls {@link #preheatFromRecords()} at the
+   * beginning of iocInit, unless the mode is {@code none}. This is called by
+   * the registrar of this device support, so it does not have to be called by
+   * user code. Calling it more than once has no effect.
+   */
+  static void registerInitHook();
+
+  /**
+   * Sets the preheat mode. This has to be called before the devices are
+   * created, because the {@code generated} mode is applied when a device is
+   * created.
+   */
+  static void setMode(Mode mode);
+
+private:
+
+  static std::atomic<Mode> mode;
+  static std::atomic<bool> initHookRegistered;
+
+  // This class only has static members.
+  MrfCachePreheater() = delete;
+
+};
+
+}
+}
+}
+
+#endif // ANKA_MRF_EPICS_CACHE_PREHEATER_H
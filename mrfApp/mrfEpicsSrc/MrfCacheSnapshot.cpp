@@ -0,0 +1,161 @@
+/*
+ * Copyright 2026 aquenos GmbH.
+ * Copyright 2026 Karlsruhe Institute of Technology.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * This software has been developed by aquenos GmbH on behalf of the
+ * Karlsruhe Institute of Technology's Institute for Beam Physics and
+ * Technology.
+ *
+ * This software contains code originally developed by aquenos GmbH for
+ * the s7nodave EPICS device support. aquenos GmbH has relicensed the
+ * affected poritions of code from the s7nodave EPICS device support
+ * (originally licensed under the terms of the GNU GPL) under the terms
+ * of the GNU LGPL version 3 or newer.
+ */
+
+#include <stdexcept>
+#include <thread>
+
+#include <errlog.h>
+#include <initHooks.h>
+
+#include "mrfEpicsError.h"
+
+#include "MrfCacheSnapshot.h"
+
+namespace anka {
+namespace mrf {
+namespace epics {
+
+namespace {
+
+void initHook(::initHookState state) {
+  if (state != initHookAfterIocRunning) {
+    return;
+  }
+  MrfCacheSnapshot::verifyAndSaveAll();
+}
+
+} // anonymous namespace
+
+constexpr std::uint32_t MrfCacheSnapshot::firmwareVersionAddress;
+std::atomic<bool> MrfCacheSnapshot::initHookRegistered(false);
+std::mutex MrfCacheSnapshot::snapshotsMutex;
+std::vector<std::shared_ptr<MrfCacheSnapshot>> MrfCacheSnapshot::snapshots;
+
+std::shared_ptr<MrfCacheSnapshot> MrfCacheSnapshot::create(
+    const std::string &deviceId, std::shared_ptr<MrfMemoryCache> cache,
+    std::shared_ptr<MrfMemoryAccess> memoryAccess,
+    const std::string &fileName) {
+  if (!initHookRegistered.exchange(true)) {
+    if (::initHookRegister(initHook)) {
+      initHookRegistered.store(false);
+      throw std::runtime_error("Could not register the init hook.");
+    }
+  }
+  // The constructor is private, so we cannot use std::make_shared.
+  std::shared_ptr<MrfCacheSnapshot> snapshot(
+      new MrfCacheSnapshot(deviceId, cache, memoryAccess, fileName));
+  {
+    std::lock_guard<std::mutex> lock(snapshotsMutex);
+    snapshots.push_back(snapshot);
+  }
+  cache->beginSnapshotLoad();
+  return snapshot;
+}
+
+void MrfCacheSnapshot::verifyAndSaveAll() {
+  std::vector<std::shared_ptr<MrfCacheSnapshot>> snapshotsToVerify;
+  {
+    std::lock_guard<std::mutex> lock(snapshotsMutex);
+    snapshotsToVerify.swap(snapshots);
+  }
+  for (auto &snapshot : snapshotsToVerify) {
+    // Verification of a snapshot blocks until all values have been read from
+    // the device, so we use a separate thread for each device.
+    std::thread verifyThread([snapshot]() {
+      snapshot->verifyAndSave();
+    });
+    verifyThread.detach();
+  }
+}
+
+void MrfCacheSnapshot::load() {
+  try {
+    std::uint32_t key = getKey();
+    if (cache->loadSnapshot(fileName, key)) {
+      ::errlogPrintf(
+          "Loaded cache snapshot %s for device %s (firmware version 0x%08x).\n",
+          fileName.c_str(), deviceId.c_str(), static_cast<unsigned int>(key));
+    } else {
+      ::errlogPrintf(
+          "Cache snapshot %s for device %s does not exist or has been saved for a different firmware version.\n",
+          fileName.c_str(), deviceId.c_str());
+    }
+  } catch (std::exception &e) {
+    errorPrintf("Loading cache snapshot %s for device %s failed: %s",
+        fileName.c_str(), deviceId.c_str(), e.what());
+  } catch (...) {
+    errorPrintf("Loading cache snapshot %s for device %s failed: Unknown error.",
+        fileName.c_str(), deviceId.c_str());
+  }
+  cache->finishSnapshotLoad();
+}
+
+void MrfCacheSnapshot::verifyAndSave() {
+  try {
+    MrfMemoryCache::SnapshotVerificationResult result = cache->verifySnapshot();
+    if (result.verified || result.corrected || result.failed) {
+      ::errlogPrintf(
+          "Verified cache snapshot for device %s: %llu values verified, %llu corrected, %llu failed.\n",
+          deviceId.c_str(),
+          static_cast<unsigned long long>(result.verified),
+          static_cast<unsigned long long>(result.corrected),
+          static_cast<unsigned long long>(result.failed));
+    }
+    cache->saveSnapshot(fileName, getKey());
+  } catch (std::exception &e) {
+    errorPrintf("Saving cache snapshot %s for device %s failed: %s",
+        fileName.c_str(), deviceId.c_str(), e.what());
+  } catch (...) {
+    errorPrintf("Saving cache snapshot %s for device %s failed: Unknown error.",
+        fileName.c_str(), deviceId.c_str());
+  }
+}
+
+MrfCacheSnapshot::MrfCacheSnapshot(const std::string &deviceId,
+    std::shared_ptr<MrfMemoryCache> cache,
+    std::shared_ptr<MrfMemoryAccess> memoryAccess,
+    const std::string &fileName) :
+    deviceId(deviceId), cache(cache), memoryAccess(memoryAccess),
+    fileName(fileName), keyAvailable(false), key(0) {
+}
+
+std::uint32_t MrfCacheSnapshot::getKey() {
+  std::lock_guard<std::mutex> lock(mutex);
+  if (!keyAvailable) {
+    // We read the firmware version directly from the device, because it must
+    // not be taken from the cache.
+    key = memoryAccess->readUInt32(firmwareVersionAddress);
+    keyAvailable = true;
+  }
+  return key;
+}
+
+}
+}
+}
@@ -0,0 +1,151 @@
+/*
+ * Copyright 2026 aquenos GmbH.
+ * Copyright 2026 Karlsruhe Institute of Technology.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * This software has been developed by aquenos GmbH on behalf of the
+ * Karlsruhe Institute of Technology's Institute for Beam Physics and
+ * Technology.
+ *
+ * This software contains code originally developed by aquenos GmbH for
+ * the s7nodave EPICS device support. aquenos GmbH has relicensed the
+ * affected poritions of code from the s7nodave EPICS device support
+ * (originally licensed under the terms of the GNU GPL) under the terms
+ * of the GNU LGPL version 3 or newer.
+ */
+
+#ifndef ANKA_MRF_EPICS_CACHE_SNAPSHOT_H
+#define ANKA_MRF_EPICS_CACHE_SNAPSHOT_H
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <MrfMemoryAccess.h>
+
+#include "MrfMemoryCache.h"
+
+namespace anka {
+namespace mrf {
+namespace epics {
+
+/**
+ * Persists the memory cache of a device across IOC restarts. When the device
+ * is created, the cache is warm-started from the snapshot file, so that record
+ * initialization does not have to wait for the device. The snapshot is keyed
+ * by the firmware version register, so that it is not used after the firmware
+ * of the device has changed.
+ *
+ * After iocInit has finished, the values loaded from the snapshot are verified
+ * in the background. Output records that have been initialized with a value
+ * that turns out to be different from the value stored in the device are
+ * corrected, unless they have been processed in the meantime. Finally, the
+ * cache contents are saved to the snapshot file, so that they can be used when
+ * the IOC is started the next time.
+ */
+class MrfCacheSnapshot {
+
+public:
+
+  /**
+   * Address of the firmware version register. This register is at the same
+   * address for the EVG and the EVR.
+   */
+  static constexpr std::uint32_t firmwareVersionAddress = 0x2c;
+
+  /**
+   * Creates a snapshot for the specified device and registers it, so that it
+   * is verified and saved after iocInit has finished. The cache is marked as
+   * loading a snapshot, so that reads wait until {@link #load()} has been
+   * called. For this reason, {@link #load()} must be called after creating
+   * the snapshot, typically from a background thread.
+   */
+  static std::shared_ptr<MrfCacheSnapshot> create(const std::string &deviceId,
+      std::shared_ptr<MrfMemoryCache> cache,
+      std::shared_ptr<MrfMemoryAccess> memoryAccess,
+      const std::string &fileName);
+
+  /**
+   * Starts the verification of all registered snapshots. Each snapshot is
+   * verified and saved in a separate thread, so that the devices are handled
+   * in parallel. This method is called by an init hook after iocInit has
+   * finished.
+   */
+  static void verifyAndSaveAll();
+
+  /**
+   * Reads the firmware version from the device and loads the snapshot file if
+   * it has been saved for the same firmware version. This method blocks until
+   * the snapshot has been loaded. Errors are reported, but not passed on to
+   * the caller. In any case, reads from the cache are resumed when this method
+   * returns.
+   */
+  void load();
+
+  /**
+   * Verifies the values that have been loaded from the snapshot and saves the
+   * cache contents to the snapshot file. This method blocks until the values
+   * have been verified and the file has been written. Errors are reported, but
+   * not passed on to the caller.
+   */
+  void verifyAndSave();
+
+private:
+
+  // We do not want to allow copy or move construction or assignment.
+  MrfCacheSnapshot(const MrfCacheSnapshot &) = delete;
+  MrfCacheSnapshot(MrfCacheSnapshot &&) = delete;
+  MrfCacheSnapshot &operator=(const MrfCacheSnapshot &) = delete;
+  MrfCacheSnapshot &operator=(MrfCacheSnapshot &&) = delete;
+
+  static std::atomic<bool> initHookRegistered;
+  static std::mutex snapshotsMutex;
+  static std::vector<std::shared_ptr<MrfCacheSnapshot>> snapshots;
+
+  std::string deviceId;
+  std::shared_ptr<MrfMemoryCache> cache;
+  std::shared_ptr<MrfMemoryAccess> memoryAccess;
+  std::string fileName;
+
+  /**
+   * Mutex protecting the key.
+   */
+  std::mutex mutex;
+  bool keyAvailable;
+  std::uint32_t key;
+
+  MrfCacheSnapshot(const std::string &deviceId,
+      std::shared_ptr<MrfMemoryCache> cache,
+      std::shared_ptr<MrfMemoryAccess> memoryAccess,
+      const std::string &fileName);
+
+  /**
+   * Returns the key for the snapshot. If the firmware version has not been
+   * read successfully when loading the snapshot, this method tries to read it
+   * again. Throws an exception if the firmware version cannot be read.
+   */
+  std::uint32_t getKey();
+
+};
+
+}
+}
+}
+
+#endif // ANKA_MRF_EPICS_CACHE_SNAPSHOT_H
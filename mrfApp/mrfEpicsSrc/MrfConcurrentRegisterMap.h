@@ -0,0 +1,532 @@
+/*
+ * Copyright 2026 aquenos GmbH.
+ * Copyright 2026 Karlsruhe Institute of Technology.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * This software has been developed by aquenos GmbH on behalf of the
+ * Karlsruhe Institute of Technology's Institute for Beam Physics and
+ * Technology.
+ *
+ * This software contains code originally developed by aquenos GmbH for
+ * the s7nodave EPICS device support. aquenos GmbH has relicensed the
+ * affected poritions of code from the s7nodave EPICS device support
+ * (originally licensed under the terms of the GNU GPL) under the terms
+ * of the GNU LGPL version 3 or newer.
+ */
+
+#ifndef ANKA_MRF_EPICS_CONCURRENT_REGISTER_MAP_H
+#define ANKA_MRF_EPICS_CONCURRENT_REGISTER_MAP_H
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace anka {
+namespace mrf {
+namespace epics {
+
+/**
+ * Map from register addresses to register values that is optimized for
+ * concurrent reads. The map uses an open-addressing hash table with linear
+ * probing. Lookups and snapshots do not acquire any lock, so they never block
+ * and are never blocked by writers. Insertions, updates, and removals can be
+ * made concurrently from several threads. They are serialized internally, but
+ * readers are not affected by this.
+ *
+ * When the table has to grow, a new table is allocated and published. The old
+ * table is kept until the map is destroyed, so that readers that still use it
+ * are safe. Because the table doubles in size each time, the memory used by
+ * the old tables is never larger than the memory used by the current table.
+ * A reader that still uses the old table might not see values that have been
+ * inserted after the new table has been published. This is fine for a cache,
+ * because such a reader behaves as if it had looked up the value a moment
+ * earlier.
+ *
+ * Each value is stored together with the time when it was obtained from the
+ * device. Values whose time is not known (e.g. because they have been loaded
+ * from a snapshot) are stored with a default constructed time point. The time
+ * is written after the value and read before it, so a reader might see a new
+ * value with the time of the old one, but never an old value with the time of
+ * the new one. This means that a value never appears to be more recent than it
+ * actually is.
+ *
+ * The address 0xffffffff is used internally for marking unused slots, so it
+ * cannot be used as a key. This is not a limitation in practice, because it is
+ * not a valid address for a 16-bit or 32-bit register.
+ */
+template<typename T>
+class MrfConcurrentRegisterMap {
+
+public:
+
+  /**
+   * Type used for the time when a value was obtained from the device.
+   */
+  using TimePoint = std::chrono::steady_clock::time_point;
+
+  /**
+   * Creates an empty map.
+   */
+  MrfConcurrentRegisterMap();
+
+  /**
+   * Tells whether the map contains a value for the specified address. This
+   * method does not block.
+   */
+  bool contains(std::uint32_t address) const;
+
+  /**
+   * Inserts the specified value unless the map already contains a value for
+   * the specified address. Returns the value that is stored in the map after
+   * the operation and a flag that is {@code true} if the value has been
+   * inserted and {@code false} if there already was a value.
+   */
+  std::pair<T, bool> emplace(std::uint32_t address, T value,
+      TimePoint time = std::chrono::steady_clock::now());
+
+  /**
+   * Removes the value for the specified address. Returns {@code true} if there
+   * was a value and {@code false} otherwise.
+   */
+  bool erase(std::uint32_t address);
+
+  /**
+   * Looks up the value for the specified address. If the map contains a value,
+   * it is stored in {@code value} and {@code true} is returned. Otherwise,
+   * {@code false} is returned. This method does not block.
+   */
+  bool find(std::uint32_t address, T &value) const;
+
+  /**
+   * Looks up the value for the specified address. If the map contains a value,
+   * it is stored in {@code value}, the time when it was obtained is stored in
+   * {@code time}, and {@code true} is returned. Otherwise, {@code false} is
+   * returned. This method does not block.
+   */
+  bool find(std::uint32_t address, T &value, TimePoint &time) const;
+
+  /**
+   * Returns a copy of the map's contents, sorted by address. This method does
+   * not block and does not block writers. Values that are inserted or updated
+   * while the copy is made might or might not be included.
+   */
+  std::map<std::uint32_t, T> getSnapshot() const;
+
+  /**
+   * Removes the values for all addresses from {@code firstAddress} to
+   * {@code lastAddress} (inclusive) and records the specified time for them,
+   * so that {@link #storeIfNewer(std::uint32_t, T, TimePoint)} does not store
+   * values that have been obtained earlier. Returns the number of values that
+   * have been removed.
+   */
+  std::size_t invalidate(std::uint32_t firstAddress, std::uint32_t lastAddress,
+      TimePoint time);
+
+  /**
+   * Stores the specified value, replacing any existing value for the specified
+   * address.
+   */
+  void store(std::uint32_t address, T value,
+      TimePoint time = std::chrono::steady_clock::now());
+
+  /**
+   * Stores the specified value unless the value that is stored for the
+   * specified address (or the invalidation of that value) is more recent than
+   * the specified time. Returns {@code true} if the value has been stored and
+   * {@code false} otherwise.
+   */
+  bool storeIfNewer(std::uint32_t address, T value, TimePoint time);
+
+private:
+
+  /**
+   * Address that marks an unused slot.
+   */
+  static constexpr std::uint32_t emptyAddress = 0xffffffff;
+
+  /**
+   * Number of slots of the initial table. This has to be a power of two.
+   */
+  static constexpr std::size_t initialCapacity = 1024;
+
+  /**
+   * Flag that is set in a slot's value word if the slot holds a value.
+   */
+  static constexpr std::uint64_t presentFlag = static_cast<std::uint64_t>(1)
+      << 32;
+
+  /**
+   * Slot of the hash table. Once a slot has been assigned to an address, it
+   * keeps that address. When the value is removed, only the present flag is
+   * cleared, so that probing sequences are not interrupted. The time is kept,
+   * so that a removed value is still known to have been invalidated at that
+   * time.
+   */
+  struct Slot {
+    std::atomic<std::uint32_t> address;
+    std::atomic<std::uint64_t> value;
+    std::atomic<TimePoint::rep> time;
+  };
+
+  /**
+   * Hash table. The number of slots is a power of two and at most half of the
+   * slots are used, so that probing sequences stay short and always end at an
+   * unused slot.
+   */
+  struct Table {
+
+    Table(std::size_t capacity) :
+        capacity(capacity), slots(new Slot[capacity]), used(0) {
+      for (std::size_t i = 0; i < capacity; ++i) {
+        slots[i].address.store(emptyAddress, std::memory_order_relaxed);
+        slots[i].value.store(0, std::memory_order_relaxed);
+        slots[i].time.store(0, std::memory_order_relaxed);
+      }
+    }
+
+    std::size_t capacity;
+    std::unique_ptr<Slot[]> slots;
+
+    /**
+     * Number of slots that have been assigned to an address. This is only
+     * accessed while holding the write mutex.
+     */
+    std::size_t used;
+
+  };
+
+  // We do not want to allow copy or move construction or assignment.
+  MrfConcurrentRegisterMap(const MrfConcurrentRegisterMap &) = delete;
+  MrfConcurrentRegisterMap(MrfConcurrentRegisterMap &&) = delete;
+  MrfConcurrentRegisterMap &operator=(const MrfConcurrentRegisterMap &) =
+      delete;
+  MrfConcurrentRegisterMap &operator=(MrfConcurrentRegisterMap &&) = delete;
+
+  /**
+   * Table that is currently used.
+   */
+  std::atomic<Table *> table;
+
+  /**
+   * All tables that have been allocated, including the current one. Only
+   * accessed while holding the write mutex.
+   */
+  std::vector<std::unique_ptr<Table>> tables;
+
+  /**
+   * Mutex that serializes writers.
+   */
+  std::mutex writeMutex;
+
+  /**
+   * Returns the slot for the specified address, assigning an unused slot to
+   * the address if there is no slot yet. The table is grown if necessary. Must
+   * only be called while holding the write mutex.
+   */
+  Slot &assignSlot(std::uint32_t address);
+
+  /**
+   * Returns the slot for the specified address or null if no slot has been
+   * assigned to the address.
+   */
+  static Slot *findSlot(Table &table, std::uint32_t address);
+
+  /**
+   * Stores the value and time in the specified slot. Must only be called while
+   * holding the write mutex.
+   */
+  static void storeSlot(Slot &slot, T value, TimePoint time);
+
+  /**
+   * Returns the index of the first slot that is probed for the specified
+   * address.
+   */
+  static std::size_t hash(const Table &table, std::uint32_t address);
+
+};
+
+template<typename T>
+constexpr std::uint32_t MrfConcurrentRegisterMap<T>::emptyAddress;
+
+template<typename T>
+constexpr std::size_t MrfConcurrentRegisterMap<T>::initialCapacity;
+
+template<typename T>
+constexpr std::uint64_t MrfConcurrentRegisterMap<T>::presentFlag;
+
+template<typename T>
+MrfConcurrentRegisterMap<T>::MrfConcurrentRegisterMap() {
+  tables.emplace_back(new Table(initialCapacity));
+  table.store(tables.back().get(), std::memory_order_release);
+}
+
+template<typename T>
+bool MrfConcurrentRegisterMap<T>::contains(std::uint32_t address) const {
+  T value;
+  return find(address, value);
+}
+
+template<typename T>
+std::pair<T, bool> MrfConcurrentRegisterMap<T>::emplace(std::uint32_t address,
+    T value, TimePoint time) {
+  std::lock_guard<std::mutex> lock(writeMutex);
+  Slot &slot = assignSlot(address);
+  std::uint64_t word = slot.value.load(std::memory_order_relaxed);
+  if (word & presentFlag) {
+    return std::make_pair(static_cast<T>(word), false);
+  }
+  storeSlot(slot, value, time);
+  return std::make_pair(value, true);
+}
+
+template<typename T>
+bool MrfConcurrentRegisterMap<T>::erase(std::uint32_t address) {
+  std::lock_guard<std::mutex> lock(writeMutex);
+  Slot *slot = findSlot(*table.load(std::memory_order_relaxed), address);
+  if (!slot || !(slot->value.load(std::memory_order_relaxed) & presentFlag)) {
+    return false;
+  }
+  slot->value.store(0, std::memory_order_release);
+  return true;
+}
+
+template<typename T>
+bool MrfConcurrentRegisterMap<T>::find(std::uint32_t address, T &value) const {
+  Slot *slot = findSlot(*table.load(std::memory_order_acquire), address);
+  if (!slot) {
+    return false;
+  }
+  std::uint64_t word = slot->value.load(std::memory_order_acquire);
+  if (!(word & presentFlag)) {
+    return false;
+  }
+  value = static_cast<T>(word);
+  return true;
+}
+
+template<typename T>
+bool MrfConcurrentRegisterMap<T>::find(std::uint32_t address, T &value,
+    TimePoint &time) const {
+  Slot *slot = findSlot(*table.load(std::memory_order_acquire), address);
+  if (!slot) {
+    return false;
+  }
+  // The time has to be read before the value (see the class description).
+  TimePoint::rep timeCount = slot->time.load(std::memory_order_acquire);
+  std::uint64_t word = slot->value.load(std::memory_order_acquire);
+  if (!(word & presentFlag)) {
+    return false;
+  }
+  value = static_cast<T>(word);
+  time = TimePoint(TimePoint::duration(timeCount));
+  return true;
+}
+
+template<typename T>
+std::map<std::uint32_t, T> MrfConcurrentRegisterMap<T>::getSnapshot() const {
+  std::map<std::uint32_t, T> snapshot;
+  Table &currentTable = *table.load(std::memory_order_acquire);
+  for (std::size_t i = 0; i < currentTable.capacity; ++i) {
+    Slot &slot = currentTable.slots[i];
+    std::uint32_t address = slot.address.load(std::memory_order_acquire);
+    if (address == emptyAddress) {
+      continue;
+    }
+    std::uint64_t word = slot.value.load(std::memory_order_acquire);
+    if (word & presentFlag) {
+      snapshot.emplace(address, static_cast<T>(word));
+    }
+  }
+  return snapshot;
+}
+
+template<typename T>
+std::size_t MrfConcurrentRegisterMap<T>::invalidate(std::uint32_t firstAddress,
+    std::uint32_t lastAddress, TimePoint time) {
+  std::lock_guard<std::mutex> lock(writeMutex);
+  Table &currentTable = *table.load(std::memory_order_relaxed);
+  std::size_t removed = 0;
+  auto invalidateSlot = [&removed, time](Slot &slot) {
+    // The value has to be removed before the time is updated, so that a
+    // reader never sees the old value with the new time.
+    if (slot.value.load(std::memory_order_relaxed) & presentFlag) {
+      slot.value.store(0, std::memory_order_release);
+      ++removed;
+    }
+    if (slot.time.load(std::memory_order_relaxed)
+        < time.time_since_epoch().count()) {
+      slot.time.store(time.time_since_epoch().count(),
+          std::memory_order_release);
+    }
+  };
+  // Small ranges (e.g. the registers touched by a single write) are handled by
+  // looking up each address. For large ranges, it is cheaper to scan the whole
+  // table.
+  if (lastAddress - firstAddress < currentTable.capacity) {
+    std::uint32_t address = firstAddress;
+    while (true) {
+      Slot *slot = findSlot(currentTable, address);
+      if (slot) {
+        invalidateSlot(*slot);
+      }
+      if (address == lastAddress) {
+        break;
+      }
+      ++address;
+    }
+  } else {
+    for (std::size_t i = 0; i < currentTable.capacity; ++i) {
+      Slot &slot = currentTable.slots[i];
+      std::uint32_t address = slot.address.load(std::memory_order_relaxed);
+      if (address != emptyAddress && address >= firstAddress
+          && address <= lastAddress) {
+        invalidateSlot(slot);
+      }
+    }
+  }
+  return removed;
+}
+
+template<typename T>
+void MrfConcurrentRegisterMap<T>::store(std::uint32_t address, T value,
+    TimePoint time) {
+  std::lock_guard<std::mutex> lock(writeMutex);
+  storeSlot(assignSlot(address), value, time);
+}
+
+template<typename T>
+bool MrfConcurrentRegisterMap<T>::storeIfNewer(std::uint32_t address, T value,
+    TimePoint time) {
+  std::lock_guard<std::mutex> lock(writeMutex);
+  Table &currentTable = *table.load(std::memory_order_relaxed);
+  Slot *slot = findSlot(currentTable, address);
+  if (slot && slot->time.load(std::memory_order_relaxed)
+      > time.time_since_epoch().count()) {
+    return false;
+  }
+  storeSlot(slot ? *slot : assignSlot(address), value, time);
+  return true;
+}
+
+template<typename T>
+typename MrfConcurrentRegisterMap<T>::Slot &MrfConcurrentRegisterMap<T>::assignSlot(
+    std::uint32_t address) {
+  if (address == emptyAddress) {
+    throw std::invalid_argument(
+        "The address 0xffffffff cannot be stored in the map.");
+  }
+  Table *currentTable = table.load(std::memory_order_relaxed);
+  Slot *slot = findSlot(*currentTable, address);
+  if (slot) {
+    return *slot;
+  }
+  if (2 * (currentTable->used + 1) > currentTable->capacity) {
+    // We copy the slots that hold a value into a table of twice the size.
+    // Slots whose value has been removed are copied as well if they have a
+    // time, because this time tells storeIfNewer that a value read before the
+    // invalidation must not be stored. Only slots that have neither a value nor
+    // a time are dropped.
+    std::unique_ptr<Table> newTable(new Table(2 * currentTable->capacity));
+    for (std::size_t i = 0; i < currentTable->capacity; ++i) {
+      Slot &oldSlot = currentTable->slots[i];
+      std::uint32_t oldAddress = oldSlot.address.load(
+          std::memory_order_relaxed);
+      std::uint64_t word = oldSlot.value.load(std::memory_order_relaxed);
+      TimePoint::rep timeCount = oldSlot.time.load(std::memory_order_relaxed);
+      if (oldAddress == emptyAddress
+          || (!(word & presentFlag) && timeCount == 0)) {
+        continue;
+      }
+      std::size_t index = hash(*newTable, oldAddress);
+      while (newTable->slots[index].address.load(std::memory_order_relaxed)
+          != emptyAddress) {
+        index = (index + 1) & (newTable->capacity - 1);
+      }
+      newTable->slots[index].address.store(oldAddress,
+          std::memory_order_relaxed);
+      newTable->slots[index].value.store(word, std::memory_order_relaxed);
+      newTable->slots[index].time.store(timeCount, std::memory_order_relaxed);
+      ++newTable->used;
+    }
+    tables.push_back(std::move(newTable));
+    currentTable = tables.back().get();
+    // Publishing the table with release semantics ensures that readers see
+    // the initialized slots.
+    table.store(currentTable, std::memory_order_release);
+  }
+  std::size_t index = hash(*currentTable, address);
+  while (currentTable->slots[index].address.load(std::memory_order_relaxed)
+      != emptyAddress) {
+    index = (index + 1) & (currentTable->capacity - 1);
+  }
+  // The caller stores the value after the address has been assigned. Readers
+  // check the present flag of the value, so they never see a slot that has an
+  // address but no value yet.
+  Slot &newSlot = currentTable->slots[index];
+  newSlot.value.store(0, std::memory_order_relaxed);
+  newSlot.time.store(0, std::memory_order_relaxed);
+  newSlot.address.store(address, std::memory_order_release);
+  ++currentTable->used;
+  return newSlot;
+}
+
+template<typename T>
+typename MrfConcurrentRegisterMap<T>::Slot *MrfConcurrentRegisterMap<T>::findSlot(
+    Table &table, std::uint32_t address) {
+  std::size_t index = hash(table, address);
+  while (true) {
+    Slot &slot = table.slots[index];
+    std::uint32_t slotAddress = slot.address.load(std::memory_order_acquire);
+    if (slotAddress == address) {
+      return &slot;
+    }
+    if (slotAddress == emptyAddress) {
+      return nullptr;
+    }
+    index = (index + 1) & (table.capacity - 1);
+  }
+}
+
+template<typename T>
+void MrfConcurrentRegisterMap<T>::storeSlot(Slot &slot, T value,
+    TimePoint time) {
+  // The value has to be written before the time (see the class description).
+  slot.value.store(presentFlag | value, std::memory_order_release);
+  slot.time.store(time.time_since_epoch().count(), std::memory_order_release);
+}
+
+template<typename T>
+std::size_t MrfConcurrentRegisterMap<T>::hash(const Table &table,
+    std::uint32_t address) {
+  // Register addresses are multiples of two or four and are often contiguous,
+  // so we use Fibonacci hashing in order to spread them over the table.
+  return static_cast<std::size_t>(
+      (static_cast<std::uint64_t>(address) * 0x9e3779b97f4a7c15ULL) >> 32)
+      & (table.capacity - 1);
+}
+
+}
+}
+}
+
+#endif // ANKA_MRF_EPICS_CONCURRENT_REGISTER_MAP_H
@@ -32,6 +32,10 @@
 #include <MrfConsistentAsynchronousMemoryAccess.h>
 
 #include "MrfDeviceRegistry.h"
+#include "MrfInterruptOverflowCounter.h"
+#include "MrfPollGroup.h"
+#include "MrfPostedWriteStatus.h"
+#include "MrfReadCoalescer.h"
 
 namespace anka {
 namespace mrf {
@@ -50,6 +54,17 @@ std::shared_ptr<MrfConsistentMemoryAccess> MrfDeviceRegistry::getDevice(
   }
 }
 
+std::shared_ptr<MrfConsistentMemoryAccess> MrfDeviceRegistry::getDevice(
+    MrfIdTable::Handle deviceHandle) {
+  // We have to hold the mutex in order to protect the vector from concurrent
+  // access.
+  std::lock_guard<std::recursive_mutex> lock(mutex);
+  if (deviceHandle >= devicesByHandle.size()) {
+    return std::shared_ptr<MrfConsistentMemoryAccess>();
+  }
+  return devicesByHandle[deviceHandle];
+}
+
 std::shared_ptr<MrfMemoryCache> MrfDeviceRegistry::getDeviceCache(
     const std::string &deviceId) {
   // We have to hold the mutex in order to protect the map from concurrent
@@ -63,6 +78,82 @@ std::shared_ptr<MrfMemoryCache> MrfDeviceRegistry::getDeviceCache(
   }
 }
 
+std::shared_ptr<MrfMemoryCache> MrfDeviceRegistry::getDeviceCache(
+    MrfIdTable::Handle deviceHandle) {
+  // We have to hold the mutex in order to protect the vector from concurrent
+  // access.
+  std::lock_guard<std::recursive_mutex> lock(mutex);
+  if (deviceHandle >= cachesByHandle.size()) {
+    return std::shared_ptr<MrfMemoryCache>();
+  }
+  return cachesByHandle[deviceHandle];
+}
+
+std::shared_ptr<MrfInterruptOverflowCounter> MrfDeviceRegistry::getInterruptOverflowCounter(
+    const std::string &deviceId) {
+  // We have to hold the mutex in order to protect the maps from concurrent
+  // access.
+  std::lock_guard<std::recursive_mutex> lock(mutex);
+  if (!devices.count(deviceId)) {
+    return std::shared_ptr<MrfInterruptOverflowCounter>();
+  }
+  auto counter = interruptOverflowCounters.find(deviceId);
+  if (counter != interruptOverflowCounters.end()) {
+    return counter->second;
+  }
+  auto newCounter = std::make_shared<MrfInterruptOverflowCounter>();
+  interruptOverflowCounters.insert(std::make_pair(deviceId, newCounter));
+  return newCounter;
+}
+
+std::shared_ptr<MrfPollGroup> MrfDeviceRegistry::getPollGroup(
+    const std::string &pollGroupId) {
+  // We have to hold the mutex in order to protect the map from concurrent
+  // access.
+  std::lock_guard<std::recursive_mutex> lock(mutex);
+  auto pollGroup = pollGroups.find(pollGroupId);
+  if (pollGroup == pollGroups.end()) {
+    return std::shared_ptr<MrfPollGroup>();
+  } else {
+    return pollGroup->second;
+  }
+}
+
+std::shared_ptr<MrfPostedWriteStatus> MrfDeviceRegistry::getPostedWriteStatus(
+    const std::string &deviceId) {
+  // We have to hold the mutex in order to protect the maps from concurrent
+  // access.
+  std::lock_guard<std::recursive_mutex> lock(mutex);
+  if (!devices.count(deviceId)) {
+    return std::shared_ptr<MrfPostedWriteStatus>();
+  }
+  auto status = postedWriteStatuses.find(deviceId);
+  if (status != postedWriteStatuses.end()) {
+    return status->second;
+  }
+  auto newStatus = std::make_shared<MrfPostedWriteStatus>();
+  postedWriteStatuses.insert(std::make_pair(deviceId, newStatus));
+  return newStatus;
+}
+
+std::shared_ptr<MrfReadCoalescer> MrfDeviceRegistry::getReadCoalescer(
+    const std::string &deviceId) {
+  // We have to hold the mutex in order to protect the maps from concurrent
+  // access.
+  std::lock_guard<std::recursive_mutex> lock(mutex);
+  auto device = devices.find(deviceId);
+  if (device == devices.end()) {
+    return std::shared_ptr<MrfReadCoalescer>();
+  }
+  auto readCoalescer = readCoalescers.find(deviceId);
+  if (readCoalescer != readCoalescers.end()) {
+    return readCoalescer->second;
+  }
+  auto newReadCoalescer = std::make_shared<MrfReadCoalescer>(device->second);
+  readCoalescers.insert(std::make_pair(deviceId, newReadCoalescer));
+  return newReadCoalescer;
+}
+
 void MrfDeviceRegistry::registerDevice(const std::string &deviceId,
     std::shared_ptr<MrfConsistentMemoryAccess> device) {
   // We have to hold the mutex in order to protect the map from concurrent
@@ -71,9 +162,32 @@ void MrfDeviceRegistry::registerDevice(const std::string &deviceId,
   if (devices.count(deviceId)) {
     throw std::runtime_error("Device ID is already in use.");
   }
+  MrfIdTable::Handle deviceHandle = MrfIdTable::getInstance().intern(deviceId);
+  auto cache = std::make_shared<MrfMemoryCache>(device);
+  // All writes to the device pass through the consistent memory access, so
+  // registering the cache as a write listener keeps it coherent.
+  if (device->supportsWriteListeners()) {
+    device->addWriteListener(cache->getWriteListener());
+  }
+  if (deviceHandle >= devicesByHandle.size()) {
+    devicesByHandle.resize(deviceHandle + 1);
+    cachesByHandle.resize(deviceHandle + 1);
+  }
   devices.insert(std::make_pair(deviceId, device));
-  caches.insert(
-      std::make_pair(deviceId, std::make_shared<MrfMemoryCache>(device)));
+  caches.insert(std::make_pair(deviceId, cache));
+  devicesByHandle[deviceHandle] = device;
+  cachesByHandle[deviceHandle] = cache;
+}
+
+void MrfDeviceRegistry::registerPollGroup(const std::string &pollGroupId,
+    std::shared_ptr<MrfPollGroup> pollGroup) {
+  // We have to hold the mutex in order to protect the map from concurrent
+  // access.
+  std::lock_guard<std::recursive_mutex> lock(mutex);
+  if (pollGroups.count(pollGroupId)) {
+    throw std::runtime_error("Poll group ID is already in use.");
+  }
+  pollGroups.insert(std::make_pair(pollGroupId, pollGroup));
 }
 
 MrfDeviceRegistry MrfDeviceRegistry::instance;
@@ -33,15 +33,33 @@
 #include <memory>
 #include <mutex>
 #include <unordered_map>
+#include <vector>
 
 #include <MrfConsistentMemoryAccess.h>
 
+#include "MrfIdTable.h"
 #include "MrfMemoryCache.h"
 
 namespace anka {
 namespace mrf {
 namespace epics {
 
+// Forward declaration. The full declaration is only needed by code that
+// actually uses interrupt records.
+class MrfInterruptOverflowCounter;
+
+// Forward declaration. The full declaration is only needed by code that
+// actually uses poll groups.
+class MrfPollGroup;
+
+// Forward declaration. The full declaration is only needed by code that
+// actually uses posted writes.
+class MrfPostedWriteStatus;
+
+// Forward declaration. The full declaration is only needed by code that
+// actually shares reads.
+class MrfReadCoalescer;
+
 /**
  * Registry holding MRF devices. Devices are registered with the registry
  * during initialization and can then be retrieved for use by different records.
@@ -66,12 +84,61 @@ public:
   std::shared_ptr<MrfConsistentMemoryAccess> getDevice(
       const std::string &deviceId);
 
+  /**
+   * Returns the device with the ID identified by the specified handle (see
+   * {@link MrfIdTable}). If no device with the ID has been registered, a
+   * pointer to null is returned. This is cheaper than looking up the device
+   * by its ID, because the ID does not have to be hashed.
+   */
+  std::shared_ptr<MrfConsistentMemoryAccess> getDevice(
+      MrfIdTable::Handle deviceHandle);
+
   /**
    * Returns the cache for the device with the specified ID. If no device with
    * the ID has been registered, a pointer to null is returned.
    */
   std::shared_ptr<MrfMemoryCache> getDeviceCache(const std::string &deviceId);
 
+  /**
+   * Returns the cache for the device with the ID identified by the specified
+   * handle (see {@link MrfIdTable}). If no device with the ID has been
+   * registered, a pointer to null is returned.
+   */
+  std::shared_ptr<MrfMemoryCache> getDeviceCache(
+      MrfIdTable::Handle deviceHandle);
+
+  /**
+   * Returns the counter for interrupts that could not be queued normally by
+   * the interrupt records of the device with the specified ID. The counter is
+   * created when it is requested for the first time. If no device with the ID
+   * has been registered, a pointer to null is returned.
+   */
+  std::shared_ptr<MrfInterruptOverflowCounter> getInterruptOverflowCounter(
+      const std::string &deviceId);
+
+  /**
+   * Returns the poll group with the specified ID. If no poll group with the ID
+   * has been registered, a pointer to null is returned.
+   */
+  std::shared_ptr<MrfPollGroup> getPollGroup(const std::string &pollGroupId);
+
+  /**
+   * Returns the status of the posted writes for the device with the specified
+   * ID. The status object is created when it is requested for the first time.
+   * If no device with the ID has been registered, a pointer to null is
+   * returned.
+   */
+  std::shared_ptr<MrfPostedWriteStatus> getPostedWriteStatus(
+      const std::string &deviceId);
+
+  /**
+   * Returns the read coalescer for the device with the specified ID. The read
+   * coalescer is created when it is requested for the first time. If no device
+   * with the ID has been registered, a pointer to null is returned.
+   */
+  std::shared_ptr<MrfReadCoalescer> getReadCoalescer(
+      const std::string &deviceId);
+
   /**
    * Registers a device under the specified name. This method can be used to
    * register a device instance that cannot be created by the device registry
@@ -83,6 +150,14 @@ public:
   void registerDevice(const std::string &deviceId,
       std::shared_ptr<MrfConsistentMemoryAccess> device);
 
+  /**
+   * Registers a poll group under the specified name. Throws an exception if the
+   * poll group cannot be registered because the specified name is already in
+   * use.
+   */
+  void registerPollGroup(const std::string &pollGroupId,
+      std::shared_ptr<MrfPollGroup> pollGroup);
+
 private:
 
   // We do not want to allow copy or move construction or assignment.
@@ -95,6 +170,16 @@ private:
 
   std::unordered_map<std::string, std::shared_ptr<MrfConsistentMemoryAccess>> devices;
   std::unordered_map<std::string, std::shared_ptr<MrfMemoryCache>> caches;
+  std::unordered_map<std::string, std::shared_ptr<MrfInterruptOverflowCounter>> interruptOverflowCounters;
+  std::unordered_map<std::string, std::shared_ptr<MrfPollGroup>> pollGroups;
+  std::unordered_map<std::string, std::shared_ptr<MrfPostedWriteStatus>> postedWriteStatuses;
+  std::unordered_map<std::string, std::shared_ptr<MrfReadCoalescer>> readCoalescers;
+  /**
+   * Devices and caches indexed by the handle of the device ID. Handles of IDs
+   * that are not used by a device have a null pointer.
+   */
+  std::vector<std::shared_ptr<MrfConsistentMemoryAccess>> devicesByHandle;
+  std::vector<std::shared_ptr<MrfMemoryCache>> cachesByHandle;
   std::recursive_mutex mutex;
 
   MrfDeviceRegistry();
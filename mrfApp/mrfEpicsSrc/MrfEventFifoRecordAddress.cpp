@@ -0,0 +1,159 @@
+/*
+ * Copyright 2026 aquenos GmbH.
+ * Copyright 2026 Karlsruhe Institute of Technology.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * This software has been developed by aquenos GmbH on behalf of the
+ * Karlsruhe Institute of Technology's Institute for Beam Physics and
+ * Technology.
+ *
+ * This software contains code originally developed by aquenos GmbH for
+ * the s7nodave EPICS device support. aquenos GmbH has relicensed the
+ * affected poritions of code from the s7nodave EPICS device support
+ * (originally licensed under the terms of the GNU GPL) under the terms
+ * of the GNU LGPL version 3 or newer.
+ */
+
+#include <algorithm>
+#include <cctype>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <utility>
+
+#include "MrfEventFifoRecordAddress.h"
+
+namespace anka {
+namespace mrf {
+namespace epics {
+
+// We put all locally used functions into an anonoymous namespace so that they
+// do not collide with other functions that might accidentally have the same
+// name.
+namespace {
+
+bool compareStringsIgnoreCase(const std::string &str1,
+    const std::string &str2) {
+  if (str1.length() != str2.length()) {
+    return false;
+  }
+  return std::equal(str1.begin(), str1.end(), str2.begin(),
+      [](char c1, char c2) {return std::tolower(c1) == std::tolower(c2);});
+}
+
+bool startsWithIgnoreCase(const std::string &str, const std::string &prefix) {
+  return str.length() >= prefix.length()
+      && compareStringsIgnoreCase(str.substr(0, prefix.length()), prefix);
+}
+
+std::pair<std::size_t, std::size_t> findNextToken(const std::string &str,
+    const std::string &delimiters, std::size_t startPos) {
+  if (str.length() == 0) {
+    return std::make_pair(std::string::npos, 0);
+  }
+  std::size_t startOfToken = str.find_first_not_of(delimiters, startPos);
+  if (startOfToken == std::string::npos) {
+    return std::make_pair(std::string::npos, 0);
+  }
+  std::size_t endOfToken = str.find_first_of(delimiters, startOfToken);
+  if (endOfToken == std::string::npos) {
+    return std::make_pair(startOfToken, str.length() - startOfToken);
+  }
+  return std::make_pair(startOfToken, endOfToken - startOfToken);
+}
+
+unsigned long parseNumber(const std::string &token, std::size_t prefixLength,
+    const char *description) {
+  std::size_t numberLength;
+  unsigned long number;
+  std::string numberString = token.substr(prefixLength, std::string::npos);
+  try {
+    number = std::stoul(numberString, &numberLength, 0);
+  } catch (std::invalid_argument&) {
+    throw std::invalid_argument(
+        std::string("Invalid ") + description + " in record address: "
+            + token);
+  } catch (std::out_of_range&) {
+    throw std::invalid_argument(
+        std::string("Invalid ") + description + " in record address: "
+            + token);
+  }
+  // The stoul function ignores trailing garbage, so we have to check that the
+  // whole string has been used.
+  if (numberLength != numberString.length()) {
+    throw std::invalid_argument(
+        std::string("Invalid ") + description + " in record address: "
+            + token);
+  }
+  return number;
+}
+
+} // anonymous namespace
+
+MrfEventFifoRecordAddress::MrfEventFifoRecordAddress(
+    const std::string &addressString) :
+    deviceId(""), eventCode(0), queueSize(4096), overflows(false) {
+  const std::string delimiters(" \t\n\v\f\r");
+  std::size_t tokenStart, tokenLength;
+  // First, read the device name.
+  std::tie(tokenStart, tokenLength) = findNextToken(addressString, delimiters,
+      0);
+  if (tokenStart == std::string::npos) {
+    throw std::invalid_argument("Could not find device ID in record address.");
+  }
+  this->deviceId = addressString.substr(tokenStart, tokenLength);
+  // Read additional optional flags.
+  std::tie(tokenStart, tokenLength) = findNextToken(addressString, delimiters,
+      tokenStart + tokenLength);
+  const std::string eventCodeString = "event_code=";
+  const std::string queueSizeString = "queue_size=";
+  const std::string overflowsString = "overflows";
+  while (tokenStart != std::string::npos) {
+    std::string token = addressString.substr(tokenStart, tokenLength);
+    if (startsWithIgnoreCase(token, eventCodeString)) {
+      unsigned long eventCode = parseNumber(token, eventCodeString.length(),
+          "event code");
+      // Event code zero is used by the hardware to signal an empty FIFO, so
+      // it can never be part of an entry.
+      if (eventCode == 0 || eventCode > 255) {
+        throw std::invalid_argument(
+            std::string("Invalid event code in record address: ") + token);
+      }
+      this->eventCode = eventCode;
+    } else if (startsWithIgnoreCase(token, queueSizeString)) {
+      unsigned long queueSize = parseNumber(token, queueSizeString.length(),
+          "queue size");
+      // We limit the queue size to a sensible value, so that a typo does not
+      // result in a huge amount of memory being allocated.
+      if (queueSize == 0 || queueSize > 1048576) {
+        throw std::invalid_argument(
+            std::string("Invalid queue size in record address: ") + token);
+      }
+      this->queueSize = queueSize;
+    } else if (compareStringsIgnoreCase(token, overflowsString)) {
+      this->overflows = true;
+    } else {
+      throw std::invalid_argument(
+          std::string("Unrecognized token in record address: ") + token);
+    }
+    std::tie(tokenStart, tokenLength) = findNextToken(addressString, delimiters,
+        tokenStart + tokenLength);
+  }
+}
+
+} // namespace epics
+} // namespace mrf
+} // namespace anka
@@ -0,0 +1,108 @@
+/*
+ * Copyright 2026 aquenos GmbH.
+ * Copyright 2026 Karlsruhe Institute of Technology.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * This software has been developed by aquenos GmbH on behalf of the
+ * Karlsruhe Institute of Technology's Institute for Beam Physics and
+ * Technology.
+ *
+ * This software contains code originally developed by aquenos GmbH for
+ * the s7nodave EPICS device support. aquenos GmbH has relicensed the
+ * affected poritions of code from the s7nodave EPICS device support
+ * (originally licensed under the terms of the GNU GPL) under the terms
+ * of the GNU LGPL version 3 or newer.
+ */
+
+#ifndef ANKA_MRF_EPICS_EVENT_FIFO_RECORD_ADDRESS_H
+#define ANKA_MRF_EPICS_EVENT_FIFO_RECORD_ADDRESS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace anka {
+namespace mrf {
+namespace epics {
+
+/**
+ * Record address for special records that deal with the event FIFO of MRF
+ * event receivers.
+ *
+ * The address starts with the device ID, optionally followed by
+ * "event_code=<code>" (only use entries with the specified event code),
+ * "queue_size=<size>" (number of entries that can be buffered for a record),
+ * and "overflows" (count FIFO overflows instead of events).
+ *
+ * @see MrfWaveformEventFifoRecord
+ * @see MrfLonginEventCounterRecord
+ */
+class MrfEventFifoRecordAddress {
+
+public:
+
+  /**
+   * Creates a record address from a string. Throws an std::invalid_argument
+   * exception if the address string does not specify a valid address.
+   */
+  MrfEventFifoRecordAddress(const std::string &addressString);
+
+  /**
+   * Returns the string identifying the device.
+   */
+  inline const std::string &getDeviceId() const {
+    return deviceId;
+  }
+
+  /**
+   * Returns the event code specified in the address. If no event code has
+   * been specified, zero is returned, meaning that all event codes are
+   * relevant.
+   */
+  inline std::uint8_t getEventCode() const {
+    return eventCode;
+  }
+
+  /**
+   * Returns the number of FIFO entries that can be buffered for the record.
+   * If not specified explicitly, this is 4096. The queue size is never zero.
+   */
+  inline std::size_t getQueueSize() const {
+    return queueSize;
+  }
+
+  /**
+   * Tells whether the "overflows" flag has been specified. This flag selects
+   * the number of FIFO overflows instead of the number of events.
+   */
+  inline bool isOverflows() const {
+    return overflows;
+  }
+
+private:
+
+  std::string deviceId;
+  std::uint8_t eventCode;
+  std::size_t queueSize;
+  bool overflows;
+
+};
+
+} // namespace epics
+} // namespace mrf
+} // namespace anka
+
+#endif // ANKA_MRF_EPICS_EVENT_FIFO_RECORD_ADDRESS_H
@@ -50,6 +50,12 @@ public:
    */
   MrfGenericRvalOutputRecord(RecordType *record) :
       MrfOutputRecord<RecordType>(record) {
+    // The record support only derives the record's value from RVAL while the
+    // record is initialized, so we cannot set the value after iocInit.
+    if (this->getRecordAddress().isLazyInit()) {
+      throw std::runtime_error(
+          "This record type does not support lazy initialization.");
+    }
     this->initializeValue();
   }
 
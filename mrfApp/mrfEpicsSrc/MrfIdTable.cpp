@@ -0,0 +1,75 @@
+/*
+ * Copyright 2026 aquenos GmbH.
+ * Copyright 2026 Karlsruhe Institute of Technology.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * This software has been developed by aquenos GmbH on behalf of the
+ * Karlsruhe Institute of Technology's Institute for Beam Physics and
+ * Technology.
+ *
+ * This software contains code originally developed by aquenos GmbH for
+ * the s7nodave EPICS device support. aquenos GmbH has relicensed the
+ * affected poritions of code from the s7nodave EPICS device support
+ * (originally licensed under the terms of the GNU GPL) under the terms
+ * of the GNU LGPL version 3 or newer.
+ */
+
+#include <limits>
+#include <stdexcept>
+
+#include "MrfIdTable.h"
+
+namespace anka {
+namespace mrf {
+namespace epics {
+
+const std::string &MrfIdTable::getId(Handle handle) {
+  // We have to hold the mutex, because growing the deque modifies its index
+  // structure, even though it does not move the elements.
+  std::lock_guard<std::mutex> lock(mutex);
+  if (handle >= ids.size()) {
+    throw std::out_of_range("Invalid ID handle.");
+  }
+  return ids[handle];
+}
+
+MrfIdTable::Handle MrfIdTable::intern(const std::string &id) {
+  std::lock_guard<std::mutex> lock(mutex);
+  auto iterator = handles.find(id);
+  if (iterator != handles.end()) {
+    return iterator->second;
+  }
+  if (ids.size() > std::numeric_limits<Handle>::max()) {
+    throw std::runtime_error("Too many distinct device and poll group IDs.");
+  }
+  Handle handle = static_cast<Handle>(ids.size());
+  ids.push_back(id);
+  handles.insert(std::make_pair(id, handle));
+  return handle;
+}
+
+MrfIdTable MrfIdTable::instance;
+
+MrfIdTable::MrfIdTable() {
+  // The empty string always has the handle zero, so that a record address
+  // that does not specify a poll group does not need an entry of its own.
+  ids.push_back(std::string());
+  handles.insert(std::make_pair(std::string(), 0));
+}
+
+}
+}
+}
@@ -0,0 +1,108 @@
+/*
+ * Copyright 2026 aquenos GmbH.
+ * Copyright 2026 Karlsruhe Institute of Technology.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * This software has been developed by aquenos GmbH on behalf of the
+ * Karlsruhe Institute of Technology's Institute for Beam Physics and
+ * Technology.
+ *
+ * This software contains code originally developed by aquenos GmbH for
+ * the s7nodave EPICS device support. aquenos GmbH has relicensed the
+ * affected poritions of code from the s7nodave EPICS device support
+ * (originally licensed under the terms of the GNU GPL) under the terms
+ * of the GNU LGPL version 3 or newer.
+ */
+
+#ifndef ANKA_MRF_EPICS_ID_TABLE_H
+#define ANKA_MRF_EPICS_ID_TABLE_H
+
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace anka {
+namespace mrf {
+namespace epics {
+
+/**
+ * Table of interned IDs (device IDs and poll group IDs). Record addresses
+ * refer to devices and poll groups through the small handles returned by this
+ * table instead of storing the ID strings themselves. This keeps the record
+ * addresses small and allows the {@link MrfDeviceRegistry} to look up a device
+ * without hashing its ID. This class implements the singleton pattern and the
+ * only instance is returned by the {@link #getInstance()} function.
+ */
+class MrfIdTable {
+
+public:
+
+  /**
+   * Handle identifying an interned ID. The handle of the empty string is
+   * always zero.
+   */
+  using Handle = std::uint16_t;
+
+  /**
+   * Returns the only instance of this class.
+   */
+  inline static MrfIdTable &getInstance() {
+    return instance;
+  }
+
+  /**
+   * Returns the ID identified by the specified handle. The returned reference
+   * stays valid for the lifetime of the process. Throws an exception if the
+   * handle is invalid.
+   */
+  const std::string &getId(Handle handle);
+
+  /**
+   * Interns the specified ID and returns its handle. If the ID has already been
+   * interned, the existing handle is returned. Throws an exception if the table
+   * is full.
+   */
+  Handle intern(const std::string &id);
+
+private:
+
+  // We do not want to allow copy or move construction or assignment.
+  MrfIdTable(const MrfIdTable &) = delete;
+  MrfIdTable(MrfIdTable &&) = delete;
+  MrfIdTable &operator=(const MrfIdTable &) = delete;
+  MrfIdTable &operator=(MrfIdTable &&) = delete;
+
+  static MrfIdTable instance;
+
+  /**
+   * Interned IDs, indexed by their handle. We use a deque because it does not
+   * move the elements when growing, so references to the IDs stay valid.
+   */
+  std::deque<std::string> ids;
+  std::unordered_map<std::string, Handle> handles;
+  std::mutex mutex;
+
+  MrfIdTable();
+
+};
+
+}
+}
+}
+
+#endif // ANKA_MRF_EPICS_ID_TABLE_H
@@ -30,12 +30,19 @@
 #ifndef ANKA_MRF_EPICS_INPUT_RECORD_H
 #define ANKA_MRF_EPICS_INPUT_RECORD_H
 
+#include <chrono>
+#include <memory>
+#include <mutex>
 #include <stdexcept>
 #include <string>
 
 #include <alarm.h>
+#include <dbScan.h>
 #include <recGbl.h>
 
+#include "MrfLazyInitializer.h"
+#include "MrfPollGroup.h"
+#include "MrfReadCoalescer.h"
 #include "MrfRecord.h"
 #include "mrfEpicsError.h"
 
@@ -45,20 +52,49 @@ namespace epics {
 
 /**
  * Base class for most device support classes belonging to EPICS input records.
+ *
+ * When the record address specifies a poll group, the record does not read
+ * from the device itself. Instead, it uses the value that has been read by the
+ * poll group most recently. Such a record can be put into the "I/O Intr" mode,
+ * so that it is processed each time the poll group has read the register.
+ *
+ * When the record address specifies a maximum age, the record shares its reads
+ * with other records reading the same register through the device's
+ * {@link MrfReadCoalescer}. This way, a record that is processed while a read
+ * of the same register is still in progress does not add another request to
+ * the device's queue.
+ *
+ * When a TTL has been configured for the record's register in the device's
+ * {@link MrfMemoryCache}, the record reads through the cache instead, so that
+ * the value is only read from the device when the cached value has expired.
+ * In this case, the maximum age specified in the record address is not used.
  */
 template<typename RecordType>
 class MrfInputRecord: public MrfRecord<RecordType> {
 
+public:
+
+  /**
+   * Processes a request to enable or disable the I/O Intr mode. This mode is
+   * only supported when the record belongs to a poll group.
+   */
+  void getInterruptInfo(int command, IOSCANPVT *iopvt);
+
+  /**
+   * Called each time the record is processed. If the record belongs to a poll
+   * group and the poll group has already read the register, the record is
+   * updated synchronously with the value that has been read most recently.
+   * Otherwise, the register is read asynchronously.
+   */
+  virtual void processRecord();
+
 protected:
 
   /**
    * Creates an instance of the device support class for the specified record
    * instance.
    */
-  MrfInputRecord(RecordType *record) :
-      MrfRecord<RecordType>(record, record->inp), readSuccessful(false), readValue(
-          0) {
-  }
+  MrfInputRecord(RecordType *record);
 
   /**
    * Destructor.
@@ -84,6 +120,17 @@ private:
     MrfInputRecord &record;
   };
 
+  struct PollListenerImpl: MrfPollGroup::Listener {
+    PollListenerImpl(MrfInputRecord &record);
+    void success(std::uint32_t address, std::uint32_t value);
+    void failure(std::uint32_t address, MrfMemoryAccess::ErrorCode errorCode,
+        const std::string &details);
+
+    // In EPICS, records are never destroyed. Therefore, we can safely keep a
+    // reference to the device support object.
+    MrfInputRecord &record;
+  };
+
   // We do not want to allow copy or move construction or assignment.
   MrfInputRecord(const MrfInputRecord &) = delete;
   MrfInputRecord(MrfInputRecord &&) = delete;
@@ -94,21 +141,158 @@ private:
   std::uint32_t readValue;
   std::string readErrorMessage;
 
+  /**
+   * Listener subscribed to the poll group. Null if the record does not belong
+   * to a poll group.
+   */
+  std::shared_ptr<PollListenerImpl> pollListener;
+
+  /**
+   * Read coalescer used for sharing reads with other records. Null if the
+   * record address does not specify a maximum age.
+   */
+  std::shared_ptr<MrfReadCoalescer> readCoalescer;
+
+  /**
+   * Cache used for serving reads at runtime. Null if no TTL has been
+   * configured for the record's register.
+   */
+  std::shared_ptr<MrfMemoryCache> runtimeCache;
+
+  /**
+   * TTL of the record's register in the runtime cache.
+   */
+  std::chrono::steady_clock::duration cacheTtl;
+
+  /**
+   * Mutex protecting the poll result and the {@link interruptModeEnabled}
+   * flag.
+   */
+  std::mutex pollMutex;
+  bool pollValueAvailable;
+  bool pollSuccessful;
+  std::uint32_t pollValue;
+  std::string pollErrorMessage;
+
+  /**
+   * Flag indicating whether the record is operating in the "I/O Intr" mode.
+   */
+  bool interruptModeEnabled;
+
+  /**
+   * Data structure used in order to schedule processing when the poll group
+   * has read the register.
+   */
+  ::IOSCANPVT ioScanPvt;
+
 };
 
+template<typename RecordType>
+MrfInputRecord<RecordType>::MrfInputRecord(RecordType *record) :
+    MrfRecord<RecordType>(record, record->inp), readSuccessful(false),
+    readValue(0), cacheTtl(std::chrono::steady_clock::duration::zero()),
+    pollValueAvailable(false), pollSuccessful(false), pollValue(0),
+    interruptModeEnabled(false) {
+  auto cache = MrfDeviceRegistry::getInstance().getDeviceCache(
+      this->getRecordAddress().getDeviceHandle());
+  if (cache) {
+    cacheTtl = cache->getTtl(this->getRecordAddress().getMemoryAddress());
+    if (cacheTtl.count() > 0) {
+      runtimeCache = cache;
+    }
+  }
+  if (!runtimeCache && this->getRecordAddress().getMaxAge().count() > 0) {
+    readCoalescer = MrfDeviceRegistry::getInstance().getReadCoalescer(
+        this->getRecordAddress().getDeviceId());
+  }
+  const std::string &pollGroupId = this->getRecordAddress().getPollGroupId();
+  if (!pollGroupId.empty()) {
+    auto pollGroup = MrfDeviceRegistry::getInstance().getPollGroup(
+        pollGroupId);
+    if (!pollGroup) {
+      throw std::runtime_error(
+          std::string("Could not find poll group ") + pollGroupId + ".");
+    }
+    if (pollGroup->getDeviceId() != this->getRecordAddress().getDeviceId()) {
+      throw std::runtime_error(
+          std::string("The poll group ") + pollGroupId
+              + " does not belong to the device "
+              + this->getRecordAddress().getDeviceId() + ".");
+    }
+    ::scanIoInit(&ioScanPvt);
+    this->pollListener = std::make_shared<PollListenerImpl>(*this);
+    pollGroup->subscribe(this->getRecordAddress().getMemoryAddress(),
+        this->getRecordAddress().getDataType(), this->pollListener);
+  }
+  // A record that is initialized lazily is processed once when the IOC is
+  // running. We only schedule this when the constructor cannot fail any
+  // longer. Records are never destroyed, so we can safely keep the pointer.
+  if (this->getRecordAddress().isLazyInit()) {
+    MrfLazyInitializer::scheduleProcessing(
+        reinterpret_cast<::dbCommon *>(record));
+  }
+}
+
+template<typename RecordType>
+void MrfInputRecord<RecordType>::getInterruptInfo(int command,
+    IOSCANPVT *iopvt) {
+  if (!pollListener) {
+    *iopvt = nullptr;
+    throw std::runtime_error(
+        "I/O Intr mode is only supported for records that belong to a poll group.");
+  }
+  std::lock_guard<std::mutex> lock(pollMutex);
+  interruptModeEnabled = (command == 0);
+  *iopvt = this->ioScanPvt;
+}
+
+template<typename RecordType>
+void MrfInputRecord<RecordType>::processRecord() {
+  if (pollListener && !this->getRecord()->pact) {
+    // There is no asynchronous read in progress (PACT is not set), so we can
+    // safely overwrite the read result.
+    bool available;
+    {
+      std::lock_guard<std::mutex> lock(pollMutex);
+      available = pollValueAvailable;
+      readSuccessful = pollSuccessful;
+      readValue = pollValue;
+      readErrorMessage = pollErrorMessage;
+    }
+    if (available) {
+      processComplete();
+      return;
+    }
+  }
+  MrfRecord<RecordType>::processRecord();
+}
+
 template<typename RecordType>
 void MrfInputRecord<RecordType>::processPrepare() {
+  std::uint32_t address = this->getRecordAddress().getMemoryAddress();
   switch (this->getRecordAddress().getDataType()) {
   case MrfRecordAddress::DataType::uInt16: {
     auto callback = std::make_shared<CallbackImpl<std::uint16_t>>(*this);
-    this->getDevice()->readUInt16(this->getRecordAddress().getMemoryAddress(),
-        callback);
+    if (runtimeCache) {
+      runtimeCache->readUInt16(address, cacheTtl, callback);
+    } else if (readCoalescer) {
+      readCoalescer->readUInt16(address, this->getRecordAddress().getMaxAge(),
+          callback);
+    } else {
+      this->getDevice()->readUInt16(address, callback);
+    }
     break;
   }
   case MrfRecordAddress::DataType::uInt32: {
     auto callback = std::make_shared<CallbackImpl<std::uint32_t>>(*this);
-    this->getDevice()->readUInt32(this->getRecordAddress().getMemoryAddress(),
-        callback);
+    if (runtimeCache) {
+      runtimeCache->readUInt32(address, cacheTtl, callback);
+    } else if (readCoalescer) {
+      readCoalescer->readUInt32(address, this->getRecordAddress().getMaxAge(),
+          callback);
+    } else {
+      this->getDevice()->readUInt32(address, callback);
+    }
     break;
   }
   }
@@ -156,6 +340,52 @@ void MrfInputRecord<RecordType>::CallbackImpl<T>::failure(std::uint32_t address,
   record.scheduleProcessing();
 }
 
+template<typename RecordType>
+MrfInputRecord<RecordType>::PollListenerImpl::PollListenerImpl(
+    MrfInputRecord &record) :
+    record(record) {
+}
+
+template<typename RecordType>
+void MrfInputRecord<RecordType>::PollListenerImpl::success(std::uint32_t,
+    std::uint32_t value) {
+  bool doScanIoRequest;
+  {
+    std::lock_guard<std::mutex> lock(record.pollMutex);
+    record.pollValueAvailable = true;
+    record.pollSuccessful = true;
+    record.pollValue = value;
+    doScanIoRequest = record.interruptModeEnabled;
+  }
+  if (doScanIoRequest) {
+    scanIoRequest(record.ioScanPvt);
+  }
+}
+
+template<typename RecordType>
+void MrfInputRecord<RecordType>::PollListenerImpl::failure(
+    std::uint32_t address, MrfMemoryAccess::ErrorCode errorCode,
+    const std::string &details) {
+  bool doScanIoRequest;
+  {
+    std::lock_guard<std::mutex> lock(record.pollMutex);
+    record.pollValueAvailable = true;
+    record.pollSuccessful = false;
+    try {
+      record.pollErrorMessage = std::string("Error reading from address ")
+          + mrfMemoryAddressToString(address) + ": "
+          + (details.empty() ? mrfErrorCodeToString(errorCode) : details);
+    } catch (...) {
+      // We want to schedule processing of the record even if we cannot
+      // assemble the error message for some obscure reason.
+    }
+    doScanIoRequest = record.interruptModeEnabled;
+  }
+  if (doScanIoRequest) {
+    scanIoRequest(record.ioScanPvt);
+  }
+}
+
 }
 }
 }
@@ -0,0 +1,226 @@
+/*
+ * Copyright 2026 aquenos GmbH.
+ * Copyright 2026 Karlsruhe Institute of Technology.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * This software has been developed by aquenos GmbH on behalf of the
+ * Karlsruhe Institute of Technology's Institute for Beam Physics and
+ * Technology.
+ *
+ * This software contains code originally developed by aquenos GmbH for
+ * the s7nodave EPICS device support. aquenos GmbH has relicensed the
+ * affected poritions of code from the s7nodave EPICS device support
+ * (originally licensed under the terms of the GNU GPL) under the terms
+ * of the GNU LGPL version 3 or newer.
+ */
+
+#ifndef ANKA_MRF_EPICS_INTERRUPT_FLAGS_RING_H
+#define ANKA_MRF_EPICS_INTERRUPT_FLAGS_RING_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+
+namespace anka {
+namespace mrf {
+namespace epics {
+
+/**
+ * Bounded lock-free queue of interrupt flags for exactly one producer thread
+ * (the device's I/O thread) and one consumer thread (record processing).
+ * Pushing and popping elements never blocks and never allocates memory.
+ *
+ * Unlike {@link MrfSpscRing}, this queue can handle an overflow in three
+ * different ways (see {@link OverflowPolicy}). In order to drop the oldest
+ * element, the producer has to move the head of the queue, which is otherwise
+ * only moved by the consumer. For this reason, the head is updated with a
+ * compare-and-swap operation and the elements are stored in atomic variables,
+ * so that the consumer can safely detect that an element has been replaced
+ * while it was reading it. The capacity is rounded up to the next power of
+ * two.
+ */
+class MrfInterruptFlagsRing {
+
+public:
+
+  /**
+   * Tells what happens when an element is pushed while the queue is full.
+   */
+  enum class OverflowPolicy {
+
+    /**
+     * The oldest element is removed from the queue, so that the new element
+     * can be added.
+     */
+    dropOldest,
+
+    /**
+     * The new element is discarded.
+     */
+    dropNewest,
+
+    /**
+     * The new element is merged (OR'ed) with all other elements that did not
+     * fit into the queue. The merged flags are returned by
+     * {@link pop(std::uint32_t&)} after all elements in the queue. Elements
+     * that are pushed before the merged flags have been popped are merged as
+     * well, so that the order of the flags is preserved.
+     */
+    merge
+
+  };
+
+  /**
+   * Creates a queue that can hold at least the specified number of elements.
+   * Throws an exception if the capacity is zero or too large.
+   */
+  MrfInterruptFlagsRing(std::size_t minimumCapacity,
+      OverflowPolicy overflowPolicy) :
+      head(0), tail(0), mergedFlags(0), overflowPolicy(overflowPolicy) {
+    if (minimumCapacity == 0) {
+      throw std::invalid_argument("The capacity must not be zero.");
+    }
+    std::size_t roundedCapacity = 1;
+    while (roundedCapacity < minimumCapacity) {
+      if (roundedCapacity > (static_cast<std::size_t>(-1) >> 2)) {
+        throw std::invalid_argument("The capacity is too large.");
+      }
+      roundedCapacity <<= 1;
+    }
+    this->capacityMask = roundedCapacity - 1;
+    this->elements.reset(new std::atomic<std::uint32_t>[roundedCapacity]);
+    for (std::size_t index = 0; index < roundedCapacity; ++index) {
+      this->elements[index].store(0, std::memory_order_relaxed);
+    }
+  }
+
+  /**
+   * Returns the number of elements that the queue can hold.
+   */
+  inline std::size_t capacity() const {
+    return capacityMask + 1;
+  }
+
+  /**
+   * Returns the policy that is applied when the queue is full.
+   */
+  inline OverflowPolicy getOverflowPolicy() const {
+    return overflowPolicy;
+  }
+
+  /**
+   * Adds an element to the queue. Returns {@code true} if the element has been
+   * added without an overflow and {@code false} if the overflow policy had to
+   * be applied. May only be called by the producer thread.
+   */
+  inline bool push(std::uint32_t flags) {
+    if (overflowPolicy == OverflowPolicy::merge
+        && mergedFlags.load(std::memory_order_acquire) != 0) {
+      mergedFlags.fetch_or(flags, std::memory_order_acq_rel);
+      return false;
+    }
+    std::size_t currentTail = tail.load(std::memory_order_relaxed);
+    std::size_t currentHead = head.load(std::memory_order_acquire);
+    bool overflow = false;
+    if (currentTail - currentHead > capacityMask) {
+      switch (overflowPolicy) {
+      case OverflowPolicy::dropOldest:
+        // If the compare-and-swap fails, the consumer has removed the oldest
+        // element in the meantime, so there is space for the new element.
+        overflow = head.compare_exchange_strong(currentHead, currentHead + 1,
+            std::memory_order_acq_rel, std::memory_order_acquire);
+        break;
+      case OverflowPolicy::dropNewest:
+        return false;
+      case OverflowPolicy::merge:
+        mergedFlags.fetch_or(flags, std::memory_order_acq_rel);
+        return false;
+      }
+    }
+    elements[currentTail & capacityMask].store(flags,
+        std::memory_order_relaxed);
+    tail.store(currentTail + 1, std::memory_order_release);
+    return !overflow;
+  }
+
+  /**
+   * Removes the oldest element from the queue and stores it in the specified
+   * variable. Returns {@code true} if an element has been removed and
+   * {@code false} if the queue is empty. May only be called by the consumer
+   * thread.
+   */
+  inline bool pop(std::uint32_t &flags) {
+    std::size_t currentHead = head.load(std::memory_order_acquire);
+    while (currentHead != tail.load(std::memory_order_acquire)) {
+      std::uint32_t element = elements[currentHead & capacityMask].load(
+          std::memory_order_relaxed);
+      // If the producer has dropped the element while we were reading it, the
+      // compare-and-swap fails and we try again with the new head.
+      if (head.compare_exchange_weak(currentHead, currentHead + 1,
+          std::memory_order_acq_rel, std::memory_order_acquire)) {
+        flags = element;
+        return true;
+      }
+    }
+    if (overflowPolicy == OverflowPolicy::merge) {
+      std::uint32_t merged = mergedFlags.exchange(0,
+          std::memory_order_acq_rel);
+      if (merged != 0) {
+        flags = merged;
+        return true;
+      }
+    }
+    return false;
+  }
+
+  /**
+   * Tells whether the queue is empty. The result is only a snapshot when
+   * called while the other thread is pushing or popping elements.
+   */
+  inline bool empty() const {
+    return head.load(std::memory_order_acquire)
+        == tail.load(std::memory_order_acquire)
+        && mergedFlags.load(std::memory_order_acquire) == 0;
+  }
+
+private:
+
+  // We do not want to allow copy or move construction or assignment.
+  MrfInterruptFlagsRing(const MrfInterruptFlagsRing &) = delete;
+  MrfInterruptFlagsRing(MrfInterruptFlagsRing &&) = delete;
+  MrfInterruptFlagsRing &operator=(const MrfInterruptFlagsRing &) = delete;
+  MrfInterruptFlagsRing &operator=(MrfInterruptFlagsRing &&) = delete;
+
+  // Like in MrfSpscRing, we keep the head and the tail on separate cache
+  // lines. The counters are never reset, they simply wrap around.
+  std::atomic<std::size_t> head;
+  char headPadding[64 - sizeof(std::atomic<std::size_t>)];
+  std::atomic<std::size_t> tail;
+  char tailPadding[64 - sizeof(std::atomic<std::size_t>)];
+  std::atomic<std::uint32_t> mergedFlags;
+  std::size_t capacityMask;
+  std::unique_ptr<std::atomic<std::uint32_t>[]> elements;
+  OverflowPolicy overflowPolicy;
+
+};
+
+} // namespace epics
+} // namespace mrf
+} // namespace anka
+
+#endif // ANKA_MRF_EPICS_INTERRUPT_FLAGS_RING_H
@@ -0,0 +1,55 @@
+/*
+ * Copyright 2026 aquenos GmbH.
+ * Copyright 2026 Karlsruhe Institute of Technology.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * This software has been developed by aquenos GmbH on behalf of the
+ * Karlsruhe Institute of Technology's Institute for Beam Physics and
+ * Technology.
+ *
+ * This software contains code originally developed by aquenos GmbH for
+ * the s7nodave EPICS device support. aquenos GmbH has relicensed the
+ * affected poritions of code from the s7nodave EPICS device support
+ * (originally licensed under the terms of the GNU GPL) under the terms
+ * of the GNU LGPL version 3 or newer.
+ */
+
+#include "MrfInterruptOverflowCounter.h"
+
+namespace anka {
+namespace mrf {
+namespace epics {
+
+constexpr std::uint32_t MrfInterruptOverflowCounter::maxCount;
+
+MrfInterruptOverflowCounter::MrfInterruptOverflowCounter() :
+    count(0) {
+  ::scanIoInit(&ioScanPvt);
+}
+
+void MrfInterruptOverflowCounter::reportOverflow() {
+  std::uint32_t oldCount = count.load(std::memory_order_relaxed);
+  while (oldCount < maxCount
+      && !count.compare_exchange_weak(oldCount, oldCount + 1,
+          std::memory_order_relaxed)) {
+    // compare_exchange_weak has updated oldCount, so we simply try again.
+  }
+  ::scanIoRequest(ioScanPvt);
+}
+
+}
+}
+}
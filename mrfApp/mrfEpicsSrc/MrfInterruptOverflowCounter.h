@@ -0,0 +1,110 @@
+/*
+ * Copyright 2026 aquenos GmbH.
+ * Copyright 2026 Karlsruhe Institute of Technology.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * This software has been developed by aquenos GmbH on behalf of the
+ * Karlsruhe Institute of Technology's Institute for Beam Physics and
+ * Technology.
+ *
+ * This software contains code originally developed by aquenos GmbH for
+ * the s7nodave EPICS device support. aquenos GmbH has relicensed the
+ * affected poritions of code from the s7nodave EPICS device support
+ * (originally licensed under the terms of the GNU GPL) under the terms
+ * of the GNU LGPL version 3 or newer.
+ */
+
+#ifndef ANKA_MRF_EPICS_INTERRUPT_OVERFLOW_COUNTER_H
+#define ANKA_MRF_EPICS_INTERRUPT_OVERFLOW_COUNTER_H
+
+#include <atomic>
+#include <cstdint>
+
+#include <dbScan.h>
+
+namespace anka {
+namespace mrf {
+namespace epics {
+
+/**
+ * Counter for the interrupts of a device that could not be queued normally by
+ * the interrupt records, because their queues were full. Besides counting the
+ * overflows, it triggers processing of the records that are in the "I/O Intr"
+ * mode and monitor the counter.
+ *
+ * There is one instance of this class for each device. It can be retrieved
+ * through
+ * {@link MrfDeviceRegistry::getInterruptOverflowCounter(const std::string&)}.
+ */
+class MrfInterruptOverflowCounter {
+
+public:
+
+  /**
+   * Largest value of the counter. This is the largest value that can be
+   * stored in the VAL field of a longin record, so the counter saturates
+   * instead of turning negative in the record.
+   */
+  static constexpr std::uint32_t maxCount = 0x7fffffff;
+
+  /**
+   * Creates the overflow counter for a device.
+   */
+  MrfInterruptOverflowCounter();
+
+  /**
+   * Returns the number of interrupts that could not be queued normally so far.
+   * The counter stops at {@link #maxCount}.
+   */
+  inline std::uint32_t getCount() const {
+    return count.load(std::memory_order_relaxed);
+  }
+
+  /**
+   * Returns the data structure that can be used in order to process records in
+   * the "I/O Intr" mode each time an overflow has been reported.
+   */
+  inline ::IOSCANPVT getIoScanPvt() const {
+    return ioScanPvt;
+  }
+
+  /**
+   * Reports that an interrupt could not be queued normally. This increments
+   * the counter and requests processing of all records that are in the
+   * "I/O Intr" mode.
+   */
+  void reportOverflow();
+
+private:
+
+  // We do not want to allow copy or move construction or assignment.
+  MrfInterruptOverflowCounter(const MrfInterruptOverflowCounter &) = delete;
+  MrfInterruptOverflowCounter(MrfInterruptOverflowCounter &&) = delete;
+  MrfInterruptOverflowCounter &operator=(
+      const MrfInterruptOverflowCounter &) = delete;
+  MrfInterruptOverflowCounter &operator=(
+      MrfInterruptOverflowCounter &&) = delete;
+
+  std::atomic<std::uint32_t> count;
+  ::IOSCANPVT ioScanPvt;
+
+};
+
+}
+}
+}
+
+#endif // ANKA_MRF_EPICS_INTERRUPT_OVERFLOW_COUNTER_H
@@ -30,12 +30,13 @@
 #ifndef ANKA_MRF_EPICS_INTERRUPT_RECORD_H
 #define ANKA_MRF_EPICS_INTERRUPT_RECORD_H
 
+#include <atomic>
 #include <cstdint>
 #include <memory>
-#include <mutex>
-#include <queue>
 #include <stdexcept>
 
+#include <alarm.h>
+#include <recGbl.h>
 extern "C" {
 #include <dbCommon.h>
 #include <dbScan.h>
@@ -44,6 +45,8 @@ extern "C" {
 #include <MrfMemoryAccess.h>
 
 #include "MrfDeviceRegistry.h"
+#include "MrfInterruptFlagsRing.h"
+#include "MrfInterruptOverflowCounter.h"
 #include "MrfInterruptRecordAddress.h"
 #include "mrfEpicsError.h"
 
@@ -54,6 +57,14 @@ namespace epics {
 /**
  * Class template that serves as a base for all record types that deal with
  * interrupts generated by MRF devices.
+ *
+ * The interrupt listener puts the interrupt flags into a bounded lock-free
+ * queue, so that the I/O thread of the device is never blocked or delayed by
+ * an allocation, even during an interrupt storm. The size of the queue and
+ * what happens when it is full can be configured through the record address.
+ * Interrupts that are lost (or merged) because the queue is full are counted
+ * for the device (see {@link MrfDeviceRegistry#getInterruptOverflowCounter})
+ * and put the record into a MINOR alarm state the next time it is processed.
  */
 template<typename RecordTypeParam>
 class MrfInterruptRecord {
@@ -146,58 +157,32 @@ private:
     }
 
     void operator()(std::uint32_t interruptFlags) {
-      bool doScanIoRequest;
-      // We have to hold the mutex while accessing the interruptFlagsQueue and
-      // the interruptModeEnabled flag.
-      {
-        std::lock_guard<std::mutex> lock(recordDeviceSupport.mutex);
-        // We mask the interrupt flags with the user-configurable mask. If none
-        // of the bits that is set in the mask is also set in the interrupt
-        // flags, we want to ignore this interrupt.
-        interruptFlags &= recordDeviceSupport.interruptFlagsMask;
-        if (interruptFlags == 0) {
-          return;
-        }
-        // We only want to call scanIoRequest(...) when the queue is empty
-        // before we add an event and we are in the I/O Intr mode.
-        doScanIoRequest = recordDeviceSupport.interruptModeEnabled
-            && recordDeviceSupport.interruptFlagsQueue.empty();
-        // We want to queue a maximum of 1024 interrupts. This allows all
-        // interrupts to be processed when record processing is paused for a
-        // short moment, but it also ensures that the queue does not grow
-        // without bounds when the record processing simply cannot keep up with
-        // the fast pace of the interrupts. When not operating in "I/O Intr"
-        // mode, we only keep one notification and discard all other ones. This
-        // makes sense because a record in scan mode is usually expected to
-        // reflect the current state at the time of processing.
-        if (recordDeviceSupport.interruptModeEnabled) {
-          while (recordDeviceSupport.interruptFlagsQueue.size() >= 1024) {
-            recordDeviceSupport.interruptFlagsQueue.pop();
-            errorExtendedPrintf(
-                "%s Interrupt queue overflow. Interrupt events have been lost. Typically, this happens when interrupts occur at a rate that is so high that the record cannot be processed at the same rate.",
-                recordDeviceSupport.record->name);
-          }
-        } else {
-          while (!recordDeviceSupport.interruptFlagsQueue.empty()) {
-            recordDeviceSupport.interruptFlagsQueue.pop();
-          }
-        }
-        recordDeviceSupport.interruptFlagsQueue.push(interruptFlags);
+      // We mask the interrupt flags with the user-configurable mask. If none
+      // of the bits that is set in the mask is also set in the interrupt
+      // flags, we want to ignore this interrupt.
+      interruptFlags &= recordDeviceSupport.interruptFlagsMask;
+      if (interruptFlags == 0) {
+        return;
+      }
+      // When not operating in "I/O Intr" mode, we only keep the latest
+      // notification. This makes sense because a record in scan mode is
+      // usually expected to reflect the current state at the time of
+      // processing. This method is always called by the I/O thread of the
+      // device, so it is the only producer for the queue.
+      if (!recordDeviceSupport.interruptModeEnabled.load()) {
+        recordDeviceSupport.latestInterruptFlags.store(interruptFlags);
+        return;
       }
-      // We call scanIoRequest() after releasing the mutex. It should be safe to
-      // call it while holding the mutex because it looks like the record
-      // processing is actually not triggered while holding the same mutex (and
-      // thus there cannot be a dead lock). On the other hand, there could be a
-      // dead lock when this implementation changes. More importantly, calling
-      // scanIoRequest(...) while holding the mutex would only have the
-      // advantage that we would never call it when the interrupt mode has been
-      // disabled. However, as the actual processing is done asynchronously, it
-      // could still happen that interrupt mode is disabled between calling it
-      // and the processing being triggered. For this reason, there is no
-      // downside to releasing the mutex first.
-      if (doScanIoRequest) {
-        scanIoRequest(recordDeviceSupport.ioScanPvt);
+      if (!recordDeviceSupport.queue.push(interruptFlags)) {
+        recordDeviceSupport.overflowsSinceLastProcessing.fetch_add(1,
+            std::memory_order_relaxed);
+        recordDeviceSupport.overflowCounter->reportOverflow();
       }
+      recordDeviceSupport.requestProcessing();
+    }
+
+    std::uint32_t getInterruptFlagsMask() const {
+      return recordDeviceSupport.interruptFlagsMask;
     }
 
   private:
@@ -216,6 +201,11 @@ private:
   MrfInterruptRecord &operator=(const MrfInterruptRecord &) = delete;
   MrfInterruptRecord &operator=(MrfInterruptRecord &&) = delete;
 
+  /**
+   * Address specified in the INP field of the record.
+   */
+  MrfInterruptRecordAddress address;
+
   /**
    * Pointer to the underlying device.
    */
@@ -228,18 +218,37 @@ private:
   std::uint32_t interruptFlagsMask;
 
   /**
-   * Mutex protecting the {@link interruptFlagsQueue} and the
-   * {@link interruptModeEnabled} flag.
+   * Queue storing the interrupt flags that arrived with interrupt events while
+   * the record is in "I/O Intr" mode. The interrupt listener is the only
+   * producer and record processing is the only consumer.
+   */
+  MrfInterruptFlagsRing queue;
+
+  /**
+   * Interrupt flags of the latest interrupt that arrived while the record was
+   * not in "I/O Intr" mode. Zero if no interrupt has arrived since the record
+   * was last processed.
+   */
+  std::atomic<std::uint32_t> latestInterruptFlags;
+
+  /**
+   * Number of interrupts that could not be queued normally since the record
+   * was last processed.
+   */
+  std::atomic<std::uint32_t> overflowsSinceLastProcessing;
+
+  /**
+   * Counter for the interrupts that could not be queued normally by any of
+   * the records for the device.
    */
-  std::mutex mutex;
+  std::shared_ptr<MrfInterruptOverflowCounter> overflowCounter;
 
   /**
-   * Queue storing the interrupt flags that arrived with interrupt events. The
-   * interrupt listener adds interrupts to the queue and triggers processing of
-   * the record. When the record is processed, the oldest element is taken from
-   * the queue and put into the record.
+   * Flag indicating whether processing of the record has been requested but
+   * has not started yet. This flag ensures that a burst of interrupts only
+   * results in a single request.
    */
-  std::queue<std::uint32_t> interruptFlagsQueue;
+  std::atomic<bool> processingPending;
 
   /**
    * Interrupt listener that is called by the device each time an interrupt
@@ -250,7 +259,7 @@ private:
   /**
    * Flag indicating whether the record is operating in the "I/O Intr" mode.
    */
-  bool interruptModeEnabled;
+  std::atomic<bool> interruptModeEnabled;
 
   /**
    * Record this device support has been instantiated for.
@@ -263,6 +272,17 @@ private:
    */
   ::IOSCANPVT ioScanPvt;
 
+  /**
+   * Reads the record address from the record's INP field.
+   */
+  static MrfInterruptRecordAddress readRecordAddress(RecordType *record);
+
+  /**
+   * Requests processing of the record if it is in "I/O Intr" mode and no
+   * processing is pending yet.
+   */
+  void requestProcessing();
+
 };
 
 template<typename RecordType>
@@ -274,90 +294,91 @@ void MrfInterruptRecord<RecordType>::getInterruptInfo(int command,
     *iopvt = NULL;
     return;
   }
-  // We have to hold the mutex while accessing the interruptFlagsQueue and while
-  // modifying the interruptModeEnabled flag. However, we do not want to hold
-  // it while scheduling a callback. We do not have to either, because the
-  // interrupt mode cannot change while we are in this method (EPICS holds the
-  // record mutex while calling this method).
-  bool triggerProcessing = false;
-  {
-    std::lock_guard<std::mutex> lock(mutex);
-    if (command == 0) {
-      interruptModeEnabled = true;
-      // If there are interrupt notifications in the queue, we have to schedule
-      // a processing of the record. When the queue is not empty, the interrupt
-      // handler will not trigger a processing, so the record would never be
-      // processed.
-      triggerProcessing = !this->interruptFlagsQueue.empty();
-    } else {
-      interruptModeEnabled = false;
+  if (command == 0) {
+    interruptModeEnabled.store(true);
+    // A processing that was requested before the record left the I/O Intr
+    // mode might never have happened, so we reset the flag. If an interrupt
+    // arrived before entering the I/O Intr mode, we have to schedule a
+    // processing of the record because the interrupt listener did not do
+    // this.
+    processingPending.store(false);
+    *iopvt = this->ioScanPvt;
+    if (!queue.empty() || latestInterruptFlags.load() != 0) {
+      requestProcessing();
     }
-  }
-  *iopvt = this->ioScanPvt;
-  if (triggerProcessing) {
-    scanIoRequest(this->ioScanPvt);
+  } else {
+    interruptModeEnabled.store(false);
+    *iopvt = this->ioScanPvt;
   }
 }
 
 template<typename RecordType>
 void MrfInterruptRecord<RecordType>::processRecord() {
-  std::uint32_t interruptFlags;
-  bool doScanIoRequest;
-  {
-    // Access to the interruptFlagsQueue is protected by the mutex.
-    std::lock_guard<std::mutex> lock(mutex);
-    if (interruptFlagsQueue.empty()) {
-      // Processing the record while the queue is empty can only happen when
-      // PINI is set or the record operates in scan mode. We set the record's
-      // value to zero in order to indicate that no interrupts are pending.
-      interruptFlags = 0;
-      doScanIoRequest = false;
-    } else {
-      interruptFlags = interruptFlagsQueue.front();
-      interruptFlagsQueue.pop();
-      // If there are more pending interrupts, we have to process the record
-      // again.
-      doScanIoRequest = !interruptFlagsQueue.empty() && interruptModeEnabled;
+  // We reset the flag before taking an element from the queue. This way,
+  // interrupts that arrive while we are processing trigger another processing.
+  processingPending.store(false);
+  std::uint32_t interruptFlags = 0;
+  if (interruptModeEnabled.load()) {
+    if (!queue.pop(interruptFlags)) {
+      // An interrupt that arrived before entering the I/O Intr mode is only
+      // stored as the latest interrupt.
+      interruptFlags = latestInterruptFlags.exchange(0);
+    }
+  } else {
+    // Elements that are still in the queue from the time when the record was
+    // in I/O Intr mode are older than the latest interrupt, so we only use
+    // them if no interrupt has arrived since.
+    std::uint32_t queuedFlags;
+    while (queue.pop(queuedFlags)) {
+      interruptFlags = queuedFlags;
+    }
+    std::uint32_t latestFlags = latestInterruptFlags.exchange(0);
+    if (latestFlags != 0) {
+      interruptFlags = latestFlags;
     }
   }
+  // If the queue is empty, the value is zero. This can only happen when PINI is
+  // set or the record operates in scan mode. We set the record's value to zero
+  // in order to indicate that no interrupts are pending.
   writeRecordValue(interruptFlags);
-  // If the record is in I/O Intr mode and more interrupt notifications are
-  // pending, we have to schedule another processing because the interrupt
-  // listener does not schedule a processing when the queue is not empty before
-  // it is called.
-  // We do this without holding the mutex in order to avoid an (unlikely) dead
-  // lock (depending on how EPICS deals with locks). This should still be safe
-  // because this method should only be called while holding the record lock and
-  // this means that getInterruptInfo() (which might modify the
-  // interruptModeEnabled flag) should not be called concurrently.
-  if (doScanIoRequest) {
-    scanIoRequest(ioScanPvt);
+  std::uint32_t overflows = overflowsSinceLastProcessing.exchange(0,
+      std::memory_order_relaxed);
+  if (overflows != 0) {
+    recGblSetSevr(this->record, READ_ALARM, MINOR_ALARM);
+    errorExtendedPrintf(
+        "%s Interrupt queue overflow. %u interrupt events have been lost or merged. Typically, this happens when interrupts occur at a rate that is so high that the record cannot be processed at the same rate. Increasing queue_size might help.",
+        this->record->name, static_cast<unsigned int>(overflows));
+  }
+  // If more interrupt notifications are pending, we have to schedule another
+  // processing because the interrupt listener does not schedule a processing
+  // while one is pending.
+  if (!queue.empty()) {
+    requestProcessing();
   }
 }
 
 template<typename RecordType>
 MrfInterruptRecord<RecordType>::MrfInterruptRecord(RecordType *record) :
-    interruptModeEnabled(false), record(record) {
-  if (this->record->inp.type != INST_IO) {
-    throw std::runtime_error(
-        "Invalid device address. Maybe mixed up INP/OUT or forgot '@'?");
-  }
-  MrfInterruptRecordAddress recordAddress(
-      this->record->inp.value.instio.string == nullptr ?
-          "" : record->inp.value.instio.string);
+    address(readRecordAddress(record)),
+    queue(address.getQueueSize(), address.getOverflowPolicy()),
+    latestInterruptFlags(0), overflowsSinceLastProcessing(0),
+    processingPending(false), interruptModeEnabled(false), record(record) {
   this->device = MrfDeviceRegistry::getInstance().getDevice(
-      recordAddress.getDeviceId());
+      address.getDeviceId());
   if (!this->device) {
     throw std::runtime_error(
-        std::string("Could not find device ") + recordAddress.getDeviceId()
+        std::string("Could not find device ") + address.getDeviceId()
             + ".");
   }
   if (!this->device->supportsInterrupts()) {
     throw std::runtime_error(
-        std::string("The device ") + recordAddress.getDeviceId()
+        std::string("The device ") + address.getDeviceId()
             + " does not support interrupts.");
   }
-  this->interruptFlagsMask = recordAddress.getInterruptFlagsMask();
+  this->interruptFlagsMask = address.getInterruptFlagsMask();
+  this->overflowCounter =
+      MrfDeviceRegistry::getInstance().getInterruptOverflowCounter(
+          address.getDeviceId());
   ::scanIoInit(&ioScanPvt);
   // The interrupt listener stores a reference to this object. For this reason
   // we create it after we can be sure that this constructor will not throw an
@@ -378,6 +399,28 @@ MrfInterruptRecord<RecordType>::~MrfInterruptRecord() {
   }
 }
 
+template<typename RecordType>
+MrfInterruptRecordAddress MrfInterruptRecord<RecordType>::readRecordAddress(
+    RecordType *record) {
+  if (record->inp.type != INST_IO) {
+    throw std::runtime_error(
+        "Invalid device address. Maybe mixed up INP/OUT or forgot '@'?");
+  }
+  return MrfInterruptRecordAddress(
+      record->inp.value.instio.string == nullptr ?
+          "" : record->inp.value.instio.string);
+}
+
+template<typename RecordType>
+void MrfInterruptRecord<RecordType>::requestProcessing() {
+  // We only call scanIoRequest(...) when there is no pending processing. This
+  // way, a burst of interrupts only results in a single processing (or as many
+  // as are needed to move all queued interrupts into the record).
+  if (interruptModeEnabled.load() && !processingPending.exchange(true)) {
+    scanIoRequest(ioScanPvt);
+  }
+}
+
 } // namespace epics
 } // namespace mrf
 } // namespace anka
@@ -77,7 +77,9 @@ std::pair<std::size_t, std::size_t> findNextToken(const std::string &str,
 
 MrfInterruptRecordAddress::MrfInterruptRecordAddress(
     const std::string &addressString) :
-    deviceId(""), interruptFlagsMask(0xffffffff) {
+    deviceId(""), interruptFlagsMask(0xffffffff),
+    overflowPolicy(MrfInterruptFlagsRing::OverflowPolicy::dropOldest),
+    queueSize(1024) {
   const std::string delimiters(" \t\n\v\f\r");
   std::size_t tokenStart, tokenLength;
   // First, read the device name.
@@ -91,6 +93,8 @@ MrfInterruptRecordAddress::MrfInterruptRecordAddress(
   std::tie(tokenStart, tokenLength) = findNextToken(addressString, delimiters,
       tokenStart + tokenLength);
   const std::string interruptFlagsMaskString = "interrupt_flags_mask=";
+  const std::string overflowPolicyString = "overflow_policy=";
+  const std::string queueSizeString = "queue_size=";
   while (tokenStart != std::string::npos) {
     std::string token = addressString.substr(tokenStart, tokenLength);
     if (token.length() >= interruptFlagsMaskString.length()
@@ -125,6 +129,48 @@ MrfInterruptRecordAddress::MrfInterruptRecordAddress(
                 + token);
       }
       this->interruptFlagsMask = interruptFlagsMask;
+    } else if (token.length() >= overflowPolicyString.length()
+        && compareStringsIgnoreCase(
+            token.substr(0, overflowPolicyString.length()),
+            overflowPolicyString)) {
+      std::string policy = token.substr(overflowPolicyString.length(),
+          std::string::npos);
+      if (compareStringsIgnoreCase(policy, "drop_oldest")) {
+        this->overflowPolicy =
+            MrfInterruptFlagsRing::OverflowPolicy::dropOldest;
+      } else if (compareStringsIgnoreCase(policy, "drop_newest")) {
+        this->overflowPolicy =
+            MrfInterruptFlagsRing::OverflowPolicy::dropNewest;
+      } else if (compareStringsIgnoreCase(policy, "merge")) {
+        this->overflowPolicy = MrfInterruptFlagsRing::OverflowPolicy::merge;
+      } else {
+        throw std::invalid_argument(
+            std::string("Invalid overflow policy in record address: ")
+                + token);
+      }
+    } else if (token.length() >= queueSizeString.length()
+        && compareStringsIgnoreCase(
+            token.substr(0, queueSizeString.length()), queueSizeString)) {
+      std::size_t numberLength;
+      unsigned long queueSize;
+      try {
+        queueSize = std::stoul(
+            token.substr(queueSizeString.length(), std::string::npos),
+            &numberLength, 0);
+      } catch (std::invalid_argument&) {
+        throw std::invalid_argument(
+            std::string("Invalid queue size in record address: ") + token);
+      } catch (std::out_of_range&) {
+        throw std::invalid_argument(
+            std::string("Invalid queue size in record address: ") + token);
+      }
+      // A queue size of zero does not make sense and very large queue sizes
+      // are most likely a mistake, so we limit the size to 2^20 entries.
+      if (queueSize == 0 || queueSize > 1048576) {
+        throw std::invalid_argument(
+            std::string("Invalid queue size in record address: ") + token);
+      }
+      this->queueSize = queueSize;
     } else {
       throw std::invalid_argument(
           std::string("Unrecognized token in record address: ") + token);
@@ -30,9 +30,12 @@
 #ifndef ANKA_MRF_EPICS_INTERRUPT_RECORD_ADDRESS_H
 #define ANKA_MRF_EPICS_INTERRUPT_RECORD_ADDRESS_H
 
+#include <cstddef>
 #include <cstdint>
 #include <string>
 
+#include "MrfInterruptFlagsRing.h"
+
 namespace anka {
 namespace mrf {
 namespace epics {
@@ -41,6 +44,11 @@ namespace epics {
  * Record address for special records that deal with interrupts generated by MRF
  * devices.
  *
+ * The address starts with the device ID, optionally followed by
+ * "interrupt_flags_mask=<mask>", "queue_size=<size>" (number of interrupts
+ * that can be buffered for a record), and "overflow_policy=<policy>" (one of
+ * "drop_oldest", "drop_newest", or "merge").
+ *
  * @see MrfInterruptRecord
  */
 class MrfInterruptRecordAddress {
@@ -73,10 +81,29 @@ public:
     return interruptFlagsMask;
   }
 
+  /**
+   * Returns the policy that is applied when an interrupt occurs while the
+   * queue of the record is full. If not specified explicitly, this is
+   * {@link MrfInterruptFlagsRing::OverflowPolicy::dropOldest}.
+   */
+  inline MrfInterruptFlagsRing::OverflowPolicy getOverflowPolicy() const {
+    return overflowPolicy;
+  }
+
+  /**
+   * Returns the number of interrupts that can be buffered for the record. If
+   * not specified explicitly, this is 1024. The queue size is never zero.
+   */
+  inline std::size_t getQueueSize() const {
+    return queueSize;
+  }
+
 private:
 
   std::string deviceId;
   std::uint32_t interruptFlagsMask;
+  MrfInterruptFlagsRing::OverflowPolicy overflowPolicy;
+  std::size_t queueSize;
 
 };
 
@@ -0,0 +1,165 @@
+/*
+ * Copyright 2026 aquenos GmbH.
+ * Copyright 2026 Karlsruhe Institute of Technology.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * This software has been developed by aquenos GmbH on behalf of the
+ * Karlsruhe Institute of Technology's Institute for Beam Physics and
+ * Technology.
+ *
+ * This software contains code originally developed by aquenos GmbH for
+ * the s7nodave EPICS device support. aquenos GmbH has relicensed the
+ * affected poritions of code from the s7nodave EPICS device support
+ * (originally licensed under the terms of the GNU GPL) under the terms
+ * of the GNU LGPL version 3 or newer.
+ */
+
+#include <chrono>
+#include <cmath>
+#include <deque>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+
+#include <dbScan.h>
+#include <initHooks.h>
+
+#include "mrfEpicsError.h"
+
+#include "MrfLazyInitializer.h"
+
+namespace anka {
+namespace mrf {
+namespace epics {
+
+namespace {
+
+struct LazyInitState {
+  std::mutex mutex;
+  std::deque<std::function<void()>> tasks;
+  bool iocRunning = false;
+  bool workerRunning = false;
+};
+
+LazyInitState &getState() {
+  static LazyInitState state;
+  return state;
+}
+
+void runTasks() {
+  LazyInitState &state = getState();
+  auto nextTaskTime = std::chrono::steady_clock::now();
+  while (true) {
+    std::function<void()> task;
+    {
+      std::lock_guard<std::mutex> lock(state.mutex);
+      if (state.tasks.empty()) {
+        state.workerRunning = false;
+        return;
+      }
+      task = std::move(state.tasks.front());
+      state.tasks.pop_front();
+    }
+    std::this_thread::sleep_until(nextTaskTime);
+    try {
+      task();
+    } catch (std::exception &e) {
+      errorPrintf("Lazy initialization of a record failed: %s", e.what());
+    } catch (...) {
+      errorPrintf("Lazy initialization of a record failed: Unknown error.");
+    }
+    // A task that takes longer than the interval (e.g. because it waits for a
+    // slow device) delays the next task, but we do not try to catch up
+    // afterwards, because this would defeat the purpose of the rate limit.
+    nextTaskTime += std::chrono::duration_cast<
+        std::chrono::steady_clock::duration>(
+        std::chrono::duration<double>(1.0 / MrfLazyInitializer::getRate()));
+    auto now = std::chrono::steady_clock::now();
+    if (nextTaskTime < now) {
+      nextTaskTime = now;
+    }
+  }
+}
+
+// Has to be called with the mutex held.
+void startWorker(LazyInitState &state) {
+  if (state.workerRunning || state.tasks.empty()) {
+    return;
+  }
+  std::thread workerThread(runTasks);
+  workerThread.detach();
+  state.workerRunning = true;
+}
+
+void initHook(::initHookState state) {
+  if (state != initHookAfterIocRunning) {
+    return;
+  }
+  LazyInitState &lazyInitState = getState();
+  try {
+    std::lock_guard<std::mutex> lock(lazyInitState.mutex);
+    lazyInitState.iocRunning = true;
+    startWorker(lazyInitState);
+  } catch (std::exception &e) {
+    errorPrintf("Could not start the lazy initialization of records: %s",
+        e.what());
+  } catch (...) {
+    errorPrintf(
+        "Could not start the lazy initialization of records: Unknown error.");
+  }
+}
+
+} // anonymous namespace
+
+std::atomic<double> MrfLazyInitializer::rate(100.0);
+std::atomic<bool> MrfLazyInitializer::initHookRegistered(false);
+
+void MrfLazyInitializer::registerInitHook() {
+  if (!initHookRegistered.exchange(true)) {
+    if (::initHookRegister(initHook)) {
+      initHookRegistered.store(false);
+      throw std::runtime_error("Could not register the init hook.");
+    }
+  }
+}
+
+void MrfLazyInitializer::schedule(std::function<void()> task) {
+  LazyInitState &state = getState();
+  std::lock_guard<std::mutex> lock(state.mutex);
+  state.tasks.push_back(std::move(task));
+  if (state.iocRunning) {
+    startWorker(state);
+  }
+}
+
+void MrfLazyInitializer::scheduleProcessing(::dbCommon *record) {
+  // Processing an input record only starts the read, so the task finishes
+  // quickly and the rate limit applies to the reads being started.
+  schedule([record]() {
+    ::scanOnce(record);
+  });
+}
+
+void MrfLazyInitializer::setRate(double rate) {
+  if (!std::isfinite(rate) || rate <= 0.0) {
+    throw std::invalid_argument("The rate must be a positive number.");
+  }
+  MrfLazyInitializer::rate.store(rate, std::memory_order_relaxed);
+}
+
+}
+}
+}
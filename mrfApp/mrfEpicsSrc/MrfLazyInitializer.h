@@ -0,0 +1,108 @@
+/*
+ * Copyright 2026 aquenos GmbH.
+ * Copyright 2026 Karlsruhe Institute of Technology.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * This software has been developed by aquenos GmbH on behalf of the
+ * Karlsruhe Institute of Technology's Institute for Beam Physics and
+ * Technology.
+ *
+ * This software contains code originally developed by aquenos GmbH for
+ * the s7nodave EPICS device support. aquenos GmbH has relicensed the
+ * affected poritions of code from the s7nodave EPICS device support
+ * (originally licensed under the terms of the GNU GPL) under the terms
+ * of the GNU LGPL version 3 or newer.
+ */
+
+#ifndef ANKA_MRF_EPICS_LAZY_INITIALIZER_H
+#define ANKA_MRF_EPICS_LAZY_INITIALIZER_H
+
+#include <atomic>
+#include <functional>
+
+#include <dbCommon.h>
+
+namespace anka {
+namespace mrf {
+namespace epics {
+
+/**
+ * Initializes records that specify the {@code lazy_init} flag in their
+ * address after iocInit has finished.
+ *
+ * Such records do not read their initial value from the device while
+ * iocInit is running, so they stay undefined when the IOC starts. Instead,
+ * a background thread initializes them one after the other when the IOC is
+ * running. This way, the IOC is ready as soon as the critical records have
+ * been initialized, and the low-priority records (e.g. diagnostics) follow
+ * later. The records are initialized at a limited rate, so that they do not
+ * congest the device's queue and delay the requests of other records.
+ */
+class MrfLazyInitializer {
+
+public:
+
+  /**
+   * Returns the maximum number of records that are initialized per second.
+   * The default is 100.
+   */
+  inline static double getRate() {
+    return rate.load(std::memory_order_relaxed);
+  }
+
+  /**
+   * Registers the init hook that starts the lazy initialization when the IOC
+   * is running. This is called by the registrar of this device support, so it
+   * does not have to be called by user code. Calling it more than once has no
+   * effect.
+   */
+  static void registerInitHook();
+
+  /**
+   * Schedules a task that initializes a record. The tasks are run in the order
+   * in which they have been scheduled, but not before the IOC is running. Each
+   * task runs with no lock held, so it has to lock the record itself if it
+   * modifies the record.
+   */
+  static void schedule(std::function<void()> task);
+
+  /**
+   * Schedules processing of the specified record. This is used for input
+   * records, which are initialized by being processed once.
+   */
+  static void scheduleProcessing(::dbCommon *record);
+
+  /**
+   * Sets the maximum number of records that are initialized per second. The
+   * rate must be positive.
+   */
+  static void setRate(double rate);
+
+private:
+
+  static std::atomic<double> rate;
+  static std::atomic<bool> initHookRegistered;
+
+  // This class only has static members.
+  MrfLazyInitializer() = delete;
+
+};
+
+}
+}
+}
+
+#endif // ANKA_MRF_EPICS_LAZY_INITIALIZER_H
@@ -0,0 +1,131 @@
+/*
+ * Copyright 2026 aquenos GmbH.
+ * Copyright 2026 Karlsruhe Institute of Technology.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * This software has been developed by aquenos GmbH on behalf of the
+ * Karlsruhe Institute of Technology's Institute for Beam Physics and
+ * Technology.
+ *
+ * This software contains code originally developed by aquenos GmbH for
+ * the s7nodave EPICS device support. aquenos GmbH has relicensed the
+ * affected poritions of code from the s7nodave EPICS device support
+ * (originally licensed under the terms of the GNU GPL) under the terms
+ * of the GNU LGPL version 3 or newer.
+ */
+
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+
+#include "MrfDeviceRegistry.h"
+#include "MrfEventFifoRecordAddress.h"
+
+#include "MrfLonginEventCounterRecord.h"
+
+namespace anka {
+namespace mrf {
+namespace epics {
+
+namespace {
+
+MrfEventFifoRecordAddress readRecordAddress(const ::DBLINK &addressField) {
+  if (addressField.type != INST_IO) {
+    throw std::runtime_error(
+        "Invalid device address. Maybe mixed up INP/OUT or forgot '@'?");
+  }
+  return MrfEventFifoRecordAddress(
+      addressField.value.instio.string == nullptr ?
+          "" : addressField.value.instio.string);
+}
+
+// The counters are shared by all records for the same device. The map keeps
+// them alive because the device only holds weak references to its listeners.
+std::mutex countersMutex;
+std::unordered_map<std::string,
+    std::shared_ptr<MrfLonginEventCounterRecord::Counters>> countersByDeviceId;
+
+std::shared_ptr<MrfLonginEventCounterRecord::Counters> getCounters(
+    const std::string &deviceId) {
+  std::lock_guard<std::mutex> lock(countersMutex);
+  auto countersIterator = countersByDeviceId.find(deviceId);
+  if (countersIterator != countersByDeviceId.end()) {
+    return countersIterator->second;
+  }
+  auto device = MrfDeviceRegistry::getInstance().getDevice(deviceId);
+  if (!device) {
+    throw std::runtime_error(
+        std::string("Could not find device ") + deviceId + ".");
+  }
+  if (!device->supportsEventFifo()) {
+    throw std::runtime_error(
+        std::string("The device ") + deviceId
+            + " does not support reading the event FIFO.");
+  }
+  auto counters = std::make_shared<MrfLonginEventCounterRecord::Counters>();
+  device->addEventFifoListener(counters);
+  countersByDeviceId.insert(std::make_pair(deviceId, counters));
+  return counters;
+}
+
+} // End of anonymous namespace
+
+MrfLonginEventCounterRecord::Counters::Counters() :
+    overflowCount(0) {
+  for (auto &eventCount : eventCounts) {
+    eventCount.store(0, std::memory_order_relaxed);
+  }
+}
+
+void MrfLonginEventCounterRecord::Counters::operator()(
+    const MrfMemoryAccess::EventFifoEntry *entries, std::size_t count,
+    bool overflow) {
+  // The counters are independent of each other, so relaxed memory ordering
+  // is sufficient.
+  for (std::size_t index = 0; index < count; ++index) {
+    eventCounts[entries[index].eventCode].fetch_add(1,
+        std::memory_order_relaxed);
+  }
+  if (overflow) {
+    overflowCount.fetch_add(1, std::memory_order_relaxed);
+  }
+}
+
+MrfLonginEventCounterRecord::MrfLonginEventCounterRecord(
+    ::longinRecord *record) :
+    record(record), counter(nullptr) {
+  MrfEventFifoRecordAddress address(readRecordAddress(record->inp));
+  if (address.isOverflows() == (address.getEventCode() != 0)) {
+    throw std::runtime_error(
+        "The record address must specify either an event code or the overflows flag.");
+  }
+  this->counters = getCounters(address.getDeviceId());
+  if (address.isOverflows()) {
+    this->counter = &this->counters->overflowCount;
+  } else {
+    this->counter = &this->counters->eventCounts[address.getEventCode()];
+  }
+}
+
+void MrfLonginEventCounterRecord::processRecord() {
+  this->record->val = counter->load(std::memory_order_relaxed);
+  this->record->udf = false;
+}
+
+} // namespace epics
+} // namespace mrf
+} // namespace anka
@@ -0,0 +1,132 @@
+/*
+ * Copyright 2026 aquenos GmbH.
+ * Copyright 2026 Karlsruhe Institute of Technology.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * This software has been developed by aquenos GmbH on behalf of the
+ * Karlsruhe Institute of Technology's Institute for Beam Physics and
+ * Technology.
+ *
+ * This software contains code originally developed by aquenos GmbH for
+ * the s7nodave EPICS device support. aquenos GmbH has relicensed the
+ * affected poritions of code from the s7nodave EPICS device support
+ * (originally licensed under the terms of the GNU GPL) under the terms
+ * of the GNU LGPL version 3 or newer.
+ */
+
+#ifndef ANKA_MRF_EPICS_LONGIN_EVENT_COUNTER_RECORD_H
+#define ANKA_MRF_EPICS_LONGIN_EVENT_COUNTER_RECORD_H
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+#include <longinRecord.h>
+
+#include <MrfMemoryAccess.h>
+
+namespace anka {
+namespace mrf {
+namespace epics {
+
+/**
+ * Device support class for a longin record that counts the entries read from
+ * the event FIFO of an event receiver.
+ *
+ * The counters are kept per device, so all records for the same device share
+ * a single event FIFO listener and the counters keep counting when the record
+ * is not processed. Depending on the address, the record's value is set to
+ * the number of entries with a specific event code or to the number of FIFO
+ * overflows when the record is processed. The counters wrap around when they
+ * overflow.
+ */
+class MrfLonginEventCounterRecord {
+
+public:
+
+  /**
+   * Type of data structure used by the supported record.
+   */
+  using RecordType = ::longinRecord;
+
+  /**
+   * Creates an instance of the device support for the specified record.
+   */
+  MrfLonginEventCounterRecord(::longinRecord *record);
+
+  /**
+   * Called each time the record is processed. Copies the current value of the
+   * counter into the record's value.
+   */
+  void processRecord();
+
+  /**
+   * Counters for one device. The counters are updated by the event FIFO
+   * listener and read when a record is processed.
+   */
+  class Counters: public MrfMemoryAccess::EventFifoListener {
+
+  public:
+
+    Counters();
+
+    void operator()(const MrfMemoryAccess::EventFifoEntry *entries,
+        std::size_t count, bool overflow);
+
+    /**
+     * Number of entries that have been received for each event code.
+     */
+    std::atomic<std::uint32_t> eventCounts[256];
+
+    /**
+     * Number of times the FIFO has overflowed.
+     */
+    std::atomic<std::uint32_t> overflowCount;
+
+  };
+
+private:
+
+  // We do not want to allow copy or move construction or assignment.
+  MrfLonginEventCounterRecord(const MrfLonginEventCounterRecord &) = delete;
+  MrfLonginEventCounterRecord(MrfLonginEventCounterRecord &&) = delete;
+  MrfLonginEventCounterRecord &operator=(const MrfLonginEventCounterRecord &) =
+      delete;
+  MrfLonginEventCounterRecord &operator=(MrfLonginEventCounterRecord &&) =
+      delete;
+
+  /**
+   * Record this device support has been instantiated for.
+   */
+  ::longinRecord *record;
+
+  /**
+   * Counters for the device specified in the record's address.
+   */
+  std::shared_ptr<Counters> counters;
+
+  /**
+   * Counter that is read when the record is processed.
+   */
+  std::atomic<std::uint32_t> *counter;
+
+};
+
+} // namespace epics
+} // namespace mrf
+} // namespace anka
+
+#endif // ANKA_MRF_EPICS_LONGIN_EVENT_COUNTER_RECORD_H
@@ -0,0 +1,90 @@
+/*
+ * Copyright 2026 aquenos GmbH.
+ * Copyright 2026 Karlsruhe Institute of Technology.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * This software has been developed by aquenos GmbH on behalf of the
+ * Karlsruhe Institute of Technology's Institute for Beam Physics and
+ * Technology.
+ *
+ * This software contains code originally developed by aquenos GmbH for
+ * the s7nodave EPICS device support. aquenos GmbH has relicensed the
+ * affected poritions of code from the s7nodave EPICS device support
+ * (originally licensed under the terms of the GNU GPL) under the terms
+ * of the GNU LGPL version 3 or newer.
+ */
+
+#include <stdexcept>
+#include <string>
+
+#include "MrfDeviceRegistry.h"
+
+#include "MrfLonginInterruptOverflowCounterRecord.h"
+
+namespace anka {
+namespace mrf {
+namespace epics {
+
+namespace {
+
+std::string readDeviceId(const ::DBLINK &addressField) {
+  if (addressField.type != INST_IO) {
+    throw std::runtime_error(
+        "Invalid device address. Maybe mixed up INP/OUT or forgot '@'?");
+  }
+  const std::string delimiters(" \t\n\v\f\r");
+  std::string addressString = addressField.value.instio.string == nullptr ?
+      "" : addressField.value.instio.string;
+  std::size_t tokenStart = addressString.find_first_not_of(delimiters);
+  if (tokenStart == std::string::npos) {
+    throw std::runtime_error("Could not find device ID in record address.");
+  }
+  std::size_t tokenEnd = addressString.find_first_of(delimiters, tokenStart);
+  if (addressString.find_first_not_of(delimiters, tokenEnd)
+      != std::string::npos) {
+    throw std::runtime_error(
+        "The record address must only specify the device ID.");
+  }
+  return addressString.substr(tokenStart, tokenEnd - tokenStart);
+}
+
+} // End of anonymous namespace
+
+MrfLonginInterruptOverflowCounterRecord::MrfLonginInterruptOverflowCounterRecord(
+    ::longinRecord *record) :
+    record(record) {
+  std::string deviceId = readDeviceId(record->inp);
+  this->counter = MrfDeviceRegistry::getInstance().getInterruptOverflowCounter(
+      deviceId);
+  if (!this->counter) {
+    throw std::runtime_error(
+        std::string("Could not find device ") + deviceId + ".");
+  }
+}
+
+void MrfLonginInterruptOverflowCounterRecord::getInterruptInfo(int,
+    ::IOSCANPVT *iopvt) {
+  *iopvt = counter->getIoScanPvt();
+}
+
+void MrfLonginInterruptOverflowCounterRecord::processRecord() {
+  this->record->val = counter->getCount();
+  this->record->udf = false;
+}
+
+} // namespace epics
+} // namespace mrf
+} // namespace anka
@@ -0,0 +1,108 @@
+/*
+ * Copyright 2026 aquenos GmbH.
+ * Copyright 2026 Karlsruhe Institute of Technology.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * This software has been developed by aquenos GmbH on behalf of the
+ * Karlsruhe Institute of Technology's Institute for Beam Physics and
+ * Technology.
+ *
+ * This software contains code originally developed by aquenos GmbH for
+ * the s7nodave EPICS device support. aquenos GmbH has relicensed the
+ * affected poritions of code from the s7nodave EPICS device support
+ * (originally licensed under the terms of the GNU GPL) under the terms
+ * of the GNU LGPL version 3 or newer.
+ */
+
+#ifndef ANKA_MRF_EPICS_LONGIN_INTERRUPT_OVERFLOW_COUNTER_RECORD_H
+#define ANKA_MRF_EPICS_LONGIN_INTERRUPT_OVERFLOW_COUNTER_RECORD_H
+
+#include <memory>
+
+#include <dbScan.h>
+#include <longinRecord.h>
+
+#include "MrfInterruptOverflowCounter.h"
+
+namespace anka {
+namespace mrf {
+namespace epics {
+
+/**
+ * Device support class for a longin record that counts the interrupts that
+ * could not be queued normally by the interrupt records of a device, because
+ * their queues were full.
+ *
+ * The counter is kept per device and keeps counting when the record is not
+ * processed. When the record is processed, the record's value is set to the
+ * current value of the counter. The counter stops at the largest value that
+ * can be stored in the record. When the record is in the "I/O Intr" mode, it
+ * is processed each time an interrupt could not be queued normally.
+ */
+class MrfLonginInterruptOverflowCounterRecord {
+
+public:
+
+  /**
+   * Type of data structure used by the supported record.
+   */
+  using RecordType = ::longinRecord;
+
+  /**
+   * Creates an instance of the device support for the specified record.
+   */
+  MrfLonginInterruptOverflowCounterRecord(::longinRecord *record);
+
+  /**
+   * Processes a request to enable or disable the I/O Intr mode.
+   */
+  void getInterruptInfo(int command, ::IOSCANPVT *iopvt);
+
+  /**
+   * Called each time the record is processed. Copies the current value of the
+   * counter into the record's value.
+   */
+  void processRecord();
+
+private:
+
+  // We do not want to allow copy or move construction or assignment.
+  MrfLonginInterruptOverflowCounterRecord(
+      const MrfLonginInterruptOverflowCounterRecord &) = delete;
+  MrfLonginInterruptOverflowCounterRecord(
+      MrfLonginInterruptOverflowCounterRecord &&) = delete;
+  MrfLonginInterruptOverflowCounterRecord &operator=(
+      const MrfLonginInterruptOverflowCounterRecord &) = delete;
+  MrfLonginInterruptOverflowCounterRecord &operator=(
+      MrfLonginInterruptOverflowCounterRecord &&) = delete;
+
+  /**
+   * Record this device support has been instantiated for.
+   */
+  ::longinRecord *record;
+
+  /**
+   * Counter for the device specified in the record's address.
+   */
+  std::shared_ptr<MrfInterruptOverflowCounter> counter;
+
+};
+
+} // namespace epics
+} // namespace mrf
+} // namespace anka
+
+#endif // ANKA_MRF_EPICS_LONGIN_INTERRUPT_OVERFLOW_COUNTER_RECORD_H
@@ -0,0 +1,109 @@
+/*
+ * Copyright 2026 aquenos GmbH.
+ * Copyright 2026 Karlsruhe Institute of Technology.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * This software has been developed by aquenos GmbH on behalf of the
+ * Karlsruhe Institute of Technology's Institute for Beam Physics and
+ * Technology.
+ *
+ * This software contains code originally developed by aquenos GmbH for
+ * the s7nodave EPICS device support. aquenos GmbH has relicensed the
+ * affected poritions of code from the s7nodave EPICS device support
+ * (originally licensed under the terms of the GNU GPL) under the terms
+ * of the GNU LGPL version 3 or newer.
+ */
+
+#ifndef ANKA_MRF_EPICS_LONGIN_POSTED_WRITE_FAILURE_COUNTER_RECORD_H
+#define ANKA_MRF_EPICS_LONGIN_POSTED_WRITE_FAILURE_COUNTER_RECORD_H
+
+#include <memory>
+
+#include <dbScan.h>
+#include <longinRecord.h>
+
+#include "MrfPostedWriteStatus.h"
+
+namespace anka {
+namespace mrf {
+namespace epics {
+
+/**
+ * Device support class for a longin record that counts the posted writes of a
+ * device that have failed. Output records using posted writes complete before
+ * the write has finished, so this record provides a way of noticing failures
+ * as soon as they happen.
+ *
+ * The counter is kept per device and keeps counting when the record is not
+ * processed. When the record is processed, the record's value is set to the
+ * current value of the counter. The counter wraps around when it overflows.
+ * When the record is in the "I/O Intr" mode, it is processed each time a
+ * posted write has failed.
+ */
+class MrfLonginPostedWriteFailureCounterRecord {
+
+public:
+
+  /**
+   * Type of data structure used by the supported record.
+   */
+  using RecordType = ::longinRecord;
+
+  /**
+   * Creates an instance of the device support for the specified record.
+   */
+  MrfLonginPostedWriteFailureCounterRecord(::longinRecord *record);
+
+  /**
+   * Processes a request to enable or disable the I/O Intr mode.
+   */
+  void getInterruptInfo(int command, ::IOSCANPVT *iopvt);
+
+  /**
+   * Called each time the record is processed. Copies the current value of the
+   * counter into the record's value.
+   */
+  void processRecord();
+
+private:
+
+  // We do not want to allow copy or move construction or assignment.
+  MrfLonginPostedWriteFailureCounterRecord(
+      const MrfLonginPostedWriteFailureCounterRecord &) = delete;
+  MrfLonginPostedWriteFailureCounterRecord(
+      MrfLonginPostedWriteFailureCounterRecord &&) = delete;
+  MrfLonginPostedWriteFailureCounterRecord &operator=(
+      const MrfLonginPostedWriteFailureCounterRecord &) = delete;
+  MrfLonginPostedWriteFailureCounterRecord &operator=(
+      MrfLonginPostedWriteFailureCounterRecord &&) = delete;
+
+  /**
+   * Record this device support has been instantiated for.
+   */
+  ::longinRecord *record;
+
+  /**
+   * Posted-write status for the device specified in the record's address.
+   */
+  std::shared_ptr<MrfPostedWriteStatus> status;
+
+};
+
+} // namespace epics
+} // namespace mrf
+} // namespace anka
+
+#endif // ANKA_MRF_EPICS_LONGIN_POSTED_WRITE_FAILURE_COUNTER_RECORD_H
@@ -27,15 +27,20 @@
  * of the GNU LGPL version 3 or newer.
  */
 
+#include <algorithm>
+#include <cctype>
+#include <chrono>
 #include <cstring>
 #include <string>
 #include <stdexcept>
 #include <tuple>
+#include <vector>
 
 #include <alarm.h>
 #include <recGbl.h>
 
 #include "MrfDeviceRegistry.h"
+#include "MrfProcessScheduler.h"
 
 #include "MrfLongoutFineDelayShiftRegisterRecord.h"
 
@@ -47,6 +52,23 @@ namespace epics {
 // compilation unit.
 namespace {
 
+/**
+ * Minimum time between two consecutive writes to the GPIO output register.
+ * Without this delay, the shift register might not recognize the clock edges
+ * correctly when the device is accessed directly (e.g. through memory mapped
+ * I/O).
+ */
+const std::chrono::nanoseconds minEdgeInterval(500);
+
+bool compareStringsIgnoreCase(const std::string &str1,
+    const std::string &str2) {
+  if (str1.length() != str2.length()) {
+    return false;
+  }
+  return std::equal(str1.begin(), str1.end(), str2.begin(),
+      [](char c1, char c2) {return std::tolower(c1) == std::tolower(c2);});
+}
+
 std::pair<std::size_t, std::size_t> findNextToken(const std::string &str,
     const std::string &delimiters, std::size_t startPos) {
   if (str.length() == 0) {
@@ -132,11 +154,57 @@ std::tuple<std::uint32_t, signed char> parseMemoryAddress(
   return std::make_tuple(static_cast<std::uint32_t>(address), bitIndex);
 }
 
+std::size_t parsePipelineDepth(const std::string &optionString) {
+  const std::string optionName("pipeline_depth=");
+  if (!compareStringsIgnoreCase(optionString.substr(0, optionName.size()),
+      optionName)) {
+    throw std::invalid_argument(
+        std::string("Unrecognized token in record address: ") + optionString);
+  }
+  std::string valueString = optionString.substr(optionName.size());
+  std::size_t numberLength;
+  unsigned long pipelineDepth;
+  try {
+    pipelineDepth = std::stoul(valueString, &numberLength, 0);
+  } catch (std::invalid_argument&) {
+    throw std::invalid_argument(
+        std::string("Invalid pipeline depth in record address: ")
+            + optionString);
+  } catch (std::out_of_range&) {
+    throw std::invalid_argument(
+        std::string("Invalid pipeline depth in record address: ")
+            + optionString);
+  }
+  // There are only 50 writes to the GPIO output register, so a larger depth
+  // does not make sense.
+  if (numberLength != valueString.length() || pipelineDepth < 1
+      || pipelineDepth > 64) {
+    throw std::invalid_argument(
+        std::string("Invalid pipeline depth in record address: ")
+            + optionString);
+  }
+  return pipelineDepth;
+}
+
+// The order in which the bits are latched into the shift register does not
+// have any particular sense. According to the documentation it is:
+// DA7, DA6, DA5, DA4, DA3, DA2, DA1, DA0, DB3, DB2, DB1, DB0, LENA, unused,
+// DA9, DA8, LENB, unused, DB9, DB8, DB7, DB6, DB5, DB4
+// This table contains the bit of the record's value that is used for each of
+// these positions. LENA and LENB are the latch-enable bits for the first and
+// second output. The unused positions are always zero.
+const std::uint32_t shiftRegisterBits[24] = { 0x00000080, 0x00000040,
+    0x00000020, 0x00000010, 0x00000008, 0x00000004, 0x00000002, 0x00000001,
+    0x00080000, 0x00040000, 0x00020000, 0x00010000, 0x00000400, 0, 0x00000200,
+    0x00000100, 0x04000000, 0, 0x02000000, 0x01000000, 0x00800000, 0x00400000,
+    0x00200000, 0x00100000 };
+
 } // End of anonymous namespace
 
 MrfLongoutFineDelayShiftRegisterRecord::MrfLongoutFineDelayShiftRegisterRecord(
     ::longoutRecord *record) :
-    record(record), writeSuccessful(false), writeCallback(
+    record(record), pipelineDepth(1), nextShiftRegisterValueIndex(0),
+        writeSuccessful(false), writeCallback(
         std::make_shared<CallbackImpl>(*this)) {
   // Parse the record address.
   if (this->record->out.type != INST_IO) {
@@ -174,9 +242,16 @@ MrfLongoutFineDelayShiftRegisterRecord::MrfLongoutFineDelayShiftRegisterRecord(
   }
   std::tie(this->gpioOutputRegisterAddress, this->gpioOutputRegisterBitShift) =
       parseMemoryAddress(addressString.substr(tokenStart, tokenLength));
-  // Ensure that there is no more input.
+  // Next, read the optional pipeline depth.
   std::tie(tokenStart, tokenLength) = findNextToken(addressString, delimiters,
       tokenStart + tokenLength);
+  if (tokenStart != std::string::npos) {
+    this->pipelineDepth = parsePipelineDepth(
+        addressString.substr(tokenStart, tokenLength));
+    std::tie(tokenStart, tokenLength) = findNextToken(addressString,
+        delimiters, tokenStart + tokenLength);
+  }
+  // Ensure that there is no more input.
   if (tokenStart != std::string::npos) {
     throw std::invalid_argument(
         std::string("Unrecognized token in record address: ")
@@ -188,6 +263,13 @@ MrfLongoutFineDelayShiftRegisterRecord::MrfLongoutFineDelayShiftRegisterRecord(
     throw std::runtime_error(
         std::string("Could not find device ") + deviceId + ".");
   }
+  // When pipelining the writes, we cannot insert a delay between them, so we
+  // have to rely on the device not being able to execute them too quickly.
+  if (this->pipelineDepth > 1
+      && this->device->getMinimumWriteInterval() < minEdgeInterval) {
+    throw std::invalid_argument(
+        "The pipeline_depth option is only supported for devices that cannot execute two writes less than 500 ns apart (e.g. devices accessed through UDP/IP).");
+  }
   // Prepare the transfer callback.
   // EPICS Base does not provide a function for doing a general initialization,
   // but it expects some private fields to be initialized with zero. We use
@@ -215,9 +297,8 @@ void MrfLongoutFineDelayShiftRegisterRecord::processRecord() {
     }
   } else {
     // Start the write process.
-    nextTransferStepIndex = 0;
     writeOutputValue = record->val;
-    startNextTransferStep();
+    startTransfer();
     this->record->pact = true;
   }
 }
@@ -226,172 +307,91 @@ void MrfLongoutFineDelayShiftRegisterRecord::scheduleProcessing() {
   // Registering the callback establishes a happens-before relationship due to
   // an internal lock. Therefore, data written before registering the callback
   // is seen by the callback function.
-  ::callbackRequestProcessCallback(&this->processCallback, priorityMedium,
-      this->record);
+  MrfProcessScheduler::getInstance().requestProcessing(&this->processCallback,
+      priorityMedium, this->record);
 }
 
-void MrfLongoutFineDelayShiftRegisterRecord::startNextTransferStep() {
-  // We increment the step index before taking any action. This way, the index
-  // has been incremented, even if the callback from the action (and thus this
-  // function) is executed again before we return from this function.
-  int currentTransferStepIndex = nextTransferStepIndex;
-  ++nextTransferStepIndex;
-  if (currentTransferStepIndex == 0) {
-    // First, we have to configure the GPIO pins for output. A pin is configured
-    // as an output by setting the direction bit to one. Therefore, the mask and
-    // the value are the same. There is a small risk that the corresponding bits
-    // in the output register are not zero. This is a problem if the bit for the
-    // transfer latch clock is not zero, because an undefined value will be
-    // latched into the delay chip. However, the register is initialized with
-    // zero on device startup and we reset it to zero after every write
-    // operation, so this is very unlikely to happen. Even if it happened, we
-    // would overwrite the value immediately, so that the undefined delay value
-    // would only be active for a very short period.
-    lastValueWrittenMask = 0x0f << gpioDirectionRegisterBitShift;
-    lastValueWritten = lastValueWrittenMask;
-    device->writeUInt32(gpioDirectionRegisterAddress, lastValueWritten,
-        lastValueWrittenMask, writeCallback);
-  } else if (currentTransferStepIndex >= 1 && currentTransferStepIndex <= 48) {
-    // We have to write 24 bits in total. Each bit requires two write
-    // operations: The first write operation sets the clock line low and the
-    // data line according to the bit value. The second write operation sets the
-    // clock line high, so that the bit is latched into the shift register. The
-    // second operation always has an even step index.
-    int bitIndex = (currentTransferStepIndex - 1) / 2;
-    bool clockHigh = (currentTransferStepIndex % 2 == 0);
-    bool outputDisable = (writeOutputValue & 0x80000000);
-    bool bitValue;
-    // The order in which the bits are latched into the shift register does not
-    // have any particular sense. According to the documentation it is:
-    // DA7, DA6, DA5, DA4, DA3, DA2, DA1, DA0, DB3, DB2, DB1, DB0, LENA, unused,
-    // DA9, DA8, LENB, unused, DB9, DB8, DB7, DB6, DB5, DB4
-    switch (bitIndex) {
-    case 0:
-      bitValue = writeOutputValue & 0x00000080;
-      break;
-    case 1:
-      bitValue = writeOutputValue & 0x00000040;
-      break;
-    case 2:
-      bitValue = writeOutputValue & 0x00000020;
-      break;
-    case 3:
-      bitValue = writeOutputValue & 0x00000010;
-      break;
-    case 4:
-      bitValue = writeOutputValue & 0x00000008;
-      break;
-    case 5:
-      bitValue = writeOutputValue & 0x00000004;
-      break;
-    case 6:
-      bitValue = writeOutputValue & 0x00000002;
-      break;
-    case 7:
-      bitValue = writeOutputValue & 0x00000001;
-      break;
-    case 8:
-      bitValue = writeOutputValue & 0x00080000;
-      break;
-    case 9:
-      bitValue = writeOutputValue & 0x00040000;
-      break;
-    case 10:
-      bitValue = writeOutputValue & 0x00020000;
-      break;
-    case 11:
-      bitValue = writeOutputValue & 0x00010000;
-      break;
-    case 12:
-      // This is the latch-enable bit for the first output.
-      bitValue = writeOutputValue & 0x00000400;
-      break;
-    case 13:
-      // This bit is unused, so we set it to zero.
-      bitValue = false;
-      break;
-    case 14:
-      bitValue = writeOutputValue & 0x00000200;
-      break;
-    case 15:
-      bitValue = writeOutputValue & 0x00000100;
-      break;
-    case 16:
-      // This is the latch-enable bit for the second output.
-      bitValue = writeOutputValue & 0x04000000;
-      break;
-    case 17:
-      // This bit is unused, so we set it to zero.
-      bitValue = false;
-      break;
-    case 18:
-      bitValue = writeOutputValue & 0x02000000;
-      break;
-    case 19:
-      bitValue = writeOutputValue & 0x01000000;
-      break;
-    case 20:
-      bitValue = writeOutputValue & 0x00800000;
-      break;
-    case 21:
-      bitValue = writeOutputValue & 0x00400000;
-      break;
-    case 22:
-      bitValue = writeOutputValue & 0x00200000;
-      break;
-    case 23:
-      bitValue = writeOutputValue & 0x00100000;
-      break;
-    }
-    lastValueWrittenMask = 0x0f << gpioOutputRegisterBitShift;
-    lastValueWritten = 0;
-    if (bitValue) {
-      lastValueWritten |= 0x01;
-    }
-    if (clockHigh) {
-      lastValueWritten |= 0x02;
-    }
-    if (outputDisable) {
-      lastValueWritten |= 0x08;
-    }
-    lastValueWritten <<= gpioOutputRegisterBitShift;
-    device->writeUInt32(gpioOutputRegisterAddress, lastValueWritten,
-        lastValueWrittenMask, writeCallback);
-  } else if (currentTransferStepIndex == 49) {
-    // All bits have been latched into the shift register. Now we have to enable
-    // the transfer latch clock, so that they become active.
-    lastValueWrittenMask = 0x0f << gpioOutputRegisterBitShift;
-    lastValueWritten = 0x04;
-    bool outputDisable = (writeOutputValue & 0x80000000);
-    if (outputDisable) {
-      lastValueWritten |= 0x08;
-    }
-    lastValueWritten <<= gpioOutputRegisterBitShift;
-    device->writeUInt32(gpioOutputRegisterAddress, lastValueWritten,
-        lastValueWrittenMask, writeCallback);
-  } else if (currentTransferStepIndex == 50) {
-    // Finally, we disable the transfer latch clock again.
-    lastValueWrittenMask = 0x0f << gpioOutputRegisterBitShift;
-    lastValueWritten = 0;
-    bool outputDisable = (writeOutputValue & 0x80000000);
-    if (outputDisable) {
-      lastValueWritten |= 0x08 << gpioOutputRegisterBitShift;
-    }
-    device->writeUInt32(gpioOutputRegisterAddress, lastValueWritten,
-        lastValueWrittenMask, writeCallback);
+void MrfLongoutFineDelayShiftRegisterRecord::startTransfer() {
+  // First, we have to configure the GPIO pins for output. A pin is configured
+  // as an output by setting the direction bit to one. Therefore, the mask and
+  // the value are the same. There is a small risk that the corresponding bits
+  // in the output register are not zero. This is a problem if the bit for the
+  // transfer latch clock is not zero, because an undefined value will be
+  // latched into the delay chip. However, the register is initialized with
+  // zero on device startup and we reset it to zero after every write
+  // operation, so this is very unlikely to happen. Even if it happened, we
+  // would overwrite the value immediately, so that the undefined delay value
+  // would only be active for a very short period.
+  transferStep = TransferStep::gpioDirection;
+  lastValueWrittenMask = 0x0f << gpioDirectionRegisterBitShift;
+  lastValueWritten = lastValueWrittenMask;
+  device->writeUInt32(gpioDirectionRegisterAddress, lastValueWritten,
+      lastValueWrittenMask, writeCallback);
+}
+
+void MrfLongoutFineDelayShiftRegisterRecord::startShiftRegisterTransfer() {
+  // We precompute the complete sequence of states of the GPIO output lines.
+  bool outputDisable = (writeOutputValue & 0x80000000);
+  std::uint32_t outputDisableBit = outputDisable ? 0x08 : 0;
+  std::vector<std::uint32_t> &values = shiftRegisterValues;
+  values.clear();
+  values.reserve(50);
+  // We have to write 24 bits in total. Each bit requires two write operations:
+  // The first write operation sets the clock line low and the data line
+  // according to the bit value. The second write operation sets the clock line
+  // high, so that the bit is latched into the shift register.
+  for (std::uint32_t bit : shiftRegisterBits) {
+    std::uint32_t dataBit = (writeOutputValue & bit) ? 0x01 : 0;
+    values.push_back(
+        (dataBit | outputDisableBit) << gpioOutputRegisterBitShift);
+    values.push_back(
+        (dataBit | 0x02 | outputDisableBit) << gpioOutputRegisterBitShift);
+  }
+  // All bits have been latched into the shift register. Now we have to enable
+  // the transfer latch clock, so that they become active.
+  values.push_back((0x04 | outputDisableBit) << gpioOutputRegisterBitShift);
+  // Finally, we disable the transfer latch clock again.
+  values.push_back(outputDisableBit << gpioOutputRegisterBitShift);
+  transferStep = TransferStep::shiftRegister;
+  lastValueWrittenMask = 0x0f << gpioOutputRegisterBitShift;
+  if (pipelineDepth > 1) {
+    // When pipelining has been enabled, we queue the whole sequence as a single
+    // operation. This way, the register is only read once and other operations
+    // cannot interfere with the sequence. The constructor has ensured that the
+    // device cannot execute the writes too quickly.
+    lastValueWritten = values.back();
+    nextShiftRegisterValueIndex = values.size();
+    device->writeUInt32Sequence(gpioOutputRegisterAddress, values,
+        lastValueWrittenMask, pipelineDepth, writeCallback);
   } else {
-    // We are finished, so the only thing left to do is to process the record
-    // again.
-    writeSuccessful = true;
-    scheduleProcessing();
+    nextShiftRegisterValueIndex = 0;
+    startNextTransferStep();
   }
 }
 
+void MrfLongoutFineDelayShiftRegisterRecord::startNextTransferStep() {
+  // We increment the index before starting the write. This way, the index has
+  // been incremented, even if the callback for the write is executed before we
+  // return from this function.
+  lastValueWritten = shiftRegisterValues[nextShiftRegisterValueIndex];
+  ++nextShiftRegisterValueIndex;
+  device->writeUInt32(gpioOutputRegisterAddress, lastValueWritten,
+      lastValueWrittenMask, writeCallback);
+}
+
 void MrfLongoutFineDelayShiftRegisterRecord::startNextTransferStepStatic(
     ::CALLBACK *callback) {
-  void *deviceSupport;
-  callbackGetUser(deviceSupport, callback);
-  static_cast<MrfLongoutFineDelayShiftRegisterRecord *>(deviceSupport)->startNextTransferStep();
+  void *deviceSupportVoid;
+  callbackGetUser(deviceSupportVoid, callback);
+  MrfLongoutFineDelayShiftRegisterRecord &deviceSupport =
+      *static_cast<MrfLongoutFineDelayShiftRegisterRecord *>(deviceSupportVoid);
+  try {
+    deviceSupport.startNextTransferStep();
+  } catch (std::exception &e) {
+    deviceSupport.writeSuccessful = false;
+    deviceSupport.writeErrorMessage = e.what();
+    deviceSupport.scheduleProcessing();
+  }
 }
 
 void MrfLongoutFineDelayShiftRegisterRecord::CallbackImpl::success(
@@ -402,14 +402,28 @@ void MrfLongoutFineDelayShiftRegisterRecord::CallbackImpl::success(
     deviceSupport.writeErrorMessage =
         "Mismatch between the value written to the device and the value read back from the device.";
     deviceSupport.scheduleProcessing();
-  } else {
+  } else if (deviceSupport.transferStep == TransferStep::gpioDirection) {
+    try {
+      deviceSupport.startShiftRegisterTransfer();
+    } catch (std::exception &e) {
+      deviceSupport.writeSuccessful = false;
+      deviceSupport.writeErrorMessage = e.what();
+      deviceSupport.scheduleProcessing();
+    }
+  } else if (deviceSupport.nextShiftRegisterValueIndex
+      < deviceSupport.shiftRegisterValues.size()) {
     // We schedule a delayed callback for the next transfer step. This way, we
-    // can ensure that the bits are not written too quickly (which could cause
-    // the shift register to not recognize them correctly). When using the
-    // UDP/IP protocol, the delay introduced by the protocol is already enough,
-    // but for a more direct memory access, the extra delay of 500 ns should be
-    // sufficient.
-    callbackRequestDelayed(&deviceSupport.nextTransferStepCallback, 0.0000005);
+    // can ensure that the bits are not written too quickly, so that the shift
+    // register recognizes each clock edge. We do this in a callback thread, so
+    // that we do not block the thread that notified us about the completed
+    // write, which might also be needed for other operations.
+    callbackRequestDelayed(&deviceSupport.nextTransferStepCallback,
+        std::chrono::duration<double>(minEdgeInterval).count());
+  } else {
+    // We are finished, so the only thing left to do is to process the record
+    // again.
+    deviceSupport.writeSuccessful = true;
+    deviceSupport.scheduleProcessing();
   }
 }
 
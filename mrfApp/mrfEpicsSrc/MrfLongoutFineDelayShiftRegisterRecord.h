@@ -30,7 +30,9 @@
 #ifndef ANKA_MRF_EPICS_LONGOUT_FINE_DELAY_SHIFT_REGISTER_RECORD_H
 #define ANKA_MRF_EPICS_LONGOUT_FINE_DELAY_SHIFT_REGISTER_RECORD_H
 
+#include <cstddef>
 #include <cstdint>
+#include <vector>
 
 #include <callback.h>
 #include <longoutRecord.h>
@@ -49,7 +51,22 @@ namespace epics {
  *
  * When the record is processed, a series of write operations is started, which
  * use four GPIO outputs to configure the two delay chips on a universal output
- * module through their common shift register.
+ * module through their common shift register. The complete sequence of states
+ * of the GPIO outputs is computed in advance. The value read back after each
+ * write is verified.
+ *
+ * By default, each write is only started after the previous one has finished
+ * and a delayed callback has been run 500 ns later, so that the shift register
+ * reliably recognizes each clock edge. The optional {@code pipeline_depth}
+ * option (specified as the last token in the record address) allows for
+ * queuing the whole sequence as a single operation (see
+ * {@link MrfConsistentMemoryAccess::writeUInt32Sequence}), with up to the
+ * specified number of writes being queued with the device at the same time.
+ * In this case, no delay is inserted between the writes, so the option is
+ * only accepted for devices that cannot execute two writes less than 500 ns
+ * apart (see {@link MrfMemoryAccess::getMinimumWriteInterval()}), like devices
+ * accessed through UDP/IP. A depth of one is equivalent to not specifying the
+ * option.
  *
  * The value stored in the record is interpreted in the following way: Bits
  * 0-9 store the delay for the first output and bits 16-25 store the delay for
@@ -84,6 +101,13 @@ public:
 
 private:
 
+  /**
+   * Step of the transfer process that is currently running.
+   */
+  enum class TransferStep {
+    gpioDirection, shiftRegister
+  };
+
   /**
    * Callback implementation used when writing to the GPIO registers.
    */
@@ -156,6 +180,12 @@ private:
    */
   signed char gpioOutputRegisterBitShift;
 
+  /**
+   * Number of writes to the GPIO output register that are queued with the
+   * device at the same time.
+   */
+  std::size_t pipelineDepth;
+
   /**
    * Value to be written. This is the value of the underlying record which is
    * copied when the record processing is started.
@@ -177,10 +207,22 @@ private:
   std::uint32_t lastValueWrittenMask;
 
   /**
-   * Index of the next step in the transfer process. This index start at zero
-   * and keeps track of which action has to be taken next.
+   * Sequence of values that are written to the GPIO output register in order
+   * to transfer the value into the shift register and latch it.
+   */
+  std::vector<std::uint32_t> shiftRegisterValues;
+
+  /**
+   * Index of the element of the shift-register sequence that is written next.
+   * This is only used when the writes are not pipelined.
    */
-  int nextTransferStepIndex;
+  std::size_t nextShiftRegisterValueIndex;
+
+  /**
+   * Step of the transfer process that is currently running. This is used by
+   * the callback to decide which action has to be taken next.
+   */
+  TransferStep transferStep;
 
   /**
    * Flag indicating whether the write operation was successful. This flag is
@@ -206,8 +248,19 @@ private:
   void scheduleProcessing();
 
   /**
-   * Starts the next step of the transfer process. This also increments the
-   * next transfer-step index.
+   * Starts the transfer process by configuring the GPIO pins for output.
+   */
+  void startTransfer();
+
+  /**
+   * Computes the sequence of writes to the GPIO output register that transfers
+   * the value into the shift register and latches it and starts writing it.
+   */
+  void startShiftRegisterTransfer();
+
+  /**
+   * Writes the next element of the shift-register sequence. This also
+   * increments the index of the next element.
    */
   void startNextTransferStep();
 
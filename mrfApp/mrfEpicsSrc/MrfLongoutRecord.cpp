@@ -27,6 +27,9 @@
  * of the GNU LGPL version 3 or newer.
  */
 
+#include <caeventmask.h>
+#include <dbEvent.h>
+
 #include "MrfLongoutRecord.h"
 
 namespace anka {
@@ -38,6 +41,13 @@ MrfLongoutRecord::MrfLongoutRecord(::longoutRecord *record) :
   this->initializeValue();
 }
 
+bool MrfLongoutRecord::correctRecordValue(std::uint32_t value) {
+  writeRecordValue(value);
+  getRecord()->udf = false;
+  ::db_post_events(getRecord(), &getRecord()->val, DBE_VALUE | DBE_LOG);
+  return true;
+}
+
 std::uint32_t MrfLongoutRecord::readRecordValue() {
   return getRecord()->val;
 }
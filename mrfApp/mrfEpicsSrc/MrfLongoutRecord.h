@@ -52,6 +52,8 @@ public:
 
 protected:
 
+  bool correctRecordValue(std::uint32_t value);
+
   std::uint32_t readRecordValue();
 
   void writeRecordValue(std::uint32_t value);
@@ -27,41 +27,453 @@
  * of the GNU LGPL version 3 or newer.
  */
 
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <tuple>
+
+#include "MrfStartupProfiler.h"
+
 #include "MrfMemoryCache.h"
 
 namespace anka {
 namespace mrf {
 namespace epics {
 
+namespace {
+
+/**
+ * Magic bytes at the start of a snapshot file.
+ */
+const char snapshotMagic[4] = {'M', 'R', 'F', 'C'};
+
+/**
+ * Version of the snapshot file format. This has to be incremented when the
+ * format is changed in an incompatible way.
+ */
+const std::uint32_t snapshotFormatVersion = 1;
+
+// The snapshot file uses little-endian byte order, regardless of the byte order
+// of the host.
+
+template<typename T>
+void writeLittleEndian(std::ostream &stream, T value) {
+  char buffer[sizeof(T)];
+  for (std::size_t i = 0; i < sizeof(T); ++i) {
+    buffer[i] = static_cast<char>((value >> (8 * i)) & 0xff);
+  }
+  stream.write(buffer, sizeof(T));
+}
+
+template<typename T>
+T readLittleEndian(std::istream &stream) {
+  unsigned char buffer[sizeof(T)];
+  if (!stream.read(reinterpret_cast<char *>(buffer), sizeof(T))) {
+    throw std::runtime_error("Unexpected end of snapshot file.");
+  }
+  T value = 0;
+  for (std::size_t i = 0; i < sizeof(T); ++i) {
+    value |= static_cast<T>(static_cast<T>(buffer[i]) << (8 * i));
+  }
+  return value;
+}
+
+/**
+ * Writes a section of the snapshot file. A section consists of the number of
+ * runs, followed by the runs. Each run consists of the start address, the
+ * number of registers, and the values of these registers. Registers are part of
+ * the same run if their addresses are contiguous. The map passed has to be
+ * sorted by address.
+ */
+template<typename T>
+void writeSnapshotSection(std::ostream &stream,
+    const std::map<std::uint32_t, T> &values) {
+  std::vector<std::pair<std::uint32_t, std::vector<T>>> runs;
+  for (auto &addressAndValue : values) {
+    if (runs.empty()
+        || addressAndValue.first
+            != runs.back().first + runs.back().second.size() * sizeof(T)) {
+      runs.emplace_back(addressAndValue.first, std::vector<T>());
+    }
+    runs.back().second.push_back(addressAndValue.second);
+  }
+  writeLittleEndian<std::uint32_t>(stream, runs.size());
+  for (auto &run : runs) {
+    writeLittleEndian<std::uint32_t>(stream, run.first);
+    writeLittleEndian<std::uint32_t>(stream, run.second.size());
+    for (T value : run.second) {
+      writeLittleEndian<T>(stream, value);
+    }
+  }
+}
+
+/**
+ * Reads a section of the snapshot file that has been written by
+ * {@link writeSnapshotSection}.
+ */
+template<typename T>
+std::vector<std::pair<std::uint32_t, T>> readSnapshotSection(
+    std::istream &stream) {
+  std::vector<std::pair<std::uint32_t, T>> values;
+  std::uint32_t numberOfRuns = readLittleEndian<std::uint32_t>(stream);
+  for (std::uint32_t runIndex = 0; runIndex < numberOfRuns; ++runIndex) {
+    std::uint32_t address = readLittleEndian<std::uint32_t>(stream);
+    std::uint32_t count = readLittleEndian<std::uint32_t>(stream);
+    for (std::uint32_t i = 0; i < count; ++i) {
+      values.emplace_back(address, readLittleEndian<T>(stream));
+      address += sizeof(T);
+    }
+  }
+  return values;
+}
+
+} // anonymous namespace
+
+template<typename T>
+class MrfMemoryCache::PreheatCallbackImpl: public MrfMemoryAccess::Callback<T> {
+
+public:
+
+  PreheatCallbackImpl(MrfMemoryCache &memoryCache,
+      MrfConcurrentRegisterMap<T> &cache,
+      std::unordered_set<std::uint32_t> &preheating) :
+      memoryCache(memoryCache), cache(cache), preheating(preheating),
+      startTime(std::chrono::steady_clock::now()) {
+  }
+
+  void success(std::uint32_t address, T value) {
+    memoryCache.preheatFinished(cache, preheating, startTime, address, true,
+        value);
+  }
+
+  void failure(std::uint32_t address, MrfMemoryAccess::ErrorCode,
+      const std::string &) {
+    memoryCache.preheatFinished(cache, preheating, startTime, address, false,
+        static_cast<T>(0));
+  }
+
+private:
+
+  // The cache is not destroyed before all preheat reads have finished (see
+  // finishPreheating()), so we can safely keep references.
+  MrfMemoryCache &memoryCache;
+  MrfConcurrentRegisterMap<T> &cache;
+  std::unordered_set<std::uint32_t> &preheating;
+  std::chrono::steady_clock::time_point startTime;
+
+};
+
+template<typename T>
+class MrfMemoryCache::ReadCallbackImpl: public MrfMemoryAccess::Callback<T> {
+
+public:
+
+  ReadCallbackImpl(MrfConcurrentRegisterMap<T> &cache,
+      std::shared_ptr<MrfMemoryAccess::Callback<T>> delegate) :
+      cache(cache), delegate(delegate),
+      startTime(std::chrono::steady_clock::now()) {
+  }
+
+  void success(std::uint32_t address, T value) {
+    // The age of the value is measured from the point in time when the read
+    // was started. If the register has been written or invalidated since then,
+    // the value might be outdated, so we do not store it.
+    cache.storeIfNewer(address, value, startTime);
+    delegate->success(address, value);
+  }
+
+  void failure(std::uint32_t address, MrfMemoryAccess::ErrorCode errorCode,
+      const std::string &details) {
+    delegate->failure(address, errorCode, details);
+  }
+
+private:
+
+  // Runtime reads are only used for caches that are owned by the device
+  // registry, which are never destroyed, so we can safely keep a reference.
+  MrfConcurrentRegisterMap<T> &cache;
+  std::shared_ptr<MrfMemoryAccess::Callback<T>> delegate;
+  std::chrono::steady_clock::time_point startTime;
+
+};
+
+template<typename T>
+class MrfMemoryCache::VerifyCallbackImpl: public MrfMemoryAccess::BlockCallback<
+    T> {
+
+public:
+
+  VerifyCallbackImpl(MrfMemoryCache &memoryCache,
+      MrfConcurrentRegisterMap<T> &cache,
+      std::unordered_map<std::uint32_t, std::vector<CorrectionListener>>
+          &unverified, SnapshotVerificationResult &result, std::size_t count) :
+      memoryCache(memoryCache), cache(cache), unverified(unverified),
+      result(result), count(count),
+      startTime(std::chrono::steady_clock::now()) {
+  }
+
+  void success(std::uint32_t address, const std::vector<T> &values) {
+    memoryCache.verifyFinished(cache, unverified, result, startTime, address,
+        count, true, values);
+  }
+
+  void failure(std::uint32_t address, MrfMemoryAccess::ErrorCode,
+      const std::string &) {
+    memoryCache.verifyFinished(cache, unverified, result, startTime, address,
+        count, false, std::vector<T>());
+  }
+
+private:
+
+  // verifySnapshot() does not return before all block reads have finished, so
+  // we can safely keep references.
+  MrfMemoryCache &memoryCache;
+  MrfConcurrentRegisterMap<T> &cache;
+  std::unordered_map<std::uint32_t, std::vector<CorrectionListener>>
+      &unverified;
+  SnapshotVerificationResult &result;
+  std::size_t count;
+  std::chrono::steady_clock::time_point startTime;
+
+};
+
+class MrfMemoryCache::WriteListenerImpl: public MrfConsistentMemoryAccess::WriteListener {
+
+public:
+
+  WriteListenerImpl(MrfMemoryCache &memoryCache) :
+      memoryCache(memoryCache) {
+  }
+
+  void writeInvalidated(std::uint32_t address, std::uint32_t length) {
+    memoryCache.writeInvalidated(address, length);
+  }
+
+  void writeSucceededUInt16(std::uint32_t address, std::uint16_t value) {
+    memoryCache.writeSucceeded(address, value);
+  }
+
+  void writeSucceededUInt32(std::uint32_t address, std::uint32_t value) {
+    memoryCache.writeSucceeded(address, value);
+  }
+
+private:
+
+  // The listener is owned by the cache and the memory access only keeps a weak
+  // pointer to it, so the cache is alive as long as the listener can be used.
+  MrfMemoryCache &memoryCache;
+
+};
+
+constexpr std::size_t MrfMemoryCache::defaultPreheatLimit;
+constexpr std::chrono::steady_clock::duration MrfMemoryCache::infiniteTtl;
+constexpr std::size_t MrfMemoryCache::verifyBlockSize;
+
 MrfMemoryCache::MrfMemoryCache(MrfMemoryAccess &memoryAccess) :
-    memoryAccess(memoryAccess) {
+    memoryAccess(memoryAccess), preheatLimit(defaultPreheatLimit),
+    preheatStatistics(), preheatStarted(false), snapshotLoading(false),
+    verifyingBlocks(0),
+    writeListener(std::make_shared<WriteListenerImpl>(*this)) {
 }
 
 MrfMemoryCache::MrfMemoryCache(std::shared_ptr<MrfMemoryAccess> memoryAccess) :
-    memoryAccess(*memoryAccess), memoryAccessPtr(memoryAccess) {
+    memoryAccess(*memoryAccess), memoryAccessPtr(memoryAccess),
+    preheatLimit(defaultPreheatLimit), preheatStatistics(),
+    preheatStarted(false), snapshotLoading(false), verifyingBlocks(0),
+    writeListener(std::make_shared<WriteListenerImpl>(*this)) {
 }
 
-std::map<std::uint32_t, std::uint16_t> MrfMemoryCache::getCacheUInt16() const {
-  // Access to the hash map has to be protected by a mutex.
+bool MrfMemoryCache::addCorrectionListenerUInt16(std::uint32_t address,
+    CorrectionListener listener) {
+  return addCorrectionListener(unverifiedUInt16, address, std::move(listener));
+}
+
+bool MrfMemoryCache::addCorrectionListenerUInt32(std::uint32_t address,
+    CorrectionListener listener) {
+  return addCorrectionListener(unverifiedUInt32, address, std::move(listener));
+}
+
+void MrfMemoryCache::beginSnapshotLoad() {
   std::lock_guard<std::recursive_mutex> lock(mutex);
-  return std::map<std::uint32_t, std::uint16_t>(
-    cacheUInt16.begin(), cacheUInt16.end());
+  snapshotLoading = true;
+}
+
+void MrfMemoryCache::finishPreheating() {
+  std::unique_lock<std::recursive_mutex> lock(mutex);
+  preheatCv.wait(lock, [this]() {
+    return preheatingUInt16.empty() && preheatingUInt32.empty()
+        && scheduledUInt16.empty() && scheduledUInt32.empty();
+  });
+  if (!preheatStarted) {
+    preheatStarted = true;
+    preheatStartTime = std::chrono::steady_clock::now();
+    preheatEndTime = preheatStartTime;
+  }
+  preheatStatistics.finished = true;
+}
+
+void MrfMemoryCache::finishSnapshotLoad() {
+  std::lock_guard<std::recursive_mutex> lock(mutex);
+  snapshotLoading = false;
+  preheatCv.notify_all();
+}
+
+std::map<std::uint32_t, std::uint16_t> MrfMemoryCache::getCacheUInt16() const {
+  return cacheUInt16.getSnapshot();
 }
 
 std::map<std::uint32_t, std::uint32_t> MrfMemoryCache::getCacheUInt32() const {
-  // Access to the hash map has to be protected by a mutex.
+  return cacheUInt32.getSnapshot();
+}
+
+std::size_t MrfMemoryCache::getPreheatLimit() const {
+  std::lock_guard<std::recursive_mutex> lock(mutex);
+  return preheatLimit;
+}
+
+MrfMemoryCache::PreheatStatistics MrfMemoryCache::getPreheatStatistics() const {
+  std::lock_guard<std::recursive_mutex> lock(mutex);
+  PreheatStatistics statistics = preheatStatistics;
+  if (preheatStarted) {
+    auto endTime = statistics.finished ?
+        preheatEndTime : std::chrono::steady_clock::now();
+    statistics.wallTimeMicroseconds =
+        std::chrono::duration_cast<std::chrono::microseconds>(
+            endTime - preheatStartTime).count();
+  }
+  return statistics;
+}
+
+std::chrono::steady_clock::duration MrfMemoryCache::getTtl(
+    std::uint32_t address) const {
+  std::lock_guard<std::recursive_mutex> lock(mutex);
+  // Ranges that have been configured later take precedence, so we search
+  // backwards.
+  for (auto range = ttlRanges.rbegin(); range != ttlRanges.rend(); ++range) {
+    if (address >= range->firstAddress && address <= range->lastAddress) {
+      return range->ttl;
+    }
+  }
+  return std::chrono::steady_clock::duration::zero();
+}
+
+std::shared_ptr<MrfConsistentMemoryAccess::WriteListener> MrfMemoryCache::getWriteListener() {
+  return writeListener;
+}
+
+std::size_t MrfMemoryCache::invalidate(std::uint32_t firstAddress,
+    std::uint32_t lastAddress) {
+  if (firstAddress > lastAddress) {
+    throw std::invalid_argument(
+        "The first address must not be greater than the last address.");
+  }
+  auto now = std::chrono::steady_clock::now();
+  // A register that starts before the first address still overlaps the range
+  // if it extends into it.
+  return cacheUInt16.invalidate(firstAddress - std::min(firstAddress, 1u),
+      lastAddress, now)
+      + cacheUInt32.invalidate(firstAddress - std::min(firstAddress, 3u),
+          lastAddress, now);
+}
+
+bool MrfMemoryCache::loadSnapshot(const std::string &fileName,
+    std::uint32_t key) {
+  std::ifstream stream(fileName, std::ios::in | std::ios::binary);
+  if (!stream) {
+    return false;
+  }
+  char magic[sizeof(snapshotMagic)];
+  if (!stream.read(magic, sizeof(magic))
+      || std::memcmp(magic, snapshotMagic, sizeof(magic))) {
+    throw std::runtime_error(fileName + " is not a cache snapshot file.");
+  }
+  if (readLittleEndian<std::uint32_t>(stream) != snapshotFormatVersion) {
+    throw std::runtime_error(
+        fileName + " uses an unsupported snapshot format version.");
+  }
+  if (readLittleEndian<std::uint32_t>(stream) != key) {
+    return false;
+  }
+  // We read the whole file before modifying the cache, so that a malformed file
+  // does not leave the cache partially filled.
+  auto valuesUInt16 = readSnapshotSection<std::uint16_t>(stream);
+  auto valuesUInt32 = readSnapshotSection<std::uint32_t>(stream);
   std::lock_guard<std::recursive_mutex> lock(mutex);
-  return std::map<std::uint32_t, std::uint32_t>(
-    cacheUInt32.begin(), cacheUInt32.end());
+  // Values that have been read from the device in the meantime are more recent
+  // than the ones from the snapshot, so we do not replace them. We do not know
+  // how old the values from the snapshot are, so they are stored without a
+  // time until they have been verified.
+  for (auto &addressAndValue : valuesUInt16) {
+    if (cacheUInt16.emplace(addressAndValue.first, addressAndValue.second,
+        std::chrono::steady_clock::time_point()).second) {
+      unverifiedUInt16[addressAndValue.first];
+    }
+  }
+  for (auto &addressAndValue : valuesUInt32) {
+    if (cacheUInt32.emplace(addressAndValue.first, addressAndValue.second,
+        std::chrono::steady_clock::time_point()).second) {
+      unverifiedUInt32[addressAndValue.first];
+    }
+  }
+  return true;
+}
+
+void MrfMemoryCache::preheatScheduled(
+    const std::vector<std::pair<std::uint32_t, bool>> &registers) {
+  for (auto &addressAndWidth : registers) {
+    auto address = addressAndWidth.first;
+    if (addressAndWidth.second) {
+      if (takeScheduled(preheatingUInt32, scheduledUInt32, address)) {
+        startPreheatRead(cacheUInt32, preheatingUInt32, address);
+      }
+    } else {
+      if (takeScheduled(preheatingUInt16, scheduledUInt16, address)) {
+        startPreheatRead(cacheUInt16, preheatingUInt16, address);
+      }
+    }
+  }
+}
+
+void MrfMemoryCache::preheatUInt16(std::uint32_t address) {
+  if (preheat(cacheUInt16, preheatingUInt16, scheduledUInt16, address)) {
+    startPreheatRead(cacheUInt16, preheatingUInt16, address);
+  }
+}
+
+void MrfMemoryCache::preheatUInt32(std::uint32_t address) {
+  if (preheat(cacheUInt32, preheatingUInt32, scheduledUInt32, address)) {
+    startPreheatRead(cacheUInt32, preheatingUInt32, address);
+  }
 }
 
 std::uint16_t MrfMemoryCache::readUInt16(std::uint32_t address) {
   {
-    // Access to the hash map has to be protected by a mutex.
-    std::lock_guard<std::recursive_mutex> lock(mutex);
-    auto iterator = cacheUInt16.find(address);
-    if (iterator != cacheUInt16.end()) {
-      return iterator->second;
+    // In the common case, the value is already in the cache and we can return
+    // it without acquiring the mutex.
+    std::uint16_t value;
+    if (!snapshotLoading.load(std::memory_order_acquire)
+        && findUnexpired(cacheUInt16, address, value)) {
+      if (MrfStartupProfiler::isEnabled()) {
+        MrfStartupProfiler::recordCacheHit();
+      }
+      return value;
+    }
+  }
+  auto waitStartTime = std::chrono::steady_clock::now();
+  {
+    // If the register is being preheated or scheduled for preheating, we wait
+    // for that read instead of sending a second request.
+    std::uint16_t value;
+    if (waitForPreheat(cacheUInt16, preheatingUInt16, scheduledUInt16,
+        address, value)) {
+      if (MrfStartupProfiler::isEnabled()) {
+        MrfStartupProfiler::recordCacheWait(
+            std::chrono::steady_clock::now() - waitStartTime);
+      }
+      return value;
     }
   }
   // If the register is not in the cache yet, we read it from the memory access.
@@ -70,23 +482,55 @@ std::uint16_t MrfMemoryCache::readUInt16(std::uint32_t address) {
   // meantime. This means that the same register might be read more than once,
   // if multiple read attempt are made before the first one is finished.
   // However, this is still better than the alternative.
+  auto startTime = std::chrono::steady_clock::now();
   std::uint16_t value = memoryAccess.readUInt16(address);
-  {
-    // Access to the hash map has to be protected by a mutex.
-    std::lock_guard<std::recursive_mutex> lock(mutex);
-    // If the value has already been cached, we prefer the cached value. This
-    // way, the behavior is independent concurrency timings.
-    return cacheUInt16.emplace(address, value).first->second;
+  if (MrfStartupProfiler::isEnabled()) {
+    MrfStartupProfiler::recordCacheMiss(
+        std::chrono::steady_clock::now() - waitStartTime);
   }
+  // If a more recent value has been cached in the meantime, we prefer the
+  // cached value. This way, the behavior is independent of concurrency
+  // timings.
+  if (!cacheUInt16.storeIfNewer(address, value, startTime)) {
+    std::uint16_t cachedValue;
+    if (cacheUInt16.find(address, cachedValue)) {
+      return cachedValue;
+    }
+  }
+  return value;
+}
+
+void MrfMemoryCache::readUInt16(std::uint32_t address,
+    std::chrono::steady_clock::duration ttl,
+    std::shared_ptr<MrfMemoryAccess::CallbackUInt16> callback) {
+  readRuntime(cacheUInt16, address, ttl, callback);
 }
 
 std::uint32_t MrfMemoryCache::readUInt32(std::uint32_t address) {
   {
-    // Access to the hash map has to be protected by a mutex.
-    std::lock_guard<std::recursive_mutex> lock(mutex);
-    auto iterator = cacheUInt32.find(address);
-    if (iterator != cacheUInt32.end()) {
-      return iterator->second;
+    // In the common case, the value is already in the cache and we can return
+    // it without acquiring the mutex.
+    std::uint32_t value;
+    if (!snapshotLoading.load(std::memory_order_acquire)
+        && findUnexpired(cacheUInt32, address, value)) {
+      if (MrfStartupProfiler::isEnabled()) {
+        MrfStartupProfiler::recordCacheHit();
+      }
+      return value;
+    }
+  }
+  auto waitStartTime = std::chrono::steady_clock::now();
+  {
+    // If the register is being preheated or scheduled for preheating, we wait
+    // for that read instead of sending a second request.
+    std::uint32_t value;
+    if (waitForPreheat(cacheUInt32, preheatingUInt32, scheduledUInt32,
+        address, value)) {
+      if (MrfStartupProfiler::isEnabled()) {
+        MrfStartupProfiler::recordCacheWait(
+            std::chrono::steady_clock::now() - waitStartTime);
+      }
+      return value;
     }
   }
   // If the register is not in the cache yet, we read it from the memory access.
@@ -95,14 +539,123 @@ std::uint32_t MrfMemoryCache::readUInt32(std::uint32_t address) {
   // meantime. This means that the same register might be read more than once,
   // if multiple read attempt are made before the first one is finished.
   // However, this is still better than the alternative.
+  auto startTime = std::chrono::steady_clock::now();
   std::uint32_t value = memoryAccess.readUInt32(address);
+  if (MrfStartupProfiler::isEnabled()) {
+    MrfStartupProfiler::recordCacheMiss(
+        std::chrono::steady_clock::now() - waitStartTime);
+  }
+  // If a more recent value has been cached in the meantime, we prefer the
+  // cached value. This way, the behavior is independent of concurrency
+  // timings.
+  if (!cacheUInt32.storeIfNewer(address, value, startTime)) {
+    std::uint32_t cachedValue;
+    if (cacheUInt32.find(address, cachedValue)) {
+      return cachedValue;
+    }
+  }
+  return value;
+}
+
+void MrfMemoryCache::readUInt32(std::uint32_t address,
+    std::chrono::steady_clock::duration ttl,
+    std::shared_ptr<MrfMemoryAccess::CallbackUInt32> callback) {
+  readRuntime(cacheUInt32, address, ttl, callback);
+}
+
+void MrfMemoryCache::saveSnapshot(const std::string &fileName,
+    std::uint32_t key) const {
+  std::map<std::uint32_t, std::uint16_t> valuesUInt16;
+  std::map<std::uint32_t, std::uint32_t> valuesUInt32;
   {
-    // Access to the hash map has to be protected by a mutex.
     std::lock_guard<std::recursive_mutex> lock(mutex);
-    // If the value has already been cached, we prefer the cached value. This
-    // way, the behavior is independent concurrency timings.
-    return cacheUInt32.emplace(address, value).first->second;
+    valuesUInt16 = cacheUInt16.getSnapshot();
+    valuesUInt32 = cacheUInt32.getSnapshot();
+    for (auto &addressAndListeners : unverifiedUInt16) {
+      valuesUInt16.erase(addressAndListeners.first);
+    }
+    for (auto &addressAndListeners : unverifiedUInt32) {
+      valuesUInt32.erase(addressAndListeners.first);
+    }
+  }
+  std::string temporaryFileName = fileName + ".tmp";
+  {
+    std::ofstream stream(temporaryFileName,
+        std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!stream) {
+      throw std::runtime_error(
+          "Could not open " + temporaryFileName + " for writing.");
+    }
+    stream.write(snapshotMagic, sizeof(snapshotMagic));
+    writeLittleEndian<std::uint32_t>(stream, snapshotFormatVersion);
+    writeLittleEndian<std::uint32_t>(stream, key);
+    writeSnapshotSection(stream, valuesUInt16);
+    writeSnapshotSection(stream, valuesUInt32);
+    stream.close();
+    if (!stream) {
+      std::remove(temporaryFileName.c_str());
+      throw std::runtime_error("Could not write " + temporaryFileName + ".");
+    }
+  }
+  if (std::rename(temporaryFileName.c_str(), fileName.c_str())) {
+    int errorNumber = errno;
+    std::remove(temporaryFileName.c_str());
+    throw std::runtime_error(
+        "Could not rename " + temporaryFileName + " to " + fileName + ": "
+            + std::strerror(errorNumber));
+  }
+}
+
+void MrfMemoryCache::schedulePreheat(
+    const std::vector<std::pair<std::uint32_t, bool>> &registers) {
+  std::unique_lock<std::recursive_mutex> lock(mutex);
+  // If a snapshot is being loaded, we wait for it, because we do not have to
+  // preheat the registers that are contained in the snapshot.
+  preheatCv.wait(lock, [this]() {
+    return !snapshotLoading;
+  });
+  if (!preheatStarted) {
+    preheatStarted = true;
+    preheatStartTime = std::chrono::steady_clock::now();
+  }
+  for (auto &addressAndWidth : registers) {
+    auto address = addressAndWidth.first;
+    if (addressAndWidth.second) {
+      if (!cacheUInt32.contains(address) && !preheatingUInt32.count(address)) {
+        scheduledUInt32.insert(address);
+      }
+    } else {
+      if (!cacheUInt16.contains(address) && !preheatingUInt16.count(address)) {
+        scheduledUInt16.insert(address);
+      }
+    }
+  }
+  if (!scheduledUInt16.empty() || !scheduledUInt32.empty()) {
+    preheatStatistics.finished = false;
+  }
+}
+
+void MrfMemoryCache::setPreheatLimit(std::size_t limit) {
+  if (limit < 1) {
+    throw std::invalid_argument("The preheat limit must be at least one.");
+  }
+  std::lock_guard<std::recursive_mutex> lock(mutex);
+  preheatLimit = limit;
+  // Raising the limit might allow waiting preheat reads to be started.
+  preheatCv.notify_all();
+}
+
+void MrfMemoryCache::setTtl(std::uint32_t firstAddress,
+    std::uint32_t lastAddress, std::chrono::steady_clock::duration ttl) {
+  if (firstAddress > lastAddress) {
+    throw std::invalid_argument(
+        "The first address must not be greater than the last address.");
   }
+  if (ttl < std::chrono::steady_clock::duration::zero()) {
+    throw std::invalid_argument("The TTL must not be negative.");
+  }
+  std::lock_guard<std::recursive_mutex> lock(mutex);
+  ttlRanges.push_back(TtlRange { firstAddress, lastAddress, ttl });
 }
 
 void MrfMemoryCache::tryCacheUInt16(std::uint32_t address) {
@@ -121,6 +674,346 @@ void MrfMemoryCache::tryCacheUInt32(std::uint32_t address) {
   }
 }
 
+MrfMemoryCache::SnapshotVerificationResult MrfMemoryCache::verifySnapshot() {
+  {
+    std::unique_lock<std::recursive_mutex> lock(mutex);
+    preheatCv.wait(lock, [this]() {
+      return !snapshotLoading;
+    });
+  }
+  SnapshotVerificationResult result = SnapshotVerificationResult();
+  verify(cacheUInt16, unverifiedUInt16, result);
+  verify(cacheUInt32, unverifiedUInt32, result);
+  // The result is only modified while holding the mutex and verify waits for
+  // all block reads to finish while holding the mutex, so we can safely
+  // return the result.
+  return result;
+}
+
+bool MrfMemoryCache::addCorrectionListener(
+    std::unordered_map<std::uint32_t, std::vector<CorrectionListener>>
+        &unverified, std::uint32_t address, CorrectionListener listener) {
+  std::lock_guard<std::recursive_mutex> lock(mutex);
+  auto iterator = unverified.find(address);
+  if (iterator == unverified.end()) {
+    return false;
+  }
+  iterator->second.push_back(std::move(listener));
+  return true;
+}
+
+template<typename T>
+bool MrfMemoryCache::findUnexpired(MrfConcurrentRegisterMap<T> &cache,
+    std::uint32_t address, T &value) const {
+  std::chrono::steady_clock::time_point time;
+  if (!cache.find(address, value, time)) {
+    return false;
+  }
+  // Without a TTL, the value is only used while initializing records, so it
+  // does not expire. Otherwise, we apply the same rules as for runtime reads,
+  // so that a record that is initialized late does not get an outdated value.
+  auto ttl = getTtl(address);
+  if (ttl == std::chrono::steady_clock::duration::zero()
+      || ttl == infiniteTtl) {
+    return true;
+  }
+  return time != std::chrono::steady_clock::time_point()
+      && std::chrono::steady_clock::now() - time <= ttl;
+}
+
+template<typename T>
+bool MrfMemoryCache::preheat(MrfConcurrentRegisterMap<T> &cache,
+    std::unordered_set<std::uint32_t> &preheating,
+    const std::unordered_set<std::uint32_t> &scheduled,
+    std::uint32_t address) {
+  std::unique_lock<std::recursive_mutex> lock(mutex);
+  // If a snapshot is being loaded, we wait for it, because we do not have to
+  // preheat the registers that are contained in the snapshot.
+  preheatCv.wait(lock, [this]() {
+    return !snapshotLoading;
+  });
+  if (!preheatStarted) {
+    preheatStarted = true;
+    preheatStartTime = std::chrono::steady_clock::now();
+  }
+  // We check the cache again after waiting, because the register might have
+  // been read by someone else in the meantime.
+  auto isDone = [&cache, &preheating, &scheduled, address]() {
+    return cache.contains(address) || preheating.count(address)
+        || scheduled.count(address);
+  };
+  if (isDone()) {
+    return false;
+  }
+  preheatCv.wait(lock, [this]() {
+    return preheatingUInt16.size() + preheatingUInt32.size() < preheatLimit;
+  });
+  if (isDone()) {
+    return false;
+  }
+  preheating.insert(address);
+  ++preheatStatistics.requested;
+  return true;
+}
+
+template<typename T>
+void MrfMemoryCache::preheatFinished(
+    MrfConcurrentRegisterMap<T> &cache,
+    std::unordered_set<std::uint32_t> &preheating,
+    std::chrono::steady_clock::time_point startTime, std::uint32_t address,
+    bool successful, T value) {
+  std::lock_guard<std::recursive_mutex> lock(mutex);
+  if (successful) {
+    // If the value has already been cached, we prefer the cached value, just
+    // like readUInt16 and readUInt32 do.
+    cache.emplace(address, value, startTime);
+    ++preheatStatistics.succeeded;
+  } else {
+    ++preheatStatistics.failed;
+  }
+  preheating.erase(address);
+  if (preheatingUInt16.empty() && preheatingUInt32.empty()
+      && scheduledUInt16.empty() && scheduledUInt32.empty()) {
+    preheatEndTime = std::chrono::steady_clock::now();
+  }
+  preheatCv.notify_all();
+}
+
+template<typename T>
+void MrfMemoryCache::readRuntime(MrfConcurrentRegisterMap<T> &cache,
+    std::uint32_t address, std::chrono::steady_clock::duration ttl,
+    std::shared_ptr<MrfMemoryAccess::Callback<T>> callback) {
+  T value;
+  std::chrono::steady_clock::time_point time;
+  // A value without a time has been loaded from a snapshot and has not been
+  // verified yet, so we cannot tell whether it is still valid.
+  if (!snapshotLoading.load(std::memory_order_acquire)
+      && cache.find(address, value, time)
+      && time != std::chrono::steady_clock::time_point()
+      && (ttl == infiniteTtl
+          || std::chrono::steady_clock::now() - time <= ttl)) {
+    callback->success(address, value);
+    return;
+  }
+  startRead(address, std::make_shared<ReadCallbackImpl<T>>(cache, callback));
+}
+
+void MrfMemoryCache::startBlockRead(std::uint32_t address, std::size_t count,
+    std::shared_ptr<MrfMemoryAccess::BlockCallbackUInt16> callback) {
+  memoryAccess.readUInt16Block(address, count, 0, callback);
+}
+
+void MrfMemoryCache::startBlockRead(std::uint32_t address, std::size_t count,
+    std::shared_ptr<MrfMemoryAccess::BlockCallbackUInt32> callback) {
+  memoryAccess.readUInt32Block(address, count, 0, callback);
+}
+
+template<typename T>
+void MrfMemoryCache::startPreheatRead(MrfConcurrentRegisterMap<T> &cache,
+    std::unordered_set<std::uint32_t> &preheating, std::uint32_t address) {
+  std::shared_ptr<MrfMemoryAccess::Callback<T>> callback =
+      std::make_shared<PreheatCallbackImpl<T>>(*this, cache, preheating);
+  try {
+    startRead(address, callback);
+  } catch (...) {
+    preheatFinished(cache, preheating, std::chrono::steady_clock::now(),
+        address, false, static_cast<T>(0));
+  }
+}
+
+void MrfMemoryCache::startRead(std::uint32_t address,
+    std::shared_ptr<MrfMemoryAccess::CallbackUInt16> callback) {
+  memoryAccess.readUInt16(address, callback);
+}
+
+void MrfMemoryCache::startRead(std::uint32_t address,
+    std::shared_ptr<MrfMemoryAccess::CallbackUInt32> callback) {
+  memoryAccess.readUInt32(address, callback);
+}
+
+bool MrfMemoryCache::takeScheduled(
+    std::unordered_set<std::uint32_t> &preheating,
+    std::unordered_set<std::uint32_t> &scheduled, std::uint32_t address) {
+  std::unique_lock<std::recursive_mutex> lock(mutex);
+  // While we wait for the number of reads in flight to drop below the limit,
+  // the read might be sent by a blocking read that needs the register.
+  preheatCv.wait(lock, [this, &scheduled, address]() {
+    return !scheduled.count(address)
+        || preheatingUInt16.size() + preheatingUInt32.size() < preheatLimit;
+  });
+  if (!scheduled.erase(address)) {
+    return false;
+  }
+  preheating.insert(address);
+  ++preheatStatistics.requested;
+  return true;
+}
+
+template<typename T>
+void MrfMemoryCache::verify(MrfConcurrentRegisterMap<T> &cache,
+    std::unordered_map<std::uint32_t, std::vector<CorrectionListener>>
+        &unverified, SnapshotVerificationResult &result) {
+  std::vector<std::uint32_t> addresses;
+  {
+    std::lock_guard<std::recursive_mutex> lock(mutex);
+    addresses.reserve(unverified.size());
+    for (auto &addressAndListeners : unverified) {
+      addresses.push_back(addressAndListeners.first);
+    }
+  }
+  std::sort(addresses.begin(), addresses.end());
+  // We combine contiguous registers into runs, so that each run can be
+  // verified with a single block read.
+  std::vector<std::pair<std::uint32_t, std::size_t>> runs;
+  for (std::uint32_t address : addresses) {
+    if (runs.empty() || runs.back().second == verifyBlockSize
+        || address != runs.back().first + runs.back().second * sizeof(T)) {
+      runs.emplace_back(address, 0);
+    }
+    ++runs.back().second;
+  }
+  std::unique_lock<std::recursive_mutex> lock(mutex);
+  for (auto &run : runs) {
+    preheatCv.wait(lock, [this]() {
+      return verifyingBlocks < preheatLimit;
+    });
+    ++verifyingBlocks;
+    // We must not hold the mutex while starting the read, because the callback
+    // might be called synchronously in the calling thread.
+    lock.unlock();
+    try {
+      startBlockRead(run.first, run.second,
+          std::make_shared<VerifyCallbackImpl<T>>(*this, cache, unverified,
+              result, run.second));
+    } catch (...) {
+      verifyFinished(cache, unverified, result,
+          std::chrono::steady_clock::now(), run.first, run.second, false,
+          std::vector<T>());
+    }
+    lock.lock();
+  }
+  preheatCv.wait(lock, [this]() {
+    return verifyingBlocks == 0;
+  });
+}
+
+template<typename T>
+void MrfMemoryCache::verifyFinished(MrfConcurrentRegisterMap<T> &cache,
+    std::unordered_map<std::uint32_t, std::vector<CorrectionListener>>
+        &unverified, SnapshotVerificationResult &result,
+    std::chrono::steady_clock::time_point startTime, std::uint32_t address,
+    std::size_t count, bool successful, const std::vector<T> &values) {
+  // The listeners are called after releasing the mutex, so that they can
+  // safely acquire other locks (e.g. the lock of a record).
+  std::vector<std::tuple<std::vector<CorrectionListener>, T, T>> corrections;
+  {
+    std::lock_guard<std::recursive_mutex> lock(mutex);
+    if (successful && values.size() != count) {
+      successful = false;
+    }
+    for (std::size_t i = 0; i < count; ++i) {
+      std::uint32_t elementAddress = address + i * sizeof(T);
+      auto unverifiedIterator = unverified.find(elementAddress);
+      if (unverifiedIterator == unverified.end()) {
+        continue;
+      }
+      std::vector<CorrectionListener> listeners = std::move(
+          unverifiedIterator->second);
+      unverified.erase(unverifiedIterator);
+      if (!successful) {
+        // We cannot tell whether the value is still valid, so we remove it.
+        // This way, the next read goes to the device.
+        cache.erase(elementAddress);
+        ++result.failed;
+        continue;
+      }
+      T cachedValue = 0;
+      bool cached = cache.find(elementAddress, cachedValue);
+      // Storing the value read from the device also records the time of the
+      // read, so that the value can be used for runtime reads. If the register
+      // has been written or invalidated after starting the read, the value
+      // from the snapshot is not in use any longer and there is nothing to
+      // correct.
+      bool stored = cache.storeIfNewer(elementAddress, values[i], startTime);
+      if (!stored || (cached && cachedValue == values[i])) {
+        ++result.verified;
+        continue;
+      }
+      corrections.emplace_back(std::move(listeners), cachedValue, values[i]);
+      ++result.corrected;
+    }
+    --verifyingBlocks;
+    preheatCv.notify_all();
+  }
+  for (auto &correction : corrections) {
+    for (auto &listener : std::get<0>(correction)) {
+      try {
+        listener(std::get<1>(correction), std::get<2>(correction));
+      } catch (...) {
+        // An exception in one listener must not keep the other listeners from
+        // being notified.
+      }
+    }
+  }
+}
+
+template<typename T>
+bool MrfMemoryCache::waitForPreheat(
+    MrfConcurrentRegisterMap<T> &cache,
+    std::unordered_set<std::uint32_t> &preheating,
+    std::unordered_set<std::uint32_t> &scheduled, std::uint32_t address,
+    T &value) {
+  // Access to the set of registers being preheated has to be protected by the
+  // mutex.
+  std::unique_lock<std::recursive_mutex> lock(mutex);
+  preheatCv.wait(lock, [this]() {
+    return !snapshotLoading;
+  });
+  // If the register is scheduled, but its read has not been sent yet, we send
+  // it now instead of waiting for its turn. We do this even if the preheat
+  // limit has been reached, because the caller cannot continue without the
+  // value.
+  if (scheduled.erase(address)) {
+    preheating.insert(address);
+    ++preheatStatistics.requested;
+    ++preheatStatistics.promoted;
+    lock.unlock();
+    startPreheatRead(cache, preheating, address);
+    lock.lock();
+  }
+  preheatCv.wait(lock, [this, &preheating, address]() {
+    return !snapshotLoading && !preheating.count(address);
+  });
+  return findUnexpired(cache, address, value);
+}
+
+void MrfMemoryCache::writeInvalidated(std::uint32_t address,
+    std::uint32_t length) {
+  if (!length) {
+    return;
+  }
+  invalidate(address, address + (length - 1));
+}
+
+void MrfMemoryCache::writeSucceeded(std::uint32_t address,
+    std::uint16_t value) {
+  auto now = std::chrono::steady_clock::now();
+  // A 32-bit register that overlaps the written register has changed as well,
+  // but we do not know its new value.
+  cacheUInt32.invalidate(address - std::min(address, 3u), address + 1, now);
+  cacheUInt16.store(address, value, now);
+}
+
+void MrfMemoryCache::writeSucceeded(std::uint32_t address,
+    std::uint32_t value) {
+  auto now = std::chrono::steady_clock::now();
+  // 16-bit registers that overlap the written register have changed as well.
+  // We do not derive their values, because we would have to make assumptions
+  // about the byte order.
+  cacheUInt16.invalidate(address - std::min(address, 1u), address + 3, now);
+  cacheUInt32.store(address, value, now);
+}
+
 }
 }
 }
@@ -30,13 +30,26 @@
 #ifndef ANKA_MRF_EPICS_MEMORY_CACHE_H
 #define ANKA_MRF_EPICS_MEMORY_CACHE_H
 
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
 #include <cstdint>
+#include <functional>
 #include <map>
+#include <memory>
 #include <mutex>
+#include <string>
 #include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
 
+#include <MrfConsistentMemoryAccess.h>
 #include <MrfMemoryAccess.h>
 
+#include "MrfConcurrentRegisterMap.h"
+
 namespace anka {
 namespace mrf {
 namespace epics {
@@ -54,11 +67,127 @@ namespace epics {
  * access (e.g. one using the UDP/IP protocol) does not slow down the
  * initialization of many records that refer to the same register (e.g. a
  * register that acts as a bit field).
+ *
+ * The cached values are stored in a {@link MrfConcurrentRegisterMap}, so
+ * reading a value that is already cached does not acquire any lock. The mutex
+ * is only needed for the bookkeeping of preheating and snapshots.
+ *
+ * The cache can be preheated asynchronously. Preheat reads are sent to the
+ * memory access without waiting for earlier reads to finish, up to a
+ * configurable number of reads in flight, and their results are inserted into
+ * the cache as they arrive. A blocking read of an address that is being
+ * preheated waits for that specific read instead of sending a second request.
+ * Registers can also be scheduled for preheating as a whole list before the
+ * first read is sent. The reads are then sent in the order of the list, and a
+ * blocking read of a scheduled register that has not been sent yet sends that
+ * read right away, so that the caller only waits for the registers it actually
+ * needs.
+ *
+ * After initialization, the cache can also serve reads at runtime. For this
+ * purpose, a time-to-live (TTL) can be configured for ranges of addresses.
+ * Asynchronous reads of an address with a non-zero TTL are served from the
+ * cache as long as the cached value is not older than the TTL. Static
+ * configuration registers typically use an infinite TTL, while status registers
+ * use a short TTL or none at all. The cache is kept coherent with the device by
+ * registering the listener returned by {@link #getWriteListener()} with the
+ * consistent memory access that is used for writing: values written to the
+ * device are stored in the cache (write-through) and registers affected by a
+ * failed or block write are invalidated. Registers that the device changes by
+ * itself cannot be tracked, so they should not have an infinite TTL. They can
+ * also be invalidated explicitly.
  */
 class MrfMemoryCache {
 
 public:
 
+  /**
+   * Listener that is notified when the verification of a value that has been
+   * loaded from a snapshot finds that the device stores a different value. The
+   * first argument is the value from the snapshot, the second argument is the
+   * value read from the device. Both values are passed as 32-bit values, even
+   * for 16-bit registers.
+   */
+  using CorrectionListener = std::function<void(std::uint32_t, std::uint32_t)>;
+
+  /**
+   * Default for the maximum number of preheat reads that are in flight at the
+   * same time.
+   */
+  static constexpr std::size_t defaultPreheatLimit = 64;
+
+  /**
+   * TTL that marks cached values as valid until they are overwritten or
+   * invalidated.
+   */
+  static constexpr std::chrono::steady_clock::duration infiniteTtl =
+      std::chrono::steady_clock::duration::max();
+
+  /**
+   * Statistics about the preheating of the cache.
+   */
+  struct PreheatStatistics {
+
+    /**
+     * Number of preheat reads that have been sent to the memory access.
+     */
+    std::size_t requested;
+
+    /**
+     * Number of preheat reads that have finished successfully.
+     */
+    std::size_t succeeded;
+
+    /**
+     * Number of preheat reads that have failed.
+     */
+    std::size_t failed;
+
+    /**
+     * Number of preheat reads that have been sent ahead of their turn because
+     * a blocking read needed the register.
+     */
+    std::size_t promoted;
+
+    /**
+     * Tells whether preheating has finished. This is only true after
+     * {@link MrfMemoryCache::finishPreheating()} has been called and all
+     * preheat reads have finished.
+     */
+    bool finished;
+
+    /**
+     * Time (in microseconds) from the first preheat read until all preheat
+     * reads had finished. If preheating has not finished yet, this is the time
+     * that has passed since the first preheat read.
+     */
+    std::uint64_t wallTimeMicroseconds;
+
+  };
+
+  /**
+   * Result of verifying the values that have been loaded from a snapshot.
+   */
+  struct SnapshotVerificationResult {
+
+    /**
+     * Number of values that matched the values stored in the device.
+     */
+    std::size_t verified;
+
+    /**
+     * Number of values that differed from the values stored in the device and
+     * have been corrected.
+     */
+    std::size_t corrected;
+
+    /**
+     * Number of values that could not be read from the device. These values
+     * are removed from the cache.
+     */
+    std::size_t failed;
+
+  };
+
   /**
    * Creates a cache using the specified memory-access. The wrapped memory
    * access must be kept alive until this cache is not used any longer.
@@ -71,6 +200,52 @@ public:
    */
   explicit MrfMemoryCache(std::shared_ptr<MrfMemoryAccess> memoryAccess);
 
+  /**
+   * Registers a listener for an unsigned 16-bit register that is notified if
+   * the value loaded from a snapshot does not match the value stored in the
+   * device. If the cached value for the address has not been loaded from a
+   * snapshot or has already been verified, the listener is not registered and
+   * {@code false} is returned. Listeners have to be registered before
+   * {@link #verifySnapshot()} is called. They are called from the thread that
+   * verifies the snapshot, without holding the cache's mutex.
+   */
+  bool addCorrectionListenerUInt16(std::uint32_t address,
+      CorrectionListener listener);
+
+  /**
+   * Registers a listener for an unsigned 32-bit register that is notified if
+   * the value loaded from a snapshot does not match the value stored in the
+   * device. If the cached value for the address has not been loaded from a
+   * snapshot or has already been verified, the listener is not registered and
+   * {@code false} is returned. Listeners have to be registered before
+   * {@link #verifySnapshot()} is called. They are called from the thread that
+   * verifies the snapshot, without holding the cache's mutex.
+   */
+  bool addCorrectionListenerUInt32(std::uint32_t address,
+      CorrectionListener listener);
+
+  /**
+   * Marks the start of loading a snapshot. Until
+   * {@link #finishSnapshotLoad()} is called, reads and preheat reads wait, so
+   * that registers contained in the snapshot are not read from the device.
+   * This allows a snapshot to be loaded in a background thread.
+   */
+  void beginSnapshotLoad();
+
+  /**
+   * Marks the end of preheating and blocks until all preheat reads have
+   * finished. This method has to be called after the last preheat read has
+   * been started and before the cache is destroyed.
+   */
+  void finishPreheating();
+
+  /**
+   * Marks the end of loading a snapshot, waking up reads that are waiting for
+   * the snapshot. This method has to be called after
+   * {@link #beginSnapshotLoad()}, even if loading the snapshot failed.
+   */
+  void finishSnapshotLoad();
+
   /**
    * Returns a snapshot of the cache for uint16 values. The returned map is a
    * copy of the cache at the time of calling this method and does not receive
@@ -89,6 +264,79 @@ public:
    */
   std::map<std::uint32_t, std::uint32_t> getCacheUInt32() const;
 
+  /**
+   * Returns the maximum number of preheat reads that are in flight at the same
+   * time.
+   */
+  std::size_t getPreheatLimit() const;
+
+  /**
+   * Returns statistics about the preheating of the cache.
+   */
+  PreheatStatistics getPreheatStatistics() const;
+
+  /**
+   * Returns the TTL that applies to runtime reads of the specified address. If
+   * no TTL has been configured for the address, zero is returned, meaning that
+   * runtime reads of the address are not served from the cache.
+   */
+  std::chrono::steady_clock::duration getTtl(std::uint32_t address) const;
+
+  /**
+   * Returns the listener that keeps the cache coherent with writes to the
+   * device. It has to be registered with the consistent memory access that is
+   * used for writing to the device. The listener only keeps a reference to this
+   * cache, but it is owned by the cache, so it is destroyed together with it.
+   */
+  std::shared_ptr<MrfConsistentMemoryAccess::WriteListener> getWriteListener();
+
+  /**
+   * Removes the cached values of all registers that overlap the range from
+   * {@code firstAddress} to {@code lastAddress} (inclusive), so that the next
+   * read of these registers goes to the device. Reads that have been started
+   * before calling this method do not put their (possibly outdated) values
+   * back into the cache. Returns the number of values that have been removed.
+   */
+  std::size_t invalidate(std::uint32_t firstAddress, std::uint32_t lastAddress);
+
+  /**
+   * Loads the cache contents from the specified snapshot file. The key has to
+   * match the key that has been specified when saving the snapshot. Typically,
+   * it is the firmware version of the device, so that a snapshot is not used
+   * with a different firmware. Returns {@code true} if the snapshot has been
+   * loaded and {@code false} if the file does not exist or has been saved with
+   * a different key. Throws an exception if the file cannot be read or is
+   * malformed. Values that are already in the cache are not replaced. All
+   * other values are marked as unverified.
+   */
+  bool loadSnapshot(const std::string &fileName, std::uint32_t key);
+
+  /**
+   * Sends the preheat reads for those registers from the specified list that
+   * have been scheduled by {@link #schedulePreheat(...)} and have not been
+   * read yet. The reads are sent in the order of the list. Errors are silently
+   * ignored. This method only blocks when the maximum number of preheat reads
+   * is in flight.
+   */
+  void preheatScheduled(
+      const std::vector<std::pair<std::uint32_t, bool>> &registers);
+
+  /**
+   * Starts an asynchronous read of an unsigned 16-bit register in order to
+   * warm up the cache. If the register is already cached or is being read, this
+   * method does nothing. Errors are silently ignored. This method only blocks
+   * when the maximum number of preheat reads is in flight.
+   */
+  void preheatUInt16(std::uint32_t address);
+
+  /**
+   * Starts an asynchronous read of an unsigned 32-bit register in order to
+   * warm up the cache. If the register is already cached or is being read, this
+   * method does nothing. Errors are silently ignored. This method only blocks
+   * when the maximum number of preheat reads is in flight.
+   */
+  void preheatUInt32(std::uint32_t address);
+
   /**
    * Reads from an unsigned 16-bit register. The method blocks until the
    * operation has finished (either successfully or unsuccessfully). On success,
@@ -96,10 +344,25 @@ public:
    * an exception is thrown. If the value for the specified address is in the
    * cache, the cached value is returned. Otherwise, this method delegates the
    * read operation to the memory access which has been passed to the
-   * constructor and caches the read value for subsequent read operations.
+   * constructor and caches the read value for subsequent read operations. If
+   * a TTL has been configured for the address (see {@link #setTtl(
+   * std::uint32_t, std::uint32_t, std::chrono::steady_clock::duration)}), a
+   * cached value that is older than the TTL is not used.
    */
   std::uint16_t readUInt16(std::uint32_t address);
 
+  /**
+   * Reads from an unsigned 16-bit register asynchronously. If the cached value
+   * for the specified address is not older than the specified TTL, it is
+   * passed to the callback before this method returns. Otherwise, the register
+   * is read from the memory access and the value is stored in the cache before
+   * passing it to the callback. Values whose age is not known (e.g. values
+   * loaded from a snapshot that have not been verified yet) are never used.
+   */
+  void readUInt16(std::uint32_t address,
+      std::chrono::steady_clock::duration ttl,
+      std::shared_ptr<MrfMemoryAccess::CallbackUInt16> callback);
+
   /**
    * Reads from an unsigned 32-bit register. The method blocks until the
    * operation has finished (either successfully or unsuccessfully). On success,
@@ -107,10 +370,69 @@ public:
    * an exception is thrown.   If the value for the specified address is in the
    * cache, the cached value is returned. Otherwise, this method delegates the
    * read operation to the memory access which has been passed to the
-   * constructor and caches the read value for subsequent read operations.
+   * constructor and caches the read value for subsequent read operations. If
+   * a TTL has been configured for the address (see {@link #setTtl(
+   * std::uint32_t, std::uint32_t, std::chrono::steady_clock::duration)}), a
+   * cached value that is older than the TTL is not used.
    */
   std::uint32_t readUInt32(std::uint32_t address);
 
+  /**
+   * Reads from an unsigned 32-bit register asynchronously. If the cached value
+   * for the specified address is not older than the specified TTL, it is
+   * passed to the callback before this method returns. Otherwise, the register
+   * is read from the memory access and the value is stored in the cache before
+   * passing it to the callback. Values whose age is not known (e.g. values
+   * loaded from a snapshot that have not been verified yet) are never used.
+   */
+  void readUInt32(std::uint32_t address,
+      std::chrono::steady_clock::duration ttl,
+      std::shared_ptr<MrfMemoryAccess::CallbackUInt32> callback);
+
+  /**
+   * Saves the cache contents to the specified snapshot file, associating them
+   * with the specified key. Values that have been loaded from a snapshot and
+   * have not been verified yet are not saved. The file is first written under
+   * a temporary name and then renamed, so that an existing snapshot is only
+   * replaced if the new one has been written successfully. Throws an
+   * exception if the file cannot be written.
+   */
+  void saveSnapshot(const std::string &fileName, std::uint32_t key) const;
+
+  /**
+   * Schedules a list of registers for preheating. Each entry consists of the
+   * memory address and a flag telling whether the register is a 32-bit
+   * register. Registers that are already cached or being read are skipped.
+   * This method does not send any reads, so it returns quickly. The reads
+   * have to be sent by calling {@link #preheatScheduled(...)} with the same
+   * list, typically from a separate thread. A blocking read of a scheduled
+   * register sends the read for that register right away instead of waiting
+   * for its turn, so a caller only ever waits for the registers it needs.
+   * {@link #finishPreheating()} waits until all scheduled registers have been
+   * read.
+   */
+  void schedulePreheat(
+      const std::vector<std::pair<std::uint32_t, bool>> &registers);
+
+  /**
+   * Sets the maximum number of preheat reads that are in flight at the same
+   * time. This should be called before the first preheat read is started. The
+   * limit must be at least one.
+   */
+  void setPreheatLimit(std::size_t limit);
+
+  /**
+   * Sets the TTL for runtime reads of the registers from {@code firstAddress}
+   * to {@code lastAddress} (inclusive). If the range overlaps with a range that
+   * has been configured earlier, the TTL specified last takes precedence. A TTL
+   * of zero disables serving runtime reads from the cache and
+   * {@link #infiniteTtl} makes cached values valid until they are overwritten
+   * or invalidated. Records determine the TTL when they are initialized, so
+   * this method should be called before iocInit.
+   */
+  void setTtl(std::uint32_t firstAddress, std::uint32_t lastAddress,
+      std::chrono::steady_clock::duration ttl);
+
   /**
    * Tries to read an unsigned 16-bit register. If the read attempt fails, the
    * error is silently ignored. This method is intended to warm up the cache, so
@@ -127,8 +449,44 @@ public:
    */
   void tryCacheUInt32(std::uint32_t address);
 
+  /**
+   * Compares all values that have been loaded from a snapshot and have not
+   * been verified yet with the values stored in the device. Contiguous
+   * registers are read with block reads, which are sent without waiting for
+   * earlier ones to finish (up to the preheat limit). Values that differ are
+   * updated in the cache and the correction listeners registered for them are
+   * notified. This method blocks until all values have been verified. If a
+   * snapshot is being loaded, it waits for the load to finish first.
+   */
+  SnapshotVerificationResult verifySnapshot();
+
 private:
 
+  template<typename T>
+  class PreheatCallbackImpl;
+
+  template<typename T>
+  class ReadCallbackImpl;
+
+  template<typename T>
+  class VerifyCallbackImpl;
+
+  class WriteListenerImpl;
+
+  /**
+   * Range of addresses sharing the same TTL.
+   */
+  struct TtlRange {
+    std::uint32_t firstAddress;
+    std::uint32_t lastAddress;
+    std::chrono::steady_clock::duration ttl;
+  };
+
+  /**
+   * Maximum number of registers that are verified with a single block read.
+   */
+  static constexpr std::size_t verifyBlockSize = 256;
+
   // We do not want to allow copy or move construction or assignment.
   MrfMemoryCache(const MrfMemoryCache &) = delete;
   MrfMemoryCache(MrfMemoryCache &&) = delete;
@@ -140,8 +498,120 @@ private:
 
   mutable std::recursive_mutex mutex;
 
-  std::unordered_map<std::uint32_t, std::uint16_t> cacheUInt16;
-  std::unordered_map<std::uint32_t, std::uint32_t> cacheUInt32;
+  /**
+   * Condition variable that is notified (while holding the mutex) each time a
+   * preheat read has finished.
+   */
+  std::condition_variable_any preheatCv;
+
+  MrfConcurrentRegisterMap<std::uint16_t> cacheUInt16;
+  MrfConcurrentRegisterMap<std::uint32_t> cacheUInt32;
+
+  /**
+   * Addresses of values that have been loaded from a snapshot and have not
+   * been verified yet, together with the correction listeners registered for
+   * them.
+   */
+  std::unordered_map<std::uint32_t, std::vector<CorrectionListener>>
+      unverifiedUInt16;
+  std::unordered_map<std::uint32_t, std::vector<CorrectionListener>>
+      unverifiedUInt32;
+
+  std::unordered_set<std::uint32_t> preheatingUInt16;
+  std::unordered_set<std::uint32_t> preheatingUInt32;
+  /**
+   * Addresses that have been scheduled by schedulePreheat(...), but for which
+   * the preheat read has not been sent yet.
+   */
+  std::unordered_set<std::uint32_t> scheduledUInt16;
+  std::unordered_set<std::uint32_t> scheduledUInt32;
+  std::size_t preheatLimit;
+  PreheatStatistics preheatStatistics;
+  bool preheatStarted;
+  std::chrono::steady_clock::time_point preheatStartTime;
+  std::chrono::steady_clock::time_point preheatEndTime;
+  /**
+   * Tells whether a snapshot is being loaded. This is only modified while
+   * holding the mutex, but it is atomic so that reads can check it without
+   * acquiring the mutex.
+   */
+  std::atomic<bool> snapshotLoading;
+  std::size_t verifyingBlocks;
+
+  /**
+   * TTL ranges in the order in which they have been configured.
+   */
+  std::vector<TtlRange> ttlRanges;
+
+  std::shared_ptr<WriteListenerImpl> writeListener;
+
+  bool addCorrectionListener(
+      std::unordered_map<std::uint32_t, std::vector<CorrectionListener>>
+          &unverified, std::uint32_t address, CorrectionListener listener);
+
+  template<typename T>
+  bool findUnexpired(MrfConcurrentRegisterMap<T> &cache,
+      std::uint32_t address, T &value) const;
+
+  template<typename T>
+  bool preheat(MrfConcurrentRegisterMap<T> &cache,
+      std::unordered_set<std::uint32_t> &preheating,
+      const std::unordered_set<std::uint32_t> &scheduled,
+      std::uint32_t address);
+
+  template<typename T>
+  void preheatFinished(MrfConcurrentRegisterMap<T> &cache,
+      std::unordered_set<std::uint32_t> &preheating,
+      std::chrono::steady_clock::time_point startTime, std::uint32_t address,
+      bool successful, T value);
+
+  void startBlockRead(std::uint32_t address, std::size_t count,
+      std::shared_ptr<MrfMemoryAccess::BlockCallbackUInt16> callback);
+
+  void startBlockRead(std::uint32_t address, std::size_t count,
+      std::shared_ptr<MrfMemoryAccess::BlockCallbackUInt32> callback);
+
+  template<typename T>
+  void readRuntime(MrfConcurrentRegisterMap<T> &cache, std::uint32_t address,
+      std::chrono::steady_clock::duration ttl,
+      std::shared_ptr<MrfMemoryAccess::Callback<T>> callback);
+
+  template<typename T>
+  void startPreheatRead(MrfConcurrentRegisterMap<T> &cache,
+      std::unordered_set<std::uint32_t> &preheating, std::uint32_t address);
+
+  void startRead(std::uint32_t address,
+      std::shared_ptr<MrfMemoryAccess::CallbackUInt16> callback);
+
+  void startRead(std::uint32_t address,
+      std::shared_ptr<MrfMemoryAccess::CallbackUInt32> callback);
+
+  bool takeScheduled(std::unordered_set<std::uint32_t> &preheating,
+      std::unordered_set<std::uint32_t> &scheduled, std::uint32_t address);
+
+  template<typename T>
+  void verify(MrfConcurrentRegisterMap<T> &cache,
+      std::unordered_map<std::uint32_t, std::vector<CorrectionListener>>
+          &unverified, SnapshotVerificationResult &result);
+
+  template<typename T>
+  void verifyFinished(MrfConcurrentRegisterMap<T> &cache,
+      std::unordered_map<std::uint32_t, std::vector<CorrectionListener>>
+          &unverified, SnapshotVerificationResult &result,
+      std::chrono::steady_clock::time_point startTime, std::uint32_t address,
+      std::size_t count, bool successful, const std::vector<T> &values);
+
+  template<typename T>
+  bool waitForPreheat(MrfConcurrentRegisterMap<T> &cache,
+      std::unordered_set<std::uint32_t> &preheating,
+      std::unordered_set<std::uint32_t> &scheduled, std::uint32_t address,
+      T &value);
+
+  void writeInvalidated(std::uint32_t address, std::uint32_t length);
+
+  void writeSucceeded(std::uint32_t address, std::uint16_t value);
+
+  void writeSucceeded(std::uint32_t address, std::uint32_t value);
 
 };
 
@@ -30,11 +30,18 @@
 #ifndef ANKA_MRF_EPICS_OUTPUT_RECORD_H
 #define ANKA_MRF_EPICS_OUTPUT_RECORD_H
 
+#include <cstddef>
+#include <memory>
+#include <mutex>
 #include <stdexcept>
+#include <string>
 
 #include <alarm.h>
+#include <dbLock.h>
 #include <recGbl.h>
 
+#include "MrfLazyInitializer.h"
+#include "MrfPostedWriteStatus.h"
 #include "MrfRecord.h"
 #include "mrfEpicsError.h"
 
@@ -44,10 +51,35 @@ namespace epics {
 
 /**
  * Base class for most device support classes belonging to EPICS input records.
+ *
+ * When the record address specifies the <code>posted_write</code> flag, the
+ * record completes processing as soon as the write has been queued. Every
+ * value is written, and the writes are applied in the order in which they have
+ * been queued, because the memory access runs overlapping operations in that
+ * order. Up to {@link #maxPostedWritesInProgress} writes of a record can be in
+ * progress at the same time. When the record is processed while this many
+ * writes are in progress, the value is not written and the record goes into
+ * an alarm state.
  */
 template<typename RecordType>
 class MrfOutputRecord: public MrfRecord<RecordType> {
 
+public:
+
+  /**
+   * Called each time the record is processed. If the record address specifies
+   * the <code>posted_write</code> flag, the write is queued and the record
+   * completes processing synchronously. Otherwise, the record is processed
+   * asynchronously.
+   */
+  virtual void processRecord();
+
+  /**
+   * Maximum number of posted writes of a single record that can be in progress
+   * at the same time.
+   */
+  static constexpr std::size_t maxPostedWritesInProgress = 64;
+
 protected:
 
   /**
@@ -65,12 +97,26 @@ protected:
   /**
    * Initializes the records value with the current value read from the device.
    * If the record address specifies that no initialization is desired, the
-   * initialization is skipped. This is not part of the constructor because
+   * initialization is skipped. If it specifies lazy initialization, the value
+   * is read after iocInit has finished. This is not part of the constructor because
    * the virtual {@link #writeRecordValue(std::uint32_t)} method has to be
    * called which is not possible from the base constructor.
    */
   void initializeValue();
 
+  /**
+   * Corrects the record's value after the value that has been used for
+   * initializing the record turned out to be outdated. This is called with
+   * the record locked and only if the record has not been processed since it
+   * was initialized. Implementations have to update the record's value fields
+   * and post the respective monitors. They return {@code true} if the record
+   * has been corrected. The default implementation returns {@code false},
+   * which is appropriate for record types where the value cannot be derived
+   * from the raw value without the help of the record support. In this case,
+   * the record is marked as undefined instead.
+   */
+  virtual bool correctRecordValue(std::uint32_t value);
+
   /**
    * Reads and returns the record's current value.
    */
@@ -84,7 +130,8 @@ private:
 
   template<typename T>
   struct CallbackImpl: MrfMemoryAccess::Callback<T> {
-    CallbackImpl(MrfOutputRecord &record);
+    CallbackImpl(MrfOutputRecord &record, bool posted,
+        std::uint32_t requestValue);
     void success(std::uint32_t address, T value);
     void failure(std::uint32_t address, MrfMemoryAccess::ErrorCode errorCode,
         const std::string &details);
@@ -92,6 +139,8 @@ private:
     // In EPICS, records are never destroyed. Therefore, we can safely keep a
     // reference to the device support object.
     MrfOutputRecord &record;
+    bool posted;
+    std::uint32_t requestValue;
   };
 
   // We do not want to allow copy or move construction or assignment.
@@ -105,106 +154,376 @@ private:
   std::uint32_t writeReplyValue;
   std::string writeErrorMessage;
 
+  /**
+   * Tells whether the record has been processed since it was initialized.
+   * This is only accessed while holding the record's lock.
+   */
+  bool processed;
+
+  /**
+   * Status that posted-write failures are reported to. Null if the record
+   * address does not specify the <code>posted_write</code> flag.
+   */
+  std::shared_ptr<MrfPostedWriteStatus> postedWriteStatus;
+
+  /**
+   * Mutex protecting the state of the posted writes.
+   */
+  std::mutex postedWriteMutex;
+  std::size_t postedWritesInProgress;
+  bool postedWriteFailed;
+  std::string postedWriteErrorMessage;
+
+  /**
+   * Called when the value that has been used for initializing the record was
+   * loaded from a cache snapshot and the device turned out to store a different
+   * value.
+   */
+  void initialValueCorrected(std::uint32_t oldValue, std::uint32_t newValue);
+
+  /**
+   * Reads the initial value from the device and updates the record if it has
+   * not been processed yet. This is called by the {@link MrfLazyInitializer}
+   * after iocInit if the record address specifies the <code>lazy_init</code>
+   * flag. It relies on {@link #correctRecordValue(std::uint32_t)}, so the
+   * record stays undefined for record types that do not support correcting
+   * the value.
+   */
+  void lazyInitializeValue();
+
+  /**
+   * Reads the record's initial value through the device's memory cache and
+   * registers the listener that corrects the record's value if the value read
+   * turns out to be outdated. Returns the value converted with
+   * {@link #convertFromDevice(std::uint32_t)}.
+   */
+  std::uint32_t readInitialValue();
+
+  /**
+   * Queues a write of the specified value. The callback is created with the
+   * specified posted flag.
+   */
+  void startWrite(std::uint32_t value, bool posted);
+
+  /**
+   * Queues a posted write of the specified value. Exceptions are not passed on
+   * to the caller, but are handled like a failed write.
+   */
+  void startPostedWrite(std::uint32_t value);
+
+  /**
+   * Called when a posted write has finished. Reports a failure, so that it is
+   * signaled the next time the record is processed.
+   */
+  void postedWriteFinished(std::uint32_t requestValue, bool successful,
+      std::uint32_t replyValue, const std::string &errorMessage);
+
 };
 
 template<typename RecordType>
 MrfOutputRecord<RecordType>::MrfOutputRecord(RecordType *record) :
     MrfRecord<RecordType>(record, record->out), writeSuccessful(false), writeRequestValue(
-        0), writeReplyValue(0) {
+        0), writeReplyValue(0), processed(false), postedWritesInProgress(0),
+        postedWriteFailed(false) {
+  // Output records never read periodically or share read results, so these
+  // options would be silently ignored.
+  if (!this->getRecordAddress().getPollGroupId().empty()) {
+    throw std::runtime_error("Output records do not support poll groups.");
+  }
+  if (this->getRecordAddress().getMaxAge().count() > 0) {
+    throw std::runtime_error(
+        "Output records do not support the max_age option.");
+  }
+  if (this->getRecordAddress().isPostedWrite()) {
+    postedWriteStatus = MrfDeviceRegistry::getInstance().getPostedWriteStatus(
+        this->getRecordAddress().getDeviceId());
+  }
 }
 
 template<typename RecordType>
 void MrfOutputRecord<RecordType>::initializeValue() {
-  if (this->getRecordAddress().isReadOnInit()) {
-    // We try to read the value from the device, so that we can initialize the
-    // record’s value. If this fails, we do not let the exception bubble up,
-    // because we still want the record to be initialized (so that it can be
-    // processed later). In this case, the record will simply stay in an
-    // undefined state (associated with an invalid alarm) until it is
-    // successfully processed for the first time.
-    try {
-      std::shared_ptr<MrfMemoryCache> deviceCache =
-          MrfDeviceRegistry::getInstance().getDeviceCache(
-              this->getRecordAddress().getDeviceId());
-      if (!deviceCache) {
-        throw std::runtime_error(
-            std::string("Could not find cache for device ")
-                + this->getRecordAddress().getDeviceId() + ".");
+  if (!this->getRecordAddress().isReadOnInit()) {
+    return;
+  }
+  if (this->getRecordAddress().isLazyInit()) {
+    // The record stays undefined until the value has been read after iocInit.
+    // Records are never destroyed, so we can safely capture this.
+    MrfLazyInitializer::schedule([this]() {
+      this->lazyInitializeValue();
+    });
+    return;
+  }
+  // We try to read the value from the device, so that we can initialize the
+  // record’s value. If this fails, we do not let the exception bubble up,
+  // because we still want the record to be initialized (so that it can be
+  // processed later). In this case, the record will simply stay in an
+  // undefined state (associated with an invalid alarm) until it is
+  // successfully processed for the first time.
+  try {
+    this->writeRecordValue(readInitialValue());
+  } catch (std::exception &e) {
+    errorExtendedPrintf(
+        "%s Reading initial value from device failed: %s",
+        this->getRecord()->name,
+        e.what());
+    return;
+  } catch (...) {
+    errorExtendedPrintf(
+        "%s Reading initial value from device failed: Unknown error.",
+        this->getRecord()->name);
+    return;
+  }
+  // The record's value has been initialized, therefore it is not undefined
+  // any longer.
+  this->getRecord()->udf = false;
+  // We have to reset the alarm state explicitly, so that the record is not
+  // marked as invalid. This is not optimal because the record will not be
+  // placed in an alarm state if the value would usually trigger an alarm.
+  // However, alarms on output records are uncommon and we do not use them
+  // for the EVG or EVR, so this is fine. We also update the time stamp so
+  // that it represents the current time.
+  recGblGetTimeStamp(this->getRecord());
+  recGblResetAlarms(this->getRecord());
+}
+
+template<typename RecordType>
+bool MrfOutputRecord<RecordType>::correctRecordValue(std::uint32_t) {
+  return false;
+}
+
+template<typename RecordType>
+void MrfOutputRecord<RecordType>::initialValueCorrected(std::uint32_t oldValue,
+    std::uint32_t newValue) {
+  // The register might contain bits that do not belong to this record.
+  if (this->convertFromDevice(oldValue) == this->convertFromDevice(newValue)) {
+    return;
+  }
+  ::dbCommon *record = reinterpret_cast<::dbCommon *>(this->getRecord());
+  ::dbScanLock(record);
+  try {
+    // If the record has been processed, its value has been written to the
+    // device, so the value stored in the device is not relevant any longer.
+    if (!processed) {
+      if (this->correctRecordValue(this->convertFromDevice(newValue))) {
+        errorExtendedPrintf(
+            "%s The value loaded from the cache snapshot was outdated, so the record has been updated with the value from the device.",
+            record->name);
+        recGblGetTimeStamp(this->getRecord());
+      } else {
+        errorExtendedPrintf(
+            "%s The value loaded from the cache snapshot was outdated, so the record is marked as undefined until it is processed.",
+            record->name);
+        record->udf = true;
+        recGblSetSevr(this->getRecord(), UDF_ALARM, INVALID_ALARM);
+        recGblResetAlarms(this->getRecord());
       }
-      switch (this->getRecordAddress().getDataType()) {
-      case MrfRecordAddress::DataType::uInt16:
-        this->writeRecordValue(
-            this->convertFromDevice(
-                deviceCache->readUInt16(
-                    this->getRecordAddress().getMemoryAddress())));
-        break;
-      case MrfRecordAddress::DataType::uInt32:
-        this->writeRecordValue(
-            this->convertFromDevice(
-                deviceCache->readUInt32(
-                    this->getRecordAddress().getMemoryAddress())));
-        break;
+    }
+  } catch (...) {
+    ::dbScanUnlock(record);
+    throw;
+  }
+  ::dbScanUnlock(record);
+}
+
+template<typename RecordType>
+void MrfOutputRecord<RecordType>::lazyInitializeValue() {
+  ::dbCommon *record = reinterpret_cast<::dbCommon *>(this->getRecord());
+  std::uint32_t value;
+  try {
+    value = readInitialValue();
+  } catch (std::exception &e) {
+    errorExtendedPrintf(
+        "%s Reading initial value from device failed: %s",
+        record->name,
+        e.what());
+    return;
+  } catch (...) {
+    errorExtendedPrintf(
+        "%s Reading initial value from device failed: Unknown error.",
+        record->name);
+    return;
+  }
+  ::dbScanLock(record);
+  try {
+    // If the record has been processed in the meantime, its value has been
+    // written to the device, so the value that we read is not relevant any
+    // longer.
+    if (!processed) {
+      if (this->correctRecordValue(value)) {
+        recGblGetTimeStamp(this->getRecord());
+        recGblResetAlarms(this->getRecord());
+      } else {
+        errorExtendedPrintf(
+            "%s The record type does not support lazy initialization, so the record stays undefined until it is processed.",
+            record->name);
       }
-    } catch (std::exception &e) {
-      errorExtendedPrintf(
-          "%s Reading initial value from device failed: %s",
-          this->getRecord()->name,
-          e.what());
-      return;
-    } catch (...) {
-      errorExtendedPrintf(
-          "%s Reading initial value from device failed: Unknown error.",
-          this->getRecord()->name);
-      return;
     }
-    // The record's value has been initialized, therefore it is not undefined
-    // any longer.
-    this->getRecord()->udf = false;
-    // We have to reset the alarm state explicitly, so that the record is not
-    // marked as invalid. This is not optimal because the record will not be
-    // placed in an alarm state if the value would usually trigger an alarm.
-    // However, alarms on output records are uncommon and we do not use them
-    // for the EVG or EVR, so this is fine. We also update the time stamp so
-    // that it represents the current time.
-    recGblGetTimeStamp(this->getRecord());
-    recGblResetAlarms(this->getRecord());
+  } catch (...) {
+    ::dbScanUnlock(record);
+    throw;
+  }
+  ::dbScanUnlock(record);
+}
+
+template<typename RecordType>
+std::uint32_t MrfOutputRecord<RecordType>::readInitialValue() {
+  std::shared_ptr<MrfMemoryCache> deviceCache =
+      MrfDeviceRegistry::getInstance().getDeviceCache(
+          this->getRecordAddress().getDeviceHandle());
+  if (!deviceCache) {
+    throw std::runtime_error(
+        std::string("Could not find cache for device ")
+            + this->getRecordAddress().getDeviceId() + ".");
+  }
+  // If the value has been loaded from a cache snapshot, it might turn out to
+  // be outdated when the snapshot is verified. In this case, we want to
+  // correct the record's value. Records are never destroyed, so we can safely
+  // capture this.
+  MrfMemoryCache::CorrectionListener correctionListener =
+      [this](std::uint32_t oldValue, std::uint32_t newValue) {
+        this->initialValueCorrected(oldValue, newValue);
+      };
+  std::uint32_t value = 0;
+  switch (this->getRecordAddress().getDataType()) {
+  case MrfRecordAddress::DataType::uInt16:
+    value = deviceCache->readUInt16(
+        this->getRecordAddress().getMemoryAddress());
+    deviceCache->addCorrectionListenerUInt16(
+        this->getRecordAddress().getMemoryAddress(), correctionListener);
+    break;
+  case MrfRecordAddress::DataType::uInt32:
+    value = deviceCache->readUInt32(
+        this->getRecordAddress().getMemoryAddress());
+    deviceCache->addCorrectionListenerUInt32(
+        this->getRecordAddress().getMemoryAddress(), correctionListener);
+    break;
+  }
+  return this->convertFromDevice(value);
+}
+
+template<typename RecordType>
+void MrfOutputRecord<RecordType>::processRecord() {
+  processed = true;
+  if (!postedWriteStatus) {
+    MrfRecord<RecordType>::processRecord();
+    return;
+  }
+  std::uint32_t value = this->convertToDevice(this->readRecordValue());
+  bool failed;
+  std::string errorMessage;
+  bool queueFull;
+  {
+    std::lock_guard<std::mutex> lock(postedWriteMutex);
+    queueFull = (postedWritesInProgress >= maxPostedWritesInProgress);
+    // If the queue is full, an earlier failure is reported the next time the
+    // record is processed.
+    failed = !queueFull && postedWriteFailed;
+    if (failed) {
+      postedWriteFailed = false;
+      errorMessage.swap(postedWriteErrorMessage);
+    }
+    if (!queueFull) {
+      ++postedWritesInProgress;
+    }
+  }
+  if (queueFull) {
+    // We do not drop an older value in favor of the new one because for some
+    // registers (e.g. commands), every single write matters.
+    errorExtendedPrintf(
+        "%s Posted write failed: Too many posted writes in progress.",
+        this->getRecord()->name);
+    postedWriteStatus->reportFailure();
+    recGblSetSevr(this->getRecord(), WRITE_ALARM, INVALID_ALARM);
+    throw std::runtime_error(
+        "The value has not been written because too many posted writes are in progress.");
+  }
+  // The record is locked while it is processed, so the writes are queued in
+  // the order in which the record is processed.
+  startPostedWrite(value);
+  if (failed) {
+    recGblSetSevr(this->getRecord(), WRITE_ALARM, INVALID_ALARM);
+    throw std::runtime_error(
+        std::string("Previous posted write failed: ") + errorMessage);
   }
 }
 
 template<typename RecordType>
 void MrfOutputRecord<RecordType>::processPrepare() {
   this->writeRequestValue = this->convertToDevice(this->readRecordValue());
+  startWrite(this->writeRequestValue, false);
+}
+
+template<typename RecordType>
+void MrfOutputRecord<RecordType>::startWrite(std::uint32_t value,
+    bool posted) {
   switch (this->getRecordAddress().getDataType()) {
   case MrfRecordAddress::DataType::uInt16: {
-    auto callback = std::make_shared<CallbackImpl<std::uint16_t>>(*this);
+    auto callback = std::make_shared<CallbackImpl<std::uint16_t>>(*this,
+        posted, value);
     if (this->getRecordAddress().isZeroOtherBits()
         || this->getMask() == 0xffff) {
       this->getDevice()->writeUInt16(
-          this->getRecordAddress().getMemoryAddress(), this->writeRequestValue,
-          callback);
+          this->getRecordAddress().getMemoryAddress(), value, callback);
     } else {
       this->getDevice()->writeUInt16(
-          this->getRecordAddress().getMemoryAddress(), this->writeRequestValue,
-          this->getMask(), callback);
+          this->getRecordAddress().getMemoryAddress(), value, this->getMask(),
+          callback);
     }
     break;
   }
   case MrfRecordAddress::DataType::uInt32: {
-    auto callback = std::make_shared<CallbackImpl<std::uint32_t>>(*this);
+    auto callback = std::make_shared<CallbackImpl<std::uint32_t>>(*this,
+        posted, value);
     if (this->getRecordAddress().isZeroOtherBits()
         || this->getMask() == 0xffffffff) {
       this->getDevice()->writeUInt32(
-          this->getRecordAddress().getMemoryAddress(), this->writeRequestValue,
-          callback);
+          this->getRecordAddress().getMemoryAddress(), value, callback);
     } else {
       this->getDevice()->writeUInt32(
-          this->getRecordAddress().getMemoryAddress(), this->writeRequestValue,
-          this->getMask(), callback);
+          this->getRecordAddress().getMemoryAddress(), value, this->getMask(),
+          callback);
     }
     break;
   }
   }
+}
+
+template<typename RecordType>
+void MrfOutputRecord<RecordType>::startPostedWrite(std::uint32_t value) {
+  std::string errorMessage;
+  try {
+    startWrite(value, true);
+    return;
+  } catch (std::exception &e) {
+    errorMessage = e.what();
+  } catch (...) {
+    errorMessage = "Unknown error.";
+  }
+  postedWriteFinished(value, false, 0, errorMessage);
+}
 
+template<typename RecordType>
+void MrfOutputRecord<RecordType>::postedWriteFinished(
+    std::uint32_t requestValue, bool successful, std::uint32_t replyValue,
+    const std::string &errorMessage) {
+  std::string actualErrorMessage = errorMessage;
+  if (successful && this->getRecordAddress().isVerify()
+      && (replyValue & this->getMask()) != (requestValue & this->getMask())) {
+    successful = false;
+    actualErrorMessage =
+        "Mismatch between the value written to the device and the value read back from the device.";
+  }
+  if (!successful) {
+    errorExtendedPrintf("%s Posted write failed: %s", this->getRecord()->name,
+        actualErrorMessage.c_str());
+    postedWriteStatus->reportFailure();
+  }
+  std::lock_guard<std::mutex> lock(postedWriteMutex);
+  --postedWritesInProgress;
+  if (!successful) {
+    postedWriteFailed = true;
+    postedWriteErrorMessage = std::move(actualErrorMessage);
+  }
 }
 
 template<typename RecordType>
@@ -227,14 +546,18 @@ void MrfOutputRecord<RecordType>::processComplete() {
 template<typename RecordType>
 template<typename T>
 MrfOutputRecord<RecordType>::CallbackImpl<T>::CallbackImpl(
-    MrfOutputRecord &record) :
-    record(record) {
+    MrfOutputRecord &record, bool posted, std::uint32_t requestValue) :
+    record(record), posted(posted), requestValue(requestValue) {
 }
 
 template<typename RecordType>
 template<typename T>
 void MrfOutputRecord<RecordType>::CallbackImpl<T>::success(std::uint32_t,
     T value) {
+  if (posted) {
+    record.postedWriteFinished(requestValue, true, value, std::string());
+    return;
+  }
   record.writeSuccessful = true;
   record.writeReplyValue = value;
   record.scheduleProcessing();
@@ -245,15 +568,21 @@ template<typename T>
 void MrfOutputRecord<RecordType>::CallbackImpl<T>::failure(
     std::uint32_t address, MrfMemoryAccess::ErrorCode errorCode,
     const std::string &details) {
-  record.writeSuccessful = false;
+  std::string errorMessage;
   try {
-    record.writeErrorMessage = std::string("Error writing to address ")
+    errorMessage = std::string("Error writing to address ")
         + mrfMemoryAddressToString(address) + ": "
         + (details.empty() ? mrfErrorCodeToString(errorCode) : details);
   } catch (...) {
     // We want to schedule processing of the record even if we cannot assemble
     // the error message for some obscure reason.
   }
+  if (posted) {
+    record.postedWriteFinished(requestValue, false, 0, errorMessage);
+    return;
+  }
+  record.writeSuccessful = false;
+  record.writeErrorMessage = std::move(errorMessage);
   record.scheduleProcessing();
 }
 
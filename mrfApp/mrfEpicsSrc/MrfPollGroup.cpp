@@ -0,0 +1,332 @@
+/*
+ * Copyright 2026 aquenos GmbH.
+ * Copyright 2026 Karlsruhe Institute of Technology.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * This software has been developed by aquenos GmbH on behalf of the
+ * Karlsruhe Institute of Technology's Institute for Beam Physics and
+ * Technology.
+ *
+ * This software contains code originally developed by aquenos GmbH for
+ * the s7nodave EPICS device support. aquenos GmbH has relicensed the
+ * affected poritions of code from the s7nodave EPICS device support
+ * (originally licensed under the terms of the GNU GPL) under the terms
+ * of the GNU LGPL version 3 or newer.
+ */
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+
+#include "MrfPollGroup.h"
+
+namespace anka {
+namespace mrf {
+namespace epics {
+
+/**
+ * Block callback used for the requests issued by a poll group. It stores the
+ * result in the state of the cycle and notifies the poll thread when the last
+ * request of the cycle has finished.
+ */
+template<typename T>
+class MrfPollGroup::CallbackImpl: public MrfMemoryAccess::BlockCallback<T> {
+
+public:
+
+  CallbackImpl(std::shared_ptr<Cycle> cycle, std::size_t request) :
+      cycle(cycle), request(request) {
+  }
+
+  void success(std::uint32_t, const std::vector<T> &values) {
+    std::lock_guard<std::mutex> lock(cycle->mutex);
+    Result &result = cycle->results[request];
+    result.success = true;
+    result.values.assign(values.begin(), values.end());
+    finish();
+  }
+
+  void failure(std::uint32_t, MrfMemoryAccess::ErrorCode errorCode,
+      const std::string &details) {
+    std::lock_guard<std::mutex> lock(cycle->mutex);
+    Result &result = cycle->results[request];
+    result.success = false;
+    result.errorCode = errorCode;
+    try {
+      result.details = details;
+    } catch (...) {
+      // We still have to count the request as finished, even if we cannot
+      // copy the details for some obscure reason.
+    }
+    finish();
+  }
+
+private:
+
+  std::shared_ptr<Cycle> cycle;
+  std::size_t request;
+
+  // Must only be called while holding the cycle's mutex.
+  void finish() {
+    --cycle->pending;
+    if (cycle->pending == 0) {
+      cycle->cv.notify_all();
+    }
+  }
+
+};
+
+MrfPollGroup::MrfPollGroup(const std::string &deviceId,
+    std::shared_ptr<MrfConsistentMemoryAccess> device,
+    std::chrono::microseconds period, std::uint32_t rangeAddress,
+    std::size_t rangeCount) :
+    device(device), deviceId(deviceId), period(period),
+    rangeAddress(rangeAddress), rangeCount(rangeCount),
+    subscriptionsChanged(false), shutdown(false), statistics() {
+  if (!device) {
+    throw std::invalid_argument("The device must not be null.");
+  }
+  if (period.count() <= 0) {
+    throw std::invalid_argument("The period must be greater than zero.");
+  }
+  if (rangeCount != 0
+      && (rangeCount - 1) > (UINT32_MAX - rangeAddress) / 4) {
+    throw std::invalid_argument(
+        "The range must not extend beyond the end of the address space.");
+  }
+  this->pollThread = std::thread([this]() {runPollThread();});
+}
+
+MrfPollGroup::~MrfPollGroup() {
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    shutdown = true;
+    cv.notify_all();
+  }
+  // If requests are pending, the poll thread only notices the shutdown flag
+  // after they have finished. This should not take long because all requests
+  // time out eventually.
+  pollThread.join();
+}
+
+MrfPollGroup::Statistics MrfPollGroup::getStatistics() {
+  std::lock_guard<std::mutex> lock(mutex);
+  return statistics;
+}
+
+void MrfPollGroup::subscribe(std::uint32_t address,
+    MrfRecordAddress::DataType dataType, std::shared_ptr<Listener> listener) {
+  if (!listener) {
+    throw std::invalid_argument("The listener must not be null.");
+  }
+  std::lock_guard<std::mutex> lock(mutex);
+  subscriptions.push_back(Subscription{dataType, address, listener});
+  // The poll thread plans the requests before starting the next cycle, so we
+  // do not have to wake it up.
+  subscriptionsChanged = true;
+}
+
+void MrfPollGroup::planRequests(
+    const std::vector<Subscription> &subscriptions,
+    std::vector<Request> &requests, std::vector<Delivery> &deliveries) const {
+  requests.clear();
+  deliveries.clear();
+  // We sort the subscriptions by data type and address, so that registers with
+  // consecutive addresses can be merged into a single request.
+  std::vector<const Subscription *> sorted;
+  sorted.reserve(subscriptions.size());
+  for (auto &subscription : subscriptions) {
+    sorted.push_back(&subscription);
+  }
+  std::sort(sorted.begin(), sorted.end(),
+      [](const Subscription *s1, const Subscription *s2) {
+        return s1->dataType < s2->dataType
+            || (s1->dataType == s2->dataType && s1->address < s2->address);
+      });
+  const std::size_t noRequest = std::numeric_limits<std::size_t>::max();
+  std::size_t rangeRequest = noRequest;
+  std::size_t currentRequest = noRequest;
+  for (auto subscription : sorted) {
+    std::uint32_t elementSize =
+        (subscription->dataType == MrfRecordAddress::DataType::uInt16) ?
+            2 : 4;
+    std::uint32_t address = subscription->address;
+    std::size_t index;
+    if (rangeCount != 0
+        && subscription->dataType == MrfRecordAddress::DataType::uInt32
+        && address >= rangeAddress && (address - rangeAddress) % 4 == 0
+        && (address - rangeAddress) / 4 < rangeCount) {
+      if (rangeRequest == noRequest) {
+        rangeRequest = requests.size();
+        requests.push_back(
+            Request{MrfRecordAddress::DataType::uInt32, rangeAddress,
+              rangeCount, 0});
+      }
+      deliveries.push_back(
+          Delivery{address, rangeRequest, (address - rangeAddress) / 4,
+            subscription->listener});
+      continue;
+    }
+    Request *request =
+        (currentRequest == noRequest) ? nullptr : &requests[currentRequest];
+    if (request && request->dataType == subscription->dataType
+        && address == request->address
+            + (request->count - 1) * elementSize) {
+      // Several records may use the same register.
+      index = request->count - 1;
+    } else if (request && request->dataType == subscription->dataType
+        && address > request->address
+        && (address - request->address) % elementSize == 0
+        && (address - request->address) / elementSize == request->count) {
+      index = request->count;
+      ++request->count;
+    } else {
+      currentRequest = requests.size();
+      requests.push_back(Request{subscription->dataType, address, 1, 0});
+      index = 0;
+    }
+    deliveries.push_back(
+        Delivery{address, currentRequest, index, subscription->listener});
+  }
+}
+
+void MrfPollGroup::runPollThread() {
+  std::vector<Request> requests;
+  std::vector<Delivery> deliveries;
+  Clock::time_point nextCycle = Clock::now();
+  std::unique_lock<std::mutex> lock(mutex);
+  while (true) {
+    while (!shutdown && Clock::now() < nextCycle) {
+      cv.wait_until(lock, nextCycle);
+    }
+    if (shutdown) {
+      break;
+    }
+    if (subscriptionsChanged) {
+      subscriptions.erase(
+          std::remove_if(subscriptions.begin(), subscriptions.end(),
+              [](const Subscription &subscription) {
+                return subscription.listener.expired();
+              }), subscriptions.end());
+      planRequests(subscriptions, requests, deliveries);
+      subscriptionsChanged = false;
+      statistics.listeners = subscriptions.size();
+      statistics.registers = 0;
+      statistics.registersPerCycle = 0;
+      for (std::size_t i = 0; i < deliveries.size(); ++i) {
+        if (i == 0 || deliveries[i].request != deliveries[i - 1].request
+            || deliveries[i].index != deliveries[i - 1].index) {
+          ++statistics.registers;
+        }
+      }
+      for (auto &request : requests) {
+        statistics.registersPerCycle += request.count;
+      }
+      statistics.requestsPerCycle = requests.size();
+    }
+    lock.unlock();
+    Clock::time_point cycleStart = Clock::now();
+    std::uint64_t requestsFailed = 0;
+    bool listenerExpired = false;
+    if (!requests.empty()) {
+      // All requests of a cycle are queued at once, so that the device can
+      // process them back to back.
+      auto cycle = std::make_shared<Cycle>();
+      cycle->pending = requests.size();
+      cycle->results.resize(requests.size());
+      for (std::size_t i = 0; i < requests.size(); ++i) {
+        Request &request = requests[i];
+        try {
+          switch (request.dataType) {
+          case MrfRecordAddress::DataType::uInt16:
+            device->readUInt16Block(request.address, request.count,
+                request.elementDistance,
+                std::make_shared<CallbackImpl<std::uint16_t>>(cycle, i));
+            break;
+          case MrfRecordAddress::DataType::uInt32:
+            device->readUInt32Block(request.address, request.count,
+                request.elementDistance,
+                std::make_shared<CallbackImpl<std::uint32_t>>(cycle, i));
+            break;
+          }
+        } catch (...) {
+          // If the request could not be queued, its callback is never called,
+          // so we have to count it as finished here.
+          std::lock_guard<std::mutex> cycleLock(cycle->mutex);
+          cycle->results[i].success = false;
+          cycle->results[i].errorCode = MrfMemoryAccess::ErrorCode::unknown;
+          --cycle->pending;
+        }
+      }
+      {
+        std::unique_lock<std::mutex> cycleLock(cycle->mutex);
+        while (cycle->pending != 0) {
+          cycle->cv.wait(cycleLock);
+        }
+      }
+      for (auto &result : cycle->results) {
+        if (!result.success) {
+          ++requestsFailed;
+        }
+      }
+      // The listeners are notified after all requests have finished, so that
+      // the I/O thread of the device is not slowed down by them.
+      for (auto &delivery : deliveries) {
+        auto listener = delivery.listener.lock();
+        if (!listener) {
+          listenerExpired = true;
+          continue;
+        }
+        Result &result = cycle->results[delivery.request];
+        if (result.success) {
+          listener->success(delivery.address, result.values[delivery.index]);
+        } else {
+          listener->failure(delivery.address, result.errorCode,
+              result.details);
+        }
+      }
+    }
+    Clock::time_point cycleEnd = Clock::now();
+    lock.lock();
+    if (listenerExpired) {
+      subscriptionsChanged = true;
+    }
+    if (!requests.empty()) {
+      std::uint64_t cycleMicroseconds =
+          std::chrono::duration_cast<std::chrono::microseconds>(
+              cycleEnd - cycleStart).count();
+      ++statistics.cycles;
+      statistics.requestsFailed += requestsFailed;
+      statistics.lastCycleMicroseconds = cycleMicroseconds;
+      statistics.maxCycleMicroseconds = std::max(
+          statistics.maxCycleMicroseconds, cycleMicroseconds);
+    }
+    nextCycle += period;
+    if (nextCycle < cycleEnd) {
+      // We do not try to catch up with cycles that we missed, because that
+      // would only put additional load on the device.
+      if (!requests.empty()) {
+        ++statistics.overruns;
+      }
+      nextCycle = cycleEnd;
+    }
+  }
+}
+
+}
+}
+}
@@ -0,0 +1,304 @@
+/*
+ * Copyright 2026 aquenos GmbH.
+ * Copyright 2026 Karlsruhe Institute of Technology.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * This software has been developed by aquenos GmbH on behalf of the
+ * Karlsruhe Institute of Technology's Institute for Beam Physics and
+ * Technology.
+ *
+ * This software contains code originally developed by aquenos GmbH for
+ * the s7nodave EPICS device support. aquenos GmbH has relicensed the
+ * affected poritions of code from the s7nodave EPICS device support
+ * (originally licensed under the terms of the GNU GPL) under the terms
+ * of the GNU LGPL version 3 or newer.
+ */
+
+#ifndef ANKA_MRF_EPICS_POLL_GROUP_H
+#define ANKA_MRF_EPICS_POLL_GROUP_H
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <MrfConsistentMemoryAccess.h>
+
+#include "MrfRecordAddress.h"
+
+namespace anka {
+namespace mrf {
+namespace epics {
+
+/**
+ * Group of registers that are read periodically and whose values are
+ * distributed to all records that have subscribed to them. Each poll group has
+ * its own thread that reads all subscribed registers once per period. Registers
+ * with consecutive addresses are read with a single block request. When a
+ * range of registers has been specified, all subscribed 32-bit registers
+ * within this range are read with a single block request, even if there are
+ * gaps between them.
+ *
+ * A poll group only issues the requests for the next cycle after all requests
+ * of the previous cycle have finished. If this takes longer than the period,
+ * the next cycle is started immediately and the overrun is counted in the
+ * statistics.
+ */
+class MrfPollGroup {
+
+public:
+
+  /**
+   * Listener that is notified each time a subscribed register has been read.
+   * The listener is called from the poll group's thread, so it should not
+   * block.
+   */
+  class Listener {
+
+  public:
+
+    /**
+     * Called when the register has been read successfully. The value of a
+     * 16-bit register is zero-extended to 32 bits.
+     */
+    virtual void success(std::uint32_t address, std::uint32_t value) = 0;
+
+    /**
+     * Called when reading the register has failed. The error code gives
+     * information about the cause of the failure. The optional string may
+     * give additional information about the cause of the error, but it may
+     * also be empty.
+     */
+    virtual void failure(std::uint32_t address,
+        MrfMemoryAccess::ErrorCode errorCode, const std::string &details) = 0;
+
+    /**
+     * Default constructor.
+     */
+    Listener() {
+    }
+
+    /**
+     * Destructor. Virtual classes should have a virtual destructor.
+     */
+    virtual ~Listener() {
+    }
+
+    // We do not want to allow copy or move construction or assignment.
+    Listener(const Listener &) = delete;
+    Listener(Listener &&) = delete;
+    Listener &operator=(const Listener &) = delete;
+    Listener &operator=(Listener &&) = delete;
+
+  };
+
+  /**
+   * Statistics about the poll group.
+   *
+   * @see getStatistics()
+   */
+  struct Statistics {
+
+    /**
+     * Number of registers (not records) that have been subscribed to.
+     */
+    std::size_t registers;
+
+    /**
+     * Number of listeners that have subscribed to the registers.
+     */
+    std::size_t listeners;
+
+    /**
+     * Number of read requests that are issued per cycle.
+     */
+    std::size_t requestsPerCycle;
+
+    /**
+     * Number of registers that are read per cycle. This can be greater than
+     * the number of subscribed registers when a range has been specified.
+     */
+    std::size_t registersPerCycle;
+
+    /**
+     * Number of cycles that have been run.
+     */
+    std::uint64_t cycles;
+
+    /**
+     * Number of cycles that took longer than the period.
+     */
+    std::uint64_t overruns;
+
+    /**
+     * Number of read requests that have failed.
+     */
+    std::uint64_t requestsFailed;
+
+    /**
+     * Time (in microseconds) that the last cycle took.
+     */
+    std::uint64_t lastCycleMicroseconds;
+
+    /**
+     * Longest time (in microseconds) that a cycle took.
+     */
+    std::uint64_t maxCycleMicroseconds;
+
+  };
+
+  /**
+   * Creates a poll group that reads from the specified device. The period is
+   * the time between the start of two consecutive cycles. If the range count
+   * is not zero, all subscribed 32-bit registers in the range starting at the
+   * range address are read with a single block request.
+   */
+  MrfPollGroup(const std::string &deviceId,
+      std::shared_ptr<MrfConsistentMemoryAccess> device,
+      std::chrono::microseconds period, std::uint32_t rangeAddress,
+      std::size_t rangeCount);
+
+  /**
+   * Destructor. Stops the poll thread. If requests are still pending, this
+   * waits for them to finish.
+   */
+  ~MrfPollGroup();
+
+  /**
+   * Returns the ID of the device from which this poll group reads.
+   */
+  inline const std::string &getDeviceId() const {
+    return deviceId;
+  }
+
+  /**
+   * Returns the period of this poll group.
+   */
+  inline std::chrono::microseconds getPeriod() const {
+    return period;
+  }
+
+  /**
+   * Returns the statistics for this poll group.
+   */
+  Statistics getStatistics();
+
+  /**
+   * Subscribes the listener to the register with the specified address and
+   * data type. The listener is notified each time the register has been read,
+   * starting with the next cycle. The listener is internally kept using a
+   * weak pointer. This means that the listener is automatically removed when
+   * it is destroyed.
+   */
+  void subscribe(std::uint32_t address, MrfRecordAddress::DataType dataType,
+      std::shared_ptr<Listener> listener);
+
+private:
+
+  using Clock = std::chrono::steady_clock;
+
+  /**
+   * Read request issued once per cycle.
+   */
+  struct Request {
+    MrfRecordAddress::DataType dataType;
+    std::uint32_t address;
+    std::size_t count;
+    std::uint32_t elementDistance;
+  };
+
+  /**
+   * Registers a listener is subscribed to.
+   */
+  struct Subscription {
+    MrfRecordAddress::DataType dataType;
+    std::uint32_t address;
+    std::weak_ptr<Listener> listener;
+  };
+
+  /**
+   * Tells which element of which request provides the value for a
+   * subscription.
+   */
+  struct Delivery {
+    std::uint32_t address;
+    std::size_t request;
+    std::size_t index;
+    std::weak_ptr<Listener> listener;
+  };
+
+  /**
+   * Result of a read request.
+   */
+  struct Result {
+    bool success;
+    MrfMemoryAccess::ErrorCode errorCode;
+    std::string details;
+    std::vector<std::uint32_t> values;
+  };
+
+  /**
+   * State shared between the poll thread and the callbacks for the requests
+   * of one cycle.
+   */
+  struct Cycle {
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::size_t pending;
+    std::vector<Result> results;
+  };
+
+  template<typename T>
+  class CallbackImpl;
+
+  // We do not want to allow copy or move construction or assignment.
+  MrfPollGroup(const MrfPollGroup &) = delete;
+  MrfPollGroup(MrfPollGroup &&) = delete;
+  MrfPollGroup &operator=(const MrfPollGroup &) = delete;
+  MrfPollGroup &operator=(MrfPollGroup &&) = delete;
+
+  std::shared_ptr<MrfConsistentMemoryAccess> device;
+  std::string deviceId;
+  std::chrono::microseconds period;
+  std::uint32_t rangeAddress;
+  std::size_t rangeCount;
+
+  /**
+   * Mutex protecting the subscriptions, the statistics, and the flags.
+   */
+  std::mutex mutex;
+  std::condition_variable cv;
+  std::vector<Subscription> subscriptions;
+  bool subscriptionsChanged;
+  bool shutdown;
+  Statistics statistics;
+  std::thread pollThread;
+
+  void planRequests(const std::vector<Subscription> &subscriptions,
+      std::vector<Request> &requests, std::vector<Delivery> &deliveries) const;
+  void runPollThread();
+
+};
+
+}
+}
+}
+
+#endif // ANKA_MRF_EPICS_POLL_GROUP_H
@@ -0,0 +1,100 @@
+/*
+ * Copyright 2026 aquenos GmbH.
+ * Copyright 2026 Karlsruhe Institute of Technology.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * This software has been developed by aquenos GmbH on behalf of the
+ * Karlsruhe Institute of Technology's Institute for Beam Physics and
+ * Technology.
+ *
+ * This software contains code originally developed by aquenos GmbH for
+ * the s7nodave EPICS device support. aquenos GmbH has relicensed the
+ * affected poritions of code from the s7nodave EPICS device support
+ * (originally licensed under the terms of the GNU GPL) under the terms
+ * of the GNU LGPL version 3 or newer.
+ */
+
+#ifndef ANKA_MRF_EPICS_POSTED_WRITE_STATUS_H
+#define ANKA_MRF_EPICS_POSTED_WRITE_STATUS_H
+
+#include <atomic>
+#include <cstdint>
+
+#include <dbScan.h>
+
+namespace anka {
+namespace mrf {
+namespace epics {
+
+/**
+ * Status of the posted writes for a device. Output records using posted writes
+ * complete before the write has finished, so they cannot report a failure
+ * directly. Instead, they report it to this object, which counts the failures
+ * and triggers processing of the records that are in the "I/O Intr" mode and
+ * monitor the failure count.
+ *
+ * There is one instance of this class for each device. It can be retrieved
+ * through {@link MrfDeviceRegistry::getPostedWriteStatus(const std::string&)}.
+ */
+class MrfPostedWriteStatus {
+
+public:
+
+  /**
+   * Creates the posted-write status for a device.
+   */
+  MrfPostedWriteStatus();
+
+  /**
+   * Returns the number of posted writes that have failed so far. The counter
+   * wraps around when it overflows.
+   */
+  inline std::uint32_t getFailureCount() const {
+    return failureCount.load(std::memory_order_relaxed);
+  }
+
+  /**
+   * Returns the data structure that can be used in order to process records in
+   * the "I/O Intr" mode each time a posted write has failed.
+   */
+  inline ::IOSCANPVT getIoScanPvt() const {
+    return ioScanPvt;
+  }
+
+  /**
+   * Reports that a posted write has failed. This increments the failure count
+   * and requests processing of all records that are in the "I/O Intr" mode.
+   */
+  void reportFailure();
+
+private:
+
+  // We do not want to allow copy or move construction or assignment.
+  MrfPostedWriteStatus(const MrfPostedWriteStatus &) = delete;
+  MrfPostedWriteStatus(MrfPostedWriteStatus &&) = delete;
+  MrfPostedWriteStatus &operator=(const MrfPostedWriteStatus &) = delete;
+  MrfPostedWriteStatus &operator=(MrfPostedWriteStatus &&) = delete;
+
+  std::atomic<std::uint32_t> failureCount;
+  ::IOSCANPVT ioScanPvt;
+
+};
+
+}
+}
+}
+
+#endif // ANKA_MRF_EPICS_POSTED_WRITE_STATUS_H
@@ -0,0 +1,180 @@
+/*
+ * Copyright 2026 aquenos GmbH.
+ * Copyright 2026 Karlsruhe Institute of Technology.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * This software has been developed by aquenos GmbH on behalf of the
+ * Karlsruhe Institute of Technology's Institute for Beam Physics and
+ * Technology.
+ *
+ * This software contains code originally developed by aquenos GmbH for
+ * the s7nodave EPICS device support. aquenos GmbH has relicensed the
+ * affected poritions of code from the s7nodave EPICS device support
+ * (originally licensed under the terms of the GNU GPL) under the terms
+ * of the GNU LGPL version 3 or newer.
+ */
+
+#include <cstring>
+
+#include <dbLock.h>
+#include <epicsThread.h>
+#include <recSup.h>
+
+#include "MrfProcessScheduler.h"
+
+namespace anka {
+namespace mrf {
+namespace epics {
+
+MrfProcessScheduler MrfProcessScheduler::instance;
+
+MrfProcessScheduler::MrfProcessScheduler() :
+    batchWindow(-1.0), timerQueue(nullptr) {
+  for (int priority = 0; priority < NUM_CALLBACK_PRIORITIES; ++priority) {
+    Batch &batch = batches[priority];
+    // EPICS Base does not provide a function for doing a general
+    // initialization, but it expects some private fields to be initialized
+    // with zero. We use memset to initialize these fields. This is more
+    // compatible than initializing the fields individually (they might change
+    // in future versions of EPICS Base).
+    std::memset(&batch.callback, 0, sizeof(batch.callback));
+    callbackSetCallback(processBatchStatic, &batch.callback);
+    callbackSetPriority(priority, &batch.callback);
+    callbackSetUser(this, &batch.callback);
+    batch.callbackQueued = false;
+    batch.priority = priority;
+    batch.timer = nullptr;
+  }
+}
+
+int MrfProcessScheduler::toEpicsPriority(
+    MrfRecordAddress::CallbackPriority priority) {
+  switch (priority) {
+  case MrfRecordAddress::CallbackPriority::low:
+    return priorityLow;
+  case MrfRecordAddress::CallbackPriority::high:
+    return priorityHigh;
+  default:
+    return priorityMedium;
+  }
+}
+
+void MrfProcessScheduler::requestProcessing(::CALLBACK *callback, int priority,
+    void *record) {
+  std::unique_lock<std::mutex> lock(mutex);
+  if (batchWindow < 0.0) {
+    lock.unlock();
+    ::callbackRequestProcessCallback(callback, priority, record);
+    return;
+  }
+  Batch &batch = batches[priority];
+  batch.records.push_back(
+      std::make_pair(callback, static_cast<::dbCommon *>(record)));
+  if (batch.callbackQueued) {
+    return;
+  }
+  batch.callbackQueued = true;
+  if (batchWindow > 0.0) {
+    // We use our own timer instead of callbackRequestDelayed. When the timer
+    // expires, callbackRequestDelayed queues the callback, but it cannot
+    // report when this fails, so the records would never be processed.
+    if (!batch.timer) {
+      if (!timerQueue) {
+        timerQueue = ::epicsTimerQueueAllocate(1,
+            epicsThreadPriorityScanHigh);
+      }
+      if (timerQueue) {
+        batch.timer = ::epicsTimerQueueCreateTimer(timerQueue,
+            batchTimerExpiredStatic, &batch);
+      }
+    }
+    if (batch.timer) {
+      ::epicsTimerStartDelay(batch.timer, batchWindow);
+      return;
+    }
+    // Without a timer, we cannot delay the batch, so we queue the callback
+    // right away.
+  }
+  queueBatchCallback(batch, lock);
+}
+
+void MrfProcessScheduler::queueBatchCallback(Batch &batch,
+    std::unique_lock<std::mutex> &lock) {
+  if (::callbackRequest(&batch.callback) == 0) {
+    lock.unlock();
+    return;
+  }
+  // The callback could not be queued (because the queue is full). We remove
+  // the records from the batch and fall back to queuing a callback for each of
+  // them. Otherwise, the records would stay in the batch and remain active
+  // until another record finishes.
+  std::vector<std::pair<::CALLBACK *, ::dbCommon *>> records;
+  records.swap(batch.records);
+  batch.callbackQueued = false;
+  lock.unlock();
+  for (auto &callbackAndRecord : records) {
+    ::callbackRequestProcessCallback(callbackAndRecord.first, batch.priority,
+        callbackAndRecord.second);
+  }
+}
+
+void MrfProcessScheduler::batchTimerExpired(int priority) {
+  std::unique_lock<std::mutex> lock(mutex);
+  queueBatchCallback(batches[priority], lock);
+}
+
+void MrfProcessScheduler::batchTimerExpiredStatic(void *batch) {
+  instance.batchTimerExpired(static_cast<Batch *>(batch)->priority);
+}
+
+double MrfProcessScheduler::getBatchWindow() {
+  std::lock_guard<std::mutex> lock(mutex);
+  return batchWindow;
+}
+
+void MrfProcessScheduler::setBatchWindow(double batchWindow) {
+  std::lock_guard<std::mutex> lock(mutex);
+  this->batchWindow = batchWindow;
+}
+
+void MrfProcessScheduler::processBatch(int priority) {
+  std::vector<std::pair<::CALLBACK *, ::dbCommon *>> records;
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    Batch &batch = batches[priority];
+    records.swap(batch.records);
+    batch.callbackQueued = false;
+  }
+  // This is what callbackRequestProcessCallback does for a single record.
+  for (auto &callbackAndRecord : records) {
+    ::dbCommon *record = callbackAndRecord.second;
+    ::dbScanLock(record);
+    (*record->rset->process)(record);
+    ::dbScanUnlock(record);
+  }
+}
+
+void MrfProcessScheduler::processBatchStatic(::CALLBACK *callback) {
+  void *scheduler;
+  int priority;
+  callbackGetUser(scheduler, callback);
+  callbackGetPriority(priority, callback);
+  static_cast<MrfProcessScheduler *>(scheduler)->processBatch(priority);
+}
+
+}
+}
+}
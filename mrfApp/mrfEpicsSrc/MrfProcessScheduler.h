@@ -0,0 +1,185 @@
+/*
+ * Copyright 2026 aquenos GmbH.
+ * Copyright 2026 Karlsruhe Institute of Technology.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * This software has been developed by aquenos GmbH on behalf of the
+ * Karlsruhe Institute of Technology's Institute for Beam Physics and
+ * Technology.
+ *
+ * This software contains code originally developed by aquenos GmbH for
+ * the s7nodave EPICS device support. aquenos GmbH has relicensed the
+ * affected poritions of code from the s7nodave EPICS device support
+ * (originally licensed under the terms of the GNU GPL) under the terms
+ * of the GNU LGPL version 3 or newer.
+ */
+
+#ifndef ANKA_MRF_EPICS_PROCESS_SCHEDULER_H
+#define ANKA_MRF_EPICS_PROCESS_SCHEDULER_H
+
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include <callback.h>
+#include <dbCommon.h>
+#include <epicsTimer.h>
+
+#include "MrfRecordAddress.h"
+
+namespace anka {
+namespace mrf {
+namespace epics {
+
+/**
+ * Schedules the processing of records after an asynchronous operation has
+ * completed. By default, each request is passed on to EPICS Base separately
+ * (using {@code callbackRequestProcessCallback}). When batching has been
+ * enabled, the requests for each callback priority are collected and a single
+ * callback processes all records that have been requested until it runs. This
+ * reduces the load on the callback queues when many operations finish at
+ * about the same time (e.g. during IOC startup or when many settings are
+ * written at once).
+ *
+ * This class implements the singleton pattern and the only instance is returned
+ * by the {@link #getInstance()} function.
+ */
+class MrfProcessScheduler {
+
+public:
+
+  /**
+   * Returns the only instance of this class.
+   */
+  inline static MrfProcessScheduler &getInstance() {
+    return instance;
+  }
+
+  /**
+   * Converts the callback priority specified in a record address to the
+   * respective EPICS callback priority.
+   */
+  static int toEpicsPriority(MrfRecordAddress::CallbackPriority priority);
+
+  /**
+   * Requests the specified record to be processed by a callback thread with
+   * the specified priority. The callback is only used when batching is
+   * disabled or when the callback processing the batch cannot be queued. It
+   * must belong to the record and must not be used for anything else. Like with {@code callbackRequestProcessCallback}, data written
+   * before calling this method is seen by the thread processing the record.
+   */
+  void requestProcessing(::CALLBACK *callback, int priority, void *record);
+
+  /**
+   * Returns the batch window (in seconds). A negative value means that
+   * batching is disabled.
+   */
+  double getBatchWindow();
+
+  /**
+   * Sets the batch window (in seconds). If zero, all requests that arrive
+   * until the callback processing the batch runs are processed together. If
+   * positive, the callback is delayed by the specified time, so that more
+   * requests can be collected. If negative, batching is disabled and each
+   * request is passed on to EPICS Base separately.
+   */
+  void setBatchWindow(double batchWindow);
+
+private:
+
+  /**
+   * Records waiting to be processed by a callback with a certain priority.
+   */
+  struct Batch {
+    ::CALLBACK callback;
+    bool callbackQueued;
+    int priority;
+    /**
+     * Timer used for delaying the callback when the batch window is
+     * positive. It is created when it is needed for the first time.
+     */
+    ::epicsTimerId timer;
+    /**
+     * Records in the batch, together with the callback that has been passed
+     * for each of them. The callback is used when the callback processing the
+     * batch cannot be queued.
+     */
+    std::vector<std::pair<::CALLBACK *, ::dbCommon *>> records;
+  };
+
+  static MrfProcessScheduler instance;
+
+  std::mutex mutex;
+  double batchWindow;
+  Batch batches[NUM_CALLBACK_PRIORITIES];
+
+  /**
+   * Timer queue for the batch timers. It is allocated when it is needed for the
+   * first time.
+   */
+  ::epicsTimerQueueId timerQueue;
+
+  /**
+   * Default constructor. Only used for the singleton instance.
+   */
+  MrfProcessScheduler();
+
+  // We do not want to allow copy or move construction or assignment.
+  MrfProcessScheduler(const MrfProcessScheduler &) = delete;
+  MrfProcessScheduler(MrfProcessScheduler &&) = delete;
+  MrfProcessScheduler &operator=(const MrfProcessScheduler &) = delete;
+  MrfProcessScheduler &operator=(MrfProcessScheduler &&) = delete;
+
+  /**
+   * Queues the callback processing the specified batch. If the callback cannot
+   * be queued (because the callback queue is full), the records are removed
+   * from the batch and a separate callback is queued for each of them instead.
+   * Must be called while holding the mutex, which is released by this method.
+   */
+  void queueBatchCallback(Batch &batch, std::unique_lock<std::mutex> &lock);
+
+  /**
+   * Called when the timer of the batch with the specified priority expires.
+   */
+  void batchTimerExpired(int priority);
+
+  /**
+   * Timer callback function used for delaying a batch. This function extracts
+   * the batch from the argument and then calls
+   * {@link #batchTimerExpired(int)}.
+   */
+  static void batchTimerExpiredStatic(void *batch);
+
+  /**
+   * Processes all records in the batch for the priority of the specified
+   * callback.
+   */
+  void processBatch(int priority);
+
+  /**
+   * Callback function used for processing a batch. This function extracts
+   * the instance of this class from the callback and then calls
+   * {@link #processBatch(int)}.
+   */
+  static void processBatchStatic(::CALLBACK *callback);
+
+};
+
+}
+}
+}
+
+#endif // ANKA_MRF_EPICS_PROCESS_SCHEDULER_H
@@ -0,0 +1,204 @@
+/*
+ * Copyright 2026 aquenos GmbH.
+ * Copyright 2026 Karlsruhe Institute of Technology.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * This software has been developed by aquenos GmbH on behalf of the
+ * Karlsruhe Institute of Technology's Institute for Beam Physics and
+ * Technology.
+ *
+ * This software contains code originally developed by aquenos GmbH for
+ * the s7nodave EPICS device support. aquenos GmbH has relicensed the
+ * affected poritions of code from the s7nodave EPICS device support
+ * (originally licensed under the terms of the GNU GPL) under the terms
+ * of the GNU LGPL version 3 or newer.
+ */
+
+#include <exception>
+#include <utility>
+
+#include "MrfReadCoalescer.h"
+
+namespace anka {
+namespace mrf {
+namespace epics {
+
+template<typename T>
+class MrfReadCoalescer::CallbackImpl: public MrfMemoryAccess::Callback<T> {
+
+public:
+
+  CallbackImpl(MrfReadCoalescer &coalescer, EntryMap<T> &entries) :
+      coalescer(coalescer), entries(entries) {
+  }
+
+  void success(std::uint32_t address, T value) {
+    coalescer.readFinished(entries, address, true, value,
+        MrfMemoryAccess::ErrorCode::unknown, std::string());
+  }
+
+  void failure(std::uint32_t address, MrfMemoryAccess::ErrorCode errorCode,
+      const std::string &details) {
+    coalescer.readFinished(entries, address, false, static_cast<T>(0),
+        errorCode, details);
+  }
+
+private:
+
+  // Read coalescers are kept by the device registry and are never destroyed,
+  // so we can safely keep references.
+  MrfReadCoalescer &coalescer;
+  EntryMap<T> &entries;
+
+};
+
+MrfReadCoalescer::MrfReadCoalescer(std::shared_ptr<MrfMemoryAccess> device) :
+    device(device) {
+}
+
+void MrfReadCoalescer::readUInt16(std::uint32_t address,
+    std::chrono::steady_clock::duration maxAge,
+    std::shared_ptr<MrfMemoryAccess::CallbackUInt16> callback) {
+  read(uInt16Entries, address, maxAge, callback);
+}
+
+void MrfReadCoalescer::readUInt32(std::uint32_t address,
+    std::chrono::steady_clock::duration maxAge,
+    std::shared_ptr<MrfMemoryAccess::CallbackUInt32> callback) {
+  read(uInt32Entries, address, maxAge, callback);
+}
+
+template<typename T>
+void MrfReadCoalescer::read(EntryMap<T> &entries, std::uint32_t address,
+    std::chrono::steady_clock::duration maxAge,
+    std::shared_ptr<MrfMemoryAccess::Callback<T>> callback) {
+  if (maxAge <= std::chrono::steady_clock::duration::zero()) {
+    startRead(address, callback);
+    return;
+  }
+  bool successful = false;
+  T value = 0;
+  MrfMemoryAccess::ErrorCode errorCode = MrfMemoryAccess::ErrorCode::unknown;
+  std::string errorDetails;
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto now = std::chrono::steady_clock::now();
+    Entry<T> &entry = entries[address];
+    bool fresh = entry.startTime >= now - maxAge;
+    if (entry.inProgress) {
+      // If the read in progress is too old, we do not start a second read
+      // right now. Instead, we start a single new read for all callbacks that
+      // are in the same situation as soon as the read in progress has
+      // finished. This way, we avoid piling up requests for the same register
+      // in the device's queue.
+      if (fresh) {
+        entry.waitingCallbacks.push_back(callback);
+      } else {
+        entry.nextReadCallbacks.push_back(callback);
+      }
+      return;
+    }
+    if (!entry.resultAvailable || !fresh) {
+      entry.inProgress = true;
+      entry.startTime = now;
+      entry.waitingCallbacks.push_back(callback);
+      callback.reset();
+    } else {
+      successful = entry.successful;
+      value = entry.value;
+      errorCode = entry.errorCode;
+      errorDetails = entry.errorDetails;
+    }
+  }
+  // We must not hold the mutex while calling the device or the callback. The
+  // device might call our callback synchronously and the record's callback
+  // might start another read.
+  if (!callback) {
+    startSharedRead(entries, address);
+  } else if (successful) {
+    callback->success(address, value);
+  } else {
+    callback->failure(address, errorCode, errorDetails);
+  }
+}
+
+template<typename T>
+void MrfReadCoalescer::readFinished(EntryMap<T> &entries,
+    std::uint32_t address, bool successful, T value,
+    MrfMemoryAccess::ErrorCode errorCode, const std::string &errorDetails) {
+  std::vector<std::shared_ptr<MrfMemoryAccess::Callback<T>>> callbacks;
+  bool startNextRead;
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    Entry<T> &entry = entries[address];
+    entry.resultAvailable = true;
+    entry.successful = successful;
+    entry.value = value;
+    entry.errorCode = errorCode;
+    entry.errorDetails = errorDetails;
+    callbacks = std::move(entry.waitingCallbacks);
+    entry.waitingCallbacks = std::move(entry.nextReadCallbacks);
+    entry.nextReadCallbacks.clear();
+    startNextRead = !entry.waitingCallbacks.empty();
+    entry.inProgress = startNextRead;
+    if (startNextRead) {
+      entry.startTime = std::chrono::steady_clock::now();
+    }
+  }
+  for (auto &callback : callbacks) {
+    if (successful) {
+      callback->success(address, value);
+    } else {
+      callback->failure(address, errorCode, errorDetails);
+    }
+  }
+  if (startNextRead) {
+    startSharedRead(entries, address);
+  }
+}
+
+template<typename T>
+void MrfReadCoalescer::startSharedRead(EntryMap<T> &entries,
+    std::uint32_t address) {
+  // Other callbacks might already be waiting for this read, so we cannot
+  // simply let an exception propagate. Instead, we treat it like a failed
+  // read, so that all waiting callbacks are notified.
+  std::string errorDetails;
+  try {
+    startRead(address, std::make_shared<CallbackImpl<T>>(*this, entries));
+    return;
+  } catch (std::exception &e) {
+    errorDetails = e.what();
+  } catch (...) {
+    errorDetails = "Unknown error.";
+  }
+  readFinished(entries, address, false, static_cast<T>(0),
+      MrfMemoryAccess::ErrorCode::unknown, errorDetails);
+}
+
+void MrfReadCoalescer::startRead(std::uint32_t address,
+    std::shared_ptr<MrfMemoryAccess::CallbackUInt16> callback) {
+  device->readUInt16(address, callback);
+}
+
+void MrfReadCoalescer::startRead(std::uint32_t address,
+    std::shared_ptr<MrfMemoryAccess::CallbackUInt32> callback) {
+  device->readUInt32(address, callback);
+}
+
+}
+}
+}
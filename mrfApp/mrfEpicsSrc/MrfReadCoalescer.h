@@ -0,0 +1,158 @@
+/*
+ * Copyright 2026 aquenos GmbH.
+ * Copyright 2026 Karlsruhe Institute of Technology.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * This software has been developed by aquenos GmbH on behalf of the
+ * Karlsruhe Institute of Technology's Institute for Beam Physics and
+ * Technology.
+ *
+ * This software contains code originally developed by aquenos GmbH for
+ * the s7nodave EPICS device support. aquenos GmbH has relicensed the
+ * affected poritions of code from the s7nodave EPICS device support
+ * (originally licensed under the terms of the GNU GPL) under the terms
+ * of the GNU LGPL version 3 or newer.
+ */
+
+#ifndef ANKA_MRF_EPICS_READ_COALESCER_H
+#define ANKA_MRF_EPICS_READ_COALESCER_H
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <MrfMemoryAccess.h>
+
+namespace anka {
+namespace mrf {
+namespace epics {
+
+/**
+ * Shares read operations between records that read the same register of a
+ * device. When a read is requested while a read of the same register is still
+ * in progress, no new request is sent to the device. Instead, the callback is
+ * notified when the read in progress finishes. When the last read of the
+ * register has already finished, its result is reused as long as it is not too
+ * old.
+ *
+ * The age of a result is measured from the point in time when the read was
+ * started, so a result is never older than the maximum age specified by the
+ * caller. If the read in progress has been started too long ago, the callback
+ * is queued and a single new read is started for all queued callbacks when the
+ * read in progress has finished. This way, there is never more than one read
+ * of the same register waiting in the device's queue. A maximum age of zero
+ * disables the sharing and a new read is always started.
+ *
+ * There is one instance of this class for each device. It can be retrieved
+ * through {@link MrfDeviceRegistry::getReadCoalescer(const std::string&)}.
+ */
+class MrfReadCoalescer {
+
+public:
+
+  /**
+   * Creates a read coalescer that reads from the specified device.
+   */
+  MrfReadCoalescer(std::shared_ptr<MrfMemoryAccess> device);
+
+  /**
+   * Reads an unsigned 16-bit register. If there is a read of the same register
+   * that has been started no longer than the specified time ago, its result is
+   * passed to the callback instead of reading the register again. If this
+   * result is already available, the callback is called before this method
+   * returns.
+   */
+  void readUInt16(std::uint32_t address,
+      std::chrono::steady_clock::duration maxAge,
+      std::shared_ptr<MrfMemoryAccess::CallbackUInt16> callback);
+
+  /**
+   * Reads an unsigned 32-bit register. If there is a read of the same register
+   * that has been started no longer than the specified time ago, its result is
+   * passed to the callback instead of reading the register again. If this
+   * result is already available, the callback is called before this method
+   * returns.
+   */
+  void readUInt32(std::uint32_t address,
+      std::chrono::steady_clock::duration maxAge,
+      std::shared_ptr<MrfMemoryAccess::CallbackUInt32> callback);
+
+private:
+
+  template<typename T>
+  struct Entry {
+    bool inProgress;
+    bool resultAvailable;
+    std::chrono::steady_clock::time_point startTime;
+    bool successful;
+    T value;
+    MrfMemoryAccess::ErrorCode errorCode;
+    std::string errorDetails;
+    std::vector<std::shared_ptr<MrfMemoryAccess::Callback<T>>> waitingCallbacks;
+    std::vector<std::shared_ptr<MrfMemoryAccess::Callback<T>>> nextReadCallbacks;
+  };
+
+  template<typename T>
+  using EntryMap = std::unordered_map<std::uint32_t, Entry<T>>;
+
+  template<typename T>
+  class CallbackImpl;
+
+  // We do not want to allow copy or move construction or assignment.
+  MrfReadCoalescer(const MrfReadCoalescer &) = delete;
+  MrfReadCoalescer(MrfReadCoalescer &&) = delete;
+  MrfReadCoalescer &operator=(const MrfReadCoalescer &) = delete;
+  MrfReadCoalescer &operator=(MrfReadCoalescer &&) = delete;
+
+  std::shared_ptr<MrfMemoryAccess> device;
+
+  /**
+   * Mutex protecting the entry maps.
+   */
+  std::mutex mutex;
+  EntryMap<std::uint16_t> uInt16Entries;
+  EntryMap<std::uint32_t> uInt32Entries;
+
+  template<typename T>
+  void read(EntryMap<T> &entries, std::uint32_t address,
+      std::chrono::steady_clock::duration maxAge,
+      std::shared_ptr<MrfMemoryAccess::Callback<T>> callback);
+
+  template<typename T>
+  void readFinished(EntryMap<T> &entries, std::uint32_t address,
+      bool successful, T value, MrfMemoryAccess::ErrorCode errorCode,
+      const std::string &errorDetails);
+
+  template<typename T>
+  void startSharedRead(EntryMap<T> &entries, std::uint32_t address);
+
+  void startRead(std::uint32_t address,
+      std::shared_ptr<MrfMemoryAccess::CallbackUInt16> callback);
+
+  void startRead(std::uint32_t address,
+      std::shared_ptr<MrfMemoryAccess::CallbackUInt32> callback);
+
+};
+
+}
+}
+}
+
+#endif // ANKA_MRF_EPICS_READ_COALESCER_H
@@ -40,6 +40,7 @@
 #include <MrfConsistentMemoryAccess.h>
 
 #include "MrfDeviceRegistry.h"
+#include "MrfProcessScheduler.h"
 #include "MrfRecordAddress.h"
 
 namespace anka {
@@ -202,7 +203,7 @@ MrfRecord<RecordType>::MrfRecord(RecordType *record,
     const ::DBLINK &addressField) :
     address(readRecordAddress(addressField)), record(record) {
   this->device = MrfDeviceRegistry::getInstance().getDevice(
-      this->address.getDeviceId());
+      this->address.getDeviceHandle());
   if (!this->device) {
     throw std::runtime_error(
         std::string("Could not find device ") + this->address.getDeviceId()
@@ -252,7 +253,8 @@ void MrfRecord<RecordType>::scheduleProcessing() {
   // Registering the callback establishes a happens-before relationship due to
   // an internal lock. Therefore, data written before registering the callback
   // is seen by the callback function.
-  ::callbackRequestProcessCallback(&this->processCallback, priorityMedium,
+  MrfProcessScheduler::getInstance().requestProcessing(&this->processCallback,
+      MrfProcessScheduler::toEpicsPriority(address.getCallbackPriority()),
       this->record);
 }
 
@@ -263,7 +265,7 @@ MrfRecordAddress MrfRecord<RecordType>::readRecordAddress(
     throw std::runtime_error(
         "Invalid device address. Maybe mixed up INP/OUT or forgot '@'?");
   }
-  return MrfRecordAddress(
+  return MrfRecordAddress::parseCached(
       addressField.value.instio.string == nullptr ?
           "" : addressField.value.instio.string);
 }
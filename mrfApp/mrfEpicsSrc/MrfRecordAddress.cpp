@@ -30,8 +30,14 @@
 #include <algorithm>
 #include <cctype>
 #include <climits>
+#include <cstring>
+#include <mutex>
 #include <stdexcept>
 #include <tuple>
+#include <type_traits>
+#include <unordered_map>
+
+#include <initHooks.h>
 
 #include "MrfRecordAddress.h"
 
@@ -41,14 +47,51 @@ namespace epics {
 
 namespace {
 
+// Record addresses are copied by the parse cache and kept by each record, so
+// they should stay small and must not own any resources.
+static_assert(std::is_standard_layout<MrfRecordAddress>::value
+    && std::is_trivially_destructible<MrfRecordAddress>::value,
+    "MrfRecordAddress must be a standard-layout, trivially destructible type.");
+
+/**
+ * Cache of parsed record addresses, keyed by the address string.
+ */
+struct ParseCache {
+  std::mutex mutex;
+  std::unordered_map<std::string, MrfRecordAddress> addresses;
+};
+
 const std::string emptyString;
 
-bool compareStringsIgnoreCase(const std::string &str1,
-    const std::string &str2) {
-  if (str1.length() != str2.length()) {
+ParseCache &getParseCache() {
+  static ParseCache parseCache;
+  return parseCache;
+}
+
+void initHook(::initHookState state) {
+  // All records have been initialized at this point, so nobody is going to
+  // parse addresses any longer and we can free the memory used by the cache.
+  if (state == initHookAfterInitDatabase) {
+    MrfRecordAddress::clearParseCache();
+  }
+}
+
+// Every record address is parsed while the IOC starts, so we avoid creating
+// temporary strings when comparing tokens with string literals and prefixes.
+bool compareStringsIgnoreCase(const std::string &str1, const char *str2) {
+  std::size_t length = std::strlen(str2);
+  if (str1.length() != length) {
+    return false;
+  }
+  return std::equal(str1.begin(), str1.end(), str2,
+      [](char c1, char c2) {return std::tolower(c1) == std::tolower(c2);});
+}
+
+bool startsWithIgnoreCase(const std::string &str, const std::string &prefix) {
+  if (str.length() < prefix.length()) {
     return false;
   }
-  return std::equal(str1.begin(), str1.end(), str2.begin(),
+  return std::equal(prefix.begin(), prefix.end(), str.begin(),
       [](char c1, char c2) {return std::tolower(c1) == std::tolower(c2);});
 }
 
@@ -164,9 +207,12 @@ std::tuple<std::uint32_t, signed char, signed char> parseMemoryAddress(
 }
 
 MrfRecordAddress::MrfRecordAddress(const std::string &addressString) :
-    changedElementsOnly(false), elementDistance(0), readOnInit(true),
-    stringLength(0), verify(true), zeroOtherBits(false) {
-  const std::string delimiters(" \t\n\v\f\r");
+    address(0), elementDistance(0), maxAgeMilliseconds(0), stringLength(0),
+    deviceHandle(0), pollGroupHandle(0), highestBit(0), lowestBit(0),
+    dataType(DataType::uInt32), callbackPriority(CallbackPriority::medium),
+    changedElementsOnly(false), lazyInit(false), postedWrite(false),
+    readOnInit(true), verify(true), zeroOtherBits(false) {
+  static const std::string delimiters(" \t\n\v\f\r");
   std::size_t tokenStart, tokenLength;
   // First, read the device name.
   std::tie(tokenStart, tokenLength) = findNextToken(addressString, delimiters,
@@ -174,7 +220,8 @@ MrfRecordAddress::MrfRecordAddress(const std::string &addressString) :
   if (tokenStart == std::string::npos) {
     throw std::invalid_argument("Could not find device ID in record address.");
   }
-  deviceId = addressString.substr(tokenStart, tokenLength);
+  deviceHandle = MrfIdTable::getInstance().intern(
+      addressString.substr(tokenStart, tokenLength));
   // Next, read the address. However, we have to delay the parsing of the address
   // until we know the data type.
   std::tie(tokenStart, tokenLength) = findNextToken(addressString, delimiters,
@@ -206,8 +253,11 @@ MrfRecordAddress::MrfRecordAddress(const std::string &addressString) :
   // Read additional optional flags.
   std::tie(tokenStart, tokenLength) = findNextToken(addressString, delimiters,
       tokenStart + tokenLength);
-  const std::string elementDistanceString = "element_distance=";
-  const std::string stringLengthString = "string_length=";
+  static const std::string elementDistanceString = "element_distance=";
+  static const std::string maxAgeString = "max_age=";
+  static const std::string pollGroupString = "poll_group=";
+  static const std::string priorityString = "priority=";
+  static const std::string stringLengthString = "string_length=";
   while (tokenStart != std::string::npos) {
     std::string token = addressString.substr(tokenStart, tokenLength);
     if (compareStringsIgnoreCase(token, "zero_other_bits")) {
@@ -217,12 +267,13 @@ MrfRecordAddress::MrfRecordAddress(const std::string &addressString) :
       readOnInit = false;
     } else if (compareStringsIgnoreCase(token, "no_read_on_init")) {
       readOnInit = false;
+    } else if (compareStringsIgnoreCase(token, "lazy_init")) {
+      lazyInit = true;
     } else if (compareStringsIgnoreCase(token, "changed_elements_only")) {
       changedElementsOnly = true;
-    } else if (token.length() >= elementDistanceString.length()
-        && compareStringsIgnoreCase(
-            token.substr(0, elementDistanceString.length()),
-            elementDistanceString)) {
+    } else if (compareStringsIgnoreCase(token, "posted_write")) {
+      postedWrite = true;
+    } else if (startsWithIgnoreCase(token, elementDistanceString)) {
       std::size_t numberLength;
       unsigned long elementDistance;
       try {
@@ -245,10 +296,48 @@ MrfRecordAddress::MrfRecordAddress(const std::string &addressString) :
                 + token);
       }
       this->elementDistance = elementDistance;
-    } else if (token.length() >= stringLengthString.length()
-        && compareStringsIgnoreCase(
-            token.substr(0, stringLengthString.length()),
-            stringLengthString)) {
+    } else if (startsWithIgnoreCase(token, maxAgeString)) {
+      std::size_t numberLength;
+      unsigned long maxAge;
+      try {
+        maxAge = std::stoul(
+            token.substr(maxAgeString.length(), std::string::npos),
+            &numberLength, 0);
+      } catch (std::invalid_argument&) {
+        throw std::invalid_argument(
+            std::string("Invalid maximum age in record address: ") + token);
+      } catch (std::out_of_range&) {
+        throw std::invalid_argument(
+            std::string("Invalid maximum age in record address: ") + token);
+      }
+      // We have to make sure that the value fits into a signed integer.
+      if (maxAge > INT_MAX) {
+        throw std::invalid_argument(
+            std::string("Invalid maximum age in record address: ") + token);
+      }
+      this->maxAgeMilliseconds = static_cast<std::uint32_t>(maxAge);
+    } else if (startsWithIgnoreCase(token, pollGroupString)) {
+      std::string pollGroupId = token.substr(pollGroupString.length(),
+          std::string::npos);
+      if (pollGroupId.empty()) {
+        throw std::invalid_argument(
+            std::string("Invalid poll group in record address: ") + token);
+      }
+      pollGroupHandle = MrfIdTable::getInstance().intern(pollGroupId);
+    } else if (startsWithIgnoreCase(token, priorityString)) {
+      std::string priorityValue = token.substr(priorityString.length(),
+          std::string::npos);
+      if (compareStringsIgnoreCase(priorityValue, "low")) {
+        callbackPriority = CallbackPriority::low;
+      } else if (compareStringsIgnoreCase(priorityValue, "medium")) {
+        callbackPriority = CallbackPriority::medium;
+      } else if (compareStringsIgnoreCase(priorityValue, "high")) {
+        callbackPriority = CallbackPriority::high;
+      } else {
+        throw std::invalid_argument(
+            std::string("Invalid priority in record address: ") + token);
+      }
+    } else if (startsWithIgnoreCase(token, stringLengthString)) {
       std::size_t numberLength;
       unsigned long stringLength;
       try {
@@ -280,6 +369,45 @@ MrfRecordAddress::MrfRecordAddress(const std::string &addressString) :
   }
 }
 
+std::atomic<bool> MrfRecordAddress::initHookRegistered(false);
+
+void MrfRecordAddress::clearParseCache() {
+  ParseCache &parseCache = getParseCache();
+  std::lock_guard<std::mutex> lock(parseCache.mutex);
+  // Swapping with an empty map releases the memory, which clear() does not
+  // necessarily do.
+  std::unordered_map<std::string, MrfRecordAddress>().swap(
+      parseCache.addresses);
+}
+
+MrfRecordAddress MrfRecordAddress::parseCached(
+    const std::string &addressString) {
+  ParseCache &parseCache = getParseCache();
+  {
+    std::lock_guard<std::mutex> lock(parseCache.mutex);
+    auto iterator = parseCache.addresses.find(addressString);
+    if (iterator != parseCache.addresses.end()) {
+      return iterator->second;
+    }
+  }
+  // We parse the address without holding the mutex. If another thread parses
+  // the same string concurrently, both threads get the same result, so it
+  // does not matter which one ends up in the cache.
+  MrfRecordAddress address(addressString);
+  std::lock_guard<std::mutex> lock(parseCache.mutex);
+  parseCache.addresses.insert(std::make_pair(addressString, address));
+  return address;
+}
+
+void MrfRecordAddress::registerInitHook() {
+  if (!initHookRegistered.exchange(true)) {
+    if (::initHookRegister(initHook)) {
+      initHookRegistered.store(false);
+      throw std::runtime_error("Could not register the init hook.");
+    }
+  }
+}
+
 }
 }
 }
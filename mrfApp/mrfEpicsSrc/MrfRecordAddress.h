@@ -30,15 +30,25 @@
 #ifndef ANKA_MRF_EPICS_RECORD_ADDRESS_H
 #define ANKA_MRF_EPICS_RECORD_ADDRESS_H
 
+#include <atomic>
+#include <chrono>
 #include <cstdint>
 #include <string>
 
+#include "MrfIdTable.h"
+
 namespace anka {
 namespace mrf {
 namespace epics {
 
 /**
  * Record address for the MRF memory device support.
+ *
+ * Instances of this class are small and trivially copyable: The device ID and
+ * the poll group ID are interned in the {@link MrfIdTable}, so that the
+ * address only stores their handles, and the flags are packed into bit
+ * fields. This matters because each record keeps a copy of its address and an
+ * IOC can have tens of thousands of records.
  */
 class MrfRecordAddress {
 
@@ -47,7 +57,7 @@ public:
   /**
    * Type of the memory register.
    */
-  enum class DataType {
+  enum class DataType : std::uint8_t {
     /**
      * Unsigned 16-bit register.
      */
@@ -59,17 +69,60 @@ public:
     uInt32
   };
 
+  /**
+   * Priority of the EPICS callback thread that processes the record after an
+   * asynchronous operation has finished.
+   */
+  enum class CallbackPriority : std::uint8_t {
+    low, medium, high
+  };
+
   /**
    * Creates a record address from a string. Throws an std::invalid_argument
    * exception if the address string does not specify a valid address.
    */
   MrfRecordAddress(const std::string &addressString);
 
+  /**
+   * Clears the cache used by {@link #parseCached(const std::string &)}. This
+   * happens automatically when all records have been initialized, because the
+   * addresses are not parsed any longer after that.
+   */
+  static void clearParseCache();
+
+  /**
+   * Returns the record address for the specified string, like the constructor
+   * does. The addresses are cached, so that a string that has been parsed
+   * before is not parsed again. During IOC initialization, the same address
+   * strings are typically parsed more than once (e.g. by the
+   * {@link MrfCachePreheater} and when initializing the record), and records
+   * generated from the same template often share their address strings.
+   * Errors are not cached, so an invalid address string results in an
+   * exception each time.
+   */
+  static MrfRecordAddress parseCached(const std::string &addressString);
+
+  /**
+   * Registers the init hook that clears the parse cache when all records have
+   * been initialized. This is called by the registrar of this device support,
+   * so it does not have to be called by user code. Calling it more than once
+   * has no effect.
+   */
+  static void registerInitHook();
+
+  /**
+   * Returns the handle of the device ID in the {@link MrfIdTable}. Looking up
+   * the device by its handle is cheaper than looking it up by its ID.
+   */
+  inline MrfIdTable::Handle getDeviceHandle() const {
+    return deviceHandle;
+  }
+
   /**
    * Returns the string identifying the device.
    */
   inline const std::string &getDeviceId() const {
-    return deviceId;
+    return MrfIdTable::getInstance().getId(deviceHandle);
   }
 
   /**
@@ -152,6 +205,20 @@ public:
     return verify;
   }
 
+  /**
+   * Tells whether writes should be posted. If <code>true</code>, an output
+   * record completes processing as soon as the write has been queued, without
+   * waiting for the device's response. Failures and (if the verify flag is
+   * set) mismatches of the value read back are reported when the record is
+   * processed the next time and are counted per device, so that they can be
+   * monitored through a separate record. If <code>false</code>, the record
+   * completes processing when the write has finished. For input records, this
+   * flag does not have any effects.
+   */
+  inline bool isPostedWrite() const {
+    return postedWrite;
+  }
+
   /**
    * Tells whether the record should be initialized with the value read from the
    * device. If <code>true</code>, the current value is read once during record
@@ -163,6 +230,20 @@ public:
     return readOnInit;
   }
 
+  /**
+   * Tells whether the record should be initialized lazily. If
+   * <code>true</code>, the record is not initialized while iocInit is running,
+   * but after the IOC has been started (see {@link MrfLazyInitializer}). Output
+   * records read their initial value from the device at that point (unless
+   * the read-on-init flag is <code>false</code>) and input records are
+   * processed once. If <code>false</code>, output records read their initial
+   * value during record initialization and input records are not processed
+   * by the device support.
+   */
+  inline bool isLazyInit() const {
+    return lazyInit;
+  }
+
   /**
    * Tells whether a write operation should send all elements of an array to the
    * device or just the one that have been changed. This flag only has an
@@ -176,22 +257,67 @@ public:
     return changedElementsOnly;
   }
 
+  /**
+   * Returns the ID of the poll group that the record belongs to. If the record
+   * does not belong to a poll group, the empty string is returned. Records
+   * belonging to a poll group do not read from the device themselves, but get
+   * the values that are periodically read by the poll group. This setting is
+   * only supported by the ai, bi, longin, mbbi, and mbbiDirect records.
+   */
+  inline const std::string &getPollGroupId() const {
+    return MrfIdTable::getInstance().getId(pollGroupHandle);
+  }
+
+  /**
+   * Returns the maximum age of a read result that may be shared with other
+   * records reading the same register. When the record is processed while a
+   * read of the same register that has been started no longer than this time
+   * ago is in progress or has finished, the record uses the result of that
+   * read instead of reading the register again. The default is zero, meaning
+   * that the record always reads the register itself. This setting is only
+   * supported by the ai, bi, longin, mbbi, and mbbiDirect records.
+   */
+  inline std::chrono::milliseconds getMaxAge() const {
+    return std::chrono::milliseconds(maxAgeMilliseconds);
+  }
+
+  /**
+   * Returns the priority of the EPICS callback thread that processes the
+   * record after an asynchronous read or write operation has finished. The
+   * default is {@code medium}. Records that are time-critical can use
+   * {@code high}, while records that are only used for bulk settings can use
+   * {@code low}, so that they do not delay other records.
+   */
+  inline CallbackPriority getCallbackPriority() const {
+    return callbackPriority;
+  }
+
 private:
 
-  std::string deviceId;
+  static std::atomic<bool> initHookRegistered;
 
+  // The fields are ordered by their size, so that there is no padding between
+  // them.
   std::uint32_t address;
+  int elementDistance;
+  std::uint32_t maxAgeMilliseconds;
+  int stringLength;
+
+  MrfIdTable::Handle deviceHandle;
+  MrfIdTable::Handle pollGroupHandle;
+
   signed char highestBit;
   signed char lowestBit;
 
   DataType dataType;
+  CallbackPriority callbackPriority;
 
-  bool changedElementsOnly;
-  int elementDistance;
-  bool readOnInit;
-  int stringLength;
-  bool verify;
-  bool zeroOtherBits;
+  bool changedElementsOnly : 1;
+  bool lazyInit : 1;
+  bool postedWrite : 1;
+  bool readOnInit : 1;
+  bool verify : 1;
+  bool zeroOtherBits : 1;
 
 };
 
@@ -0,0 +1,160 @@
+/*
+ * Copyright 2026 aquenos GmbH.
+ * Copyright 2026 Karlsruhe Institute of Technology.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * This software has been developed by aquenos GmbH on behalf of the
+ * Karlsruhe Institute of Technology's Institute for Beam Physics and
+ * Technology.
+ *
+ * This software contains code originally developed by aquenos GmbH for
+ * the s7nodave EPICS device support. aquenos GmbH has relicensed the
+ * affected poritions of code from the s7nodave EPICS device support
+ * (originally licensed under the terms of the GNU GPL) under the terms
+ * of the GNU LGPL version 3 or newer.
+ */
+
+#ifndef ANKA_MRF_EPICS_SPSC_RING_H
+#define ANKA_MRF_EPICS_SPSC_RING_H
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <stdexcept>
+
+namespace anka {
+namespace mrf {
+namespace epics {
+
+/**
+ * Bounded lock-free queue for exactly one producer thread and one consumer
+ * thread. Pushing and popping elements never blocks and never allocates
+ * memory, so the queue can be used to hand data from an I/O thread to record
+ * processing without the risk of the I/O thread being delayed by a lock.
+ *
+ * At any time, at most one thread may call {@link push(const T&)} and at most
+ * one (other) thread may call {@link pop(T&)}. The capacity is rounded up to
+ * the next power of two.
+ */
+template<typename T>
+class MrfSpscRing {
+
+public:
+
+  /**
+   * Creates a ring that can hold at least the specified number of elements.
+   * Throws an exception if the capacity is zero or too large.
+   */
+  explicit MrfSpscRing(std::size_t minimumCapacity) :
+      head(0), tail(0) {
+    if (minimumCapacity == 0) {
+      throw std::invalid_argument("The capacity must not be zero.");
+    }
+    std::size_t roundedCapacity = 1;
+    while (roundedCapacity < minimumCapacity) {
+      if (roundedCapacity > (static_cast<std::size_t>(-1) >> 2)) {
+        throw std::invalid_argument("The capacity is too large.");
+      }
+      roundedCapacity <<= 1;
+    }
+    this->capacityMask = roundedCapacity - 1;
+    this->elements.reset(new T[roundedCapacity]);
+  }
+
+  /**
+   * Returns the number of elements that the ring can hold.
+   */
+  inline std::size_t capacity() const {
+    return capacityMask + 1;
+  }
+
+  /**
+   * Adds an element to the ring. Returns {@code true} if the element has been
+   * added and {@code false} if the ring is full. May only be called by the
+   * producer thread.
+   */
+  inline bool push(const T &element) {
+    std::size_t currentTail = tail.load(std::memory_order_relaxed);
+    if (currentTail - head.load(std::memory_order_acquire) > capacityMask) {
+      return false;
+    }
+    elements[currentTail & capacityMask] = element;
+    tail.store(currentTail + 1, std::memory_order_release);
+    return true;
+  }
+
+  /**
+   * Removes the oldest element from the ring and stores it in the specified
+   * variable. Returns {@code true} if an element has been removed and
+   * {@code false} if the ring is empty. May only be called by the consumer
+   * thread.
+   */
+  inline bool pop(T &element) {
+    std::size_t currentHead = head.load(std::memory_order_relaxed);
+    if (currentHead == tail.load(std::memory_order_acquire)) {
+      return false;
+    }
+    element = elements[currentHead & capacityMask];
+    head.store(currentHead + 1, std::memory_order_release);
+    return true;
+  }
+
+  /**
+   * Tells whether the ring is empty. The result is only a snapshot when
+   * called while the other thread is pushing or popping elements.
+   */
+  inline bool empty() const {
+    return head.load(std::memory_order_acquire)
+        == tail.load(std::memory_order_acquire);
+  }
+
+  /**
+   * Returns the number of elements in the ring. The result is only a
+   * snapshot when called while the other thread is pushing or popping
+   * elements.
+   */
+  inline std::size_t size() const {
+    return tail.load(std::memory_order_acquire)
+        - head.load(std::memory_order_acquire);
+  }
+
+private:
+
+  // We do not want to allow copy or move construction or assignment.
+  MrfSpscRing(const MrfSpscRing &) = delete;
+  MrfSpscRing(MrfSpscRing &&) = delete;
+  MrfSpscRing &operator=(const MrfSpscRing &) = delete;
+  MrfSpscRing &operator=(MrfSpscRing &&) = delete;
+
+  // The head is only written by the consumer and the tail is only written by
+  // the producer. We keep them on separate cache lines, so that the two
+  // threads do not invalidate each other's cache line on every operation.
+  // The counters are never reset, they simply wrap around, which is fine
+  // because the capacity is a power of two.
+  std::atomic<std::size_t> head;
+  char headPadding[64 - sizeof(std::atomic<std::size_t>)];
+  std::atomic<std::size_t> tail;
+  char tailPadding[64 - sizeof(std::atomic<std::size_t>)];
+  std::size_t capacityMask;
+  std::unique_ptr<T[]> elements;
+
+};
+
+} // namespace epics
+} // namespace mrf
+} // namespace anka
+
+#endif // ANKA_MRF_EPICS_SPSC_RING_H
@@ -0,0 +1,432 @@
+/*
+ * Copyright 2026 aquenos GmbH.
+ * Copyright 2026 Karlsruhe Institute of Technology.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * This software has been developed by aquenos GmbH on behalf of the
+ * Karlsruhe Institute of Technology's Institute for Beam Physics and
+ * Technology.
+ *
+ * This software contains code originally developed by aquenos GmbH for
+ * the s7nodave EPICS device support. aquenos GmbH has relicensed the
+ * affected poritions of code from the s7nodave EPICS device support
+ * (originally licensed under the terms of the GNU GPL) under the terms
+ * of the GNU LGPL version 3 or newer.
+ */
+
+#include <algorithm>
+#include <cstdio>
+#include <map>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <epicsStdio.h>
+#include <errlog.h>
+#include <initHooks.h>
+
+#include "mrfEpicsError.h"
+
+#include "MrfStartupProfiler.h"
+
+namespace anka {
+namespace mrf {
+namespace epics {
+
+namespace {
+
+using Clock = MrfStartupProfiler::Clock;
+
+/**
+ * Maximum number of events that are kept for the trace file. Further events
+ * are still included in the summary, but they are not written to the trace
+ * file, so that the memory consumption is bounded for very large databases.
+ */
+constexpr std::size_t maxTraceEvents = 200000;
+
+/**
+ * Number of records that are listed in the summary as the slowest ones.
+ */
+constexpr std::size_t slowestRecordsCount = 10;
+
+struct Event {
+  const char *category;
+  std::string name;
+  Clock::time_point startTime;
+  Clock::time_point endTime;
+  unsigned threadIndex;
+  // Only used for record initialization events.
+  const char *recordType;
+  Clock::duration blockedTime;
+};
+
+struct RecordTypeStatistics {
+  std::size_t records;
+  std::size_t blockedRecords;
+  Clock::duration initTime;
+  Clock::duration blockedTime;
+  Clock::duration maxInitTime;
+};
+
+struct SlowRecord {
+  std::string name;
+  std::string recordType;
+  Clock::duration initTime;
+  Clock::duration blockedTime;
+};
+
+struct ProfilerState {
+  std::mutex mutex;
+  Clock::time_point startTime;
+  std::string traceFileName;
+  bool initHookRegistered = false;
+  std::vector<Event> events;
+  std::size_t droppedEvents = 0;
+  std::map<std::thread::id, unsigned> threadIndices;
+  std::vector<std::pair<const char *, Clock::time_point>> phases;
+  std::map<std::string, RecordTypeStatistics> recordTypes;
+  std::vector<SlowRecord> slowestRecords;
+  std::atomic<std::size_t> cacheHits {0};
+  std::atomic<std::size_t> cacheWaits {0};
+  std::atomic<std::size_t> cacheMisses {0};
+  std::atomic<Clock::rep> cacheWaitTime {0};
+  std::atomic<Clock::rep> cacheMissTime {0};
+};
+
+thread_local Clock::duration threadBlockedTime = Clock::duration::zero();
+
+ProfilerState &getState() {
+  static ProfilerState state;
+  return state;
+}
+
+double toMilliseconds(Clock::duration duration) {
+  return std::chrono::duration<double, std::milli>(duration).count();
+}
+
+double toMicroseconds(Clock::duration duration) {
+  return std::chrono::duration<double, std::micro>(duration).count();
+}
+
+/**
+ * Adds an event. This must only be called while holding the mutex.
+ */
+void addEvent(ProfilerState &state, Event &&event) {
+  if (state.events.size() >= maxTraceEvents) {
+    ++state.droppedEvents;
+    return;
+  }
+  auto threadIndexIterator = state.threadIndices.emplace(
+      std::this_thread::get_id(),
+      static_cast<unsigned>(state.threadIndices.size() + 1)).first;
+  event.threadIndex = threadIndexIterator->second;
+  state.events.push_back(std::move(event));
+}
+
+/**
+ * Writes a string as a JSON string literal.
+ */
+void writeJsonString(std::FILE *file, const std::string &value) {
+  std::fputc('"', file);
+  for (char c : value) {
+    if (c == '"' || c == '\\') {
+      std::fputc('\\', file);
+      std::fputc(c, file);
+    } else if (static_cast<unsigned char>(c) < 0x20) {
+      std::fprintf(file, "\\u%04x", static_cast<unsigned>(c));
+    } else {
+      std::fputc(c, file);
+    }
+  }
+  std::fputc('"', file);
+}
+
+void writeTraceFile(ProfilerState &state, const std::string &fileName) {
+  std::FILE *file = std::fopen(fileName.c_str(), "w");
+  if (!file) {
+    throw std::runtime_error("Could not open " + fileName + " for writing.");
+  }
+  std::fputs("{\"traceEvents\":[\n", file);
+  bool first = true;
+  for (auto &event : state.events) {
+    std::fputs(first ? "" : ",\n", file);
+    first = false;
+    std::fputs("{\"name\":", file);
+    writeJsonString(file, event.name);
+    std::fputs(",\"cat\":", file);
+    writeJsonString(file, event.category);
+    std::fprintf(file,
+        ",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f",
+        event.threadIndex, toMicroseconds(event.startTime - state.startTime),
+        toMicroseconds(event.endTime - event.startTime));
+    if (event.recordType) {
+      std::fputs(",\"args\":{\"type\":", file);
+      writeJsonString(file, event.recordType);
+      std::fprintf(file, ",\"blocked_us\":%.3f}",
+          toMicroseconds(event.blockedTime));
+    }
+    std::fputc('}', file);
+  }
+  for (auto &phase : state.phases) {
+    std::fputs(first ? "" : ",\n", file);
+    first = false;
+    std::fputs("{\"name\":", file);
+    writeJsonString(file, phase.first);
+    std::fprintf(file,
+        ",\"cat\":\"iocInit\",\"ph\":\"i\",\"s\":\"g\",\"pid\":1,\"tid\":0,"
+        "\"ts\":%.3f}", toMicroseconds(phase.second - state.startTime));
+  }
+  std::fputs("\n]}\n", file);
+  bool failed = std::ferror(file);
+  if (std::fclose(file) || failed) {
+    throw std::runtime_error("Could not write " + fileName + ".");
+  }
+}
+
+const char *getPhaseName(::initHookState state) {
+  switch (state) {
+  case initHookAtBeginning:
+    return "iocInit started";
+  case initHookAfterInitDevSup:
+    return "Device support initialized";
+  case initHookAfterInitDatabase:
+    return "Records initialized";
+  case initHookAfterFinishDevSup:
+    return "Device support finished";
+  case initHookAfterInitialProcess:
+    return "PINI records processed";
+  case initHookAfterIocRunning:
+    return "IOC running";
+  default:
+    return nullptr;
+  }
+}
+
+void initHook(::initHookState hookState) {
+  if (!MrfStartupProfiler::isEnabled()) {
+    return;
+  }
+  const char *phaseName = getPhaseName(hookState);
+  if (!phaseName) {
+    return;
+  }
+  auto &state = getState();
+  std::string traceFileName;
+  {
+    std::lock_guard<std::mutex> lock(state.mutex);
+    state.phases.emplace_back(phaseName, Clock::now());
+    if (hookState != initHookAfterIocRunning) {
+      return;
+    }
+    traceFileName = state.traceFileName;
+  }
+  // Once the IOC is running, the startup has finished, so we stop recording.
+  // Events that are recorded by other threads after this point are still
+  // added, but there should not be many of them.
+  MrfStartupProfiler::disable();
+  if (traceFileName.empty()) {
+    return;
+  }
+  try {
+    std::lock_guard<std::mutex> lock(state.mutex);
+    writeTraceFile(state, traceFileName);
+    ::errlogPrintf("Startup trace has been written to %s.\n",
+        traceFileName.c_str());
+  } catch (std::exception &e) {
+    errorPrintf("Could not write the startup trace: %s", e.what());
+  } catch (...) {
+    errorPrintf("Could not write the startup trace: Unknown error.");
+  }
+}
+
+} // anonymous namespace
+
+std::atomic<bool> MrfStartupProfiler::enabled(false);
+
+MrfStartupProfiler::Span::Span(const char *category, const std::string &name)
+    : category(category), active(MrfStartupProfiler::isEnabled()) {
+  if (active) {
+    this->name = name;
+    startTime = Clock::now();
+  }
+}
+
+MrfStartupProfiler::Span::~Span() {
+  if (active) {
+    try {
+      MrfStartupProfiler::recordSpan(category, name, startTime, Clock::now());
+    } catch (...) {
+      // A destructor must not throw and a missing event is not a problem.
+    }
+  }
+}
+
+void MrfStartupProfiler::disable() {
+  enabled.store(false, std::memory_order_relaxed);
+}
+
+void MrfStartupProfiler::enable(const std::string &traceFileName) {
+  auto &state = getState();
+  std::lock_guard<std::mutex> lock(state.mutex);
+  if (!state.initHookRegistered) {
+    if (::initHookRegister(initHook)) {
+      throw std::runtime_error("Could not register the init hook.");
+    }
+    state.initHookRegistered = true;
+  }
+  state.traceFileName = traceFileName;
+  if (!enabled.exchange(true)) {
+    state.startTime = Clock::now();
+  }
+}
+
+Clock::duration MrfStartupProfiler::getThreadBlockedTime() {
+  return threadBlockedTime;
+}
+
+void MrfStartupProfiler::printSummary() {
+  auto &state = getState();
+  std::lock_guard<std::mutex> lock(state.mutex);
+  if (state.startTime == Clock::time_point()) {
+    ::epicsStdoutPrintf("Startup profiling has not been enabled.\n");
+    return;
+  }
+  ::epicsStdoutPrintf("Times are relative to enabling the profiler.\n");
+  if (!state.phases.empty()) {
+    ::epicsStdoutPrintf("\niocInit:\n");
+    for (auto &phase : state.phases) {
+      ::epicsStdoutPrintf("  %-28s %10.3f ms\n", phase.first,
+          toMilliseconds(phase.second - state.startTime));
+    }
+  }
+  bool haveSpans = false;
+  for (auto &event : state.events) {
+    if (event.recordType) {
+      continue;
+    }
+    if (!haveSpans) {
+      ::epicsStdoutPrintf("\nDevices and caches:\n");
+      ::epicsStdoutPrintf("  %-10s %-28s %12s %12s\n", "Category", "Name",
+          "Start (ms)", "Time (ms)");
+      haveSpans = true;
+    }
+    ::epicsStdoutPrintf("  %-10s %-28s %12.3f %12.3f\n", event.category,
+        event.name.c_str(), toMilliseconds(event.startTime - state.startTime),
+        toMilliseconds(event.endTime - event.startTime));
+  }
+  ::epicsStdoutPrintf("\nBlocking cache reads:\n");
+  ::epicsStdoutPrintf("  Served from cache:          %lu\n",
+      static_cast<unsigned long>(state.cacheHits.load()));
+  ::epicsStdoutPrintf("  Waited for preheat:         %lu (%.3f ms)\n",
+      static_cast<unsigned long>(state.cacheWaits.load()),
+      toMilliseconds(Clock::duration(state.cacheWaitTime.load())));
+  ::epicsStdoutPrintf("  Read from device:           %lu (%.3f ms)\n",
+      static_cast<unsigned long>(state.cacheMisses.load()),
+      toMilliseconds(Clock::duration(state.cacheMissTime.load())));
+  if (!state.recordTypes.empty()) {
+    ::epicsStdoutPrintf("\nRecord initialization:\n");
+    ::epicsStdoutPrintf("  %-16s %8s %12s %8s %12s %10s\n", "Type", "Records",
+        "Total (ms)", "Blocked", "Blocked (ms)", "Max (ms)");
+    for (auto &typeAndStatistics : state.recordTypes) {
+      auto &statistics = typeAndStatistics.second;
+      ::epicsStdoutPrintf("  %-16s %8lu %12.3f %8lu %12.3f %10.3f\n",
+          typeAndStatistics.first.c_str(),
+          static_cast<unsigned long>(statistics.records),
+          toMilliseconds(statistics.initTime),
+          static_cast<unsigned long>(statistics.blockedRecords),
+          toMilliseconds(statistics.blockedTime),
+          toMilliseconds(statistics.maxInitTime));
+    }
+  }
+  if (!state.slowestRecords.empty()) {
+    ::epicsStdoutPrintf("\nSlowest records:\n");
+    for (auto &record : state.slowestRecords) {
+      ::epicsStdoutPrintf("  %-40s %-16s %10.3f ms (blocked %.3f ms)\n",
+          record.name.c_str(), record.recordType.c_str(),
+          toMilliseconds(record.initTime), toMilliseconds(record.blockedTime));
+    }
+  }
+  if (state.droppedEvents) {
+    ::epicsStdoutPrintf(
+        "\n%lu events have not been kept for the trace file.\n",
+        static_cast<unsigned long>(state.droppedEvents));
+  }
+}
+
+void MrfStartupProfiler::recordCacheHit() {
+  getState().cacheHits.fetch_add(1, std::memory_order_relaxed);
+}
+
+void MrfStartupProfiler::recordCacheMiss(Clock::duration duration) {
+  auto &state = getState();
+  state.cacheMisses.fetch_add(1, std::memory_order_relaxed);
+  state.cacheMissTime.fetch_add(duration.count(), std::memory_order_relaxed);
+  threadBlockedTime += duration;
+}
+
+void MrfStartupProfiler::recordCacheWait(Clock::duration duration) {
+  auto &state = getState();
+  state.cacheWaits.fetch_add(1, std::memory_order_relaxed);
+  state.cacheWaitTime.fetch_add(duration.count(), std::memory_order_relaxed);
+  threadBlockedTime += duration;
+}
+
+void MrfStartupProfiler::recordRecordInit(const char *recordName,
+    const char *recordType, Clock::time_point startTime,
+    Clock::time_point endTime, Clock::duration blockedTime) {
+  auto &state = getState();
+  auto initTime = endTime - startTime;
+  std::lock_guard<std::mutex> lock(state.mutex);
+  auto &statistics = state.recordTypes[recordType];
+  ++statistics.records;
+  statistics.initTime += initTime;
+  if (blockedTime > Clock::duration::zero()) {
+    ++statistics.blockedRecords;
+    statistics.blockedTime += blockedTime;
+  }
+  statistics.maxInitTime = std::max(statistics.maxInitTime, initTime);
+  // The list of the slowest records is short, so we simply keep it sorted.
+  auto &slowestRecords = state.slowestRecords;
+  if (slowestRecords.size() < slowestRecordsCount
+      || slowestRecords.back().initTime < initTime) {
+    if (slowestRecords.size() == slowestRecordsCount) {
+      slowestRecords.pop_back();
+    }
+    auto position = std::find_if(slowestRecords.begin(), slowestRecords.end(),
+        [initTime](const SlowRecord &record) {
+          return record.initTime < initTime;
+        });
+    slowestRecords.insert(position,
+        SlowRecord {recordName, recordType, initTime, blockedTime});
+  }
+  addEvent(state, Event {"record", recordName, startTime, endTime, 0,
+      recordType, blockedTime});
+}
+
+void MrfStartupProfiler::recordSpan(const char *category,
+    const std::string &name, Clock::time_point startTime,
+    Clock::time_point endTime) {
+  auto &state = getState();
+  std::lock_guard<std::mutex> lock(state.mutex);
+  addEvent(state, Event {category, name, startTime, endTime, 0, nullptr,
+      Clock::duration::zero()});
+}
+
+}
+}
+}
@@ -0,0 +1,187 @@
+/*
+ * Copyright 2026 aquenos GmbH.
+ * Copyright 2026 Karlsruhe Institute of Technology.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * This software has been developed by aquenos GmbH on behalf of the
+ * Karlsruhe Institute of Technology's Institute for Beam Physics and
+ * Technology.
+ *
+ * This software contains code originally developed by aquenos GmbH for
+ * the s7nodave EPICS device support. aquenos GmbH has relicensed the
+ * affected poritions of code from the s7nodave EPICS device support
+ * (originally licensed under the terms of the GNU GPL) under the terms
+ * of the GNU LGPL version 3 or newer.
+ */
+
+#ifndef ANKA_MRF_EPICS_STARTUP_PROFILER_H
+#define ANKA_MRF_EPICS_STARTUP_PROFILER_H
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <string>
+
+namespace anka {
+namespace mrf {
+namespace epics {
+
+/**
+ * Records where the time is spent while the IOC starts: creating the devices,
+ * loading cache snapshots, preheating the caches, and initializing the
+ * records. For the records, the time spent in {@code init_record} is
+ * aggregated by record type, together with the time that has been spent
+ * waiting for blocking reads from the memory cache, and the slowest records are
+ * remembered. The memory caches count how many blocking reads have been served
+ * from the cache, have waited for a preheat read, or have had to read from the
+ * device.
+ *
+ * Profiling is disabled by default, and while it is disabled, the
+ * instrumented code only checks an atomic flag. It is enabled by calling
+ * {@link #enable(const std::string&)}, which should happen before the devices
+ * are created. Profiling ends when the IOC is running (after iocInit has
+ * finished). At that point, the recorded events are written to a trace file
+ * (if one has been specified) that uses the Trace Event Format, which can be
+ * loaded into Chrome's trace viewer or Perfetto. A summary can be printed with
+ * {@link #printSummary()}.
+ *
+ * This class only has static members.
+ */
+class MrfStartupProfiler {
+
+public:
+
+  /**
+   * Clock that is used for all time measurements.
+   */
+  using Clock = std::chrono::steady_clock;
+
+  /**
+   * Measures the time between its construction and its destruction and
+   * records it as a span with the specified category and name. If profiling is
+   * not enabled when the span is constructed, nothing is recorded.
+   */
+  class Span {
+
+  public:
+
+    /**
+     * Creates a span. The category has to be a string literal (or another
+     * string that is never freed).
+     */
+    Span(const char *category, const std::string &name);
+
+    /**
+     * Records the span.
+     */
+    ~Span();
+
+  private:
+
+    const char *category;
+    std::string name;
+    Clock::time_point startTime;
+    bool active;
+
+    // We do not want to allow copy or move construction or assignment.
+    Span(const Span &) = delete;
+    Span(Span &&) = delete;
+    Span &operator=(const Span &) = delete;
+    Span &operator=(Span &&) = delete;
+
+  };
+
+  /**
+   * Disables profiling. This is called automatically when the IOC is running.
+   * Events that have been recorded so far are kept.
+   */
+  static void disable();
+
+  /**
+   * Enables profiling. If the trace file name is not empty, the recorded
+   * events are written to this file when the IOC is running. Throws an
+   * exception if the init hook that finishes profiling cannot be registered.
+   * Calling this method again only changes the name of the trace file.
+   */
+  static void enable(const std::string &traceFileName);
+
+  /**
+   * Returns the total time that the calling thread has spent waiting for
+   * blocking reads from the memory caches while profiling was enabled.
+   */
+  static Clock::duration getThreadBlockedTime();
+
+  /**
+   * Tells whether events are being recorded.
+   */
+  inline static bool isEnabled() {
+    return enabled.load(std::memory_order_relaxed);
+  }
+
+  /**
+   * Prints a summary of the events that have been recorded so far.
+   */
+  static void printSummary();
+
+  /**
+   * Records a blocking read that has been served from a memory cache.
+   */
+  static void recordCacheHit();
+
+  /**
+   * Records a blocking read that had to be sent to the device, because the
+   * register was not in the memory cache.
+   */
+  static void recordCacheMiss(Clock::duration duration);
+
+  /**
+   * Records a blocking read that had to wait for a preheat read of the
+   * memory cache.
+   */
+  static void recordCacheWait(Clock::duration duration);
+
+  /**
+   * Records the initialization of a record. The blocked time is the time that
+   * the initialization spent waiting for blocking reads from the memory cache.
+   * It is determined by comparing the result of
+   * {@link #getThreadBlockedTime()} before and after initializing the record.
+   * The record type has to stay valid until the IOC is shut down (which is
+   * the case for the name stored in the record's {@code rdes} field).
+   */
+  static void recordRecordInit(const char *recordName, const char *recordType,
+      Clock::time_point startTime, Clock::time_point endTime,
+      Clock::duration blockedTime);
+
+  /**
+   * Records a span that has been measured by the caller.
+   */
+  static void recordSpan(const char *category, const std::string &name,
+      Clock::time_point startTime, Clock::time_point endTime);
+
+private:
+
+  static std::atomic<bool> enabled;
+
+  // This class only has static members.
+  MrfStartupProfiler() = delete;
+
+};
+
+}
+}
+}
+
+#endif // ANKA_MRF_EPICS_STARTUP_PROFILER_H
@@ -37,6 +37,8 @@
 #include <recGbl.h>
 
 #include "MrfDeviceRegistry.h"
+#include "MrfLazyInitializer.h"
+#include "MrfProcessScheduler.h"
 
 #include "MrfStringinRecord.h"
 
@@ -51,7 +53,7 @@ MrfRecordAddress readRecordAddress(const ::DBLINK &addressField) {
     throw std::runtime_error(
         "Invalid device address. Maybe mixed up INP/OUT or forgot '@'?");
   }
-  return MrfRecordAddress(
+  return MrfRecordAddress::parseCached(
       addressField.value.instio.string == nullptr ?
           "" : addressField.value.instio.string);
 }
@@ -83,8 +85,11 @@ void MrfStringinRecord::CallbackImpl::success(
   }
   --deviceSupport.pendingReadRequests;
   if (deviceSupport.pendingReadRequests == 0) {
-    ::callbackRequestProcessCallback(&deviceSupport.processCallback,
-    priorityMedium, deviceSupport.record);
+    MrfProcessScheduler::getInstance().requestProcessing(
+        &deviceSupport.processCallback,
+        MrfProcessScheduler::toEpicsPriority(
+            deviceSupport.address.getCallbackPriority()),
+        deviceSupport.record);
   }
 }
 
@@ -113,8 +118,11 @@ void MrfStringinRecord::CallbackImpl::success(
   }
   --deviceSupport.pendingReadRequests;
   if (deviceSupport.pendingReadRequests == 0) {
-    ::callbackRequestProcessCallback(&deviceSupport.processCallback,
-    priorityMedium, deviceSupport.record);
+    MrfProcessScheduler::getInstance().requestProcessing(
+        &deviceSupport.processCallback,
+        MrfProcessScheduler::toEpicsPriority(
+            deviceSupport.address.getCallbackPriority()),
+        deviceSupport.record);
   }
 }
 
@@ -136,8 +144,11 @@ void MrfStringinRecord::CallbackImpl::failure(uint32_t address,
   }
   --deviceSupport.pendingReadRequests;
   if (deviceSupport.pendingReadRequests == 0) {
-    ::callbackRequestProcessCallback(&deviceSupport.processCallback,
-    priorityMedium, deviceSupport.record);
+    MrfProcessScheduler::getInstance().requestProcessing(
+        &deviceSupport.processCallback,
+        MrfProcessScheduler::toEpicsPriority(
+            deviceSupport.address.getCallbackPriority()),
+        deviceSupport.record);
   }
 }
 
@@ -182,13 +193,26 @@ MrfStringinRecord::MrfStringinRecord(::stringinRecord *record) :
       "The stringin record does not support reading individual bits of a "
       "register.");
   }
+  if (!this->address.getPollGroupId().empty()) {
+    throw std::runtime_error(
+      "The stringin record does not support poll groups.");
+  }
+  if (this->address.getMaxAge().count() > 0) {
+    throw std::runtime_error(
+      "The stringin record does not support the max_age option.");
+  }
   this->device = MrfDeviceRegistry::getInstance().getDevice(
-      this->address.getDeviceId());
+      this->address.getDeviceHandle());
   if (!this->device) {
     throw std::runtime_error(
         std::string("Could not find device ") + this->address.getDeviceId()
             + ".");
   }
+  // Lazily initialized records are processed once when the IOC is running.
+  if (this->address.isLazyInit()) {
+    MrfLazyInitializer::scheduleProcessing(
+        reinterpret_cast<::dbCommon *>(record));
+  }
 }
 
 void MrfStringinRecord::processRecord() {
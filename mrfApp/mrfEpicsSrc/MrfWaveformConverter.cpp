@@ -0,0 +1,111 @@
+/*
+ * Copyright 2026 aquenos GmbH.
+ * Copyright 2026 Karlsruhe Institute of Technology.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * This software has been developed by aquenos GmbH on behalf of the
+ * Karlsruhe Institute of Technology's Institute for Beam Physics and
+ * Technology.
+ *
+ * This software contains code originally developed by aquenos GmbH for
+ * the s7nodave EPICS device support. aquenos GmbH has relicensed the
+ * affected poritions of code from the s7nodave EPICS device support
+ * (originally licensed under the terms of the GNU GPL) under the terms
+ * of the GNU LGPL version 3 or newer.
+ */
+
+#include <cstring>
+#include <stdexcept>
+
+#include <dbFldTypes.h>
+
+#include <mrfElementConversion.h>
+
+#include "MrfWaveformConverter.h"
+
+namespace anka {
+namespace mrf {
+namespace epics {
+
+template<>
+void MrfWaveformConverter::ElementConversion<std::uint8_t>::toRecord(
+    const std::uint32_t *values, void *buffer, std::size_t count) {
+  mrfNarrowUInt32ToUInt8(values, static_cast<std::uint8_t *>(buffer), count);
+}
+
+template<>
+void MrfWaveformConverter::ElementConversion<std::uint8_t>::fromRecord(
+    const void *buffer, std::uint32_t *values, std::size_t count) {
+  mrfWidenUInt8ToUInt32(static_cast<const std::uint8_t *>(buffer), values,
+      count);
+}
+
+template<>
+void MrfWaveformConverter::ElementConversion<std::uint16_t>::toRecord(
+    const std::uint32_t *values, void *buffer, std::size_t count) {
+  mrfNarrowUInt32ToUInt16(values, static_cast<std::uint16_t *>(buffer),
+      count);
+}
+
+template<>
+void MrfWaveformConverter::ElementConversion<std::uint16_t>::fromRecord(
+    const void *buffer, std::uint32_t *values, std::size_t count) {
+  mrfWidenUInt16ToUInt32(static_cast<const std::uint16_t *>(buffer), values,
+      count);
+}
+
+template<>
+void MrfWaveformConverter::ElementConversion<std::uint32_t>::toRecord(
+    const std::uint32_t *values, void *buffer, std::size_t count) {
+  std::memcpy(buffer, values, count * sizeof(std::uint32_t));
+}
+
+template<>
+void MrfWaveformConverter::ElementConversion<std::uint32_t>::fromRecord(
+    const void *buffer, std::uint32_t *values, std::size_t count) {
+  std::memcpy(values, buffer, count * sizeof(std::uint32_t));
+}
+
+template<typename T>
+void MrfWaveformConverter::useElementType() {
+  elementSize = sizeof(T);
+  toRecordFunction = ElementConversion<T>::toRecord;
+  fromRecordFunction = ElementConversion<T>::fromRecord;
+}
+
+MrfWaveformConverter::MrfWaveformConverter(epicsEnum16 elementType) {
+  switch (elementType) {
+  case DBF_CHAR:
+  case DBF_UCHAR:
+    useElementType<std::uint8_t>();
+    break;
+  case DBF_SHORT:
+  case DBF_USHORT:
+    useElementType<std::uint16_t>();
+    break;
+  case DBF_LONG:
+  case DBF_ULONG:
+    useElementType<std::uint32_t>();
+    break;
+  default:
+    throw std::runtime_error(
+        "The value type of the array must be CHAR, UCHAR, SHORT, USHORT, LONG, or ULONG.");
+  }
+}
+
+}
+}
+}
@@ -0,0 +1,124 @@
+/*
+ * Copyright 2026 aquenos GmbH.
+ * Copyright 2026 Karlsruhe Institute of Technology.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * This software has been developed by aquenos GmbH on behalf of the
+ * Karlsruhe Institute of Technology's Institute for Beam Physics and
+ * Technology.
+ *
+ * This software contains code originally developed by aquenos GmbH for
+ * the s7nodave EPICS device support. aquenos GmbH has relicensed the
+ * affected poritions of code from the s7nodave EPICS device support
+ * (originally licensed under the terms of the GNU GPL) under the terms
+ * of the GNU LGPL version 3 or newer.
+ */
+
+#ifndef ANKA_MRF_EPICS_WAVEFORM_CONVERTER_H
+#define ANKA_MRF_EPICS_WAVEFORM_CONVERTER_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include <epicsTypes.h>
+
+namespace anka {
+namespace mrf {
+namespace epics {
+
+/**
+ * Converts between the 32-bit register values of a device and the elements of
+ * a waveform record's value array. The conversion function is selected once
+ * for the record's element type (CHAR, UCHAR, SHORT, USHORT, LONG, or ULONG)
+ * when the converter is created, so that the conversion of the array does not
+ * have to check the element type for each element.
+ *
+ * When converting to the record's value array, values are truncated if the
+ * element type is smaller than 32 bits. When converting from the record's
+ * value array, elements are extended with zeros, even for signed types.
+ */
+class MrfWaveformConverter {
+
+public:
+
+  /**
+   * Creates a converter for the specified element type (the record's FTVL
+   * field). Throws an exception if the element type is not supported.
+   */
+  explicit MrfWaveformConverter(epicsEnum16 elementType);
+
+  /**
+   * Returns the size of a single element of the record's value array (in
+   * bytes).
+   */
+  inline std::size_t getElementSize() const {
+    return elementSize;
+  }
+
+  /**
+   * Copies the specified number of register values into the record's value
+   * array.
+   */
+  inline void toRecord(const std::uint32_t *values, void *buffer,
+      std::size_t count) const {
+    toRecordFunction(values, buffer, count);
+  }
+
+  /**
+   * Copies the specified number of elements of the record's value array into
+   * the array of register values.
+   */
+  inline void fromRecord(const void *buffer, std::uint32_t *values,
+      std::size_t count) const {
+    fromRecordFunction(buffer, values, count);
+  }
+
+private:
+
+  using ToRecordFunction = void (*)(const std::uint32_t *, void *,
+      std::size_t);
+  using FromRecordFunction = void (*)(const void *, std::uint32_t *,
+      std::size_t);
+
+  /**
+   * Conversion functions for a specific element type. This template is
+   * specialized for each of the supported element types.
+   */
+  template<typename T>
+  struct ElementConversion {
+    static void toRecord(const std::uint32_t *values, void *buffer,
+        std::size_t count);
+    static void fromRecord(const void *buffer, std::uint32_t *values,
+        std::size_t count);
+  };
+
+  /**
+   * Selects the conversion functions for the specified element type.
+   */
+  template<typename T>
+  void useElementType();
+
+  std::size_t elementSize;
+  ToRecordFunction toRecordFunction;
+  FromRecordFunction fromRecordFunction;
+
+};
+
+}
+}
+}
+
+#endif // ANKA_MRF_EPICS_WAVEFORM_CONVERTER_H
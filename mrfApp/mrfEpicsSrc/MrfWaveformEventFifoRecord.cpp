@@ -0,0 +1,207 @@
+/*
+ * Copyright 2026 aquenos GmbH.
+ * Copyright 2026 Karlsruhe Institute of Technology.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * This software has been developed by aquenos GmbH on behalf of the
+ * Karlsruhe Institute of Technology's Institute for Beam Physics and
+ * Technology.
+ *
+ * This software contains code originally developed by aquenos GmbH for
+ * the s7nodave EPICS device support. aquenos GmbH has relicensed the
+ * affected poritions of code from the s7nodave EPICS device support
+ * (originally licensed under the terms of the GNU GPL) under the terms
+ * of the GNU LGPL version 3 or newer.
+ */
+
+#include <cstring>
+#include <stdexcept>
+
+#include <alarm.h>
+#include <dbFldTypes.h>
+#include <recGbl.h>
+
+#include "MrfDeviceRegistry.h"
+#include "mrfEpicsError.h"
+
+#include "MrfWaveformEventFifoRecord.h"
+
+namespace anka {
+namespace mrf {
+namespace epics {
+
+namespace {
+
+MrfEventFifoRecordAddress readRecordAddress(const ::DBLINK &addressField) {
+  if (addressField.type != INST_IO) {
+    throw std::runtime_error(
+        "Invalid device address. Maybe mixed up INP/OUT or forgot '@'?");
+  }
+  return MrfEventFifoRecordAddress(
+      addressField.value.instio.string == nullptr ?
+          "" : addressField.value.instio.string);
+}
+
+} // End of anonymous namespace
+
+void MrfWaveformEventFifoRecord::EventFifoListenerImpl::operator()(
+    const MrfMemoryAccess::EventFifoEntry *entries, std::size_t count,
+    bool overflow) {
+  // This method is always called by the I/O thread of the device, so it is
+  // the only producer for the queue.
+  std::uint8_t eventCode = recordDeviceSupport.address.getEventCode();
+  std::uint32_t lostEntries = 0;
+  bool haveEntries = false;
+  for (std::size_t index = 0; index < count; ++index) {
+    if (eventCode != 0 && entries[index].eventCode != eventCode) {
+      continue;
+    }
+    if (recordDeviceSupport.queue.push(entries[index])) {
+      haveEntries = true;
+    } else {
+      ++lostEntries;
+    }
+  }
+  if (lostEntries != 0) {
+    recordDeviceSupport.lostEntries.fetch_add(lostEntries);
+  }
+  if (overflow) {
+    recordDeviceSupport.fifoOverflowed.store(true);
+  }
+  if (haveEntries || lostEntries != 0 || overflow) {
+    recordDeviceSupport.requestProcessing();
+  }
+}
+
+MrfWaveformEventFifoRecord::MrfWaveformEventFifoRecord(
+    ::waveformRecord *record) :
+    address(readRecordAddress(record->inp)), record(record), queue(
+        address.getQueueSize()), lostEntries(0), fifoOverflowed(false), processingPending(
+        false), interruptModeEnabled(false) {
+  if (this->record->ftvl != DBF_LONG && this->record->ftvl != DBF_ULONG) {
+    throw std::runtime_error("The value type of the array must be LONG or ULONG.");
+  }
+  if (this->record->nelm < 3) {
+    throw std::runtime_error(
+        "The array must have at least three elements (one FIFO entry).");
+  }
+  if (this->address.isOverflows()) {
+    throw std::runtime_error(
+        "The overflows flag is not supported for this record type.");
+  }
+  this->device = MrfDeviceRegistry::getInstance().getDevice(
+      this->address.getDeviceId());
+  if (!this->device) {
+    throw std::runtime_error(
+        std::string("Could not find device ") + this->address.getDeviceId()
+            + ".");
+  }
+  if (!this->device->supportsEventFifo()) {
+    throw std::runtime_error(
+        std::string("The device ") + this->address.getDeviceId()
+            + " does not support reading the event FIFO.");
+  }
+  // Make sure that all elements are initialized with zeros.
+  std::memset(this->record->bptr, 0, this->record->nelm * 4);
+  this->record->nord = 0;
+  ::scanIoInit(&ioScanPvt);
+  // The listener stores a reference to this object. For this reason we create
+  // it after we can be sure that this constructor will not throw an exception
+  // and thus this object will stay available.
+  this->eventFifoListener = std::make_shared<EventFifoListenerImpl>(*this);
+  this->device->addEventFifoListener(this->eventFifoListener);
+}
+
+MrfWaveformEventFifoRecord::~MrfWaveformEventFifoRecord() {
+  // This is not sufficient because the listener might be called
+  // asynchronously and it will then use the invalid reference to this object,
+  // but it is better than doing nothing. Usually, this destructor should not be
+  // called anyway because the record device support is never destroyed after
+  // having been created.
+  if (this->eventFifoListener) {
+    this->device->removeEventFifoListener(this->eventFifoListener);
+  }
+}
+
+void MrfWaveformEventFifoRecord::getInterruptInfo(int command,
+    IOSCANPVT *iopvt) {
+  if (command == 0) {
+    interruptModeEnabled.store(true);
+    // A processing that was requested before the record left the I/O Intr
+    // mode might never have happened, so we reset the flag. If there are
+    // entries in the queue, we have to schedule a processing of the record
+    // because the listener only does this when it adds new entries.
+    processingPending.store(false);
+    *iopvt = this->ioScanPvt;
+    if (!queue.empty()) {
+      requestProcessing();
+    }
+  } else {
+    interruptModeEnabled.store(false);
+    *iopvt = this->ioScanPvt;
+  }
+}
+
+void MrfWaveformEventFifoRecord::processRecord() {
+  // We reset the flag before taking entries from the queue. This way, entries
+  // that are added while we are processing trigger another processing.
+  processingPending.store(false);
+  std::uint32_t *buffer = static_cast<std::uint32_t *>(this->record->bptr);
+  std::size_t maxEntries = this->record->nelm / 3;
+  std::size_t entriesRead = 0;
+  MrfMemoryAccess::EventFifoEntry entry;
+  while (entriesRead < maxEntries && queue.pop(entry)) {
+    buffer[entriesRead * 3] = entry.eventCode;
+    buffer[entriesRead * 3 + 1] = entry.seconds;
+    buffer[entriesRead * 3 + 2] = entry.timestamp;
+    ++entriesRead;
+  }
+  this->record->nord = entriesRead * 3;
+  this->record->udf = false;
+  std::uint32_t lostEntriesSinceLastProcessing = lostEntries.exchange(0);
+  bool fifoOverflowedSinceLastProcessing = fifoOverflowed.exchange(false);
+  if (lostEntriesSinceLastProcessing != 0) {
+    recGblSetSevr(this->record, READ_ALARM, MINOR_ALARM);
+    errorExtendedPrintf(
+        "%s Event FIFO queue overflow. %u entries have been lost. Typically, this happens when events occur at a rate that is so high that the record cannot be processed at the same rate. Increasing NELM or queue_size might help.",
+        this->record->name,
+        static_cast<unsigned int>(lostEntriesSinceLastProcessing));
+  }
+  if (fifoOverflowedSinceLastProcessing) {
+    recGblSetSevr(this->record, READ_ALARM, MINOR_ALARM);
+    errorExtendedPrintf(
+        "%s Event FIFO overflow. Entries have been lost before the FIFO could be drained.",
+        this->record->name);
+  }
+  // If there are more entries than fit into the record, we have to process
+  // the record again.
+  if (!queue.empty()) {
+    requestProcessing();
+  }
+}
+
+void MrfWaveformEventFifoRecord::requestProcessing() {
+  // We only call scanIoRequest(...) when there is no pending processing. This
+  // way, a burst of entries only results in a single processing (or as many
+  // as are needed to move all entries into the record).
+  if (interruptModeEnabled.load() && !processingPending.exchange(true)) {
+    scanIoRequest(ioScanPvt);
+  }
+}
+
+} // namespace epics
+} // namespace mrf
+} // namespace anka
@@ -0,0 +1,204 @@
+/*
+ * Copyright 2026 aquenos GmbH.
+ * Copyright 2026 Karlsruhe Institute of Technology.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * This software has been developed by aquenos GmbH on behalf of the
+ * Karlsruhe Institute of Technology's Institute for Beam Physics and
+ * Technology.
+ *
+ * This software contains code originally developed by aquenos GmbH for
+ * the s7nodave EPICS device support. aquenos GmbH has relicensed the
+ * affected poritions of code from the s7nodave EPICS device support
+ * (originally licensed under the terms of the GNU GPL) under the terms
+ * of the GNU LGPL version 3 or newer.
+ */
+
+#ifndef ANKA_MRF_EPICS_WAVEFORM_EVENT_FIFO_RECORD_H
+#define ANKA_MRF_EPICS_WAVEFORM_EVENT_FIFO_RECORD_H
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+extern "C" {
+#include <dbScan.h>
+}
+#include <waveformRecord.h>
+
+#include <MrfConsistentMemoryAccess.h>
+
+#include "MrfEventFifoRecordAddress.h"
+#include "MrfSpscRing.h"
+
+namespace anka {
+namespace mrf {
+namespace epics {
+
+/**
+ * Device support class for a waveform record that publishes the entries read
+ * from the event FIFO of an event receiver.
+ *
+ * The device drains the event FIFO when it generates an interrupt and hands
+ * the entries to this device support, which buffers them in a lock-free
+ * queue. Each time the record is processed, as many entries as fit into the
+ * record are taken from the queue and stored in the record's value. Each
+ * entry occupies three elements: the event code, the seconds counter, and the
+ * timestamp counter. The record's element type must be LONG or ULONG.
+ *
+ * Usually, the record is put into "I/O Intr" mode. In this case, processing is
+ * triggered when new entries are available. If more entries are queued than
+ * fit into the record, the record is processed again until the queue is
+ * empty. When entries are lost, either because the hardware FIFO overflowed
+ * or because the queue of this record was full, the record is put into a
+ * MINOR alarm state the next time it is processed.
+ */
+class MrfWaveformEventFifoRecord {
+
+public:
+
+  /**
+   * Type of data structure used by the supported record.
+   */
+  using RecordType = ::waveformRecord;
+
+  /**
+   * Creates an instance of the device support for the specified record.
+   */
+  MrfWaveformEventFifoRecord(::waveformRecord *record);
+
+  /**
+   * Destructor.
+   */
+  ~MrfWaveformEventFifoRecord();
+
+  /**
+   * Processes a request to enable or disable the I/O Intr mode.
+   */
+  void getInterruptInfo(int command, IOSCANPVT *iopvt);
+
+  /**
+   * Called each time the record is processed. Moves the queued FIFO entries
+   * into the record's value.
+   */
+  void processRecord();
+
+private:
+
+  /**
+   * Event FIFO listener that puts the entries into the queue of this device
+   * support.
+   */
+  class EventFifoListenerImpl: public MrfMemoryAccess::EventFifoListener {
+
+  public:
+
+    EventFifoListenerImpl(MrfWaveformEventFifoRecord &recordDeviceSupport) :
+        recordDeviceSupport(recordDeviceSupport) {
+    }
+
+    void operator()(const MrfMemoryAccess::EventFifoEntry *entries,
+        std::size_t count, bool overflow);
+
+  private:
+
+    // Storing a reference to the record device-support looks unsafe and in
+    // fact it would if the record device-support was ever going to be
+    // destroyed. However, EPICS never destroys the device support, so we should
+    // be safe.
+    MrfWaveformEventFifoRecord &recordDeviceSupport;
+
+  };
+
+  // We do not want to allow copy or move construction or assignment.
+  MrfWaveformEventFifoRecord(const MrfWaveformEventFifoRecord &) = delete;
+  MrfWaveformEventFifoRecord(MrfWaveformEventFifoRecord &&) = delete;
+  MrfWaveformEventFifoRecord &operator=(const MrfWaveformEventFifoRecord &) =
+      delete;
+  MrfWaveformEventFifoRecord &operator=(MrfWaveformEventFifoRecord &&) =
+      delete;
+
+  /**
+   * Address specified in the INP field of the record.
+   */
+  MrfEventFifoRecordAddress address;
+
+  /**
+   * Pointer to the underlying device.
+   */
+  std::shared_ptr<MrfConsistentMemoryAccess> device;
+
+  /**
+   * Record this device support has been instantiated for.
+   */
+  ::waveformRecord *record;
+
+  /**
+   * Queue holding the entries that have not been put into the record yet. The
+   * event FIFO listener is the only producer and record processing is the
+   * only consumer.
+   */
+  MrfSpscRing<MrfMemoryAccess::EventFifoEntry> queue;
+
+  /**
+   * Number of entries that have been lost since the record was last
+   * processed.
+   */
+  std::atomic<std::uint32_t> lostEntries;
+
+  /**
+   * Flag indicating that the hardware FIFO overflowed since the record was
+   * last processed.
+   */
+  std::atomic<bool> fifoOverflowed;
+
+  /**
+   * Flag indicating whether processing of the record has been requested but
+   * has not started yet. This flag ensures that a burst of entries only
+   * results in a single request, regardless of how many entries it contains.
+   */
+  std::atomic<bool> processingPending;
+
+  /**
+   * Flag indicating whether the record is operating in the "I/O Intr" mode.
+   */
+  std::atomic<bool> interruptModeEnabled;
+
+  /**
+   * Event FIFO listener that is called by the device each time the FIFO has
+   * been drained.
+   */
+  std::shared_ptr<EventFifoListenerImpl> eventFifoListener;
+
+  /**
+   * Data structure used by in order to schedule processing because of new
+   * entries.
+   */
+  ::IOSCANPVT ioScanPvt;
+
+  /**
+   * Requests processing of the record if it is in "I/O Intr" mode and no
+   * processing is pending yet.
+   */
+  void requestProcessing();
+
+};
+
+} // namespace epics
+} // namespace mrf
+} // namespace anka
+
+#endif // ANKA_MRF_EPICS_WAVEFORM_EVENT_FIFO_RECORD_H
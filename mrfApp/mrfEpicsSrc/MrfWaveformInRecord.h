@@ -39,6 +39,7 @@
 
 #include <MrfConsistentMemoryAccess.h>
 #include "MrfRecordAddress.h"
+#include "MrfWaveformConverter.h"
 
 namespace anka {
 namespace mrf {
@@ -51,7 +52,9 @@ namespace epics {
  * must be an integer type (CHAR, UCHAR, SHORT, USHORT, LONG, or ULONG). For
  * data types that are smaller than LONG or ULONG, data received from the device
  * is truncated. The device support reads all elements from the memory of the
- * MRF device, starting at the specified address, into the record's value.
+ * MRF device, starting at the specified address, into the record's value. All
+ * elements are read with a single block request, so that the memory access
+ * can transfer them in one go.
  */
 class MrfWaveformInRecord {
 
@@ -78,14 +81,15 @@ public:
 private:
 
   /**
-   * Callback implementation used for reading array elements.
+   * Callback implementation used for reading the array elements.
    */
-  struct CallbackImpl: MrfMemoryAccess::CallbackUInt32 {
+  struct CallbackImpl: MrfMemoryAccess::BlockCallbackUInt32 {
     MrfWaveformInRecord &deviceSupport;
     CallbackImpl(MrfWaveformInRecord &deviceSupport) :
         deviceSupport(deviceSupport) {
     }
-    void success(std::uint32_t address, std::uint32_t value);
+    void success(std::uint32_t address,
+        const std::vector<std::uint32_t> &values);
     void failure(std::uint32_t address, MrfMemoryAccess::ErrorCode errorCode,
         const std::string &details);
   };
@@ -118,13 +122,19 @@ private:
    */
   ::waveformRecord *record;
 
+  /**
+   * Converter used for copying the values read from the device into the
+   * record's value array.
+   */
+  MrfWaveformConverter converter;
+
   /**
    * Callback needed to queue a request for processRecord to be run again.
    */
   ::CALLBACK processCallback;
 
   /**
-   * Callback used when reading array elements.
+   * Callback used when reading the array elements.
    */
   std::shared_ptr<CallbackImpl> readCallback;
 
@@ -142,11 +152,12 @@ private:
   std::string readErrorMessage;
 
   /**
-   * Number of pending read requests. This is used by the read callback to
-   * determine when the last response has been received and the record should
-   * be processed again.
+   * Flag indicating whether the read request is still pending. This is used
+   * to determine whether the callback has been called before the process
+   * method returned, in which case the record does not have to be processed
+   * again.
    */
-  std::uint32_t pendingReadRequests;
+  bool readPending;
 
   /**
    * Contains the value read as part of the last read attempt. When the value
@@ -155,6 +166,14 @@ private:
    */
   std::vector<std::uint32_t> lastValueRead;
 
+  /**
+   * Completes the processing of the record after the read request has
+   * finished. If the request was successful, the values read from the device
+   * are copied into the record's value array. Otherwise, the alarm state is
+   * set and an exception is thrown.
+   */
+  void completeRead();
+
 };
 
 }
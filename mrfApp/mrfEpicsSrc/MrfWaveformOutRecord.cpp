@@ -32,10 +32,16 @@
 #include <stdexcept>
 
 #include <alarm.h>
-#include <dbFldTypes.h>
+#include <caeventmask.h>
+#include <dbEvent.h>
+#include <dbLock.h>
+#include <errlog.h>
 #include <recGbl.h>
 
+#include <mrfElementConversion.h>
+
 #include "MrfDeviceRegistry.h"
+#include "MrfProcessScheduler.h"
 #include "mrfEpicsError.h"
 
 #include "MrfWaveformOutRecord.h"
@@ -51,7 +57,7 @@ MrfRecordAddress readRecordAddress(const ::DBLINK &addressField) {
     throw std::runtime_error(
         "Invalid device address. Maybe mixed up INP/OUT or forgot '@'?");
   }
-  return MrfRecordAddress(
+  return MrfRecordAddress::parseCached(
       addressField.value.instio.string == nullptr ?
           "" : addressField.value.instio.string);
 }
@@ -59,18 +65,25 @@ MrfRecordAddress readRecordAddress(const ::DBLINK &addressField) {
 } // End of anonymous namespace
 
 void MrfWaveformOutRecord::CallbackImpl::success(uint32_t address,
-    uint32_t value) {
+    const std::vector<std::uint32_t> &values) {
   std::unique_lock<std::recursive_mutex> lock(deviceSupport.mutex);
-  try {
-    std::uint32_t arrayIndex = (address
-        - deviceSupport.address.getMemoryAddress())
-        / (sizeof(std::uint32_t) + deviceSupport.address.getElementDistance());
-    // The address might come from the network, so we should not trust the value
-    // but make a sanity check.
-    if (arrayIndex < deviceSupport.lastValueWritten.size()) {
-      if (!deviceSupport.address.isVerify()
-          || deviceSupport.lastValueWritten[arrayIndex] == value) {
-        deviceSupport.lastValueWrittenValid[arrayIndex] = true;
+  // The address is the start address of the block, so the elements of the
+  // block are consecutive elements of the array, starting at this index.
+  std::uint32_t firstIndex = (address
+      - deviceSupport.address.getMemoryAddress())
+      / deviceSupport.getElementStride();
+  // The address might come from the network, so we should not trust the value
+  // but make a sanity check.
+  if (firstIndex <= deviceSupport.lastValueWritten.size()
+      && values.size() <= deviceSupport.lastValueWritten.size() - firstIndex) {
+    bool verify = deviceSupport.address.isVerify();
+    for (std::size_t i = 0; i < values.size(); ++i) {
+      std::size_t arrayIndex = firstIndex + i;
+      if (!verify || deviceSupport.lastValueWritten[arrayIndex] == values[i]) {
+        if (!deviceSupport.lastValueWrittenValid[arrayIndex]) {
+          deviceSupport.lastValueWrittenValid[arrayIndex] = true;
+          --deviceSupport.invalidElements;
+        }
       } else {
         // We want to use the message from the first error.
         if (deviceSupport.writeSuccessful) {
@@ -80,14 +93,14 @@ void MrfWaveformOutRecord::CallbackImpl::success(uint32_t address,
         }
       }
     }
-  } catch (...) {
-    // If there is any error, we still want to decrement the
-    // pendingWriteRequests counter and process the record again.
   }
   --deviceSupport.pendingWriteRequests;
   if (deviceSupport.pendingWriteRequests == 0) {
-    ::callbackRequestProcessCallback(&deviceSupport.processCallback,
-    priorityMedium, deviceSupport.record);
+    MrfProcessScheduler::getInstance().requestProcessing(
+        &deviceSupport.processCallback,
+        MrfProcessScheduler::toEpicsPriority(
+            deviceSupport.address.getCallbackPriority()),
+        deviceSupport.record);
   }
 }
 
@@ -108,22 +121,20 @@ void MrfWaveformOutRecord::CallbackImpl::failure(uint32_t address,
   }
   --deviceSupport.pendingWriteRequests;
   if (deviceSupport.pendingWriteRequests == 0) {
-    ::callbackRequestProcessCallback(&deviceSupport.processCallback,
-    priorityMedium, deviceSupport.record);
+    MrfProcessScheduler::getInstance().requestProcessing(
+        &deviceSupport.processCallback,
+        MrfProcessScheduler::toEpicsPriority(
+            deviceSupport.address.getCallbackPriority()),
+        deviceSupport.record);
   }
 }
 
 MrfWaveformOutRecord::MrfWaveformOutRecord(::waveformRecord *record) :
-    address(readRecordAddress(record->inp)), record(record), writeCallback(
-        std::make_shared<CallbackImpl>(*this)), writeSuccessful(false), pendingWriteRequests(
-        0), lastValueWritten(record->nelm), lastValueWrittenValid(record->nelm,
-        false) {
-  if (this->record->ftvl != DBF_CHAR && this->record->ftvl != DBF_UCHAR
-      && this->record->ftvl != DBF_SHORT && this->record->ftvl != DBF_USHORT
-      && this->record->ftvl != DBF_LONG && this->record->ftvl != DBF_ULONG) {
-    throw std::runtime_error(
-        "The value type of the array must be CHAR, UCHAR, SHORT, USHORT, LONG, or ULONG.");
-  }
+    address(readRecordAddress(record->inp)), record(record), converter(
+        record->ftvl), writeCallback(std::make_shared<CallbackImpl>(*this)), writeSuccessful(
+        false), pendingWriteRequests(0), lastValueWritten(record->nelm), lastValueWrittenValid(
+        record->nelm, false), invalidElements(record->nelm), recordValue(
+        record->nelm), blockBuffer(), writeStatistics(), processed(false) {
   if (this->address.getDataType() != MrfRecordAddress::DataType::uInt32) {
     throw std::runtime_error(
         "The waveform record only supports 32-bit unsigned integer registers.");
@@ -133,26 +144,36 @@ MrfWaveformOutRecord::MrfWaveformOutRecord(::waveformRecord *record) :
     throw std::runtime_error(
         "The waveform record does not support writing to individual bits of a register.");
   }
+  if (this->address.isLazyInit()) {
+    throw std::runtime_error(
+        "The waveform record does not support lazy initialization when used as an output.");
+  }
+  if (this->address.isPostedWrite()) {
+    throw std::runtime_error(
+        "The waveform record does not support posted writes.");
+  }
+  if (!this->address.getPollGroupId().empty()) {
+    throw std::runtime_error(
+        "The waveform record does not support poll groups when used as an output.");
+  }
+  if (this->address.getMaxAge().count() > 0) {
+    throw std::runtime_error(
+        "The waveform record does not support the max_age option when used as an output.");
+  }
   this->device = MrfDeviceRegistry::getInstance().getDevice(
-      this->address.getDeviceId());
+      this->address.getDeviceHandle());
   if (!this->device) {
     throw std::runtime_error(
         std::string("Could not find device ") + this->address.getDeviceId()
             + ".");
   }
-  std::uint8_t *recordValueBufferUInt8 =
-      reinterpret_cast<std::uint8_t *>(this->record->bptr);
-  std::uint16_t *recordValueBufferUInt16 =
-      reinterpret_cast<std::uint16_t *>(this->record->bptr);
-  std::uint32_t *recordValueBufferUInt32 =
-      reinterpret_cast<std::uint32_t *>(this->record->bptr);
   // We set the number of valid elements equal to the number of elements because
   // we always deal with fix-sized blocks of data.
   this->record->nord = this->record->nelm;
   if (this->address.isReadOnInit()) {
     std::shared_ptr<MrfMemoryCache> deviceCache =
         MrfDeviceRegistry::getInstance().getDeviceCache(
-            this->address.getDeviceId());
+            this->address.getDeviceHandle());
     if (!deviceCache) {
       throw std::runtime_error(
           std::string("Could not find cache for device ")
@@ -191,22 +212,23 @@ MrfWaveformOutRecord::MrfWaveformOutRecord(::waveformRecord *record) :
         }
       lastValueWritten[arrayIndex] = value;
       lastValueWrittenValid[arrayIndex] = true;
-      switch (this->record->ftvl) {
-      case DBF_CHAR:
-      case DBF_UCHAR:
-        recordValueBufferUInt8[arrayIndex] = value;
-        break;
-      case DBF_SHORT:
-      case DBF_USHORT:
-        recordValueBufferUInt16[arrayIndex] = value;
-        break;
-      case DBF_LONG:
-      case DBF_ULONG:
-        recordValueBufferUInt32[arrayIndex] = value;
-        break;
-      }
     }
     if (readFromDeviceSuccessful) {
+      // If the values have been loaded from a cache snapshot, they might turn
+      // out to be outdated when the snapshot is verified. In this case, we
+      // want to correct the record's value. Records are never destroyed, so
+      // we can safely capture this.
+      for (std::uint32_t arrayIndex = 0; arrayIndex < this->record->nelm;
+          ++arrayIndex) {
+        deviceCache->addCorrectionListenerUInt32(
+            this->address.getMemoryAddress() + getElementStride() * arrayIndex,
+            [this, arrayIndex](std::uint32_t, std::uint32_t newValue) {
+              this->initialValueCorrected(arrayIndex, newValue);
+            });
+      }
+      invalidElements = 0;
+      converter.toRecord(lastValueWritten.data(), this->record->bptr,
+          this->record->nelm);
       // The record's value has been initialized, thus it is not undefined any
       // longer.
       this->record->udf = false;
@@ -231,27 +253,124 @@ MrfWaveformOutRecord::MrfWaveformOutRecord(::waveformRecord *record) :
     }
   }
   // Make sure that all elements are initialized with zeros.
-  switch (this->record->ftvl) {
-  case DBF_CHAR:
-  case DBF_UCHAR:
-    std::memset(this->record->bptr, 0, this->record->nelm);
-    break;
-  case DBF_SHORT:
-  case DBF_USHORT:
-    std::memset(this->record->bptr, 0, this->record->nelm * 2);
-    break;
-  case DBF_LONG:
-  case DBF_ULONG:
-    std::memset(this->record->bptr, 0, this->record->nelm * 4);
-    break;
+  std::memset(this->record->bptr, 0,
+      this->record->nelm * converter.getElementSize());
+}
+
+std::uint32_t MrfWaveformOutRecord::getElementStride() const {
+  // The element distance specified in the record address is the gap between
+  // two registers, while the memory access expects the distance between their
+  // start addresses.
+  return sizeof(std::uint32_t) + address.getElementDistance();
+}
+
+void MrfWaveformOutRecord::initialValueCorrected(std::uint32_t arrayIndex,
+    std::uint32_t value) {
+  ::dbCommon *commonRecord = reinterpret_cast<::dbCommon *>(this->record);
+  ::dbScanLock(commonRecord);
+  {
+    std::lock_guard<std::recursive_mutex> lock(mutex);
+    if (processed) {
+      // The element might have been skipped when writing because it matched
+      // the outdated value, so we make sure that it is written the next time.
+      if (lastValueWrittenValid[arrayIndex]) {
+        lastValueWrittenValid[arrayIndex] = false;
+        ++invalidElements;
+      }
+    } else {
+      lastValueWritten[arrayIndex] = value;
+      converter.toRecord(lastValueWritten.data(), this->record->bptr,
+          this->record->nelm);
+      errorExtendedPrintf(
+          "%s The value loaded from the cache snapshot was outdated, so the record has been updated with the value from the device.",
+          this->record->name);
+      recGblGetTimeStamp(this->record);
+      // Passing null for the field posts the events for all fields that are
+      // monitored, including the value.
+      ::db_post_events(this->record, nullptr, DBE_VALUE | DBE_LOG);
+    }
+  }
+  ::dbScanUnlock(commonRecord);
+}
+
+void MrfWaveformOutRecord::writeElements(std::uint32_t firstIndex,
+    std::uint32_t count) {
+  blockBuffer.assign(lastValueWritten.begin() + firstIndex,
+      lastValueWritten.begin() + firstIndex + count);
+  ++pendingWriteRequests;
+  device->writeUInt32Block(
+      address.getMemoryAddress() + getElementStride() * firstIndex,
+      blockBuffer, getElementStride(), writeCallback);
+}
+
+void MrfWaveformOutRecord::planWrite() {
+  writeRanges.clear();
+  std::uint32_t elementCount = record->nelm;
+  if (!address.isChangedElementsOnly()) {
+    writeRanges.push_back(WriteRange(0, elementCount));
+    return;
+  }
+  // We compare the old and the new values in chunks of 32 elements, getting
+  // a bit mask of the elements that have changed for each chunk. Elements
+  // that have not been written successfully have to be written again, even
+  // if their value has not changed. Usually, there are no such elements, so
+  // we only check the valid flags if necessary.
+  bool checkValid = (invalidElements != 0);
+  bool rangeActive = false;
+  std::uint32_t rangeStart = 0;
+  for (std::uint32_t chunkStart = 0; chunkStart < elementCount;
+      chunkStart += 32) {
+    std::uint32_t chunkSize = std::min(elementCount - chunkStart,
+        static_cast<std::uint32_t>(32));
+    std::uint32_t changed = mrfCompareUInt32(
+        lastValueWritten.data() + chunkStart, recordValue.data() + chunkStart,
+        chunkSize);
+    if (checkValid) {
+      for (std::uint32_t i = 0; i < chunkSize; ++i) {
+        if (!lastValueWrittenValid[chunkStart + i]) {
+          changed |= 1u << i;
+        }
+      }
+    }
+    // If all elements of the chunk have the same state and that state is the
+    // same as for the preceding element, there is no need to look at the
+    // individual elements.
+    std::uint32_t chunkMask =
+        (chunkSize == 32) ? 0xffffffffu : ((1u << chunkSize) - 1);
+    if ((rangeActive && changed == chunkMask) || (!rangeActive && !changed)) {
+      continue;
+    }
+    for (std::uint32_t i = 0; i < chunkSize; ++i) {
+      bool elementChanged = (changed & (1u << i)) != 0;
+      if (elementChanged && !rangeActive) {
+        rangeActive = true;
+        rangeStart = chunkStart + i;
+      } else if (!elementChanged && rangeActive) {
+        rangeActive = false;
+        writeRanges.push_back(
+            WriteRange(rangeStart, chunkStart + i - rangeStart));
+      }
+    }
+  }
+  if (rangeActive) {
+    writeRanges.push_back(WriteRange(rangeStart, elementCount - rangeStart));
   }
 }
 
+MrfWaveformOutRecord::WriteStatistics MrfWaveformOutRecord::getWriteStatistics() {
+  std::lock_guard<std::recursive_mutex> lock(mutex);
+  return writeStatistics;
+}
+
 void MrfWaveformOutRecord::processRecord() {
   // The number of valid elements is reset when elements are written to the
   // record. However, we always want all elements to be considered valid, even
   // if not all of them have been updated.
   this->record->nord = this->record->nelm;
+  {
+    std::lock_guard<std::recursive_mutex> lock(mutex);
+    processed = true;
+  }
   if (this->record->pact) {
     this->record->pact = false;
     if (!writeSuccessful) {
@@ -269,53 +388,55 @@ void MrfWaveformOutRecord::processRecord() {
     // We set the writeSuccessful flag. If one of the write requests fails, it
     // is cleared by the callback.
     writeSuccessful = true;
-    std::uint8_t *recordValueBufferUInt8 =
-        reinterpret_cast<std::uint8_t *>(this->record->bptr);
-    std::uint16_t *recordValueBufferUInt16 =
-        reinterpret_cast<std::uint16_t *>(this->record->bptr);
-    std::uint32_t *recordValueBufferUInt32 =
-        reinterpret_cast<std::uint32_t *>(this->record->bptr);
+    // We convert the whole value array at once, so that the loop below does
+    // not depend on the element type.
+    converter.fromRecord(this->record->bptr, recordValue.data(),
+        this->record->nelm);
+    // Elements that have to be written are collected into ranges of
+    // consecutive elements, so that each range can be written with a single
+    // block request. If all elements are written, there is only one range.
+    planWrite();
+    std::uint32_t elementsWritten = 0;
+    for (const WriteRange &range : writeRanges) {
+      elementsWritten += range.count;
+    }
+    std::uint32_t elementsSkipped = record->nelm - elementsWritten;
+    ++writeStatistics.writes;
+    writeStatistics.elementsWritten += elementsWritten;
+    writeStatistics.elementsSkipped += elementsSkipped;
+    writeStatistics.lastElementsWritten = elementsWritten;
+    writeStatistics.lastElementsSkipped = elementsSkipped;
+    writeStatistics.lastRanges = static_cast<std::uint32_t>(
+        writeRanges.size());
+    if (record->tpro) {
+      ::errlogPrintf(
+          "%s: writing %u elements in %u ranges, skipping %u elements (%llu written and %llu skipped in total)\n",
+          record->name, static_cast<unsigned int>(elementsWritten),
+          static_cast<unsigned int>(writeRanges.size()),
+          static_cast<unsigned int>(elementsSkipped),
+          static_cast<unsigned long long>(writeStatistics.elementsWritten),
+          static_cast<unsigned long long>(writeStatistics.elementsSkipped));
+    }
     // We start with a non-zero value for the pending write requests. This
     // ensures that the callback does not trigger actions prematurely if it is
     // called within the same thread.
     pendingWriteRequests = 1;
-    for (std::uint32_t arrayIndex = 0; arrayIndex < record->nelm;
-        ++arrayIndex) {
-      std::uint32_t value;
-      switch (record->ftvl) {
-      case DBF_CHAR:
-      case DBF_UCHAR:
-        value = recordValueBufferUInt8[arrayIndex];
-        break;
-      case DBF_SHORT:
-      case DBF_USHORT:
-        value = recordValueBufferUInt16[arrayIndex];
-        break;
-      case DBF_LONG:
-      case DBF_ULONG:
-        value = recordValueBufferUInt32[arrayIndex];
-        break;
-      default:
-        // The default case can never happen because we ensure earlier that we
-        // have a supported type, but the compiler complains about use of an
-        // uninitialized value if we do not have this branch.
-        value = 0;
-        break;
-      }
-      if (!address.isChangedElementsOnly() || !lastValueWrittenValid[arrayIndex]
-          || lastValueWritten[arrayIndex] != value) {
+    // All ranges are queued right away, so that the memory access can process
+    // them back to back without waiting for the completion of each range.
+    for (const WriteRange &range : writeRanges) {
+      for (std::uint32_t arrayIndex = range.first;
+          arrayIndex < range.first + range.count; ++arrayIndex) {
         // We set the valid flag to false. This ensures that the element will
         // be written again the next time if the write attempt is not
         // successful. If it is successful, the flag will be set again by the
         // callback.
-        lastValueWrittenValid[arrayIndex] = false;
-        lastValueWritten[arrayIndex] = value;
-        ++pendingWriteRequests;
-        device->writeUInt32(
-            address.getMemoryAddress()
-                + (sizeof(std::uint32_t) + address.getElementDistance())
-                    * arrayIndex, value, writeCallback);
+        if (lastValueWrittenValid[arrayIndex]) {
+          lastValueWrittenValid[arrayIndex] = false;
+          ++invalidElements;
+        }
+        lastValueWritten[arrayIndex] = recordValue[arrayIndex];
       }
+      writeElements(range.first, range.count);
     }
     // Now we can decrement the number of pending write requests so that it
     // matches the actual number. If the remaining number is zero, we are
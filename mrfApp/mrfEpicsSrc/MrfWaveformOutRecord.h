@@ -39,6 +39,7 @@
 
 #include <MrfConsistentMemoryAccess.h>
 #include "MrfRecordAddress.h"
+#include "MrfWaveformConverter.h"
 
 namespace anka {
 namespace mrf {
@@ -52,6 +53,14 @@ namespace epics {
  * data types that are smaller than LONG or ULONG, data received from the device
  * is truncated. The device support writes all elements of the record's value
  * array to the memory of the MRF device, starting at the specified address.
+ * The elements are written with block requests, so that the memory access can
+ * transfer them in one go. If only changed elements shall be written, one
+ * block request is used for each contiguous range of changed elements and
+ * unchanged elements are not written at all. The number of elements written
+ * and skipped is available through {@link #getWriteStatistics()} (and thus
+ * through the mrfWaveformWriteStatistics IOC shell function). When the
+ * record's TPRO field is set, these numbers are also printed each time the
+ * record is processed.
  */
 class MrfWaveformOutRecord {
 
@@ -62,6 +71,43 @@ public:
    */
   using RecordType = ::waveformRecord;
 
+  /**
+   * Statistics about the write operations of the record.
+   */
+  struct WriteStatistics {
+    /**
+     * Number of times the record has been processed and has started a write
+     * operation.
+     */
+    std::uint64_t writes = 0;
+
+    /**
+     * Total number of elements that have been written.
+     */
+    std::uint64_t elementsWritten = 0;
+
+    /**
+     * Total number of elements that have not been written because they had
+     * not changed.
+     */
+    std::uint64_t elementsSkipped = 0;
+
+    /**
+     * Number of elements written by the last write operation.
+     */
+    std::uint32_t lastElementsWritten = 0;
+
+    /**
+     * Number of elements skipped by the last write operation.
+     */
+    std::uint32_t lastElementsSkipped = 0;
+
+    /**
+     * Number of block requests used by the last write operation.
+     */
+    std::uint32_t lastRanges = 0;
+  };
+
   /**
    * Creates an instance of the device support for the specified record.
    */
@@ -75,21 +121,39 @@ public:
    */
   void processRecord();
 
+  /**
+   * Returns the statistics about the write operations since the record has
+   * been initialized.
+   */
+  WriteStatistics getWriteStatistics();
+
 private:
 
   /**
-   * Callback implementation used for writing array elements.
+   * Callback implementation used for writing ranges of array elements.
    */
-  struct CallbackImpl: MrfMemoryAccess::CallbackUInt32 {
+  struct CallbackImpl: MrfMemoryAccess::BlockCallbackUInt32 {
     MrfWaveformOutRecord &deviceSupport;
     CallbackImpl(MrfWaveformOutRecord &deviceSupport) :
         deviceSupport(deviceSupport) {
     }
-    void success(std::uint32_t address, std::uint32_t value);
+    void success(std::uint32_t address,
+        const std::vector<std::uint32_t> &values);
     void failure(std::uint32_t address, MrfMemoryAccess::ErrorCode errorCode,
         const std::string &details);
   };
 
+  /**
+   * Range of consecutive elements that are written with a single request.
+   */
+  struct WriteRange {
+    std::uint32_t first;
+    std::uint32_t count;
+    WriteRange(std::uint32_t first, std::uint32_t count) :
+        first(first), count(count) {
+    }
+  };
+
   // We do not want to allow copy or move construction or assignment.
   MrfWaveformOutRecord(const MrfWaveformOutRecord &) = delete;
   MrfWaveformOutRecord(MrfWaveformOutRecord &&) = delete;
@@ -118,13 +182,19 @@ private:
    */
   ::waveformRecord *record;
 
+  /**
+   * Converter used for copying values between the record's value array and
+   * the arrays of register values.
+   */
+  MrfWaveformConverter converter;
+
   /**
    * Callback needed to queue a request for processRecord to be run again.
    */
   ::CALLBACK processCallback;
 
   /**
-   * Callback used when writing array elements.
+   * Callback used when writing ranges of array elements.
    */
   std::shared_ptr<CallbackImpl> writeCallback;
 
@@ -142,9 +212,9 @@ private:
   std::string writeErrorMessage;
 
   /**
-   * Number of pending write requests. This is used by the write callback to
-   * determine when the last response has been received and the record should
-   * be processed again.
+   * Number of pending block write requests. This is used by the write
+   * callback to determine when the last response has been received and the
+   * record should be processed again.
    */
   std::uint32_t pendingWriteRequests;
 
@@ -162,6 +232,71 @@ private:
    */
   std::vector<bool> lastValueWrittenValid;
 
+  /**
+   * Number of elements for which the corresponding element of
+   * lastValueWrittenValid is false.
+   */
+  std::size_t invalidElements;
+
+  /**
+   * Contains the record's value converted to register values. This is a
+   * member so that the memory does not have to be allocated each time the
+   * record is processed.
+   */
+  std::vector<std::uint32_t> recordValue;
+
+  /**
+   * Buffer used for collecting the values of a range of elements before
+   * queuing a block write request. This is a member so that the memory does
+   * not have to be allocated each time the record is processed.
+   */
+  std::vector<std::uint32_t> blockBuffer;
+
+  /**
+   * Ranges of elements that have to be written. This is a member so that the
+   * memory does not have to be allocated each time the record is processed.
+   */
+  std::vector<WriteRange> writeRanges;
+
+  /**
+   * Statistics about the write operations since the record has been
+   * initialized.
+   */
+  WriteStatistics writeStatistics;
+
+  /**
+   * Tells whether the record has been processed since it was initialized.
+   */
+  bool processed;
+
+  /**
+   * Determines the ranges of elements that have to be written and stores
+   * them in writeRanges. If only changed elements shall be written, these
+   * are the ranges of elements that differ from the last value written (or
+   * that have not been written successfully). Otherwise, there is a single
+   * range containing all elements.
+   */
+  void planWrite();
+
+  /**
+   * Returns the distance between the start addresses of two consecutive
+   * elements.
+   */
+  std::uint32_t getElementStride() const;
+
+  /**
+   * Called when the value that has been used for initializing an element was
+   * loaded from a cache snapshot and the device turned out to store a
+   * different value.
+   */
+  void initialValueCorrected(std::uint32_t arrayIndex, std::uint32_t value);
+
+  /**
+   * Queues a block write request for the specified range of elements, using
+   * the values stored in lastValueWritten.
+   */
+  void writeElements(std::uint32_t firstIndex, std::uint32_t count);
+
 };
 
 }
@@ -0,0 +1,299 @@
+/*
+ * Copyright 2026 aquenos GmbH.
+ * Copyright 2026 Karlsruhe Institute of Technology.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * This software has been developed by aquenos GmbH on behalf of the
+ * Karlsruhe Institute of Technology's Institute for Beam Physics and
+ * Technology.
+ *
+ * This software contains code originally developed by aquenos GmbH for
+ * the s7nodave EPICS device support. aquenos GmbH has relicensed the
+ * affected poritions of code from the s7nodave EPICS device support
+ * (originally licensed under the terms of the GNU GPL) under the terms
+ * of the GNU LGPL version 3 or newer.
+ */
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include <epicsStdio.h>
+#include <epicsVersion.h>
+#include <iocsh.h>
+
+#include <MrfMemoryAccess.h>
+
+#include "MrfMemoryCache.h"
+#include "mrfEpicsError.h"
+
+#include "mrfIocshBenchmarkCache.h"
+
+using namespace anka::mrf;
+using namespace anka::mrf::epics;
+
+// We use an anonymous namespace for the functions and data structures that we
+// only use internally. This way, we can avoid accidental name collisions.
+namespace {
+
+/**
+ * Memory access that does not talk to a device, but answers each request
+ * immediately. This way, the benchmark only measures the overhead of the
+ * cache.
+ */
+class SimulatedMemoryAccess: public MrfMemoryAccess {
+
+public:
+
+  using MrfMemoryAccess::readUInt16;
+  using MrfMemoryAccess::readUInt32;
+  using MrfMemoryAccess::writeUInt16;
+  using MrfMemoryAccess::writeUInt32;
+
+  void readUInt16(std::uint32_t address,
+      std::shared_ptr<CallbackUInt16> callback) {
+    callback->success(address, static_cast<std::uint16_t>(address));
+  }
+
+  void writeUInt16(std::uint32_t address, std::uint16_t value,
+      std::shared_ptr<CallbackUInt16> callback) {
+    callback->success(address, value);
+  }
+
+  void readUInt32(std::uint32_t address,
+      std::shared_ptr<CallbackUInt32> callback) {
+    callback->success(address, address);
+  }
+
+  void writeUInt32(std::uint32_t address, std::uint32_t value,
+      std::shared_ptr<CallbackUInt32> callback) {
+    callback->success(address, value);
+  }
+
+};
+
+/**
+ * Cache that protects a hash map with a mutex. This is how the memory cache
+ * used to be implemented, so it serves as the baseline for the comparison.
+ */
+class MutexCache {
+
+public:
+
+  MutexCache(MrfMemoryAccess &memoryAccess) : memoryAccess(memoryAccess) {
+  }
+
+  std::uint32_t readUInt32(std::uint32_t address) {
+    {
+      std::lock_guard<std::recursive_mutex> lock(mutex);
+      auto iterator = cache.find(address);
+      if (iterator != cache.end()) {
+        return iterator->second;
+      }
+    }
+    std::uint32_t value = memoryAccess.readUInt32(address);
+    std::lock_guard<std::recursive_mutex> lock(mutex);
+    return cache.emplace(address, value).first->second;
+  }
+
+  std::size_t getSnapshotSize() {
+    std::lock_guard<std::recursive_mutex> lock(mutex);
+    return std::map<std::uint32_t, std::uint32_t>(cache.begin(), cache.end())
+        .size();
+  }
+
+private:
+
+  MrfMemoryAccess &memoryAccess;
+  std::recursive_mutex mutex;
+  std::unordered_map<std::uint32_t, std::uint32_t> cache;
+
+};
+
+/**
+ * Adapter that gives the memory cache the same interface as the mutex-based
+ * cache.
+ */
+class MemoryCacheAdapter {
+
+public:
+
+  MemoryCacheAdapter(MrfMemoryAccess &memoryAccess) : cache(memoryAccess) {
+  }
+
+  std::uint32_t readUInt32(std::uint32_t address) {
+    return cache.readUInt32(address);
+  }
+
+  std::size_t getSnapshotSize() {
+    return cache.getCacheUInt32().size();
+  }
+
+private:
+
+  MrfMemoryCache cache;
+
+};
+
+/**
+ * Simulates the initialization of the specified number of records, using the
+ * specified number of threads. Each record reads one register through the
+ * cache. On average, two records share a register, like it is the case for
+ * registers that act as bit fields. While the records are initialized, an
+ * additional thread repeatedly takes snapshots of the cache. Returns the time
+ * needed for initializing the records and stores the number of snapshots that
+ * have been taken.
+ */
+template<typename Cache>
+std::chrono::steady_clock::duration simulateInit(Cache &cache, int records,
+    int threads, std::size_t &snapshots) {
+  std::uint32_t registers = static_cast<std::uint32_t>((records + 1) / 2);
+  std::atomic<bool> done(false);
+  std::atomic<std::size_t> snapshotCount(0);
+  std::thread snapshotThread([&cache, &done, &snapshotCount]() {
+    while (!done.load()) {
+      cache.getSnapshotSize();
+      ++snapshotCount;
+    }
+  });
+  auto startTime = std::chrono::steady_clock::now();
+  std::vector<std::thread> initThreads;
+  for (int threadIndex = 0; threadIndex < threads; ++threadIndex) {
+    initThreads.emplace_back(
+        [&cache, records, threads, registers, threadIndex]() {
+      for (int record = threadIndex; record < records; record += threads) {
+        // The multiplication spreads the registers used by consecutive records,
+        // so that the threads do not simply walk through the same registers.
+        cache.readUInt32(
+            4 * ((static_cast<std::uint32_t>(record) * 7919) % registers));
+      }
+    });
+  }
+  for (auto &thread : initThreads) {
+    thread.join();
+  }
+  auto time = std::chrono::steady_clock::now() - startTime;
+  done.store(true);
+  snapshotThread.join();
+  snapshots = snapshotCount.load();
+  return time;
+}
+
+template<typename Cache>
+void runBenchmark(const char *name, int records, int threads, int iterations) {
+  SimulatedMemoryAccess memoryAccess;
+  std::chrono::steady_clock::duration totalTime(0);
+  std::size_t totalSnapshots = 0;
+  for (int iteration = 0; iteration < iterations; ++iteration) {
+    // We use a new cache for each iteration, so that each iteration starts
+    // with an empty cache, like it is the case when the IOC is started.
+    Cache cache(memoryAccess);
+    std::size_t snapshots;
+    totalTime += simulateInit(cache, records, threads, snapshots);
+    totalSnapshots += snapshots;
+  }
+  double seconds = std::chrono::duration<double>(totalTime).count();
+  ::epicsStdoutPrintf(
+      "%-14s %10.3f ms per iteration, %10.3f ns per record, %10.1f snapshots per iteration\n",
+      name, seconds * 1e3 / iterations, seconds * 1e9 / iterations / records,
+      static_cast<double>(totalSnapshots) / iterations);
+}
+
+} // anonymous namespace
+
+extern "C" {
+
+static int mrfIocshFuncInternal(const iocshArgBuf *args) noexcept {
+  int records = args[0].ival;
+  int threads = args[1].ival;
+  int iterations = args[2].ival;
+  // Verify and convert the parameters.
+  if (records < 0 || threads < 0 || iterations < 0) {
+    errorPrintf(
+        "The number of records, threads, and iterations must not be negative.");
+    return 1;
+  }
+  if (records == 0) {
+    records = 20000;
+  }
+  if (threads == 0) {
+    threads = 4;
+  }
+  if (iterations == 0) {
+    iterations = 10;
+  }
+  try {
+    ::epicsStdoutPrintf(
+        "Initializing %d records with %d threads, %d iterations:\n", records,
+        threads, iterations);
+    runBenchmark<MutexCache>("mutex", records, threads, iterations);
+    runBenchmark<MemoryCacheAdapter>("concurrent map", records, threads,
+        iterations);
+  } catch (std::exception &e) {
+    errorPrintf("Error while running benchmark: %s", e.what());
+    return 1;
+  } catch (...) {
+    errorPrintf("Error while running benchmark: Unknown error.");
+    return 1;
+  }
+  return 0;
+}
+
+static void mrfIocshFunc(const iocshArgBuf *args) noexcept {
+
+#if EPICS_VERSION_INT >= VERSION_INT(7,0,3,1)
+  iocshSetError(mrfIocshFuncInternal(args));
+#else // EPICS_VERSION_INT >= VERSION_INT(7,0,3,1)
+  mrfIocshFuncInternal(args);
+#endif // EPICS_VERSION_INT >= VERSION_INT(7,0,3,1)
+}
+
+// Data structures needed for the iocsh mrfBenchmarkCache function.
+static const iocshArg mrfIocshArg0 = { "number of records", iocshArgInt };
+static const iocshArg mrfIocshArg1 = { "number of threads", iocshArgInt };
+static const iocshArg mrfIocshArg2 = { "iterations", iocshArgInt };
+static const iocshArg * const mrfIocshArgs[] = {
+  &mrfIocshArg0, &mrfIocshArg1, &mrfIocshArg2 };
+static const iocshFuncDef mrfIocshFuncDef = {
+  "mrfBenchmarkCache",
+  3,
+  mrfIocshArgs,
+#ifdef IOCSHFUNCDEF_HAS_USAGE
+  "Compare the memory cache with a mutex-protected hash map by simulating the"
+  " initialization of many records from several threads.\n",
+#endif // IOCSHFUNCDEF_HAS_USAGE
+};
+
+} // extern "C"
+
+namespace anka {
+namespace mrf {
+namespace epics {
+
+void registerIocshMrfBenchmarkCache() {
+  ::iocshRegister(&mrfIocshFuncDef, mrfIocshFunc);
+}
+
+} // namespace epics
+} // namespace mrf
+} // namespace anka
@@ -0,0 +1,222 @@
+/*
+ * Copyright 2026 aquenos GmbH.
+ * Copyright 2026 Karlsruhe Institute of Technology.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * This software has been developed by aquenos GmbH on behalf of the
+ * Karlsruhe Institute of Technology's Institute for Beam Physics and
+ * Technology.
+ *
+ * This software contains code originally developed by aquenos GmbH for
+ * the s7nodave EPICS device support. aquenos GmbH has relicensed the
+ * affected poritions of code from the s7nodave EPICS device support
+ * (originally licensed under the terms of the GNU GPL) under the terms
+ * of the GNU LGPL version 3 or newer.
+ */
+
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <mutex>
+#include <stdexcept>
+
+#include <epicsStdio.h>
+#include <epicsVersion.h>
+#include <iocsh.h>
+
+#include <MrfMemoryAccess.h>
+
+#include "MrfDeviceRegistry.h"
+#include "mrfEpicsError.h"
+
+#include "mrfIocshBenchmarkRead.h"
+
+using namespace anka::mrf;
+using namespace anka::mrf::epics;
+
+// We use an anonymous namespace for the functions and data structures that we
+// only use internally. This way, we can avoid accidental name collisions.
+namespace {
+
+/**
+ * Callback that counts the finished read operations, so that we can wait for
+ * a whole batch of independent operations to finish.
+ */
+class CountingCallback: public MrfMemoryAccess::CallbackUInt32 {
+
+public:
+
+  CountingCallback(std::size_t count) : remaining(count), failed(false) {
+  }
+
+  void success(std::uint32_t, std::uint32_t) {
+    std::lock_guard<std::mutex> lock(mutex);
+    --remaining;
+    if (remaining == 0) {
+      cv.notify_all();
+    }
+  }
+
+  void failure(std::uint32_t address, MrfMemoryAccess::ErrorCode errorCode,
+      const std::string &details) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!failed) {
+      failed = true;
+      errorMessage = std::string("Error reading from address ")
+          + mrfMemoryAddressToString(address) + ": "
+          + (details.empty() ? mrfErrorCodeToString(errorCode) : details);
+    }
+    --remaining;
+    if (remaining == 0) {
+      cv.notify_all();
+    }
+  }
+
+  void wait() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (remaining != 0) {
+      cv.wait(lock);
+    }
+    if (failed) {
+      throw std::runtime_error(errorMessage);
+    }
+  }
+
+private:
+
+  std::mutex mutex;
+  std::condition_variable cv;
+  std::size_t remaining;
+  bool failed;
+  std::string errorMessage;
+
+};
+
+void printResult(const char *method, std::chrono::steady_clock::duration time,
+    std::size_t count, int iterations) {
+  double seconds = std::chrono::duration<double>(time).count();
+  double bytes = 4.0 * count * iterations;
+  ::epicsStdoutPrintf(
+      "%-12s %10.3f ms total, %10.3f us per iteration, %10.3f MB/s\n",
+      method, seconds * 1e3, seconds * 1e6 / iterations,
+      bytes / seconds / 1e6);
+}
+
+} // anonymous namespace
+
+extern "C" {
+
+static int mrfIocshFuncInternal(const iocshArgBuf *args) noexcept {
+  char *deviceId = args[0].sval;
+  std::uint32_t address = static_cast<std::uint32_t>(args[1].ival);
+  int count = args[2].ival;
+  int iterations = args[3].ival;
+  // Verify and convert the parameters.
+  if (!deviceId) {
+    errorPrintf(
+        "Device ID must be specified.");
+    return 1;
+  }
+  if (!std::strlen(deviceId)) {
+    errorPrintf(
+        "Device ID must not be empty.");
+    return 1;
+  }
+  if (count <= 0) {
+    errorPrintf(
+        "The number of registers must be greater than zero.");
+    return 1;
+  }
+  if (iterations <= 0) {
+    iterations = 100;
+  }
+  try {
+    auto device = MrfDeviceRegistry::getInstance().getDevice(deviceId);
+    if (!device) {
+      errorPrintf("Could not find device with ID \"%s\".", deviceId);
+      return 1;
+    }
+    // For the per-register path, we queue all read operations of one
+    // iteration at once, so that devices that can process requests in
+    // parallel are not put at a disadvantage.
+    auto startTime = std::chrono::steady_clock::now();
+    for (int iteration = 0; iteration < iterations; ++iteration) {
+      auto callback = std::make_shared<CountingCallback>(count);
+      for (int index = 0; index < count; ++index) {
+        device->readUInt32(address + 4 * index, callback);
+      }
+      callback->wait();
+    }
+    auto perRegisterTime = std::chrono::steady_clock::now() - startTime;
+    startTime = std::chrono::steady_clock::now();
+    for (int iteration = 0; iteration < iterations; ++iteration) {
+      device->readUInt32Block(address, count, 0);
+    }
+    auto blockTime = std::chrono::steady_clock::now() - startTime;
+    ::epicsStdoutPrintf(
+        "Reading %d uint32 registers starting at %s, %d iterations:\n", count,
+        mrfMemoryAddressToString(address).c_str(), iterations);
+    printResult("per register", perRegisterTime, count, iterations);
+    printResult("block", blockTime, count, iterations);
+  } catch (std::exception &e) {
+    errorPrintf("Error while running benchmark: %s", e.what());
+    return 1;
+  } catch (...) {
+    errorPrintf("Error while running benchmark: Unknown error.");
+    return 1;
+  }
+  return 0;
+}
+
+static void mrfIocshFunc(const iocshArgBuf *args) noexcept {
+
+#if EPICS_VERSION_INT >= VERSION_INT(7,0,3,1)
+  iocshSetError(mrfIocshFuncInternal(args));
+#else // EPICS_VERSION_INT >= VERSION_INT(7,0,3,1)
+  mrfIocshFuncInternal(args);
+#endif // EPICS_VERSION_INT >= VERSION_INT(7,0,3,1)
+}
+
+// Data structures needed for the iocsh mrfBenchmarkRead function.
+static const iocshArg mrfIocshArg0 = { "device ID", iocshArgString };
+static const iocshArg mrfIocshArg1 = { "memory address", iocshArgInt };
+static const iocshArg mrfIocshArg2 = { "number of registers", iocshArgInt };
+static const iocshArg mrfIocshArg3 = { "iterations", iocshArgInt };
+static const iocshArg * const mrfIocshArgs[] = {
+  &mrfIocshArg0, &mrfIocshArg1, &mrfIocshArg2, &mrfIocshArg3 };
+static const iocshFuncDef mrfIocshFuncDef = {
+  "mrfBenchmarkRead",
+  4,
+  mrfIocshArgs,
+#ifdef IOCSHFUNCDEF_HAS_USAGE
+  "Compare reading a range of uint32 registers one by one with a block read."
+  "\n",
+#endif // IOCSHFUNCDEF_HAS_USAGE
+};
+
+} // extern "C"
+
+namespace anka {
+namespace mrf {
+namespace epics {
+
+void registerIocshMrfBenchmarkRead() {
+  ::iocshRegister(&mrfIocshFuncDef, mrfIocshFunc);
+}
+
+} // namespace epics
+} // namespace mrf
+} // namespace anka
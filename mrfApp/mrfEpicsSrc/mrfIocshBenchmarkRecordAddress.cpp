@@ -0,0 +1,257 @@
+/*
+ * Copyright 2026 aquenos GmbH.
+ * Copyright 2026 Karlsruhe Institute of Technology.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * This software has been developed by aquenos GmbH on behalf of the
+ * Karlsruhe Institute of Technology's Institute for Beam Physics and
+ * Technology.
+ *
+ * This software contains code originally developed by aquenos GmbH for
+ * the s7nodave EPICS device support. aquenos GmbH has relicensed the
+ * affected poritions of code from the s7nodave EPICS device support
+ * (originally licensed under the terms of the GNU GPL) under the terms
+ * of the GNU LGPL version 3 or newer.
+ */
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <epicsStdio.h>
+#include <epicsVersion.h>
+#include <iocsh.h>
+
+#include "MrfDeviceRegistry.h"
+#include "MrfRecordAddress.h"
+#include "mrfEpicsError.h"
+
+#include "mrfIocshBenchmarkRecordAddress.h"
+
+using namespace anka::mrf;
+using namespace anka::mrf::epics;
+
+// We use an anonymous namespace for the functions and data structures that we
+// only use internally. This way, we can avoid accidental name collisions.
+namespace {
+
+/**
+ * Layout of the record address before the IDs were interned and the flags
+ * were packed. This is only used for comparing the size.
+ */
+struct LegacyRecordAddress {
+  std::string deviceId;
+  std::uint32_t address;
+  signed char highestBit;
+  signed char lowestBit;
+  MrfRecordAddress::DataType dataType;
+  MrfRecordAddress::CallbackPriority callbackPriority;
+  bool changedElementsOnly;
+  int elementDistance;
+  bool lazyInit;
+  std::chrono::milliseconds maxAge;
+  std::string pollGroupId;
+  bool postedWrite;
+  bool readOnInit;
+  int stringLength;
+  bool verify;
+  bool zeroOtherBits;
+};
+
+/**
+ * Generates the address strings that are parsed when initializing a large
+ * database. Like in the generated databases, all devices use the same
+ * templates, so the address strings of different devices only differ in the
+ * device ID. Like in the databases shipped with this device support, three out
+ * of four records are treated as output records, whose address is parsed
+ * twice: once by the cache preheater at the beginning of iocInit and once when
+ * the record is initialized.
+ */
+std::vector<std::string> generateAddressStrings(int records, int devices) {
+  static const char *templates[] = {
+    "%s 0x%04x uint32",
+    "%s 0x%04x[15:0] uint32 zero_other_bits",
+    "%s 0x%04x[7] uint16 posted_write",
+    "%s 0x%04x uint32 no_read_on_init element_distance=12",
+    "%s 0x%04x[23:16] uint32 priority=low",
+    "%s 0x%04x uint16 max_age=100",
+  };
+  const int numberOfTemplates = sizeof(templates) / sizeof(templates[0]);
+  std::vector<std::string> recordAddresses;
+  recordAddresses.reserve(records);
+  char buffer[128];
+  for (int record = 0; record < records; ++record) {
+    int device = record % devices;
+    int index = record / devices;
+    std::string deviceId = "BenchmarkDevice" + std::to_string(device);
+    std::snprintf(buffer, sizeof(buffer),
+        templates[index % numberOfTemplates], deviceId.c_str(),
+        static_cast<unsigned int>(0x100 + 4 * index));
+    recordAddresses.push_back(buffer);
+  }
+  std::vector<std::string> addressStrings;
+  addressStrings.reserve(2 * records);
+  for (int record = 0; record < records; ++record) {
+    if (record % 4 != 0) {
+      addressStrings.push_back(recordAddresses[record]);
+    }
+  }
+  addressStrings.insert(addressStrings.end(), recordAddresses.begin(),
+      recordAddresses.end());
+  return addressStrings;
+}
+
+/**
+ * Parses each address string with a new parser and looks up the device by its
+ * ID. This is how the records used to be initialized, so it serves as the
+ * baseline for the comparison.
+ */
+std::size_t initializeUncached(const std::vector<std::string> &addressStrings) {
+  MrfDeviceRegistry &registry = MrfDeviceRegistry::getInstance();
+  std::size_t devicesFound = 0;
+  for (auto &addressString : addressStrings) {
+    MrfRecordAddress address(addressString);
+    if (registry.getDevice(address.getDeviceId())) {
+      ++devicesFound;
+    }
+  }
+  return devicesFound;
+}
+
+/**
+ * Gets each address from the parse cache and looks up the device by its
+ * handle. This is how the records are initialized now.
+ */
+std::size_t initializeCached(const std::vector<std::string> &addressStrings) {
+  MrfDeviceRegistry &registry = MrfDeviceRegistry::getInstance();
+  std::size_t devicesFound = 0;
+  for (auto &addressString : addressStrings) {
+    MrfRecordAddress address = MrfRecordAddress::parseCached(addressString);
+    if (registry.getDevice(address.getDeviceHandle())) {
+      ++devicesFound;
+    }
+  }
+  return devicesFound;
+}
+
+void runBenchmark(const char *name,
+    std::size_t (*initialize)(const std::vector<std::string> &),
+    const std::vector<std::string> &addressStrings, int records,
+    int iterations) {
+  std::chrono::steady_clock::duration totalTime(0);
+  for (int iteration = 0; iteration < iterations; ++iteration) {
+    // Each iteration starts with an empty cache, like it is the case when the
+    // IOC is started.
+    MrfRecordAddress::clearParseCache();
+    auto startTime = std::chrono::steady_clock::now();
+    initialize(addressStrings);
+    totalTime += std::chrono::steady_clock::now() - startTime;
+  }
+  MrfRecordAddress::clearParseCache();
+  double seconds = std::chrono::duration<double>(totalTime).count();
+  ::epicsStdoutPrintf(
+      "%-12s %10.3f ms per iteration, %10.3f ns per record\n",
+      name, seconds * 1e3 / iterations, seconds * 1e9 / iterations / records);
+}
+
+} // anonymous namespace
+
+extern "C" {
+
+static int mrfIocshFuncInternal(const iocshArgBuf *args) noexcept {
+  int records = args[0].ival;
+  int devices = args[1].ival;
+  int iterations = args[2].ival;
+  // Verify and convert the parameters.
+  if (records < 0 || devices < 0 || iterations < 0) {
+    errorPrintf(
+        "The number of records, devices, and iterations must not be negative.");
+    return 1;
+  }
+  if (records == 0) {
+    records = 20000;
+  }
+  if (devices == 0) {
+    devices = 10;
+  }
+  if (iterations == 0) {
+    iterations = 10;
+  }
+  try {
+    std::vector<std::string> addressStrings = generateAddressStrings(records,
+        devices);
+    ::epicsStdoutPrintf(
+        "Initializing %d records of %d devices (%lu addresses parsed), %d iterations:\n",
+        records, devices, static_cast<unsigned long>(addressStrings.size()),
+        iterations);
+    runBenchmark("uncached", initializeUncached, addressStrings, records,
+        iterations);
+    runBenchmark("cached", initializeCached, addressStrings, records,
+        iterations);
+    ::epicsStdoutPrintf(
+        "Size of a record address: %lu bytes (previously %lu bytes)\n",
+        static_cast<unsigned long>(sizeof(MrfRecordAddress)),
+        static_cast<unsigned long>(sizeof(LegacyRecordAddress)));
+  } catch (std::exception &e) {
+    errorPrintf("Error while running benchmark: %s", e.what());
+    return 1;
+  } catch (...) {
+    errorPrintf("Error while running benchmark: Unknown error.");
+    return 1;
+  }
+  return 0;
+}
+
+static void mrfIocshFunc(const iocshArgBuf *args) noexcept {
+#if EPICS_VERSION_INT >= VERSION_INT(7,0,3,1)
+  iocshSetError(mrfIocshFuncInternal(args));
+#else // EPICS_VERSION_INT >= VERSION_INT(7,0,3,1)
+  mrfIocshFuncInternal(args);
+#endif // EPICS_VERSION_INT >= VERSION_INT(7,0,3,1)
+}
+
+// Data structures needed for the iocsh mrfBenchmarkRecordAddress function.
+static const iocshArg mrfIocshArg0 = { "number of records", iocshArgInt };
+static const iocshArg mrfIocshArg1 = { "number of devices", iocshArgInt };
+static const iocshArg mrfIocshArg2 = { "iterations", iocshArgInt };
+static const iocshArg * const mrfIocshArgs[] = {
+  &mrfIocshArg0, &mrfIocshArg1, &mrfIocshArg2 };
+static const iocshFuncDef mrfIocshFuncDef = {
+  "mrfBenchmarkRecordAddress",
+  3,
+  mrfIocshArgs,
+#ifdef IOCSHFUNCDEF_HAS_USAGE
+  "Compare parsing the record addresses of a large generated database with and"
+  " without the parse cache and interned device IDs.\n",
+#endif // IOCSHFUNCDEF_HAS_USAGE
+};
+
+} // extern "C"
+
+namespace anka {
+namespace mrf {
+namespace epics {
+
+void registerIocshMrfBenchmarkRecordAddress() {
+  ::iocshRegister(&mrfIocshFuncDef, mrfIocshFunc);
+}
+
+} // namespace epics
+} // namespace mrf
+} // namespace anka
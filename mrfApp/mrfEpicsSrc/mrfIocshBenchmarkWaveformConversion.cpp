@@ -0,0 +1,236 @@
+/*
+ * Copyright 2026 aquenos GmbH.
+ * Copyright 2026 Karlsruhe Institute of Technology.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * This software has been developed by aquenos GmbH on behalf of the
+ * Karlsruhe Institute of Technology's Institute for Beam Physics and
+ * Technology.
+ *
+ * This software contains code originally developed by aquenos GmbH for
+ * the s7nodave EPICS device support. aquenos GmbH has relicensed the
+ * affected poritions of code from the s7nodave EPICS device support
+ * (originally licensed under the terms of the GNU GPL) under the terms
+ * of the GNU LGPL version 3 or newer.
+ */
+
+#include <chrono>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+#include <dbFldTypes.h>
+#include <epicsStdio.h>
+#include <epicsVersion.h>
+#include <iocsh.h>
+
+#include "MrfWaveformConverter.h"
+#include "mrfEpicsError.h"
+
+#include "mrfIocshBenchmarkWaveformConversion.h"
+
+using namespace anka::mrf;
+using namespace anka::mrf::epics;
+
+// We use an anonymous namespace for the functions and data structures that we
+// only use internally. This way, we can avoid accidental name collisions.
+namespace {
+
+/**
+ * Subset of the fields of a waveform record that are used by the reference
+ * implementation. We use a structure that is accessed through a pointer so
+ * that the element type has to be checked for each element, just like it was
+ * done by the device support before the conversion functions were introduced.
+ * The stores into the value array might alias the element type, so the
+ * compiler cannot move the check out of the loop.
+ */
+struct ReferenceRecord {
+  epicsEnum16 ftvl;
+  void *bptr;
+};
+
+/**
+ * Reference implementation that checks the element type for each element
+ * when copying register values into the record's value array.
+ */
+void referenceToRecord(
+    const std::vector<std::uint32_t> &values, ReferenceRecord *record) {
+  std::uint8_t *recordValueBufferUInt8 =
+      reinterpret_cast<std::uint8_t *>(record->bptr);
+  std::uint16_t *recordValueBufferUInt16 =
+      reinterpret_cast<std::uint16_t *>(record->bptr);
+  std::uint32_t *recordValueBufferUInt32 =
+      reinterpret_cast<std::uint32_t *>(record->bptr);
+  for (std::size_t arrayIndex = 0; arrayIndex < values.size(); ++arrayIndex) {
+    switch (record->ftvl) {
+    case DBF_CHAR:
+    case DBF_UCHAR:
+      recordValueBufferUInt8[arrayIndex] = values[arrayIndex];
+      break;
+    case DBF_SHORT:
+    case DBF_USHORT:
+      recordValueBufferUInt16[arrayIndex] = values[arrayIndex];
+      break;
+    case DBF_LONG:
+    case DBF_ULONG:
+      recordValueBufferUInt32[arrayIndex] = values[arrayIndex];
+      break;
+    }
+  }
+}
+
+/**
+ * Reference implementation that checks the element type for each element
+ * when copying the record's value array into register values.
+ */
+void referenceFromRecord(
+    const ReferenceRecord *record, std::vector<std::uint32_t> &values) {
+  const std::uint8_t *recordValueBufferUInt8 =
+      reinterpret_cast<const std::uint8_t *>(record->bptr);
+  const std::uint16_t *recordValueBufferUInt16 =
+      reinterpret_cast<const std::uint16_t *>(record->bptr);
+  const std::uint32_t *recordValueBufferUInt32 =
+      reinterpret_cast<const std::uint32_t *>(record->bptr);
+  for (std::size_t arrayIndex = 0; arrayIndex < values.size(); ++arrayIndex) {
+    switch (record->ftvl) {
+    case DBF_CHAR:
+    case DBF_UCHAR:
+      values[arrayIndex] = recordValueBufferUInt8[arrayIndex];
+      break;
+    case DBF_SHORT:
+    case DBF_USHORT:
+      values[arrayIndex] = recordValueBufferUInt16[arrayIndex];
+      break;
+    case DBF_LONG:
+    case DBF_ULONG:
+      values[arrayIndex] = recordValueBufferUInt32[arrayIndex];
+      break;
+    }
+  }
+}
+
+double nanosecondsPerElement(std::chrono::steady_clock::duration time,
+    std::size_t count, int iterations) {
+  return std::chrono::duration<double, std::nano>(time).count()
+      / (static_cast<double>(count) * iterations);
+}
+
+void runBenchmark(const char *typeName, epicsEnum16 ftvl, std::size_t count,
+    int iterations) {
+  MrfWaveformConverter converter(ftvl);
+  std::vector<std::uint32_t> values(count);
+  for (std::size_t index = 0; index < count; ++index) {
+    values[index] = static_cast<std::uint32_t>(index * 2654435761u);
+  }
+  std::vector<std::uint32_t> buffer(count);
+  ReferenceRecord record;
+  record.ftvl = ftvl;
+  record.bptr = buffer.data();
+  auto startTime = std::chrono::steady_clock::now();
+  for (int iteration = 0; iteration < iterations; ++iteration) {
+    referenceToRecord(values, &record);
+  }
+  auto referenceToRecordTime = std::chrono::steady_clock::now() - startTime;
+  startTime = std::chrono::steady_clock::now();
+  for (int iteration = 0; iteration < iterations; ++iteration) {
+    referenceFromRecord(&record, values);
+  }
+  auto referenceFromRecordTime = std::chrono::steady_clock::now() - startTime;
+  startTime = std::chrono::steady_clock::now();
+  for (int iteration = 0; iteration < iterations; ++iteration) {
+    converter.toRecord(values.data(), buffer.data(), count);
+  }
+  auto toRecordTime = std::chrono::steady_clock::now() - startTime;
+  startTime = std::chrono::steady_clock::now();
+  for (int iteration = 0; iteration < iterations; ++iteration) {
+    converter.fromRecord(buffer.data(), values.data(), count);
+  }
+  auto fromRecordTime = std::chrono::steady_clock::now() - startTime;
+  ::epicsStdoutPrintf("%-6s %8lu %10.3f %10.3f %10.3f %10.3f\n", typeName,
+      static_cast<unsigned long>(count), nanosecondsPerElement(referenceToRecordTime, count, iterations),
+      nanosecondsPerElement(toRecordTime, count, iterations),
+      nanosecondsPerElement(referenceFromRecordTime, count, iterations),
+      nanosecondsPerElement(fromRecordTime, count, iterations));
+}
+
+} // anonymous namespace
+
+extern "C" {
+
+static int mrfIocshFuncInternal(const iocshArgBuf *args) noexcept {
+  int iterations = args[0].ival;
+  if (iterations <= 0) {
+    iterations = 1000;
+  }
+  try {
+    // These are the array sizes that are typically used by the waveform
+    // records for the EVG and EVR (e.g. 2048 elements for the mapping RAM).
+    const std::size_t counts[] = { 16, 256, 2048, 16384 };
+    ::epicsStdoutPrintf(
+        "Nanoseconds per element (per-element type check / converter), %d iterations:\n",
+        iterations);
+    ::epicsStdoutPrintf("%-6s %8s %10s %10s %10s %10s\n", "type", "NELM",
+        "to ref.", "to conv.", "from ref.", "from conv.");
+    for (std::size_t count : counts) {
+      runBenchmark("UCHAR", DBF_UCHAR, count, iterations);
+      runBenchmark("USHORT", DBF_USHORT, count, iterations);
+      runBenchmark("ULONG", DBF_ULONG, count, iterations);
+    }
+  } catch (std::exception &e) {
+    errorPrintf("Error while running benchmark: %s", e.what());
+    return 1;
+  } catch (...) {
+    errorPrintf("Error while running benchmark: Unknown error.");
+    return 1;
+  }
+  return 0;
+}
+
+static void mrfIocshFunc(const iocshArgBuf *args) noexcept {
+
+#if EPICS_VERSION_INT >= VERSION_INT(7,0,3,1)
+  iocshSetError(mrfIocshFuncInternal(args));
+#else // EPICS_VERSION_INT >= VERSION_INT(7,0,3,1)
+  mrfIocshFuncInternal(args);
+#endif // EPICS_VERSION_INT >= VERSION_INT(7,0,3,1)
+}
+
+// Data structures needed for the iocsh mrfBenchmarkWaveformConversion
+// function.
+static const iocshArg mrfIocshArg0 = { "iterations", iocshArgInt };
+static const iocshArg * const mrfIocshArgs[] = { &mrfIocshArg0 };
+static const iocshFuncDef mrfIocshFuncDef = {
+  "mrfBenchmarkWaveformConversion",
+  1,
+  mrfIocshArgs,
+#ifdef IOCSHFUNCDEF_HAS_USAGE
+  "Measure the conversion between register values and waveform elements.\n",
+#endif // IOCSHFUNCDEF_HAS_USAGE
+};
+
+} // extern "C"
+
+namespace anka {
+namespace mrf {
+namespace epics {
+
+void registerIocshMrfBenchmarkWaveformConversion() {
+  ::iocshRegister(&mrfIocshFuncDef, mrfIocshFunc);
+}
+
+} // namespace epics
+} // namespace mrf
+} // namespace anka
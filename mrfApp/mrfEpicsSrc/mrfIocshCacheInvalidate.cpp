@@ -0,0 +1,124 @@
+/*
+ * Copyright 2026 aquenos GmbH.
+ * Copyright 2026 Karlsruhe Institute of Technology.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * This software has been developed by aquenos GmbH on behalf of the
+ * Karlsruhe Institute of Technology's Institute for Beam Physics and
+ * Technology.
+ *
+ * This software contains code originally developed by aquenos GmbH for
+ * the s7nodave EPICS device support. aquenos GmbH has relicensed the
+ * affected poritions of code from the s7nodave EPICS device support
+ * (originally licensed under the terms of the GNU GPL) under the terms
+ * of the GNU LGPL version 3 or newer.
+ */
+
+#include <cstring>
+#include <stdexcept>
+
+#include <epicsStdio.h>
+#include <epicsVersion.h>
+#include <iocsh.h>
+
+#include "MrfDeviceRegistry.h"
+#include "mrfEpicsError.h"
+
+#include "mrfIocshCacheInvalidate.h"
+
+using namespace anka::mrf;
+using namespace anka::mrf::epics;
+
+extern "C" {
+
+static int mrfIocshFuncInternal(const iocshArgBuf *args) noexcept {
+  char *deviceId = args[0].sval;
+  std::uint32_t firstAddress = static_cast<std::uint32_t>(args[1].ival);
+  std::uint32_t lastAddress = static_cast<std::uint32_t>(args[2].ival);
+  // Verify and convert the parameters.
+  if (!deviceId) {
+    errorPrintf(
+        "Device ID must be specified.");
+    return 1;
+  }
+  if (!std::strlen(deviceId)) {
+    errorPrintf(
+        "Device ID must not be empty.");
+    return 1;
+  }
+  if (firstAddress > lastAddress) {
+    errorPrintf(
+        "The first address must not be greater than the last address.");
+    return 1;
+  }
+  try {
+    auto cache = MrfDeviceRegistry::getInstance().getDeviceCache(deviceId);
+    if (!cache) {
+      errorPrintf("Could not find cache for device with ID \"%s\".", deviceId);
+      return 1;
+    }
+    std::size_t removed = cache->invalidate(firstAddress, lastAddress);
+    ::epicsStdoutPrintf("Invalidated %lu cached values.\n",
+        static_cast<unsigned long>(removed));
+  } catch (std::exception &e) {
+    errorPrintf("Could not invalidate the cache: %s", e.what());
+    return 1;
+  } catch (...) {
+    errorPrintf("Could not invalidate the cache: Unknown error.");
+    return 1;
+  }
+  return 0;
+}
+
+static void mrfIocshFunc(const iocshArgBuf *args) noexcept {
+
+#if EPICS_VERSION_INT >= VERSION_INT(7,0,3,1)
+  iocshSetError(mrfIocshFuncInternal(args));
+#else // EPICS_VERSION_INT >= VERSION_INT(7,0,3,1)
+  mrfIocshFuncInternal(args);
+#endif // EPICS_VERSION_INT >= VERSION_INT(7,0,3,1)
+}
+
+// Data structures needed for the iocsh mrfCacheInvalidate function.
+static const iocshArg mrfIocshArg0 = { "device ID", iocshArgString };
+static const iocshArg mrfIocshArg1 = { "first memory address", iocshArgInt };
+static const iocshArg mrfIocshArg2 = { "last memory address", iocshArgInt };
+static const iocshArg * const mrfIocshArgs[] = {
+  &mrfIocshArg0, &mrfIocshArg1, &mrfIocshArg2 };
+static const iocshFuncDef mrfIocshFuncDef = {
+  "mrfCacheInvalidate",
+  3,
+  mrfIocshArgs,
+#ifdef IOCSHFUNCDEF_HAS_USAGE
+  "Remove the cached values of a range of registers from the memory cache.\n\n"
+  "The next read of these registers goes to the device. The first and last "
+  "address\nare inclusive.\n",
+#endif // IOCSHFUNCDEF_HAS_USAGE
+};
+
+} // extern "C"
+
+namespace anka {
+namespace mrf {
+namespace epics {
+
+void registerIocshMrfCacheInvalidate() {
+  ::iocshRegister(&mrfIocshFuncDef, mrfIocshFunc);
+}
+
+} // namespace epics
+} // namespace mrf
+} // namespace anka
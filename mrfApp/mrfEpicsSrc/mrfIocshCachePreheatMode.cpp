@@ -0,0 +1,126 @@
+/*
+ * Copyright 2026 aquenos GmbH.
+ * Copyright 2026 Karlsruhe Institute of Technology.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * This software has been developed by aquenos GmbH on behalf of the
+ * Karlsruhe Institute of Technology's Institute for Beam Physics and
+ * Technology.
+ *
+ * This software contains code originally developed by aquenos GmbH for
+ * the s7nodave EPICS device support. aquenos GmbH has relicensed the
+ * affected poritions of code from the s7nodave EPICS device support
+ * (originally licensed under the terms of the GNU GPL) under the terms
+ * of the GNU LGPL version 3 or newer.
+ */
+
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+#include <epicsVersion.h>
+#include <iocsh.h>
+
+#include "MrfCachePreheater.h"
+#include "mrfEpicsError.h"
+
+#include "mrfIocshCachePreheatMode.h"
+
+using namespace anka::mrf;
+using namespace anka::mrf::epics;
+
+extern "C" {
+
+// Data structures needed for the iocsh mrfCachePreheatMode function.
+static const iocshArg iocshMrfCachePreheatModeArg0 = {
+  "mode (generated, records, or none)", iocshArgString };
+static const iocshArg * const iocshMrfCachePreheatModeArgs[] = {
+  &iocshMrfCachePreheatModeArg0 };
+static const iocshFuncDef iocshMrfCachePreheatModeFuncDef = {
+  "mrfCachePreheatMode",
+  1,
+  iocshMrfCachePreheatModeArgs,
+#ifdef IOCSHFUNCDEF_HAS_USAGE
+  "Select how the memory caches of devices are preheated.\n\n"
+  "\"records\" preheats the registers needed by the records that have been "
+  "loaded\nat the beginning of iocInit. \"generated\" (the default) "
+  "additionally preheats a\nfixed set of registers when a device is "
+  "created. \"none\" disables preheating.\nThis function has to be called "
+  "before creating the devices.\n",
+#endif // IOCSHFUNCDEF_HAS_USAGE
+};
+
+static int iocshMrfCachePreheatModeFuncInternal(
+    const iocshArgBuf *args) noexcept {
+  char *modeString = args[0].sval;
+  // Verify and convert the parameters.
+  if (!modeString) {
+    errorPrintf(
+        "Mode must be specified.");
+    return 1;
+  }
+  MrfCachePreheater::Mode mode;
+  if (!std::strcmp(modeString, "generated")) {
+    mode = MrfCachePreheater::Mode::generated;
+  } else if (!std::strcmp(modeString, "records")) {
+    mode = MrfCachePreheater::Mode::records;
+  } else if (!std::strcmp(modeString, "none")) {
+    mode = MrfCachePreheater::Mode::none;
+  } else {
+    errorPrintf(
+        "Invalid mode \"%s\". Mode must be \"generated\", \"records\", or \"none\".",
+        modeString);
+    return 1;
+  }
+  try {
+    MrfCachePreheater::setMode(mode);
+  } catch (std::exception &e) {
+    errorPrintf("Could not set the cache preheat mode: %s", e.what());
+    return 1;
+  } catch (...) {
+    errorPrintf("Could not set the cache preheat mode: Unknown error.");
+    return 1;
+  }
+  return 0;
+}
+
+/**
+ * Implementation of the iocsh mrfCachePreheatMode function. This function
+ * selects whether the memory caches are preheated with a fixed set of
+ * registers, with the registers needed by the loaded records, or not at all.
+ */
+static void iocshMrfCachePreheatModeFunc(const iocshArgBuf *args) noexcept {
+#if EPICS_VERSION_INT >= VERSION_INT(7,0,3,1)
+  iocshSetError(iocshMrfCachePreheatModeFuncInternal(args));
+#else // EPICS_VERSION_INT >= VERSION_INT(7,0,3,1)
+  iocshMrfCachePreheatModeFuncInternal(args);
+#endif // EPICS_VERSION_INT >= VERSION_INT(7,0,3,1)
+}
+
+} // extern "C"
+
+namespace anka {
+namespace mrf {
+namespace epics {
+
+void registerIocshMrfCachePreheatMode() {
+  ::iocshRegister(&iocshMrfCachePreheatModeFuncDef,
+      iocshMrfCachePreheatModeFunc);
+}
+
+} // namespace epics
+} // namespace mrf
+} // namespace anka
@@ -0,0 +1,133 @@
+/*
+ * Copyright 2026 aquenos GmbH.
+ * Copyright 2026 Karlsruhe Institute of Technology.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * This software has been developed by aquenos GmbH on behalf of the
+ * Karlsruhe Institute of Technology's Institute for Beam Physics and
+ * Technology.
+ *
+ * This software contains code originally developed by aquenos GmbH for
+ * the s7nodave EPICS device support. aquenos GmbH has relicensed the
+ * affected poritions of code from the s7nodave EPICS device support
+ * (originally licensed under the terms of the GNU GPL) under the terms
+ * of the GNU LGPL version 3 or newer.
+ */
+
+#include <cstring>
+
+#include <epicsStdio.h>
+#include <epicsVersion.h>
+#include <iocsh.h>
+
+#include "MrfDeviceRegistry.h"
+#include "MrfMemoryCache.h"
+#include "mrfEpicsError.h"
+
+#include "mrfIocshCachePreheatStatistics.h"
+
+using namespace anka::mrf;
+using namespace anka::mrf::epics;
+
+extern "C" {
+
+// Data structures needed for the iocsh mrfCachePreheatStatistics function.
+static const iocshArg iocshMrfCachePreheatStatisticsArg0 = {
+  "device ID", iocshArgString };
+static const iocshArg * const iocshMrfCachePreheatStatisticsArgs[] = {
+  &iocshMrfCachePreheatStatisticsArg0 };
+static const iocshFuncDef iocshMrfCachePreheatStatisticsFuncDef = {
+  "mrfCachePreheatStatistics",
+  1,
+  iocshMrfCachePreheatStatisticsArgs,
+#ifdef IOCSHFUNCDEF_HAS_USAGE
+  "Print statistics about the preheating of the memory cache for a device.\n",
+#endif // IOCSHFUNCDEF_HAS_USAGE
+};
+
+static int iocshMrfCachePreheatStatisticsFuncInternal(
+    const iocshArgBuf *args) noexcept {
+  char *deviceId = args[0].sval;
+  // Verify and convert the parameters.
+  if (!deviceId) {
+    errorPrintf(
+        "Device ID must be specified.");
+    return 1;
+  }
+  if (!std::strlen(deviceId)) {
+    errorPrintf(
+        "Device ID must not be empty.");
+    return 1;
+  }
+  try {
+    auto cache = MrfDeviceRegistry::getInstance().getDeviceCache(deviceId);
+    if (!cache) {
+      errorPrintf("Could not find cache for device with ID \"%s\".", deviceId);
+      return 1;
+    }
+    auto statistics = cache->getPreheatStatistics();
+    ::epicsStdoutPrintf("Finished:               %s\n",
+        statistics.finished ? "yes" : "no");
+    ::epicsStdoutPrintf("Reads in flight limit:  %lu\n",
+        static_cast<unsigned long>(cache->getPreheatLimit()));
+    ::epicsStdoutPrintf("Reads requested:        %lu\n",
+        static_cast<unsigned long>(statistics.requested));
+    ::epicsStdoutPrintf("Reads succeeded:        %lu\n",
+        static_cast<unsigned long>(statistics.succeeded));
+    ::epicsStdoutPrintf("Reads failed:           %lu\n",
+        static_cast<unsigned long>(statistics.failed));
+    ::epicsStdoutPrintf("Reads sent ahead:       %lu\n",
+        static_cast<unsigned long>(statistics.promoted));
+    ::epicsStdoutPrintf("Wall time:              %llu us\n",
+        static_cast<unsigned long long>(statistics.wallTimeMicroseconds));
+  } catch (std::exception &e) {
+    errorPrintf("Error while accessing device cache: %s", e.what());
+    return 1;
+  } catch (...) {
+    errorPrintf("Error while accessing device cache: Unknown error.");
+    return 1;
+  }
+  return 0;
+}
+
+/**
+ * Implementation of the iocsh mrfCachePreheatStatistics function. This
+ * function prints how many registers have been read while preheating the
+ * memory cache for a device and how long preheating took.
+ */
+static void iocshMrfCachePreheatStatisticsFunc(
+    const iocshArgBuf *args) noexcept {
+#if EPICS_VERSION_INT >= VERSION_INT(7,0,3,1)
+  iocshSetError(iocshMrfCachePreheatStatisticsFuncInternal(args));
+#else // EPICS_VERSION_INT >= VERSION_INT(7,0,3,1)
+  iocshMrfCachePreheatStatisticsFuncInternal(args);
+#endif // EPICS_VERSION_INT >= VERSION_INT(7,0,3,1)
+}
+
+} // extern "C"
+
+namespace anka {
+namespace mrf {
+namespace epics {
+
+void registerIocshMrfCachePreheatStatistics() {
+  ::iocshRegister(&iocshMrfCachePreheatStatisticsFuncDef,
+      iocshMrfCachePreheatStatisticsFunc);
+}
+
+} // namespace epics
+} // namespace mrf
+} // namespace anka
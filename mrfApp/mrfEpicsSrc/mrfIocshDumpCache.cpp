@@ -56,9 +56,11 @@ static const iocshFuncDef iocshMrfDumpCacheFuncDef = {
   iocshMrfDumpCacheArgs,
 #ifdef IOCSHFUNCDEF_HAS_USAGE
   "Dump the memory cache for a device.\n\n"
-  "The memory cache is only used for initializing output records during IOC "
-  "startup\nand thus will only contain entries for memory locations referenced "
-  "by such\nrecords.\n",
+  "The memory cache is mainly used for initializing output records during "
+  "IOC\nstartup and thus will mostly contain entries for memory locations "
+  "referenced by\nsuch records. Registers that have been written and "
+  "registers that are read at\nruntime (see mrfCacheTtl) are cached as "
+  "well.\n",
 #endif // IOCSHFUNCDEF_HAS_USAGE
 };
 
@@ -0,0 +1,99 @@
+/*
+ * Copyright 2026 aquenos GmbH.
+ * Copyright 2026 Karlsruhe Institute of Technology.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * This software has been developed by aquenos GmbH on behalf of the
+ * Karlsruhe Institute of Technology's Institute for Beam Physics and
+ * Technology.
+ *
+ * This software contains code originally developed by aquenos GmbH for
+ * the s7nodave EPICS device support. aquenos GmbH has relicensed the
+ * affected poritions of code from the s7nodave EPICS device support
+ * (originally licensed under the terms of the GNU GPL) under the terms
+ * of the GNU LGPL version 3 or newer.
+ */
+
+#include <stdexcept>
+
+#include <epicsVersion.h>
+#include <iocsh.h>
+
+#include "MrfLazyInitializer.h"
+#include "mrfEpicsError.h"
+
+#include "mrfIocshLazyInitRate.h"
+
+using namespace anka::mrf;
+using namespace anka::mrf::epics;
+
+extern "C" {
+
+// Data structures needed for the iocsh mrfLazyInitRate function.
+static const iocshArg iocshMrfLazyInitRateArg0 = {
+  "records per second", iocshArgDouble };
+static const iocshArg * const iocshMrfLazyInitRateArgs[] = {
+  &iocshMrfLazyInitRateArg0 };
+static const iocshFuncDef iocshMrfLazyInitRateFuncDef = {
+  "mrfLazyInitRate",
+  1,
+  iocshMrfLazyInitRateArgs,
+#ifdef IOCSHFUNCDEF_HAS_USAGE
+  "Set the maximum number of records with the lazy_init flag that are\n"
+  "initialized per second after iocInit has finished. The default is 100.\n",
+#endif // IOCSHFUNCDEF_HAS_USAGE
+};
+
+static int iocshMrfLazyInitRateFuncInternal(
+    const iocshArgBuf *args) noexcept {
+  double rate = args[0].dval;
+  try {
+    MrfLazyInitializer::setRate(rate);
+  } catch (std::exception &e) {
+    errorPrintf("Could not set the lazy initialization rate: %s", e.what());
+    return 1;
+  } catch (...) {
+    errorPrintf("Could not set the lazy initialization rate: Unknown error.");
+    return 1;
+  }
+  return 0;
+}
+
+/**
+ * Implementation of the iocsh mrfLazyInitRate function. This function sets
+ * the rate at which records are initialized after iocInit.
+ */
+static void iocshMrfLazyInitRateFunc(const iocshArgBuf *args) noexcept {
+#if EPICS_VERSION_INT >= VERSION_INT(7,0,3,1)
+  iocshSetError(iocshMrfLazyInitRateFuncInternal(args));
+#else // EPICS_VERSION_INT >= VERSION_INT(7,0,3,1)
+  iocshMrfLazyInitRateFuncInternal(args);
+#endif // EPICS_VERSION_INT >= VERSION_INT(7,0,3,1)
+}
+
+} // extern "C"
+
+namespace anka {
+namespace mrf {
+namespace epics {
+
+void registerIocshMrfLazyInitRate() {
+  ::iocshRegister(&iocshMrfLazyInitRateFuncDef, iocshMrfLazyInitRateFunc);
+}
+
+} // namespace epics
+} // namespace mrf
+} // namespace anka
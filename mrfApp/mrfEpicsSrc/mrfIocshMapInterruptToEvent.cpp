@@ -72,6 +72,10 @@ public:
     }
   }
 
+  std::uint32_t getInterruptFlagsMask() const {
+    return interruptFlagsMask;
+  }
+
 private:
 
   const int eventNumber;
@@ -0,0 +1,166 @@
+/*
+ * Copyright 2026 aquenos GmbH.
+ * Copyright 2026 Karlsruhe Institute of Technology.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * This software has been developed by aquenos GmbH on behalf of the
+ * Karlsruhe Institute of Technology's Institute for Beam Physics and
+ * Technology.
+ *
+ * This software contains code originally developed by aquenos GmbH for
+ * the s7nodave EPICS device support. aquenos GmbH has relicensed the
+ * affected poritions of code from the s7nodave EPICS device support
+ * (originally licensed under the terms of the GNU GPL) under the terms
+ * of the GNU LGPL version 3 or newer.
+ */
+
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <memory>
+
+#include <epicsVersion.h>
+#include <iocsh.h>
+
+#include "MrfDeviceRegistry.h"
+#include "MrfPollGroup.h"
+#include "mrfEpicsError.h"
+
+#include "mrfIocshPollGroup.h"
+
+using namespace anka::mrf;
+using namespace anka::mrf::epics;
+
+extern "C" {
+
+// Data structures needed for the iocsh mrfPollGroup function.
+static const iocshArg iocshMrfPollGroupArg0 = {
+  "poll group ID", iocshArgString };
+static const iocshArg iocshMrfPollGroupArg1 = { "device ID", iocshArgString };
+static const iocshArg iocshMrfPollGroupArg2 = {
+  "period (seconds)", iocshArgDouble };
+static const iocshArg iocshMrfPollGroupArg3 = {
+  "range start address", iocshArgInt };
+static const iocshArg iocshMrfPollGroupArg4 = {
+  "number of registers in range", iocshArgInt };
+static const iocshArg * const iocshMrfPollGroupArgs[] = {
+  &iocshMrfPollGroupArg0, &iocshMrfPollGroupArg1, &iocshMrfPollGroupArg2,
+  &iocshMrfPollGroupArg3, &iocshMrfPollGroupArg4 };
+static const iocshFuncDef iocshMrfPollGroupFuncDef = {
+  "mrfPollGroup",
+  5,
+  iocshMrfPollGroupArgs,
+#ifdef IOCSHFUNCDEF_HAS_USAGE
+  "Create a poll group that periodically reads registers from a device.\n\n"
+  "Records that specify the poll group in their address get the values read "
+  "by\nthe poll group and can use the I/O Intr scan mode. If the number of "
+  "registers\nin the range is not zero, all uint32 registers in the range are "
+  "read with a\nsingle request.\n",
+#endif // IOCSHFUNCDEF_HAS_USAGE
+};
+
+static int iocshMrfPollGroupFuncInternal(const iocshArgBuf *args) noexcept {
+  char *pollGroupId = args[0].sval;
+  char *deviceId = args[1].sval;
+  double periodDouble = args[2].dval;
+  std::uint32_t rangeAddress = static_cast<std::uint32_t>(args[3].ival);
+  int rangeCount = args[4].ival;
+  // Verify and convert the parameters.
+  if (!pollGroupId) {
+    errorPrintf(
+        "Could not create poll group: Poll group ID must be specified.");
+    return 1;
+  }
+  if (!std::strlen(pollGroupId)) {
+    errorPrintf(
+        "Could not create poll group: Poll group ID must not be empty.");
+    return 1;
+  }
+  if (!deviceId) {
+    errorPrintf("Could not create poll group: Device ID must be specified.");
+    return 1;
+  }
+  if (!std::strlen(deviceId)) {
+    errorPrintf("Could not create poll group: Device ID must not be empty.");
+    return 1;
+  }
+  if (!std::isfinite(periodDouble) || periodDouble < 1e-6
+      || periodDouble > 86400.0) {
+    errorPrintf(
+        "Could not create poll group: The period must be between one microsecond and one day.");
+    return 1;
+  }
+  if (rangeCount < 0) {
+    errorPrintf(
+        "Could not create poll group: The number of registers in the range must not be negative.");
+    return 1;
+  }
+  std::chrono::microseconds period(
+      static_cast<std::chrono::microseconds::rep>(periodDouble * 1e6));
+  try {
+    auto device = MrfDeviceRegistry::getInstance().getDevice(deviceId);
+    if (!device) {
+      errorPrintf(
+          "Could not create poll group: Could not find device with ID \"%s\".",
+          deviceId);
+      return 1;
+    }
+    if (MrfDeviceRegistry::getInstance().getPollGroup(pollGroupId)) {
+      errorPrintf(
+          "Could not create poll group: Poll group ID \"%s\" is already in use.",
+          pollGroupId);
+      return 1;
+    }
+    auto pollGroup = std::make_shared<MrfPollGroup>(deviceId, device, period,
+        rangeAddress, rangeCount);
+    MrfDeviceRegistry::getInstance().registerPollGroup(pollGroupId,
+        pollGroup);
+  } catch (std::exception &e) {
+    errorPrintf("Could not create poll group: %s", e.what());
+    return 1;
+  } catch (...) {
+    errorPrintf("Could not create poll group: Unknown error.");
+    return 1;
+  }
+  return 0;
+}
+
+/**
+ * Implementation of the iocsh mrfPollGroup function. This function creates a
+ * poll group that periodically reads the registers used by the records that
+ * belong to it.
+ */
+static void iocshMrfPollGroupFunc(const iocshArgBuf *args) noexcept {
+#if EPICS_VERSION_INT >= VERSION_INT(7,0,3,1)
+  iocshSetError(iocshMrfPollGroupFuncInternal(args));
+#else // EPICS_VERSION_INT >= VERSION_INT(7,0,3,1)
+  iocshMrfPollGroupFuncInternal(args);
+#endif // EPICS_VERSION_INT >= VERSION_INT(7,0,3,1)
+}
+
+} // extern "C"
+
+namespace anka {
+namespace mrf {
+namespace epics {
+
+void registerIocshMrfPollGroup() {
+  ::iocshRegister(&iocshMrfPollGroupFuncDef, iocshMrfPollGroupFunc);
+}
+
+} // namespace epics
+} // namespace mrf
+} // namespace anka
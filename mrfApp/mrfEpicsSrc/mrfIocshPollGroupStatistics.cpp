@@ -0,0 +1,141 @@
+/*
+ * Copyright 2026 aquenos GmbH.
+ * Copyright 2026 Karlsruhe Institute of Technology.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * This software has been developed by aquenos GmbH on behalf of the
+ * Karlsruhe Institute of Technology's Institute for Beam Physics and
+ * Technology.
+ *
+ * This software contains code originally developed by aquenos GmbH for
+ * the s7nodave EPICS device support. aquenos GmbH has relicensed the
+ * affected poritions of code from the s7nodave EPICS device support
+ * (originally licensed under the terms of the GNU GPL) under the terms
+ * of the GNU LGPL version 3 or newer.
+ */
+
+#include <cstring>
+
+#include <epicsStdio.h>
+#include <epicsVersion.h>
+#include <iocsh.h>
+
+#include "MrfDeviceRegistry.h"
+#include "MrfPollGroup.h"
+#include "mrfEpicsError.h"
+
+#include "mrfIocshPollGroupStatistics.h"
+
+using namespace anka::mrf;
+using namespace anka::mrf::epics;
+
+extern "C" {
+
+// Data structures needed for the iocsh mrfPollGroupStatistics function.
+static const iocshArg iocshMrfPollGroupStatisticsArg0 = {
+  "poll group ID", iocshArgString };
+static const iocshArg * const iocshMrfPollGroupStatisticsArgs[] = {
+  &iocshMrfPollGroupStatisticsArg0 };
+static const iocshFuncDef iocshMrfPollGroupStatisticsFuncDef = {
+  "mrfPollGroupStatistics",
+  1,
+  iocshMrfPollGroupStatisticsArgs,
+#ifdef IOCSHFUNCDEF_HAS_USAGE
+  "Print statistics about a poll group.\n",
+#endif // IOCSHFUNCDEF_HAS_USAGE
+};
+
+static int iocshMrfPollGroupStatisticsFuncInternal(
+    const iocshArgBuf *args) noexcept {
+  char *pollGroupId = args[0].sval;
+  // Verify and convert the parameters.
+  if (!pollGroupId) {
+    errorPrintf(
+        "Poll group ID must be specified.");
+    return 1;
+  }
+  if (!std::strlen(pollGroupId)) {
+    errorPrintf(
+        "Poll group ID must not be empty.");
+    return 1;
+  }
+  try {
+    auto pollGroup = MrfDeviceRegistry::getInstance().getPollGroup(
+        pollGroupId);
+    if (!pollGroup) {
+      errorPrintf("Could not find poll group with ID \"%s\".", pollGroupId);
+      return 1;
+    }
+    auto statistics = pollGroup->getStatistics();
+    ::epicsStdoutPrintf("Device:                 %s\n",
+        pollGroup->getDeviceId().c_str());
+    ::epicsStdoutPrintf("Period:                 %.6f s\n",
+        pollGroup->getPeriod().count() / 1e6);
+    ::epicsStdoutPrintf("Records:                %lu\n",
+        static_cast<unsigned long>(statistics.listeners));
+    ::epicsStdoutPrintf("Registers:              %lu\n",
+        static_cast<unsigned long>(statistics.registers));
+    ::epicsStdoutPrintf("Requests per cycle:     %lu\n",
+        static_cast<unsigned long>(statistics.requestsPerCycle));
+    ::epicsStdoutPrintf("Registers per cycle:    %lu\n",
+        static_cast<unsigned long>(statistics.registersPerCycle));
+    ::epicsStdoutPrintf("Cycles:                 %llu\n",
+        static_cast<unsigned long long>(statistics.cycles));
+    ::epicsStdoutPrintf("Overruns:               %llu\n",
+        static_cast<unsigned long long>(statistics.overruns));
+    ::epicsStdoutPrintf("Failed requests:        %llu\n",
+        static_cast<unsigned long long>(statistics.requestsFailed));
+    ::epicsStdoutPrintf("Last cycle:             %llu us\n",
+        static_cast<unsigned long long>(statistics.lastCycleMicroseconds));
+    ::epicsStdoutPrintf("Longest cycle:          %llu us\n",
+        static_cast<unsigned long long>(statistics.maxCycleMicroseconds));
+  } catch (std::exception &e) {
+    errorPrintf("Error while getting poll group statistics: %s", e.what());
+    return 1;
+  } catch (...) {
+    errorPrintf("Error while getting poll group statistics: Unknown error.");
+    return 1;
+  }
+  return 0;
+}
+
+/**
+ * Implementation of the iocsh mrfPollGroupStatistics function. This function
+ * prints how many registers a poll group reads, how many requests it needs
+ * for that, and how long its cycles take.
+ */
+static void iocshMrfPollGroupStatisticsFunc(const iocshArgBuf *args) noexcept {
+#if EPICS_VERSION_INT >= VERSION_INT(7,0,3,1)
+  iocshSetError(iocshMrfPollGroupStatisticsFuncInternal(args));
+#else // EPICS_VERSION_INT >= VERSION_INT(7,0,3,1)
+  iocshMrfPollGroupStatisticsFuncInternal(args);
+#endif // EPICS_VERSION_INT >= VERSION_INT(7,0,3,1)
+}
+
+} // extern "C"
+
+namespace anka {
+namespace mrf {
+namespace epics {
+
+void registerIocshMrfPollGroupStatistics() {
+  ::iocshRegister(&iocshMrfPollGroupStatisticsFuncDef,
+      iocshMrfPollGroupStatisticsFunc);
+}
+
+} // namespace epics
+} // namespace mrf
+} // namespace anka
@@ -0,0 +1,124 @@
+/*
+ * Copyright 2026 aquenos GmbH.
+ * Copyright 2026 Karlsruhe Institute of Technology.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * This software has been developed by aquenos GmbH on behalf of the
+ * Karlsruhe Institute of Technology's Institute for Beam Physics and
+ * Technology.
+ *
+ * This software contains code originally developed by aquenos GmbH for
+ * the s7nodave EPICS device support. aquenos GmbH has relicensed the
+ * affected poritions of code from the s7nodave EPICS device support
+ * (originally licensed under the terms of the GNU GPL) under the terms
+ * of the GNU LGPL version 3 or newer.
+ */
+
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+
+#include <epicsStdio.h>
+#include <epicsVersion.h>
+#include <iocsh.h>
+
+#include "MrfProcessScheduler.h"
+#include "mrfEpicsError.h"
+
+#include "mrfIocshProcessBatchWindow.h"
+
+using namespace anka::mrf;
+using namespace anka::mrf::epics;
+
+extern "C" {
+
+// Data structures needed for the iocsh mrfProcessBatchWindow function.
+static const iocshArg iocshMrfProcessBatchWindowArg0 = {
+  "batch window (seconds, negative to disable)", iocshArgString };
+static const iocshArg * const iocshMrfProcessBatchWindowArgs[] = {
+  &iocshMrfProcessBatchWindowArg0 };
+static const iocshFuncDef iocshMrfProcessBatchWindowFuncDef = {
+  "mrfProcessBatchWindow",
+  1,
+  iocshMrfProcessBatchWindowArgs,
+#ifdef IOCSHFUNCDEF_HAS_USAGE
+  "Process records that finish an operation at about the same time in a single\n"
+  "callback. A window of zero only batches requests that arrive while the\n"
+  "callback is queued, a positive window delays the callback by that time, and\n"
+  "a negative window disables batching (the default). Without a parameter, the\n"
+  "current setting is printed.\n",
+#endif // IOCSHFUNCDEF_HAS_USAGE
+};
+
+static int iocshMrfProcessBatchWindowFuncInternal(
+    const iocshArgBuf *args) noexcept {
+  const char *batchWindowString = args[0].sval;
+  // Without a parameter, we print the current setting. We use a string
+  // parameter instead of a double parameter because otherwise, we could not
+  // distinguish a missing parameter from a window of zero.
+  if (!batchWindowString || !std::strlen(batchWindowString)) {
+    double batchWindow = MrfProcessScheduler::getInstance().getBatchWindow();
+    if (batchWindow < 0.0) {
+      ::epicsStdoutPrintf("Batching is disabled.\n");
+    } else {
+      ::epicsStdoutPrintf("Batch window: %g seconds\n", batchWindow);
+    }
+    return 0;
+  }
+  char *end;
+  double batchWindow = std::strtod(batchWindowString, &end);
+  if (*end) {
+    errorPrintf("Invalid batch window \"%s\".", batchWindowString);
+    return 1;
+  }
+  // Verify the parameter. Windows longer than one second would delay the
+  // processing of records so much that this is most likely a mistake.
+  if (!std::isfinite(batchWindow) || batchWindow > 1.0) {
+    errorPrintf(
+        "The batch window must not be greater than one second.");
+    return 1;
+  }
+  MrfProcessScheduler::getInstance().setBatchWindow(batchWindow);
+  return 0;
+}
+
+/**
+ * Implementation of the iocsh mrfProcessBatchWindow function. This function
+ * configures how the processing of records is scheduled after asynchronous
+ * operations have finished.
+ */
+static void iocshMrfProcessBatchWindowFunc(const iocshArgBuf *args) noexcept {
+#if EPICS_VERSION_INT >= VERSION_INT(7,0,3,1)
+  iocshSetError(iocshMrfProcessBatchWindowFuncInternal(args));
+#else // EPICS_VERSION_INT >= VERSION_INT(7,0,3,1)
+  iocshMrfProcessBatchWindowFuncInternal(args);
+#endif // EPICS_VERSION_INT >= VERSION_INT(7,0,3,1)
+}
+
+} // extern "C"
+
+namespace anka {
+namespace mrf {
+namespace epics {
+
+void registerIocshMrfProcessBatchWindow() {
+  ::iocshRegister(&iocshMrfProcessBatchWindowFuncDef,
+      iocshMrfProcessBatchWindowFunc);
+}
+
+} // namespace epics
+} // namespace mrf
+} // namespace anka
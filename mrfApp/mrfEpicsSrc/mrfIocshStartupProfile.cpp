@@ -0,0 +1,105 @@
+/*
+ * Copyright 2026 aquenos GmbH.
+ * Copyright 2026 Karlsruhe Institute of Technology.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * This software has been developed by aquenos GmbH on behalf of the
+ * Karlsruhe Institute of Technology's Institute for Beam Physics and
+ * Technology.
+ *
+ * This software contains code originally developed by aquenos GmbH for
+ * the s7nodave EPICS device support. aquenos GmbH has relicensed the
+ * affected poritions of code from the s7nodave EPICS device support
+ * (originally licensed under the terms of the GNU GPL) under the terms
+ * of the GNU LGPL version 3 or newer.
+ */
+
+#include <stdexcept>
+#include <string>
+
+#include <epicsVersion.h>
+#include <iocsh.h>
+
+#include "MrfStartupProfiler.h"
+#include "mrfEpicsError.h"
+
+#include "mrfIocshStartupProfile.h"
+
+using namespace anka::mrf;
+using namespace anka::mrf::epics;
+
+extern "C" {
+
+// Data structures needed for the iocsh mrfStartupProfile function.
+static const iocshArg iocshMrfStartupProfileArg0 = {
+  "trace file (optional)", iocshArgString };
+static const iocshArg * const iocshMrfStartupProfileArgs[] = {
+  &iocshMrfStartupProfileArg0 };
+static const iocshFuncDef iocshMrfStartupProfileFuncDef = {
+  "mrfStartupProfile",
+  1,
+  iocshMrfStartupProfileArgs,
+#ifdef IOCSHFUNCDEF_HAS_USAGE
+  "Record where the time is spent while the IOC starts.\n\n"
+  "Profiling ends when iocInit has finished. If a trace file is specified, "
+  "the\nrecorded events are written to this file in the Chrome trace format "
+  "at that\npoint. This function should be called before creating the "
+  "devices.\n",
+#endif // IOCSHFUNCDEF_HAS_USAGE
+};
+
+static int iocshMrfStartupProfileFuncInternal(
+    const iocshArgBuf *args) noexcept {
+  char *traceFileName = args[0].sval;
+  try {
+    MrfStartupProfiler::enable(traceFileName ? traceFileName : "");
+  } catch (std::exception &e) {
+    errorPrintf("Could not enable startup profiling: %s", e.what());
+    return 1;
+  } catch (...) {
+    errorPrintf("Could not enable startup profiling: Unknown error.");
+    return 1;
+  }
+  return 0;
+}
+
+/**
+ * Implementation of the iocsh mrfStartupProfile function. This function
+ * enables the startup profiler and optionally sets the file to which the
+ * trace is written when the IOC is running.
+ */
+static void iocshMrfStartupProfileFunc(const iocshArgBuf *args) noexcept {
+#if EPICS_VERSION_INT >= VERSION_INT(7,0,3,1)
+  iocshSetError(iocshMrfStartupProfileFuncInternal(args));
+#else // EPICS_VERSION_INT >= VERSION_INT(7,0,3,1)
+  iocshMrfStartupProfileFuncInternal(args);
+#endif // EPICS_VERSION_INT >= VERSION_INT(7,0,3,1)
+}
+
+} // extern "C"
+
+namespace anka {
+namespace mrf {
+namespace epics {
+
+void registerIocshMrfStartupProfile() {
+  ::iocshRegister(&iocshMrfStartupProfileFuncDef,
+      iocshMrfStartupProfileFunc);
+}
+
+} // namespace epics
+} // namespace mrf
+} // namespace anka
@@ -0,0 +1,98 @@
+/*
+ * Copyright 2026 aquenos GmbH.
+ * Copyright 2026 Karlsruhe Institute of Technology.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * This software has been developed by aquenos GmbH on behalf of the
+ * Karlsruhe Institute of Technology's Institute for Beam Physics and
+ * Technology.
+ *
+ * This software contains code originally developed by aquenos GmbH for
+ * the s7nodave EPICS device support. aquenos GmbH has relicensed the
+ * affected poritions of code from the s7nodave EPICS device support
+ * (originally licensed under the terms of the GNU GPL) under the terms
+ * of the GNU LGPL version 3 or newer.
+ */
+
+#include <stdexcept>
+
+#include <epicsVersion.h>
+#include <iocsh.h>
+
+#include "MrfStartupProfiler.h"
+#include "mrfEpicsError.h"
+
+#include "mrfIocshStartupProfileSummary.h"
+
+using namespace anka::mrf;
+using namespace anka::mrf::epics;
+
+extern "C" {
+
+// Data structures needed for the iocsh mrfStartupProfileSummary function.
+static const iocshFuncDef iocshMrfStartupProfileSummaryFuncDef = {
+  "mrfStartupProfileSummary",
+  0,
+  nullptr,
+#ifdef IOCSHFUNCDEF_HAS_USAGE
+  "Print a summary of the startup profile.\n\n"
+  "This includes the times of the iocInit phases, the time spent creating "
+  "devices\nand preheating caches, the blocking cache reads, the time spent "
+  "initializing\nrecords by record type, and the slowest records.\n",
+#endif // IOCSHFUNCDEF_HAS_USAGE
+};
+
+static int iocshMrfStartupProfileSummaryFuncInternal(
+    const iocshArgBuf *) noexcept {
+  try {
+    MrfStartupProfiler::printSummary();
+  } catch (std::exception &e) {
+    errorPrintf("Could not print the startup profile: %s", e.what());
+    return 1;
+  } catch (...) {
+    errorPrintf("Could not print the startup profile: Unknown error.");
+    return 1;
+  }
+  return 0;
+}
+
+/**
+ * Implementation of the iocsh mrfStartupProfileSummary function. This
+ * function prints where the time has been spent while the IOC started.
+ */
+static void iocshMrfStartupProfileSummaryFunc(
+    const iocshArgBuf *args) noexcept {
+#if EPICS_VERSION_INT >= VERSION_INT(7,0,3,1)
+  iocshSetError(iocshMrfStartupProfileSummaryFuncInternal(args));
+#else // EPICS_VERSION_INT >= VERSION_INT(7,0,3,1)
+  iocshMrfStartupProfileSummaryFuncInternal(args);
+#endif // EPICS_VERSION_INT >= VERSION_INT(7,0,3,1)
+}
+
+} // extern "C"
+
+namespace anka {
+namespace mrf {
+namespace epics {
+
+void registerIocshMrfStartupProfileSummary() {
+  ::iocshRegister(&iocshMrfStartupProfileSummaryFuncDef,
+      iocshMrfStartupProfileSummaryFunc);
+}
+
+} // namespace epics
+} // namespace mrf
+} // namespace anka
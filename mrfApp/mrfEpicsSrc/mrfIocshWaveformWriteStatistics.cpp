@@ -0,0 +1,192 @@
+/*
+ * Copyright 2026 aquenos GmbH.
+ * Copyright 2026 Karlsruhe Institute of Technology.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * This software has been developed by aquenos GmbH on behalf of the
+ * Karlsruhe Institute of Technology's Institute for Beam Physics and
+ * Technology.
+ *
+ * This software contains code originally developed by aquenos GmbH for
+ * the s7nodave EPICS device support. aquenos GmbH has relicensed the
+ * affected poritions of code from the s7nodave EPICS device support
+ * (originally licensed under the terms of the GNU GPL) under the terms
+ * of the GNU LGPL version 3 or newer.
+ */
+
+#include <cstring>
+#include <string>
+
+#include <dbAccess.h>
+#include <dbStaticLib.h>
+#include <epicsStdio.h>
+#include <epicsVersion.h>
+#include <iocsh.h>
+
+#include "MrfWaveformOutRecord.h"
+#include "mrfEpicsError.h"
+
+#include "mrfIocshWaveformWriteStatistics.h"
+
+using namespace anka::mrf;
+using namespace anka::mrf::epics;
+
+// We use an anonymous namespace for the functions that we only use
+// internally. This way, we can avoid accidental name collisions.
+namespace {
+
+/**
+ * Returns the device support of the record that the entry currently points
+ * to, or null if the record is not a waveform record using the "MRF Memory
+ * Output" device support or has not been initialized successfully.
+ */
+MrfWaveformOutRecord *getDeviceSupport(DBENTRY *entry) {
+  if (std::strcmp(::dbGetRecordTypeName(entry), "waveform")) {
+    return nullptr;
+  }
+  if (::dbFindField(entry, "DTYP")) {
+    return nullptr;
+  }
+  const char *deviceType = ::dbGetString(entry);
+  if (!deviceType || std::strcmp(deviceType, "MRF Memory Output")) {
+    return nullptr;
+  }
+  ::dbCommon *record = static_cast<::dbCommon *>(entry->precnode->precord);
+  return static_cast<MrfWaveformOutRecord *>(record->dpvt);
+}
+
+void printStatistics(const char *recordName,
+    MrfWaveformOutRecord *deviceSupport) {
+  auto statistics = deviceSupport->getWriteStatistics();
+  ::epicsStdoutPrintf(
+      "%s: %llu writes, %llu elements written, %llu elements skipped (last write: %u elements written in %u ranges, %u elements skipped)\n",
+      recordName, static_cast<unsigned long long>(statistics.writes),
+      static_cast<unsigned long long>(statistics.elementsWritten),
+      static_cast<unsigned long long>(statistics.elementsSkipped),
+      static_cast<unsigned int>(statistics.lastElementsWritten),
+      static_cast<unsigned int>(statistics.lastRanges),
+      static_cast<unsigned int>(statistics.lastElementsSkipped));
+}
+
+} // anonymous namespace
+
+extern "C" {
+
+// Data structures needed for the iocsh mrfWaveformWriteStatistics function.
+static const iocshArg iocshMrfWaveformWriteStatisticsArg0 = {
+  "record name", iocshArgString };
+static const iocshArg * const iocshMrfWaveformWriteStatisticsArgs[] = {
+  &iocshMrfWaveformWriteStatisticsArg0 };
+static const iocshFuncDef iocshMrfWaveformWriteStatisticsFuncDef = {
+  "mrfWaveformWriteStatistics",
+  1,
+  iocshMrfWaveformWriteStatisticsArgs,
+#ifdef IOCSHFUNCDEF_HAS_USAGE
+  "Print the number of elements written and skipped by waveform output"
+  " records. If no record name is specified, the statistics for all records"
+  " are printed.\n",
+#endif // IOCSHFUNCDEF_HAS_USAGE
+};
+
+static int iocshMrfWaveformWriteStatisticsFuncInternal(
+    const iocshArgBuf *args) noexcept {
+  char *recordName = args[0].sval;
+  if (!::pdbbase) {
+    errorPrintf("No database has been loaded.");
+    return 1;
+  }
+  DBENTRY entry;
+  ::dbInitEntry(::pdbbase, &entry);
+  try {
+    if (recordName && std::strlen(recordName)) {
+      if (::dbFindRecord(&entry, recordName)) {
+        ::dbFinishEntry(&entry);
+        errorPrintf("Could not find record \"%s\".", recordName);
+        return 1;
+      }
+      MrfWaveformOutRecord *deviceSupport = getDeviceSupport(&entry);
+      if (!deviceSupport) {
+        ::dbFinishEntry(&entry);
+        errorPrintf(
+            "Record \"%s\" is not an initialized waveform record using the \"MRF Memory Output\" device support.",
+            recordName);
+        return 1;
+      }
+      printStatistics(recordName, deviceSupport);
+    } else {
+      for (long status = ::dbFirstRecordType(&entry); !status;
+          status = ::dbNextRecordType(&entry)) {
+        if (std::strcmp(::dbGetRecordTypeName(&entry), "waveform")) {
+          continue;
+        }
+        for (long recordStatus = ::dbFirstRecord(&entry); !recordStatus;
+            recordStatus = ::dbNextRecord(&entry)) {
+          if (::dbIsAlias(&entry)) {
+            continue;
+          }
+          MrfWaveformOutRecord *deviceSupport = getDeviceSupport(&entry);
+          if (deviceSupport) {
+            // Looking up the DTYP field moves the entry to that field, but
+            // the entry still points to the same record, so we can get its
+            // name and continue with the next record.
+            printStatistics(::dbGetRecordName(&entry), deviceSupport);
+          }
+        }
+      }
+    }
+  } catch (std::exception &e) {
+    ::dbFinishEntry(&entry);
+    errorPrintf("Error while getting waveform write statistics: %s",
+        e.what());
+    return 1;
+  } catch (...) {
+    ::dbFinishEntry(&entry);
+    errorPrintf(
+        "Error while getting waveform write statistics: Unknown error.");
+    return 1;
+  }
+  ::dbFinishEntry(&entry);
+  return 0;
+}
+
+/**
+ * Implementation of the iocsh mrfWaveformWriteStatistics function. This
+ * function prints how many elements waveform output records have written and
+ * how many they have skipped because the elements had not changed.
+ */
+static void iocshMrfWaveformWriteStatisticsFunc(
+    const iocshArgBuf *args) noexcept {
+#if EPICS_VERSION_INT >= VERSION_INT(7,0,3,1)
+  iocshSetError(iocshMrfWaveformWriteStatisticsFuncInternal(args));
+#else // EPICS_VERSION_INT >= VERSION_INT(7,0,3,1)
+  iocshMrfWaveformWriteStatisticsFuncInternal(args);
+#endif // EPICS_VERSION_INT >= VERSION_INT(7,0,3,1)
+}
+
+} // extern "C"
+
+namespace anka {
+namespace mrf {
+namespace epics {
+
+void registerIocshMrfWaveformWriteStatistics() {
+  ::iocshRegister(&iocshMrfWaveformWriteStatisticsFuncDef,
+      iocshMrfWaveformWriteStatisticsFunc);
+}
+
+} // namespace epics
+} // namespace mrf
+} // namespace anka
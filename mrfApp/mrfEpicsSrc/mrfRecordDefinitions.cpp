@@ -29,6 +29,7 @@
 
 #include <stdexcept>
 
+#include <dbBase.h>
 #include <dbCommon.h>
 #include <devSup.h>
 #include <epicsExport.h>
@@ -39,7 +40,10 @@
 #include "MrfBiInterruptRecord.h"
 #include "MrfBoRecord.h"
 #include "MrfLonginRecord.h"
+#include "MrfLonginEventCounterRecord.h"
+#include "MrfLonginInterruptOverflowCounterRecord.h"
 #include "MrfLonginInterruptRecord.h"
+#include "MrfLonginPostedWriteFailureCounterRecord.h"
 #include "MrfLongoutRecord.h"
 #include "MrfLongoutFineDelayShiftRegisterRecord.h"
 #include "MrfMbbiDirectRecord.h"
@@ -47,7 +51,9 @@
 #include "MrfMbboDirectRecord.h"
 #include "MrfMbbiRecord.h"
 #include "MrfMbboRecord.h"
+#include "MrfStartupProfiler.h"
 #include "MrfStringinRecord.h"
+#include "MrfWaveformEventFifoRecord.h"
 #include "MrfWaveformInRecord.h"
 #include "MrfWaveformOutRecord.h"
 #include "mrfEpicsError.h"
@@ -66,10 +72,30 @@ long initRecord(void *recordVoid) {
   }
   dbCommon *record = static_cast<dbCommon *>(recordVoid);
   try {
+    // When profiling the startup, we measure how long the initialization
+    // takes and how much of this time is spent waiting for blocking reads.
+    bool profile = MrfStartupProfiler::isEnabled();
+    MrfStartupProfiler::Clock::time_point startTime;
+    MrfStartupProfiler::Clock::duration blockedTimeBefore;
+    if (profile) {
+      startTime = MrfStartupProfiler::Clock::now();
+      blockedTimeBefore = MrfStartupProfiler::getThreadBlockedTime();
+    }
     RecordDeviceSupportType *deviceSupport = new RecordDeviceSupportType(
       static_cast<typename RecordDeviceSupportType::RecordType *>(
         recordVoid));
     record->dpvt = deviceSupport;
+    if (profile) {
+      try {
+        MrfStartupProfiler::recordRecordInit(record->name,
+            record->rdes ? record->rdes->name : "unknown", startTime,
+            MrfStartupProfiler::Clock::now(),
+            MrfStartupProfiler::getThreadBlockedTime() - blockedTimeBefore);
+      } catch (...) {
+        // The record has been initialized successfully, so an error while
+        // profiling must not make the initialization fail.
+      }
+    }
     return 0;
   } catch (std::exception &e) {
     record->dpvt = nullptr;
@@ -169,7 +195,7 @@ aidset devAiMrf = {
     nullptr,
     nullptr,
     initRecord<MrfAiRecord>,
-    nullptr,
+    reinterpret_cast<DEVSUPFUN>(getInterruptInfo<MrfAiRecord>),
   },
   processRecord<MrfAiRecord>,
   nullptr,
@@ -214,7 +240,7 @@ bidset devBiMrf = {
     nullptr,
     nullptr,
     initRecord<MrfBiRecord>,
-    nullptr,
+    reinterpret_cast<DEVSUPFUN>(getInterruptInfo<MrfBiRecord>),
   },
   processRecord<MrfBiRecord>,
 };
@@ -271,7 +297,7 @@ longindset devLonginMrf = {
     nullptr,
     nullptr,
     initRecord<MrfLonginRecord>,
-    nullptr,
+    reinterpret_cast<DEVSUPFUN>(getInterruptInfo<MrfLonginRecord>),
   },
   processRecord<MrfLonginRecord>,
 };
@@ -292,6 +318,53 @@ longindset devLonginInterruptMrf = {
 };
 epicsExportAddress(dset, devLonginInterruptMrf);
 
+/**
+ * longin record type. Special version for counting event FIFO entries.
+ */
+longindset devLonginEventCounterMrf = {
+  {
+    5,
+    nullptr,
+    nullptr,
+    initRecord<MrfLonginEventCounterRecord>,
+    nullptr,
+  },
+  processRecord<MrfLonginEventCounterRecord>,
+};
+epicsExportAddress(dset, devLonginEventCounterMrf);
+
+/**
+ * longin record type. Special version for counting interrupt queue overflows.
+ */
+longindset devLonginInterruptOverflowCounterMrf = {
+  {
+    5,
+    nullptr,
+    nullptr,
+    initRecord<MrfLonginInterruptOverflowCounterRecord>,
+    reinterpret_cast<DEVSUPFUN>(
+        getInterruptInfo<MrfLonginInterruptOverflowCounterRecord>),
+  },
+  processRecord<MrfLonginInterruptOverflowCounterRecord>,
+};
+epicsExportAddress(dset, devLonginInterruptOverflowCounterMrf);
+
+/**
+ * longin record type. Special version for counting failed posted writes.
+ */
+longindset devLonginPostedWriteFailureCounterMrf = {
+  {
+    5,
+    nullptr,
+    nullptr,
+    initRecord<MrfLonginPostedWriteFailureCounterRecord>,
+    reinterpret_cast<DEVSUPFUN>(
+        getInterruptInfo<MrfLonginPostedWriteFailureCounterRecord>),
+  },
+  processRecord<MrfLonginPostedWriteFailureCounterRecord>,
+};
+epicsExportAddress(dset, devLonginPostedWriteFailureCounterMrf);
+
 /**
  * longout record type.
  */
@@ -343,7 +416,7 @@ mbbidirectdset devMbbiDirectMrf = {
     nullptr,
     nullptr,
     initRecord<MrfMbbiDirectRecord>,
-    nullptr,
+    reinterpret_cast<DEVSUPFUN>(getInterruptInfo<MrfMbbiDirectRecord>),
   },
   processRecord<MrfMbbiDirectRecord>,
 };
@@ -400,7 +473,7 @@ mbbidset devMbbiMrf = {
     nullptr,
     nullptr,
     initRecord<MrfMbbiRecord>,
-    nullptr,
+    reinterpret_cast<DEVSUPFUN>(getInterruptInfo<MrfMbbiRecord>),
   },
   processRecord<MrfMbbiRecord>,
 };
@@ -484,4 +557,19 @@ wfdset devWaveformOutMrf = {
 };
 epicsExportAddress(dset, devWaveformOutMrf);
 
+/**
+ * waveform record type. Special version for reading the event FIFO.
+ */
+wfdset devWaveformEventFifoMrf = {
+  {
+    5,
+    nullptr,
+    nullptr,
+    initRecord<MrfWaveformEventFifoRecord>,
+    reinterpret_cast<DEVSUPFUN>(getInterruptInfo<MrfWaveformEventFifoRecord>),
+  },
+  processRecord<MrfWaveformEventFifoRecord>,
+};
+epicsExportAddress(dset, devWaveformEventFifoMrf);
+
 } // extern "C"
@@ -28,12 +28,33 @@
  */
 
 
+#include <exception>
+
 #include <epicsExport.h>
 
+#include "MrfCachePreheater.h"
+#include "MrfLazyInitializer.h"
+#include "MrfRecordAddress.h"
+#include "mrfEpicsError.h"
+#include "mrfIocshBenchmarkCache.h"
+#include "mrfIocshBenchmarkRead.h"
+#include "mrfIocshBenchmarkRecordAddress.h"
+#include "mrfIocshBenchmarkWaveformConversion.h"
+#include "mrfIocshCacheInvalidate.h"
+#include "mrfIocshCachePreheatMode.h"
+#include "mrfIocshCachePreheatStatistics.h"
+#include "mrfIocshCacheTtl.h"
 #include "mrfIocshDumpCache.h"
+#include "mrfIocshLazyInitRate.h"
 #include "mrfIocshMapInterruptToEvent.h"
+#include "mrfIocshPollGroup.h"
+#include "mrfIocshPollGroupStatistics.h"
+#include "mrfIocshProcessBatchWindow.h"
 #include "mrfIocshReadUInt16.h"
 #include "mrfIocshReadUInt32.h"
+#include "mrfIocshStartupProfile.h"
+#include "mrfIocshStartupProfileSummary.h"
+#include "mrfIocshWaveformWriteStatistics.h"
 #include "mrfIocshWriteUInt16.h"
 #include "mrfIocshWriteUInt32.h"
 
@@ -43,15 +64,59 @@ using namespace anka::mrf::epics;
 extern "C" {
 
 /**
- * Registrar that registers the iocsh commands.
+ * Registrar that registers the iocsh commands and the init hooks that preheat
+ * the memory caches from the records, initialize records lazily, and clear the
+ * record address parse cache.
  */
 static void mrfRegistrarCommon() {
+  registerIocshMrfBenchmarkCache();
+  registerIocshMrfBenchmarkRead();
+  registerIocshMrfBenchmarkRecordAddress();
+  registerIocshMrfBenchmarkWaveformConversion();
+  registerIocshMrfCacheInvalidate();
+  registerIocshMrfCachePreheatMode();
+  registerIocshMrfCachePreheatStatistics();
+  registerIocshMrfCacheTtl();
   registerIocshMrfDumpCache();
+  registerIocshMrfLazyInitRate();
   registerIocshMrfMapInterruptToEvent();
+  registerIocshMrfPollGroup();
+  registerIocshMrfPollGroupStatistics();
+  registerIocshMrfProcessBatchWindow();
   registerIocshMrfReadUInt16();
   registerIocshMrfReadUInt32();
+  registerIocshMrfStartupProfile();
+  registerIocshMrfStartupProfileSummary();
+  registerIocshMrfWaveformWriteStatistics();
   registerIocshMrfWriteUInt16();
   registerIocshMrfWriteUInt32();
+  try {
+    MrfCachePreheater::registerInitHook();
+  } catch (std::exception &e) {
+    errorPrintf("Could not register the cache preheat init hook: %s",
+        e.what());
+  } catch (...) {
+    errorPrintf(
+        "Could not register the cache preheat init hook: Unknown error.");
+  }
+  try {
+    MrfLazyInitializer::registerInitHook();
+  } catch (std::exception &e) {
+    errorPrintf("Could not register the lazy initialization init hook: %s",
+        e.what());
+  } catch (...) {
+    errorPrintf(
+        "Could not register the lazy initialization init hook: Unknown error.");
+  }
+  try {
+    MrfRecordAddress::registerInitHook();
+  } catch (std::exception &e) {
+    errorPrintf("Could not register the record address init hook: %s",
+        e.what());
+  } catch (...) {
+    errorPrintf(
+        "Could not register the record address init hook: Unknown error.");
+  }
 }
 
 epicsExportRegistrar(mrfRegistrarCommon);
@@ -38,8 +38,12 @@
 #include <epicsVersion.h>
 #include <iocsh.h>
 
+#include <MrfCachePreheater.h>
+#include <MrfCacheSnapshot.h>
 #include <MrfConsistentAsynchronousMemoryAccess.h>
 #include <MrfDeviceRegistry.h>
+#include <MrfStartupProfiler.h>
+#include <MrfUdpIpAddressCache.h>
 #include <MrfUdpIpMemoryAccess.h>
 #include <mrfEpicsError.h>
 
@@ -53,53 +57,55 @@ namespace {
  * time of the IOC because preheating can happen for several devices in
  * parallel, while the record initialization itself is not parallelized and
  * would that have to wait for each I/O request to finish before it could
- * continue. There is no error checking here. If there is an error, the memory
- * location simply won't be cached, and the respective error will be presented
- * to the user when the second I/O attempt that is made after checking the cache
- * fails (unless the underlying problem has been resolved by then).
+ * continue. The reads are only started here and run asynchronously, so that
+ * many of them are in flight at the same time. There is no error checking
+ * here. If there is an error, the memory location simply won't be cached, and
+ * the respective error will be presented to the user when the second I/O
+ * attempt that is made after checking the cache fails (unless the underlying
+ * problem has been resolved by then).
  */
 void preheatCacheVmeEvg230(std::shared_ptr<MrfMemoryCache> cache) {
   // This code has been generated by preheat-cache-codegen.py using the output
   // of mrfDumpCache(...). If outuput records are added to the record file, this
   // code section needs to be updated.
   for (std::uint32_t address = 0x00000400; address < 0x00000408; address += 2) {
-      cache->tryCacheUInt16(address);
+      cache->preheatUInt16(address);
   }
   for (std::uint32_t address = 0x00000440; address < 0x00000448; address += 2) {
-      cache->tryCacheUInt16(address);
+      cache->preheatUInt16(address);
   }
-  cache->tryCacheUInt32(0x00000004);
+  cache->preheatUInt32(0x00000004);
   for (std::uint32_t address = 0x0000000c; address < 0x0000001c; address += 4) {
-      cache->tryCacheUInt32(address);
+      cache->preheatUInt32(address);
   }
   for (std::uint32_t address = 0x00000020; address < 0x0000002c; address += 4) {
-      cache->tryCacheUInt32(address);
-  }
-  cache->tryCacheUInt32(0x0000004c);
-  cache->tryCacheUInt32(0x00000050);
-  cache->tryCacheUInt32(0x00000060);
-  cache->tryCacheUInt32(0x00000070);
-  cache->tryCacheUInt32(0x00000074);
-  cache->tryCacheUInt32(0x00000080);
+      cache->preheatUInt32(address);
+  }
+  cache->preheatUInt32(0x0000004c);
+  cache->preheatUInt32(0x00000050);
+  cache->preheatUInt32(0x00000060);
+  cache->preheatUInt32(0x00000070);
+  cache->preheatUInt32(0x00000074);
+  cache->preheatUInt32(0x00000080);
   for (std::uint32_t address = 0x00000100; address < 0x00000120; address += 4) {
-      cache->tryCacheUInt32(address);
+      cache->preheatUInt32(address);
   }
   for (std::uint32_t address = 0x00000180; address < 0x000001c0; address += 4) {
-      cache->tryCacheUInt32(address);
+      cache->preheatUInt32(address);
   }
-  cache->tryCacheUInt32(0x00000500);
-  cache->tryCacheUInt32(0x00000504);
+  cache->preheatUInt32(0x00000500);
+  cache->preheatUInt32(0x00000504);
   for (std::uint32_t address = 0x00000540; address < 0x00000550; address += 4) {
-      cache->tryCacheUInt32(address);
+      cache->preheatUInt32(address);
   }
   for (std::uint32_t address = 0x00000600; address < 0x00000640; address += 4) {
-      cache->tryCacheUInt32(address);
+      cache->preheatUInt32(address);
   }
   for (std::uint32_t address = 0x00000800; address < 0x00001000; address += 4) {
-      cache->tryCacheUInt32(address);
+      cache->preheatUInt32(address);
   }
   for (std::uint32_t address = 0x00008000; address < 0x00010000; address += 4) {
-      cache->tryCacheUInt32(address);
+      cache->preheatUInt32(address);
   }
 }
 
@@ -108,107 +114,109 @@ void preheatCacheVmeEvg230(std::shared_ptr<MrfMemoryCache> cache) {
  * time of the IOC because preheating can happen for several devices in
  * parallel, while the record initialization itself is not parallelized and
  * would that have to wait for each I/O request to finish before it could
- * continue. There is no error checking here. If there is an error, the memory
- * location simply won't be cached, and the respective error will be presented
- * to the user when the second I/O attempt that is made after checking the cache
- * fails (unless the underlying problem has been resolved by then).
+ * continue. The reads are only started here and run asynchronously, so that
+ * many of them are in flight at the same time. There is no error checking
+ * here. If there is an error, the memory location simply won't be cached, and
+ * the respective error will be presented to the user when the second I/O
+ * attempt that is made after checking the cache fails (unless the underlying
+ * problem has been resolved by then).
  */
 void preheatCacheVmeEvr230Rf(std::shared_ptr<MrfMemoryCache> cache) {
   // This code has been generated by preheat-cache-codegen.py using the output
   // of mrfDumpCache(...). If outuput records are added to the record file, this
   // code section needs to be updated.
   for (std::uint32_t address = 0x00000400; address < 0x0000040e; address += 2) {
-      cache->tryCacheUInt16(address);
+      cache->preheatUInt16(address);
   }
   for (std::uint32_t address = 0x00000440; address < 0x00000448; address += 2) {
-      cache->tryCacheUInt16(address);
+      cache->preheatUInt16(address);
   }
   for (std::uint32_t address = 0x00000480; address < 0x000004a0; address += 2) {
-      cache->tryCacheUInt16(address);
-  }
-  cache->tryCacheUInt16(0x00000614);
-  cache->tryCacheUInt16(0x00000616);
-  cache->tryCacheUInt16(0x00000634);
-  cache->tryCacheUInt16(0x00000636);
-  cache->tryCacheUInt16(0x00000654);
-  cache->tryCacheUInt16(0x00000656);
-  cache->tryCacheUInt32(0x00000004);
-  cache->tryCacheUInt32(0x0000000c);
-  cache->tryCacheUInt32(0x00000010);
-  cache->tryCacheUInt32(0x00000020);
-  cache->tryCacheUInt32(0x00000024);
-  cache->tryCacheUInt32(0x00000040);
-  cache->tryCacheUInt32(0x0000004c);
-  cache->tryCacheUInt32(0x00000080);
+      cache->preheatUInt16(address);
+  }
+  cache->preheatUInt16(0x00000614);
+  cache->preheatUInt16(0x00000616);
+  cache->preheatUInt16(0x00000634);
+  cache->preheatUInt16(0x00000636);
+  cache->preheatUInt16(0x00000654);
+  cache->preheatUInt16(0x00000656);
+  cache->preheatUInt32(0x00000004);
+  cache->preheatUInt32(0x0000000c);
+  cache->preheatUInt32(0x00000010);
+  cache->preheatUInt32(0x00000020);
+  cache->preheatUInt32(0x00000024);
+  cache->preheatUInt32(0x00000040);
+  cache->preheatUInt32(0x0000004c);
+  cache->preheatUInt32(0x00000080);
   for (std::uint32_t address = 0x00000100; address < 0x0000010c; address += 4) {
-      cache->tryCacheUInt32(address);
+      cache->preheatUInt32(address);
   }
   for (std::uint32_t address = 0x00000200; address < 0x00000244; address += 4) {
-      cache->tryCacheUInt32(address);
+      cache->preheatUInt32(address);
   }
   for (std::uint32_t address = 0x00000248; address < 0x00000254; address += 4) {
-      cache->tryCacheUInt32(address);
+      cache->preheatUInt32(address);
   }
   for (std::uint32_t address = 0x00000258; address < 0x00000264; address += 4) {
-      cache->tryCacheUInt32(address);
+      cache->preheatUInt32(address);
   }
   for (std::uint32_t address = 0x00000268; address < 0x00000274; address += 4) {
-      cache->tryCacheUInt32(address);
+      cache->preheatUInt32(address);
   }
   for (std::uint32_t address = 0x00000278; address < 0x00000284; address += 4) {
-      cache->tryCacheUInt32(address);
+      cache->preheatUInt32(address);
   }
   for (std::uint32_t address = 0x00000288; address < 0x00000294; address += 4) {
-      cache->tryCacheUInt32(address);
+      cache->preheatUInt32(address);
   }
   for (std::uint32_t address = 0x00000298; address < 0x000002a4; address += 4) {
-      cache->tryCacheUInt32(address);
+      cache->preheatUInt32(address);
   }
   for (std::uint32_t address = 0x000002a8; address < 0x000002b4; address += 4) {
-      cache->tryCacheUInt32(address);
+      cache->preheatUInt32(address);
   }
   for (std::uint32_t address = 0x000002b8; address < 0x000002c4; address += 4) {
-      cache->tryCacheUInt32(address);
+      cache->preheatUInt32(address);
   }
   for (std::uint32_t address = 0x000002c8; address < 0x000002d4; address += 4) {
-      cache->tryCacheUInt32(address);
+      cache->preheatUInt32(address);
   }
   for (std::uint32_t address = 0x000002d8; address < 0x000002e4; address += 4) {
-      cache->tryCacheUInt32(address);
+      cache->preheatUInt32(address);
   }
   for (std::uint32_t address = 0x000002e8; address < 0x000002f4; address += 4) {
-      cache->tryCacheUInt32(address);
+      cache->preheatUInt32(address);
   }
-  cache->tryCacheUInt32(0x000002f8);
-  cache->tryCacheUInt32(0x000002fc);
-  cache->tryCacheUInt32(0x00000500);
-  cache->tryCacheUInt32(0x00000504);
+  cache->preheatUInt32(0x000002f8);
+  cache->preheatUInt32(0x000002fc);
+  cache->preheatUInt32(0x00000500);
+  cache->preheatUInt32(0x00000504);
   for (std::uint32_t address = 0x00000600; address < 0x00000614; address += 4) {
-      cache->tryCacheUInt32(address);
+      cache->preheatUInt32(address);
   }
-  cache->tryCacheUInt32(0x00000618);
+  cache->preheatUInt32(0x00000618);
   for (std::uint32_t address = 0x00000620; address < 0x00000634; address += 4) {
-      cache->tryCacheUInt32(address);
+      cache->preheatUInt32(address);
   }
-  cache->tryCacheUInt32(0x00000638);
+  cache->preheatUInt32(0x00000638);
   for (std::uint32_t address = 0x00000640; address < 0x00000654; address += 4) {
-      cache->tryCacheUInt32(address);
+      cache->preheatUInt32(address);
   }
-  cache->tryCacheUInt32(0x00000658);
+  cache->preheatUInt32(0x00000658);
   for (std::uint32_t address = 0x00001800; address < 0x00002000; address += 4) {
-      cache->tryCacheUInt32(address);
+      cache->preheatUInt32(address);
   }
   for (std::uint32_t address = 0x00004000; address < 0x00006000; address += 4) {
-      cache->tryCacheUInt32(address);
+      cache->preheatUInt32(address);
   }
   for (std::uint32_t address = 0x00020000; address < 0x00022000; address += 4) {
-      cache->tryCacheUInt32(address);
+      cache->preheatUInt32(address);
   }
   for (std::uint32_t address = 0x00024000; address < 0x00026000; address += 4) {
-      cache->tryCacheUInt32(address);
+      cache->preheatUInt32(address);
   }
   for (std::uint32_t address = 0x00028000; address < 0x0002a000; address += 4) {
-      cache->tryCacheUInt32(address);
+      cache->preheatUInt32(address);
   }
 }
 
@@ -222,7 +230,10 @@ void createUdpIpDevice(
     std::uint32_t baseAddress,
     const std::chrono::duration<double> queueTimeout,
     const std::chrono::duration<double> requestTimeout,
+    std::size_t preheatLimit,
+    const std::string &snapshotFileName,
     std::function<void(std::shared_ptr<MrfMemoryCache>)> preheatFunction) {
+  MrfStartupProfiler::Span span("device", deviceId);
   std::shared_ptr<MrfUdpIpMemoryAccess> rawDevice = std::make_shared<
     MrfUdpIpMemoryAccess>(hostName, baseAddress, queueTimeout, requestTimeout);
   std::shared_ptr<MrfConsistentAsynchronousMemoryAccess> consistentDevice =
@@ -233,9 +244,39 @@ void createUdpIpDevice(
   // pointer is null, because it won't be null if registerDevice did not throw
   // an exception.
   auto cache = MrfDeviceRegistry::getInstance().getDeviceCache(deviceId);
-  std::thread preheatThread([cache, preheatFunction]() {
-    preheatFunction(cache);
-  });
+  cache->setPreheatLimit(preheatLimit);
+  // If a snapshot file has been specified, the cache is warm-started from it.
+  // Reads from the cache wait until the snapshot has been loaded.
+  std::shared_ptr<MrfCacheSnapshot> snapshot;
+  if (!snapshotFileName.empty()) {
+    snapshot = MrfCacheSnapshot::create(deviceId, cache, consistentDevice,
+        snapshotFileName);
+  }
+  // In the other modes, the cache is either preheated based on the loaded
+  // records or not at all.
+  bool preheat =
+      MrfCachePreheater::getMode() == MrfCachePreheater::Mode::generated;
+  if (!snapshot && !preheat) {
+    return;
+  }
+  // The preheat function only blocks when the limit of reads in flight has
+  // been reached, but there are many registers, so we still run it in a
+  // separate thread. Record initialization does not wait for this thread. It
+  // only waits for the reads of the registers that it actually needs. Loading
+  // the snapshot happens in the same thread, before preheating, so that the
+  // registers contained in the snapshot are not read from the device.
+  std::thread preheatThread(
+      [deviceId, cache, snapshot, preheat, preheatFunction]() {
+        if (snapshot) {
+          MrfStartupProfiler::Span span("snapshot", deviceId);
+          snapshot->load();
+        }
+        if (preheat) {
+          MrfStartupProfiler::Span span("preheat", deviceId);
+          preheatFunction(cache);
+          cache->finishPreheating();
+        }
+      });
   // We want to continue the preheating in the background, so we detach the
   // thread.
   preheatThread.detach();
@@ -250,13 +291,17 @@ void createUdpIpEvgDevice(
     const std::string& deviceId,
     const std::string &hostName,
     const std::chrono::duration<double> queueTimeout,
-    const std::chrono::duration<double> requestTimeout) {
+    const std::chrono::duration<double> requestTimeout,
+    std::size_t preheatLimit,
+    const std::string &snapshotFileName) {
   createUdpIpDevice(
     deviceId,
     hostName,
     MrfUdpIpMemoryAccess::baseAddressVmeEvgRegister,
     queueTimeout,
     requestTimeout,
+    preheatLimit,
+    snapshotFileName,
     preheatCacheVmeEvg230);
 }
 
@@ -269,13 +314,17 @@ void createUdpIpEvrDevice(
     const std::string& deviceId,
     const std::string &hostName,
     const std::chrono::duration<double> queueTimeout,
-    const std::chrono::duration<double> requestTimeout) {
+    const std::chrono::duration<double> requestTimeout,
+    std::size_t preheatLimit,
+    const std::string &snapshotFileName) {
   createUdpIpDevice(
     deviceId,
     hostName,
     MrfUdpIpMemoryAccess::baseAddressVmeEvrRegister,
     queueTimeout,
     requestTimeout,
+    preheatLimit,
+    snapshotFileName,
     preheatCacheVmeEvr230Rf);
 }
 
@@ -283,6 +332,55 @@ void createUdpIpEvrDevice(
 
 extern "C" {
 
+// Data structures needed for the iocsh mrfUdpIpAddressCache function.
+static const iocshArg iocshMrfUdpIpAddressCacheArg0 = {
+  "file name", iocshArgString
+};
+static const iocshArg * const iocshMrfUdpIpAddressCacheArgs[] = {
+  &iocshMrfUdpIpAddressCacheArg0
+};
+static const iocshFuncDef iocshMrfUdpIpAddressCacheFuncDef = {
+  "mrfUdpIpAddressCache",
+  1,
+  iocshMrfUdpIpAddressCacheArgs,
+#ifdef IOCSHFUNCDEF_HAS_USAGE
+  "Set the file that stores the addresses that host names have been resolved "
+  "to.\n\nIf a host name cannot be resolved when a device is created, the "
+  "address from this\nfile is used instead. This function has to be called "
+  "before creating the devices.\n",
+#endif // IOCSHFUNCDEF_HAS_USAGE
+};
+
+/**
+ * Implementation of the iocsh mrfUdpIpAddressCache function.
+ */
+static int iocshMrfUdpIpAddressCacheFuncInternal(const iocshArgBuf *args)
+    noexcept {
+  char *fileName = args[0].sval;
+  if (!fileName || !std::strlen(fileName)) {
+    errorPrintf("File name must be specified.");
+    return 1;
+  }
+  try {
+    MrfUdpIpAddressCache::getInstance().setFileName(fileName);
+  } catch (std::exception &e) {
+    errorPrintf("Could not load the address cache: %s", e.what());
+    return 1;
+  } catch (...) {
+    errorPrintf("Could not load the address cache: Unknown error.");
+    return 1;
+  }
+  return 0;
+}
+
+static void iocshMrfUdpIpAddressCacheFunc(const iocshArgBuf *args) noexcept {
+#if EPICS_VERSION_INT >= VERSION_INT(7,0,3,1)
+  iocshSetError(iocshMrfUdpIpAddressCacheFuncInternal(args));
+#else // EPICS_VERSION_INT >= VERSION_INT(7,0,3,1)
+  iocshMrfUdpIpAddressCacheFuncInternal(args);
+#endif // EPICS_VERSION_INT >= VERSION_INT(7,0,3,1)
+}
+
 // Data structures needed for the iocsh mrfUdpIpDevice function.
 static const iocshArg iocshMrfUdpIpDeviceArg0 = {"device ID", iocshArgString};
 static const iocshArg iocshMrfUdpIpDeviceArg1 = {
@@ -294,15 +392,23 @@ static const iocshArg iocshMrfUdpIpDeviceArg2 = {
 static const iocshArg iocshMrfUdpIpDeviceArg3 = {
   "request timeout (seconds)", iocshArgDouble
 };
+static const iocshArg iocshMrfUdpIpDeviceArg4 = {
+  "preheat limit (reads in flight)", iocshArgInt
+};
+static const iocshArg iocshMrfUdpIpDeviceArg5 = {
+  "cache snapshot file", iocshArgString
+};
 static const iocshArg * const iocshMrfUdpIpDeviceArgs[] = {
   &iocshMrfUdpIpDeviceArg0,
   &iocshMrfUdpIpDeviceArg1,
   &iocshMrfUdpIpDeviceArg2,
-  &iocshMrfUdpIpDeviceArg3
+  &iocshMrfUdpIpDeviceArg3,
+  &iocshMrfUdpIpDeviceArg4,
+  &iocshMrfUdpIpDeviceArg5
 };
 static const iocshFuncDef iocshMrfUdpIpEvgDeviceFuncDef = {
   "mrfUdpIpEvgDevice",
-  4,
+  6,
   iocshMrfUdpIpDeviceArgs,
 #ifdef IOCSHFUNCDEF_HAS_USAGE
   "Define a UDP/IP connection to a VME-EVG-230.\n",
@@ -310,7 +416,7 @@ static const iocshFuncDef iocshMrfUdpIpEvgDeviceFuncDef = {
 };
 static const iocshFuncDef iocshMrfUdpIpEvrDeviceFuncDef = {
   "mrfUdpIpEvrDevice",
-  4,
+  6,
   iocshMrfUdpIpDeviceArgs,
 #ifdef IOCSHFUNCDEF_HAS_USAGE
   "Define a UDP/IP connection to a VME-EVR-230RF.\n",
@@ -327,6 +433,8 @@ static int iocshMrfUdpIpDeviceFunc(const iocshArgBuf *args, bool evr)
   char *hostAddress = args[1].sval;
   double queueTimeoutDouble = args[2].dval;
   double requestTimeoutDouble = args[3].dval;
+  int preheatLimitInt = args[4].ival;
+  char *snapshotFileName = args[5].sval;
   // Verify and convert the parameters.
   if (!deviceId) {
     errorPrintf("Could not create device: Device ID must be specified.");
@@ -362,14 +470,26 @@ static int iocshMrfUdpIpDeviceFunc(const iocshArgBuf *args, bool evr)
       // sufficient.
       requestTimeoutDouble = 5.0;
     }
+    if (preheatLimitInt < 0) {
+      throw std::invalid_argument("Preheat limit must not be negative.");
+    }
+    // Zero means that the default limit shall be used.
+    std::size_t preheatLimit = preheatLimitInt ?
+        static_cast<std::size_t>(preheatLimitInt) :
+        MrfMemoryCache::defaultPreheatLimit;
     auto queueTimeout = std::chrono::duration<double>(queueTimeoutDouble);
     auto requestTimeout = std::chrono::duration<double>(requestTimeoutDouble);
+    // No snapshot file (or an empty one) means that the cache is not persisted.
+    std::string snapshotFileNameString =
+        snapshotFileName ? snapshotFileName : "";
     if (evr) {
       createUdpIpEvrDevice(
-        deviceId, hostAddress, queueTimeout, requestTimeout);
+        deviceId, hostAddress, queueTimeout, requestTimeout, preheatLimit,
+        snapshotFileNameString);
     } else {
       createUdpIpEvgDevice(
-        deviceId, hostAddress, queueTimeout, requestTimeout);
+        deviceId, hostAddress, queueTimeout, requestTimeout, preheatLimit,
+        snapshotFileNameString);
     }
   } catch (std::exception &e) {
     anka::mrf::epics::errorPrintf("Could not create device %s: %s", deviceId,
@@ -409,6 +529,8 @@ static void iocshMrfUdpIpEvrDeviceFunc(const iocshArgBuf *args) noexcept {
  * Registrar that registers the iocsh commands.
  */
 static void mrfRegistrarUdpIp() {
+  iocshRegister(&iocshMrfUdpIpAddressCacheFuncDef,
+      iocshMrfUdpIpAddressCacheFunc);
   iocshRegister(&iocshMrfUdpIpEvgDeviceFuncDef, iocshMrfUdpIpEvgDeviceFunc);
   iocshRegister(&iocshMrfUdpIpEvrDeviceFuncDef, iocshMrfUdpIpEvrDeviceFunc);
 }
@@ -27,8 +27,10 @@
  * of the GNU LGPL version 3 or newer.
  */
 
+#include <algorithm>
 #include <atomic>
 #include <cerrno>
+#include <chrono>
 #include <mutex>
 #include <stdexcept>
 #include <system_error>
@@ -39,24 +41,94 @@ extern "C" {
 #include <pthread.h>
 #include <setjmp.h>
 #include <signal.h>
+#include <sys/inotify.h>
 #include <sys/ioctl.h>
 #include <sys/mman.h>
 #include <sys/signalfd.h>
+#include <sys/stat.h>
 #include <sys/syscall.h>
 #include <time.h>
 #include <unistd.h>
 }
 
+#include <mrfByteSwap.h>
+
 #include "MrfMmapMemoryAccess.h"
 
+// Older versions of the C library do not define the flags for
+// memfd_create(...), so we define the one that we need ourselves.
+#ifndef MFD_CLOEXEC
+#define MFD_CLOEXEC 0x0001U
+#endif // MFD_CLOEXEC
+
 namespace anka {
 namespace mrf {
 
+namespace {
+
+// Prefix of device paths that refer to an anonymous memory file instead of an
+// actual device node.
+const std::string memfdPathPrefix("memfd:");
+
+// Time that the I/O thread waits before trying to open the device again after
+// the first failed attempt. The time is doubled after each failed attempt
+// until it reaches the maximum.
+const std::chrono::milliseconds minimumOpenBackoff(10);
+
+// Maximum time that the I/O thread waits before trying to open the device
+// again. If the device node is watched with inotify, the device is typically
+// opened much sooner because creating the device node wakes up the thread.
+const std::chrono::milliseconds maximumOpenBackoff(5000);
+
+// Time that the I/O thread waits after select(...) has failed for the first
+// time. Like for opening the device, this time is doubled for each
+// consecutive failure.
+const std::chrono::milliseconds minimumSelectErrorBackoff(1);
+
+// Maximum time that the I/O thread waits after select(...) has failed.
+const std::chrono::milliseconds maximumSelectErrorBackoff(1000);
+
+} // anonymous namespace
+
 MrfMmapMemoryAccess::MrfMmapMemoryAccess(const std::string &devicePath,
     std::uint32_t memorySize) :
-    devicePath(devicePath), memorySize(memorySize), shutdown(false) {
+    devicePath(devicePath), memorySize(memorySize), shutdown(false), interruptDispatchTableChanged(false), interruptHoldOffMicroseconds(
+        0), interruptStormThreshold(0), interruptStormHoldOffMicroseconds(0), interruptsReceived(
+        0), interruptsNotified(0), interruptsCoalesced(0), interruptsDropped(
+        0), interruptStorms(0), interruptStormActive(false), connectionStatistics() {
+  // If the memory is not backed by a file, we create an anonymous memory file.
+  // We have to do this here and not in the I/O thread because the memory
+  // should keep its contents when the I/O thread reopens the device after an
+  // error. Older versions of the C library do not provide a wrapper for
+  // memfd_create(...), so we use the system call directly.
+  if (devicePath.compare(0, memfdPathPrefix.size(), memfdPathPrefix) == 0) {
+#ifdef SYS_memfd_create
+    memoryFd = ::syscall(SYS_memfd_create,
+        devicePath.substr(memfdPathPrefix.size()).c_str(), MFD_CLOEXEC);
+    if (memoryFd == -1) {
+      throw std::system_error(
+          errno, std::generic_category(), "memfd_create(...) failed");
+    }
+    if (::ftruncate(memoryFd, memorySize) == -1) {
+      int errorNumber = errno;
+      ::close(memoryFd);
+      throw std::system_error(
+          errorNumber, std::generic_category(), "ftruncate(...) failed");
+    }
+#else // SYS_memfd_create
+    throw std::runtime_error(
+        "Anonymous memory files are not supported on this platform.");
+#endif // SYS_memfd_create
+  }
   // Create the background thread.
-  this->ioThread = std::thread([this]() {runIoThread();});
+  try {
+    this->ioThread = std::thread([this]() {runIoThread();});
+  } catch (...) {
+    if (memoryFd != -1) {
+      ::close(memoryFd);
+    }
+    throw;
+  }
 }
 
 MrfMmapMemoryAccess::~MrfMmapMemoryAccess() {
@@ -76,6 +148,11 @@ MrfMmapMemoryAccess::~MrfMmapMemoryAccess() {
   } catch (...) {
     // A destructor should never throw.
   }
+  // The I/O thread uses a duplicate of the memory file-descriptor, so we can
+  // safely close it, even if the thread could not be stopped.
+  if (memoryFd != -1) {
+    ::close(memoryFd);
+  }
 }
 
 static bool verifyAddress16(std::uint32_t address, std::uint32_t memorySize,
@@ -140,6 +217,86 @@ void MrfMmapMemoryAccess::writeUInt32(std::uint32_t address,
   queueIoRequest(std::move(request));
 }
 
+template<typename T>
+static bool verifyBlock(std::uint32_t address, std::size_t count,
+    std::uint32_t elementDistance, std::uint32_t memorySize,
+    std::shared_ptr<MrfMemoryAccess::BlockCallback<T>> callback) {
+  // All elements must be within the accessible memory and aligned to the size
+  // of the elements. This is the case if the first element is aligned, the
+  // element distance is a multiple of the element size, and the last element
+  // is within the accessible memory.
+  std::uint64_t lastAddress = address;
+  if (count != 0) {
+    lastAddress += static_cast<std::uint64_t>(count - 1) * elementDistance;
+  }
+  if (memorySize < sizeof(T) || lastAddress > memorySize - sizeof(T)
+      || address % sizeof(T) != 0 || elementDistance % sizeof(T) != 0) {
+    callback->failure(address, MrfMemoryAccess::ErrorCode::invalidAddress,
+        std::string());
+    return false;
+  } else {
+    return true;
+  }
+}
+
+void MrfMmapMemoryAccess::readUInt16Block(std::uint32_t address,
+    std::size_t count, std::uint32_t elementDistance,
+    std::shared_ptr<BlockCallbackUInt16> callback) {
+  if (elementDistance == 0) {
+    elementDistance = 2;
+  }
+  if (!verifyBlock(address, count, elementDistance, memorySize, callback)) {
+    return;
+  }
+  MrfIoRequest request(MrfIoRequestType::readUInt16Block, address,
+      elementDistance, std::vector<std::uint16_t>(count), callback);
+  queueIoRequest(std::move(request));
+}
+
+void MrfMmapMemoryAccess::writeUInt16Block(std::uint32_t address,
+    const std::vector<std::uint16_t> &values, std::uint32_t elementDistance,
+    std::shared_ptr<BlockCallbackUInt16> callback) {
+  if (elementDistance == 0) {
+    elementDistance = 2;
+  }
+  if (!verifyBlock(address, values.size(), elementDistance, memorySize,
+      callback)) {
+    return;
+  }
+  MrfIoRequest request(MrfIoRequestType::writeUInt16Block, address,
+      elementDistance, std::vector<std::uint16_t>(values), callback);
+  queueIoRequest(std::move(request));
+}
+
+void MrfMmapMemoryAccess::readUInt32Block(std::uint32_t address,
+    std::size_t count, std::uint32_t elementDistance,
+    std::shared_ptr<BlockCallbackUInt32> callback) {
+  if (elementDistance == 0) {
+    elementDistance = 4;
+  }
+  if (!verifyBlock(address, count, elementDistance, memorySize, callback)) {
+    return;
+  }
+  MrfIoRequest request(MrfIoRequestType::readUInt32Block, address,
+      elementDistance, std::vector<std::uint32_t>(count), callback);
+  queueIoRequest(std::move(request));
+}
+
+void MrfMmapMemoryAccess::writeUInt32Block(std::uint32_t address,
+    const std::vector<std::uint32_t> &values, std::uint32_t elementDistance,
+    std::shared_ptr<BlockCallbackUInt32> callback) {
+  if (elementDistance == 0) {
+    elementDistance = 4;
+  }
+  if (!verifyBlock(address, values.size(), elementDistance, memorySize,
+      callback)) {
+    return;
+  }
+  MrfIoRequest request(MrfIoRequestType::writeUInt32Block, address,
+      elementDistance, std::vector<std::uint32_t>(values), callback);
+  queueIoRequest(std::move(request));
+}
+
 bool MrfMmapMemoryAccess::supportsInterrupts() const {
   return true;
 }
@@ -168,6 +325,7 @@ void MrfMmapMemoryAccess::addInterruptListener(
   if (listenerMissing) {
     interruptListeners.emplace_back(interruptListener);
   }
+  updateInterruptDispatchTable();
 }
 
 void MrfMmapMemoryAccess::removeInterruptListener(
@@ -189,6 +347,319 @@ void MrfMmapMemoryAccess::removeInterruptListener(
       }
     }
   }
+  updateInterruptDispatchTable();
+}
+
+bool MrfMmapMemoryAccess::supportsEventFifo() const {
+  return true;
+}
+
+void MrfMmapMemoryAccess::addEventFifoListener(
+    std::shared_ptr<EventFifoListener> eventFifoListener) {
+  // We have to hold the mutex while accessing the list of listeners.
+  std::lock_guard<std::mutex> lock(mutex);
+  // Before trying to add a listener, we iterator over all existing listeners
+  // and remove those that have become invalid. This ensures that our list does
+  // not grow without bounds when listeners are added but never removed.
+  bool listenerMissing = true;
+  for (auto listenerIterator = eventFifoListeners.begin();
+      listenerIterator != eventFifoListeners.end();) {
+    if (listenerIterator->expired()) {
+      listenerIterator = eventFifoListeners.erase(listenerIterator);
+    } else {
+      if (listenerIterator->lock() == eventFifoListener) {
+        listenerMissing = false;
+      }
+      ++listenerIterator;
+    }
+  }
+  if (listenerMissing) {
+    eventFifoListeners.emplace_back(eventFifoListener);
+  }
+}
+
+void MrfMmapMemoryAccess::removeEventFifoListener(
+    std::shared_ptr<EventFifoListener> eventFifoListener) {
+  // We have to hold the mutex while accessing the list of listeners.
+  std::lock_guard<std::mutex> lock(mutex);
+  for (auto listenerIterator = eventFifoListeners.begin();
+      listenerIterator != eventFifoListeners.end();) {
+    std::shared_ptr<EventFifoListener> foundListener = listenerIterator->lock();
+    if (!foundListener || foundListener == eventFifoListener) {
+      listenerIterator = eventFifoListeners.erase(listenerIterator);
+    } else {
+      ++listenerIterator;
+    }
+  }
+}
+
+void MrfMmapMemoryAccess::injectInterrupt(std::uint32_t interruptFlags) {
+  // An interrupt without any flags would be ignored anyway, so we do not even
+  // have to queue it.
+  if (interruptFlags == 0) {
+    return;
+  }
+  {
+    // We have to hold the mutex while accessing the queue.
+    std::lock_guard<std::mutex> lock(mutex);
+    if (shutdown) {
+      throw std::runtime_error("This device has been shutdown.");
+    }
+    injectedInterrupts.push_back(interruptFlags);
+  }
+  // The I/O thread might be sleeping, so we have to wake it up.
+  ioThreadFdSelector.wakeUp();
+}
+
+void MrfMmapMemoryAccess::setInterruptCoalescing(
+    std::uint32_t holdOffMicroseconds, std::uint32_t stormThreshold,
+    std::uint32_t stormHoldOffMicroseconds) {
+  // The I/O thread reads each of these values independently, so it does not
+  // matter if it sees a mix of old and new values for a short moment.
+  interruptHoldOffMicroseconds.store(holdOffMicroseconds);
+  interruptStormThreshold.store(stormThreshold);
+  interruptStormHoldOffMicroseconds.store(stormHoldOffMicroseconds);
+  // The I/O thread might be sleeping with a timeout that was calculated for
+  // the old configuration, so we wake it up.
+  ioThreadFdSelector.wakeUp();
+}
+
+void MrfMmapMemoryAccess::setInterruptStormHandler(
+    InterruptStormHandler handler) {
+  // We have to hold the mutex while accessing the handler.
+  std::lock_guard<std::mutex> lock(mutex);
+  interruptStormHandler = std::move(handler);
+}
+
+MrfMmapMemoryAccess::InterruptStatistics MrfMmapMemoryAccess::getInterruptStatistics() const {
+  InterruptStatistics statistics;
+  statistics.received = interruptsReceived.load(std::memory_order_relaxed);
+  statistics.notified = interruptsNotified.load(std::memory_order_relaxed);
+  statistics.coalesced = interruptsCoalesced.load(std::memory_order_relaxed);
+  statistics.dropped = interruptsDropped.load(std::memory_order_relaxed);
+  statistics.storms = interruptStorms.load(std::memory_order_relaxed);
+  statistics.stormActive = interruptStormActive.load(std::memory_order_relaxed);
+  return statistics;
+}
+
+MrfMmapMemoryAccess::ConnectionStatistics MrfMmapMemoryAccess::getConnectionStatistics() {
+  std::lock_guard<std::mutex> lock(mutex);
+  return connectionStatistics;
+}
+
+bool MrfMmapMemoryAccess::processInterrupt(std::uint32_t interruptFlags) {
+  InterruptCoalescingState &state = interruptCoalescingState;
+  Clock::time_point now = Clock::now();
+  interruptsReceived.fetch_add(1, std::memory_order_relaxed);
+  state.lastActivity = now;
+  // We count the interrupts in windows of one second. Using fixed windows
+  // instead of a sliding window is not exact, but it is cheap and good enough
+  // for detecting a source that keeps firing.
+  if (now - state.stormWindowStart >= std::chrono::seconds(1)) {
+    state.stormWindowStart = now;
+    state.stormWindowCount = 0;
+  }
+  ++state.stormWindowCount;
+  std::uint32_t stormThreshold = interruptStormThreshold.load(
+      std::memory_order_relaxed);
+  if (stormThreshold != 0 && state.stormWindowCount > stormThreshold
+      && !interruptStormActive.load(std::memory_order_relaxed)) {
+    interruptStormActive.store(true, std::memory_order_relaxed);
+    interruptStorms.fetch_add(1, std::memory_order_relaxed);
+    notifyInterruptStormHandler(true, state.stormWindowCount);
+    // If a hold-off time is already active, we extend it, so that the storm
+    // hold-off time is used right away.
+    if (state.holdOffActive) {
+      state.holdOffEnd = std::max(state.holdOffEnd,
+          now + currentInterruptHoldOff());
+    }
+  }
+  // An interrupt might be triggered spuriously. For this reason, we only
+  // call the interrupt listeners when the interrupt flag register has at
+  // least one interrupt flag set.
+  if (interruptFlags == 0) {
+    interruptsDropped.fetch_add(1, std::memory_order_relaxed);
+    return state.holdOffActive;
+  }
+  // While a hold-off time is active, we only collect the flags. The listeners
+  // are notified when the hold-off time ends.
+  if (state.holdOffActive) {
+    state.pendingFlags |= interruptFlags;
+    ++state.pendingCount;
+    return true;
+  }
+  notifyInterruptListeners(interruptFlags);
+  interruptsNotified.fetch_add(1, std::memory_order_relaxed);
+  return startInterruptHoldOff(now);
+}
+
+bool MrfMmapMemoryAccess::processInterruptHoldOff(Clock::time_point now) {
+  InterruptCoalescingState &state = interruptCoalescingState;
+  bool holdOffEnded = true;
+  if (state.holdOffActive) {
+    if (now < state.holdOffEnd) {
+      holdOffEnded = false;
+    } else {
+      state.holdOffActive = false;
+      state.lastActivity = now;
+      if (state.pendingCount != 0) {
+        // All interrupts but the first one that are part of this notification
+        // have been coalesced.
+        interruptsCoalesced.fetch_add(state.pendingCount - 1,
+            std::memory_order_relaxed);
+        std::uint32_t interruptFlags = state.pendingFlags;
+        state.pendingFlags = 0;
+        state.pendingCount = 0;
+        notifyInterruptListeners(interruptFlags);
+        interruptsNotified.fetch_add(1, std::memory_order_relaxed);
+        // We just notified the listeners, so we start a new hold-off time.
+        // Interrupts are still re-enabled at this point, so interrupts that
+        // are latched by the device are collected during the new hold-off
+        // time.
+        startInterruptHoldOff(now);
+      }
+    }
+  }
+  // A storm has ended when we have not seen an interrupt for the storm
+  // hold-off time after the last hold-off time ended. We also end the storm
+  // if storm detection has been disabled in the meantime.
+  if (interruptStormActive.load(std::memory_order_relaxed)
+      && !state.holdOffActive
+      && (interruptStormThreshold.load(std::memory_order_relaxed) == 0
+          || now - state.lastActivity
+              >= std::chrono::microseconds(
+                  interruptStormHoldOffMicroseconds.load(
+                      std::memory_order_relaxed)))) {
+    interruptStormActive.store(false, std::memory_order_relaxed);
+    std::uint32_t interruptRate =
+        (now - state.stormWindowStart >= std::chrono::seconds(1)) ?
+            0 : state.stormWindowCount;
+    notifyInterruptStormHandler(false, interruptRate);
+  }
+  return holdOffEnded;
+}
+
+MrfMmapMemoryAccess::Clock::time_point MrfMmapMemoryAccess::nextInterruptHoldOffDeadline() const {
+  const InterruptCoalescingState &state = interruptCoalescingState;
+  if (state.holdOffActive) {
+    return state.holdOffEnd;
+  }
+  if (interruptStormActive.load(std::memory_order_relaxed)) {
+    return state.lastActivity
+        + std::chrono::microseconds(
+            interruptStormHoldOffMicroseconds.load(std::memory_order_relaxed));
+  }
+  return Clock::time_point::max();
+}
+
+bool MrfMmapMemoryAccess::startInterruptHoldOff(Clock::time_point now) {
+  InterruptCoalescingState &state = interruptCoalescingState;
+  std::chrono::microseconds holdOff = currentInterruptHoldOff();
+  if (holdOff.count() == 0) {
+    return false;
+  }
+  state.holdOffActive = true;
+  state.holdOffEnd = now + holdOff;
+  return true;
+}
+
+std::chrono::microseconds MrfMmapMemoryAccess::currentInterruptHoldOff() const {
+  std::uint32_t holdOffMicroseconds = interruptHoldOffMicroseconds.load(
+      std::memory_order_relaxed);
+  if (interruptStormActive.load(std::memory_order_relaxed)) {
+    holdOffMicroseconds = std::max(holdOffMicroseconds,
+        interruptStormHoldOffMicroseconds.load(std::memory_order_relaxed));
+  }
+  return std::chrono::microseconds(holdOffMicroseconds);
+}
+
+void MrfMmapMemoryAccess::notifyInterruptStormHandler(bool stormActive,
+    std::uint32_t interruptRate) {
+  InterruptStormHandler handler;
+  {
+    // We have to hold the mutex while accessing the handler.
+    std::lock_guard<std::mutex> lock(mutex);
+    handler = interruptStormHandler;
+  }
+  if (handler) {
+    try {
+      handler(stormActive, interruptRate);
+    } catch (...) {
+      // We do not want an exception caused by the handler to bubble up into
+      // the calling code.
+    }
+  }
+}
+
+void MrfMmapMemoryAccess::updateInterruptDispatchTable() {
+  std::shared_ptr<InterruptDispatchTable> table =
+      std::make_shared<InterruptDispatchTable>();
+  for (auto listenerIterator = interruptListeners.begin();
+      listenerIterator != interruptListeners.end();) {
+    std::shared_ptr<InterruptListener> foundListener = listenerIterator->lock();
+    if (!foundListener) {
+      listenerIterator = interruptListeners.erase(listenerIterator);
+      continue;
+    }
+    std::size_t listenerIndex = table->listeners.size();
+    std::uint32_t mask = foundListener->getInterruptFlagsMask();
+    table->listeners.push_back(*listenerIterator);
+    table->masks.push_back(mask);
+    for (int bit = 0; bit < 32; ++bit) {
+      if (mask & (static_cast<std::uint32_t>(1) << bit)) {
+        table->listenersByBit[bit].push_back(listenerIndex);
+      }
+    }
+    ++listenerIterator;
+  }
+  interruptDispatchTable = std::move(table);
+  interruptDispatchTableChanged.store(true, std::memory_order_release);
+}
+
+void MrfMmapMemoryAccess::notifyInterruptListeners(
+    std::uint32_t interruptFlags) {
+  // The I/O thread keeps its own reference to the current dispatch table, so
+  // we only have to acquire the mutex when the table has been replaced. An old
+  // table is released here, after the I/O thread has stopped using it.
+  if (interruptDispatchTableChanged.exchange(false,
+      std::memory_order_acquire)) {
+    std::lock_guard<std::mutex> lock(mutex);
+    ioThreadInterruptDispatchTable = interruptDispatchTable;
+  }
+  const InterruptDispatchTable *table = ioThreadInterruptDispatchTable.get();
+  if (!table) {
+    return;
+  }
+  // We only look at the listeners registered for the flags that are set. A
+  // listener that is interested in more than one of these flags is found
+  // once for each of them, so we only notify it when visiting the lowest
+  // flag that it has in common with the interrupt.
+  std::uint32_t remainingFlags = interruptFlags;
+  for (int bit = 0; remainingFlags != 0; ++bit, remainingFlags >>= 1) {
+    if (!(remainingFlags & 1)) {
+      continue;
+    }
+    std::uint32_t bitValue = static_cast<std::uint32_t>(1) << bit;
+    for (std::size_t listenerIndex : table->listenersByBit[bit]) {
+      std::uint32_t matchingFlags = interruptFlags
+          & table->masks[listenerIndex];
+      // matchingFlags & -matchingFlags isolates the lowest bit.
+      if ((matchingFlags & (~matchingFlags + 1)) != bitValue) {
+        continue;
+      }
+      std::shared_ptr<InterruptListener> listener =
+          table->listeners[listenerIndex].lock();
+      if (!listener) {
+        continue;
+      }
+      try {
+        (*listener)(interruptFlags);
+      } catch (...) {
+        // We do not want an exception caused by a listener to bubble up into
+        // the calling code.
+      }
+    }
+  }
 }
 
 // We need a helper class and a few static variables and functions for handling
@@ -199,10 +670,11 @@ namespace {
 
 struct MrfIoInfo {
   constexpr MrfIoInfo() :
-      active(false), address(nullptr), jumpBuffer { } {
+      active(false), address(nullptr), length(0), jumpBuffer { } {
   }
   bool active;
   void *address;
+  std::size_t length;
   ::sigjmp_buf jumpBuffer;
 };
 
@@ -235,8 +707,15 @@ std::atomic<MrfOldSignalHandlerInfo *> oldSignalHandlerInfo;
 extern "C" {
 
 void signalHandler(int signalNumber, ::siginfo_t *signalInfo, void *context) {
+  // For block operations, the fault might have been caused by any address in
+  // the block, so we have to check whether the address is in the range that
+  // is being accessed.
   if (signalInfo->si_signo != SIGBUS || !threadLocalIoInfo.active
-      || signalInfo->si_addr != threadLocalIoInfo.address) {
+      || reinterpret_cast<char *>(signalInfo->si_addr)
+          < reinterpret_cast<char *>(threadLocalIoInfo.address)
+      || reinterpret_cast<char *>(signalInfo->si_addr)
+          >= reinterpret_cast<char *>(threadLocalIoInfo.address)
+              + threadLocalIoInfo.length) {
     // If the signal has not been caused by our code, we delegate to a
     // previously registered signal handler, if there is any. If there is not,
     // we take the default action (terminate the program).
@@ -344,6 +823,28 @@ void MrfMmapMemoryAccess::MrfIoRequest::fail(ErrorCode errorCode,
       // code.
     }
     break;
+  case MrfIoRequestType::readUInt16Block:
+  case MrfIoRequestType::writeUInt16Block:
+    try {
+      if (blockCallback16) {
+        blockCallback16->failure(address, errorCode, details);
+      }
+    } catch (...) {
+      // We do not want an exception in a callback to bubble up into the calling
+      // code.
+    }
+    break;
+  case MrfIoRequestType::readUInt32Block:
+  case MrfIoRequestType::writeUInt32Block:
+    try {
+      if (blockCallback32) {
+        blockCallback32->failure(address, errorCode, details);
+      }
+    } catch (...) {
+      // We do not want an exception in a callback to bubble up into the calling
+      // code.
+    }
+    break;
   }
 
 } // anonymous namespace
@@ -427,11 +928,65 @@ static void enableInterrupt(int fileDescriptor) {
   }
 }
 
-inline static void prepareIo(void *targetAddress) noexcept {
+// Creates an inotify file descriptor that watches the directory containing the
+// device node, so that the I/O thread can try to open the device as soon as
+// the device node (re)appears (e.g. after the kernel module has been
+// reloaded). Returns -1 if the watch cannot be created. This is not an error,
+// the device is still opened periodically in this case.
+static int watchDeviceNode(const std::string &devicePath) {
+  std::string::size_type separatorPosition = devicePath.rfind('/');
+  std::string directoryPath;
+  if (separatorPosition == std::string::npos) {
+    directoryPath = ".";
+  } else if (separatorPosition == 0) {
+    directoryPath = "/";
+  } else {
+    directoryPath = devicePath.substr(0, separatorPosition);
+  }
+  int inotifyFd = ::inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+  if (inotifyFd == -1) {
+    return -1;
+  }
+  if (::inotify_add_watch(inotifyFd, directoryPath.c_str(),
+      IN_CREATE | IN_ATTRIB | IN_MOVED_TO) == -1) {
+    ::close(inotifyFd);
+    return -1;
+  }
+  return inotifyFd;
+}
+
+// Reads all pending events from the inotify file descriptor. Returns true if
+// at least one of the events refers to the specified file name (or if the
+// event queue overflowed, so that we cannot know).
+static bool readDeviceNodeEvents(int inotifyFd, const std::string &fileName) {
+  // The buffer must be aligned like the event structure and should be large
+  // enough for several events with long names.
+  alignas(::inotify_event) char buffer[4096];
+  bool deviceNodeChanged = false;
+  while (true) {
+    ::ssize_t bytesRead = ::read(inotifyFd, buffer, sizeof(buffer));
+    if (bytesRead <= 0) {
+      return deviceNodeChanged;
+    }
+    char *position = buffer;
+    while (position < buffer + bytesRead) {
+      ::inotify_event *event = reinterpret_cast<::inotify_event *>(position);
+      if ((event->mask & IN_Q_OVERFLOW)
+          || (event->len != 0 && fileName == event->name)) {
+        deviceNodeChanged = true;
+      }
+      position += sizeof(::inotify_event) + event->len;
+    }
+  }
+}
+
+inline static void prepareIo(void *targetAddress, std::size_t length)
+    noexcept {
   // When the I/O operation fails with a SIGBUS, our signal handler ensures
   // that the execution jumps back to the point where we called sigsetjmp and
   // that this function returns a non-zero value.
   threadLocalIoInfo.address = targetAddress;
+  threadLocalIoInfo.length = length;
   // We have to use two fences: One before setting active and one after. The
   // first one is so that active is not going to be set before initializing
   // address and jumpBuffer. This ensures that when the signal handler is
@@ -474,7 +1029,7 @@ inline static bool ioReadUInt16(void *targetAddress, std::uint16_t &value)
     finishIo();
     return false;
   }
-  prepareIo(targetAddress);
+  prepareIo(targetAddress, 2);
   // The MRF devices use big endian internally, so we have to convert when we
   // are running on a little endian system. htonl, htons, ntohl, and ntohs can
   // be preprocessor macros, so we cannot qualify them explicitly with "::".
@@ -491,7 +1046,7 @@ inline static bool ioReadUInt32(void *targetAddress, std::uint32_t &value)
     finishIo();
     return false;
   }
-  prepareIo(targetAddress);
+  prepareIo(targetAddress, 4);
   // The MRF devices use big endian internally, so we have to convert when we
   // are running on a little endian system. htonl, htons, ntohl, and ntohs can
   // be preprocessor macros, so we cannot qualify them explicitly with "::".
@@ -508,7 +1063,7 @@ inline static bool ioReadWriteBackUInt32(void *targetAddress, std::uint32_t &val
     finishIo();
     return false;
   }
-  prepareIo(targetAddress);
+  prepareIo(targetAddress, 4);
   // The MRF devices use big endian internally, so we have to convert when we
   // are running on a little endian system. htonl, htons, ntohl, and ntohs can
   // be preprocessor macros, so we cannot qualify them explicitly with "::".
@@ -526,7 +1081,7 @@ inline static bool ioWriteReadUInt16(void *targetAddress, std::uint16_t &value)
     finishIo();
     return false;
   }
-  prepareIo(targetAddress);
+  prepareIo(targetAddress, 2);
   // The MRF devices use big endian internally, so we have to convert when we
   // are running on a little endian system. htonl, htons, ntohl, and ntohs can
   // be preprocessor macros, so we cannot qualify them explicitly with "::".
@@ -544,7 +1099,7 @@ inline static bool ioWriteReadUInt32(void *targetAddress, std::uint32_t &value)
     finishIo();
     return false;
   }
-  prepareIo(targetAddress);
+  prepareIo(targetAddress, 4);
   // The MRF devices use big endian internally, so we have to convert when we
   // are running on a little endian system. htonl, htons, ntohl, and ntohs can
   // be preprocessor macros, so we cannot qualify them explicitly with "::".
@@ -554,6 +1109,214 @@ inline static bool ioWriteReadUInt32(void *targetAddress, std::uint32_t &value)
   return true;
 }
 
+// The block functions only access the device memory with the register width.
+// The FPGAs of the MRF devices are not guaranteed to handle wider bus
+// accesses, so we cannot use SIMD loads and stores on the device memory.
+// Instead, the byte order of the whole block is converted in regular memory
+// (using SIMD instructions where available), so that the loop accessing the
+// device does nothing but plain loads and stores. The whole block is guarded
+// by a single sigsetjmp(...) call.
+
+template<typename T>
+inline static bool ioReadBlock(char *targetAddress,
+    std::uint32_t elementDistance, T *values, std::size_t count) noexcept {
+  if (count == 0) {
+    return true;
+  }
+  // If sigsetjmp returns a non-zero value, siglongjmp was called by the signal
+  // handler which means that an error occurred.
+  if (::sigsetjmp(threadLocalIoInfo.jumpBuffer, 1)) {
+    finishIo();
+    return false;
+  }
+  prepareIo(targetAddress, (count - 1) * elementDistance + sizeof(T));
+  for (std::size_t index = 0; index < count; ++index) {
+    values[index] = *(reinterpret_cast<volatile T *>(targetAddress
+        + index * elementDistance));
+  }
+  finishIo();
+  return true;
+}
+
+template<typename T>
+inline static bool ioWriteReadBlock(char *targetAddress,
+    std::uint32_t elementDistance, T *values, std::size_t count) noexcept {
+  if (count == 0) {
+    return true;
+  }
+  // If sigsetjmp returns a non-zero value, siglongjmp was called by the signal
+  // handler which means that an error occurred.
+  if (::sigsetjmp(threadLocalIoInfo.jumpBuffer, 1)) {
+    finishIo();
+    return false;
+  }
+  prepareIo(targetAddress, (count - 1) * elementDistance + sizeof(T));
+  // We first write all elements and then read them back. Reading each element
+  // right after writing it would stall the bus for every element.
+  for (std::size_t index = 0; index < count; ++index) {
+    *(reinterpret_cast<volatile T *>(targetAddress + index * elementDistance)) =
+        values[index];
+  }
+  for (std::size_t index = 0; index < count; ++index) {
+    values[index] = *(reinterpret_cast<volatile T *>(targetAddress
+        + index * elementDistance));
+  }
+  finishIo();
+  return true;
+}
+
+inline static bool ioReadUInt16Block(char *targetAddress,
+    std::uint32_t elementDistance, std::vector<std::uint16_t> &values)
+    noexcept {
+  if (!ioReadBlock(targetAddress, elementDistance, values.data(),
+      values.size())) {
+    return false;
+  }
+  mrfSwapBigEndianUInt16(values.data(), values.size());
+  return true;
+}
+
+inline static bool ioWriteReadUInt16Block(char *targetAddress,
+    std::uint32_t elementDistance, std::vector<std::uint16_t> &values)
+    noexcept {
+  mrfSwapBigEndianUInt16(values.data(), values.size());
+  if (!ioWriteReadBlock(targetAddress, elementDistance, values.data(),
+      values.size())) {
+    return false;
+  }
+  mrfSwapBigEndianUInt16(values.data(), values.size());
+  return true;
+}
+
+inline static bool ioReadUInt32Block(char *targetAddress,
+    std::uint32_t elementDistance, std::vector<std::uint32_t> &values)
+    noexcept {
+  if (!ioReadBlock(targetAddress, elementDistance, values.data(),
+      values.size())) {
+    return false;
+  }
+  mrfSwapBigEndianUInt32(values.data(), values.size());
+  return true;
+}
+
+inline static bool ioWriteReadUInt32Block(char *targetAddress,
+    std::uint32_t elementDistance, std::vector<std::uint32_t> &values)
+    noexcept {
+  mrfSwapBigEndianUInt32(values.data(), values.size());
+  if (!ioWriteReadBlock(targetAddress, elementDistance, values.data(),
+      values.size())) {
+    return false;
+  }
+  mrfSwapBigEndianUInt32(values.data(), values.size());
+  return true;
+}
+
+// The event FIFO of the event receiver is accessed through three registers.
+// Reading the event code register removes the oldest entry from the FIFO and
+// makes the seconds and timestamp of that entry available in the two other
+// registers. An event code of zero means that the FIFO is empty.
+static const std::uint32_t eventFifoSecondsRegisterAddress = 0x70;
+static const std::uint32_t eventFifoTimestampRegisterAddress = 0x74;
+static const std::uint32_t eventFifoEventCodeRegisterAddress = 0x78;
+
+// The hardware FIFO can hold 511 entries, so reading up to 512 entries in one
+// burst drains a FIFO that is completely filled. If events keep arriving
+// while we drain the FIFO, the event flag is set again and we continue after
+// the next interrupt. This ensures that requests that are queued are not
+// starved by a continuous stream of events.
+static const std::size_t eventFifoMaxBurstSize = 512;
+
+inline static bool ioReadEventFifo(char *deviceMemory,
+    MrfMemoryAccess::EventFifoEntry *entries, std::size_t &count) noexcept {
+  // The count is written after each entry, so it has to be volatile in order
+  // to have a well-defined value when siglongjmp is called.
+  volatile std::size_t entriesRead = 0;
+  // If sigsetjmp returns a non-zero value, siglongjmp was called by the signal
+  // handler which means that an error occurred.
+  if (::sigsetjmp(threadLocalIoInfo.jumpBuffer, 1)) {
+    finishIo();
+    count = entriesRead;
+    return false;
+  }
+  prepareIo(deviceMemory + eventFifoSecondsRegisterAddress, 12);
+  volatile std::uint32_t *eventCodeRegister =
+      reinterpret_cast<volatile std::uint32_t *>(deviceMemory
+          + eventFifoEventCodeRegisterAddress);
+  volatile std::uint32_t *secondsRegister =
+      reinterpret_cast<volatile std::uint32_t *>(deviceMemory
+          + eventFifoSecondsRegisterAddress);
+  volatile std::uint32_t *timestampRegister =
+      reinterpret_cast<volatile std::uint32_t *>(deviceMemory
+          + eventFifoTimestampRegisterAddress);
+  while (entriesRead < eventFifoMaxBurstSize) {
+    std::uint8_t eventCode = ntohl(*eventCodeRegister) & 0xff;
+    if (eventCode == 0) {
+      break;
+    }
+    MrfMemoryAccess::EventFifoEntry &entry = entries[entriesRead];
+    entry.eventCode = eventCode;
+    entry.seconds = ntohl(*secondsRegister);
+    entry.timestamp = ntohl(*timestampRegister);
+    entriesRead = entriesRead + 1;
+  }
+  finishIo();
+  count = entriesRead;
+  return true;
+}
+
+bool MrfMmapMemoryAccess::drainEventFifo(void *deviceMemory, bool overflow) {
+  std::vector<std::shared_ptr<EventFifoListener>> foundListeners;
+  {
+    // We have to hold the mutex while accessing the list of listeners.
+    std::lock_guard<std::mutex> lock(mutex);
+    for (auto listenerIterator = eventFifoListeners.begin();
+        listenerIterator != eventFifoListeners.end();) {
+      std::shared_ptr<EventFifoListener> foundListener =
+          listenerIterator->lock();
+      if (!foundListener) {
+        listenerIterator = eventFifoListeners.erase(listenerIterator);
+      } else {
+        foundListeners.push_back(std::move(foundListener));
+        ++listenerIterator;
+      }
+    }
+  }
+  // Reading from the FIFO removes the entries, so we must not touch the FIFO
+  // if nobody is interested in the entries. We also do not touch it if the
+  // mapped memory is too small to contain the FIFO registers.
+  if (foundListeners.empty()
+      || memorySize < eventFifoEventCodeRegisterAddress + 4) {
+    return true;
+  }
+  // The buffer is only used by the I/O thread, so it is safe to keep it in a
+  // static thread-local variable and reuse it for each burst.
+  static thread_local EventFifoEntry entries[eventFifoMaxBurstSize];
+  std::size_t count = 0;
+  bool ioSuccessful = ioReadEventFifo(reinterpret_cast<char *>(deviceMemory),
+      entries, count);
+  // If an I/O error occurred while reading, the entry that was being read has
+  // been lost, so we have to report an overflow.
+  if (!ioSuccessful) {
+    overflow = true;
+  }
+  if (count == 0 && !overflow) {
+    return ioSuccessful;
+  }
+  // We notify the listeners after releasing the mutex. This ensures that a
+  // listener cannot cause a dead lock and also means that we do not need a
+  // recursive mutex.
+  for (auto listenerIterator = foundListeners.begin();
+      listenerIterator != foundListeners.end(); ++listenerIterator) {
+    try {
+      (**listenerIterator)(entries, count, overflow);
+    } catch (...) {
+      // We do not want an exception caused by a listener to bubble up into
+      // the calling code.
+    }
+  }
+  return ioSuccessful;
+}
+
 void MrfMmapMemoryAccess::runIoThread() {
   // We block the SIGIO signal for this thread. We want to read this signal from
   // our signal file descriptor and so we do not want a signal handler (if there
@@ -573,11 +1336,37 @@ void MrfMmapMemoryAccess::runIoThread() {
   std::size_t signalInfoBytesRead = 0;
   int signalFd = -1;
   int deviceFd = -1;
+  bool deviceIsMemoryBacked = false;
   void *deviceMemory = nullptr;
+  // When interrupt coalescing is enabled, re-enabling interrupts might be
+  // deferred until the end of the current hold-off time.
+  bool interruptEnableDeferred = false;
+  // The error that prevented us from opening the device is kept until the
+  // device has been opened successfully, because requests that are queued
+  // in the meantime are failed with this error.
+  std::string deviceErrorDetails;
+  // When opening the device fails, we do not try again in every iteration.
+  // Instead, we wait for an exponentially increasing time, unless the device
+  // node changes, which we detect through inotify. The first attempt is made
+  // right away.
+  Clock::time_point nextOpenAttempt = Clock::time_point::min();
+  std::chrono::milliseconds openBackoff = minimumOpenBackoff;
+  Clock::time_point deviceLostTime = Clock::now();
+  std::chrono::milliseconds selectErrorBackoff = minimumSelectErrorBackoff;
+  // An anonymous memory file cannot disappear, so there is no need to watch
+  // it.
+  int inotifyFd = -1;
+  std::string deviceFileName;
+  if (memoryFd == -1) {
+    inotifyFd = watchDeviceNode(devicePath);
+    deviceFileName = devicePath.substr(devicePath.rfind('/') + 1);
+  }
+  // Requests that are queued while the device is not available are failed in
+  // bulk.
+  std::list<MrfIoRequest> failedRequests;
   // We do not check the shutdown flag in the loop condition because we have to
   // acquire the mutex when checking the flag.
   while (true) {
-    std::string deviceErrorDetails;
     // We create a signal file-descriptor (if we do not have one already) so
     // that we can wait for a signal using select(...).
     if (signalFd == -1) {
@@ -595,9 +1384,41 @@ void MrfMmapMemoryAccess::runIoThread() {
     }
     // If we have not opened the device yet, we try to do this now. We do this
     // before getting the request from the queue because this way we can avoid
-    // an unnecessary delay when processing the first request.
+    // an unnecessary delay when processing the first request. If the last
+    // attempt failed, we only try again when the backoff time has passed or
+    // the device node has changed.
+    bool openDeviceNow = false;
     if (deviceMemory == nullptr && signalFd != -1) {
-      deviceFd = ::open(devicePath.c_str(), O_RDWR);
+      if (inotifyFd != -1 && readDeviceNodeEvents(inotifyFd, deviceFileName)) {
+        nextOpenAttempt = Clock::time_point::min();
+      }
+      openDeviceNow = Clock::now() >= nextOpenAttempt;
+    }
+    if (openDeviceNow) {
+      if (memoryFd != -1) {
+        // We use a duplicate of the anonymous memory file, so that we can
+        // close it like a regular file without losing the memory contents.
+        deviceFd = ::fcntl(memoryFd, F_DUPFD_CLOEXEC, 0);
+      } else {
+        deviceFd = ::open(devicePath.c_str(), O_RDWR);
+      }
+      // Only a device node can generate interrupts. A regular file (or an
+      // anonymous memory file) is simply used as backing memory and has to be
+      // at least as large as the memory that we map, because accessing a page
+      // beyond the end of the file would result in a SIGBUS.
+      struct ::stat deviceStat;
+      if (deviceFd != -1 && ::fstat(deviceFd, &deviceStat) == -1) {
+        ::close(deviceFd);
+        deviceFd = -1;
+      }
+      if (deviceFd != -1) {
+        deviceIsMemoryBacked = !S_ISCHR(deviceStat.st_mode);
+        if (deviceIsMemoryBacked && deviceStat.st_size < memorySize
+            && ::ftruncate(deviceFd, memorySize) == -1) {
+          ::close(deviceFd);
+          deviceFd = -1;
+        }
+      }
       if (deviceFd == -1) {
         deviceErrorDetails =
           std::string("Could not open device ")
@@ -609,8 +1430,11 @@ void MrfMmapMemoryAccess::runIoThread() {
             deviceFd, 0);
         if (deviceMemory != MAP_FAILED) {
           try {
-            prepareInterrupt(deviceFd);
-            enableInterrupt(deviceFd);
+            if (!deviceIsMemoryBacked) {
+              prepareInterrupt(deviceFd);
+              enableInterrupt(deviceFd);
+            }
+            interruptEnableDeferred = false;
           } catch (std::exception &e) {
             ::munmap(deviceMemory, memorySize);
             deviceMemory = nullptr;
@@ -630,6 +1454,26 @@ void MrfMmapMemoryAccess::runIoThread() {
           deviceFd = -1;
         }
       }
+      Clock::time_point now = Clock::now();
+      std::lock_guard<std::mutex> lock(mutex);
+      ++connectionStatistics.openAttempts;
+      if (deviceMemory != nullptr) {
+        deviceErrorDetails.clear();
+        openBackoff = minimumOpenBackoff;
+        std::uint64_t openDelay =
+            std::chrono::duration_cast<std::chrono::microseconds>(
+                now - deviceLostTime).count();
+        connectionStatistics.open = true;
+        ++connectionStatistics.opened;
+        connectionStatistics.lastOpenDelayMicroseconds = openDelay;
+        connectionStatistics.maxOpenDelayMicroseconds = std::max(
+            connectionStatistics.maxOpenDelayMicroseconds, openDelay);
+        connectionStatistics.currentBackoffMilliseconds = 0;
+      } else {
+        nextOpenAttempt = now + openBackoff;
+        connectionStatistics.currentBackoffMilliseconds = openBackoff.count();
+        openBackoff = std::min(openBackoff * 2, maximumOpenBackoff);
+      }
     }
     bool haveInterrupt = false;
     if (signalFd != -1) {
@@ -668,6 +1512,8 @@ void MrfMmapMemoryAccess::runIoThread() {
     }
     MrfIoRequest request;
     bool haveRequest = false;
+    std::uint32_t injectedInterruptFlags = 0;
+    bool haveInjectedInterrupt = false;
     // If we have an interrupt, we handle this interrupt before trying to get
     // the next request. However, we still check the shutdown flag so that the
     // loop quits even if interrupts happen very frequently.
@@ -686,10 +1532,22 @@ void MrfMmapMemoryAccess::runIoThread() {
       if (shutdown) {
         break;
       }
-      // If the queue is empty, we later wait for an element to be queued and
-      // then try again. The thread might wake up spuriously, so we cannot
-      // expect that the queue will always have an element when we wake up.
-      if (!ioQueue.empty()) {
+      // Injected interrupts are handled before requests, just like interrupts
+      // generated by the device. If the queue is empty, we later wait for an
+      // element to be queued and then try again. The thread might wake up
+      // spuriously, so we cannot expect that the queue will always have an
+      // element when we wake up.
+      if (!injectedInterrupts.empty()) {
+        injectedInterruptFlags = injectedInterrupts.front();
+        haveInjectedInterrupt = true;
+        injectedInterrupts.pop_front();
+      } else if (!ioQueue.empty() && deviceMemory == nullptr) {
+        // If the device is not available, processing the requests one by one
+        // would only delay the failure of the later ones, so we take all of
+        // them at once and fail them after releasing the mutex.
+        connectionStatistics.requestsFailed += ioQueue.size();
+        failedRequests.swap(ioQueue);
+      } else if (!ioQueue.empty()) {
         request = std::move(ioQueue.front());
         haveRequest = true;
         ioQueue.pop_front();
@@ -699,7 +1557,34 @@ void MrfMmapMemoryAccess::runIoThread() {
     }
     // We do not need the mutex for the rest of the operations and in fact we
     // should not hold it because we might sleep when calling select(...).
+    if (!failedRequests.empty()) {
+      std::string errorDetails = deviceErrorDetails.empty()
+          ? std::string("The device ") + devicePath + " is not available."
+          : deviceErrorDetails;
+      for (MrfIoRequest &failedRequest : failedRequests) {
+        failedRequest.fail(ErrorCode::unknown, errorDetails);
+      }
+      failedRequests.clear();
+      continue;
+    }
     bool ioSuccessful = true;
+    // If a hold-off time has ended, the interrupt listeners are notified of
+    // the interrupts that have been collected and interrupts are re-enabled.
+    // We only check the clock when there is an active hold-off time or storm,
+    // so there is no overhead when interrupt coalescing is not used.
+    if (nextInterruptHoldOffDeadline() != Clock::time_point::max()
+        && processInterruptHoldOff(Clock::now()) && interruptEnableDeferred) {
+      interruptEnableDeferred = false;
+      if (deviceMemory != nullptr && !deviceIsMemoryBacked) {
+        try {
+          enableInterrupt(deviceFd);
+        } catch (...) {
+          // If we cannot re-enable interrupts our best option is to close the
+          // device and hope that it will work the next time.
+          ioSuccessful = false;
+        }
+      }
+    }
     if (haveRequest) {
       // If we could not open and mmap the device sucessfully, we have to report
       // an error.
@@ -729,6 +1614,26 @@ void MrfMmapMemoryAccess::runIoThread() {
       case MrfIoRequestType::writeUInt32:
         ioSuccessful = ioWriteReadUInt32(targetAddress, request.value32);
         break;
+      case MrfIoRequestType::readUInt16Block:
+        ioSuccessful = ioReadUInt16Block(
+            reinterpret_cast<char *>(targetAddress), request.elementDistance,
+            request.block16);
+        break;
+      case MrfIoRequestType::writeUInt16Block:
+        ioSuccessful = ioWriteReadUInt16Block(
+            reinterpret_cast<char *>(targetAddress), request.elementDistance,
+            request.block16);
+        break;
+      case MrfIoRequestType::readUInt32Block:
+        ioSuccessful = ioReadUInt32Block(
+            reinterpret_cast<char *>(targetAddress), request.elementDistance,
+            request.block32);
+        break;
+      case MrfIoRequestType::writeUInt32Block:
+        ioSuccessful = ioWriteReadUInt32Block(
+            reinterpret_cast<char *>(targetAddress), request.elementDistance,
+            request.block32);
+        break;
       }
       // We have to notify the callback of the result of the operation.
       if (ioSuccessful) {
@@ -760,6 +1665,30 @@ void MrfMmapMemoryAccess::runIoThread() {
             // code.
           }
           break;
+        case MrfIoRequestType::readUInt16Block:
+        case MrfIoRequestType::writeUInt16Block:
+          try {
+            if (request.blockCallback16) {
+              request.blockCallback16->success(request.address,
+                  request.block16);
+            }
+          } catch (...) {
+            // We do not want an exception in a callback to bubble up into the calling
+            // code.
+          }
+          break;
+        case MrfIoRequestType::readUInt32Block:
+        case MrfIoRequestType::writeUInt32Block:
+          try {
+            if (request.blockCallback32) {
+              request.blockCallback32->success(request.address,
+                  request.block32);
+            }
+          } catch (...) {
+            // We do not want an exception in a callback to bubble up into the calling
+            // code.
+          }
+          break;
         }
       } else {
         request.fail(ErrorCode::unknown,
@@ -801,68 +1730,87 @@ void MrfMmapMemoryAccess::runIoThread() {
         // enabling interrupts). For this reason, we can simply mask the
         // interrupt flags with the interrupt enabled bits.
         interruptFlagRegister &= interruptEnableRegister;
-        // An interrupt might be triggered spuriously. For this reason, we only
-        // call the interrupt listeners when the interrupt flag register has at
-        // least one interrupt flag set.
-        if (interruptFlagRegister != 0) {
-          // Notify the interrupt listeners.
-          std::vector<std::shared_ptr<InterruptListener>> foundListeners;
-          {
-            // We have to hold the mutex while accessing the list of listeners.
-            std::lock_guard<std::mutex> lock(mutex);
-            for (auto listenerIterator = interruptListeners.begin();
-                listenerIterator != interruptListeners.end();) {
-              std::shared_ptr<InterruptListener> foundListener =
-                  listenerIterator->lock();
-              if (!foundListener) {
-                listenerIterator = interruptListeners.erase(listenerIterator);
-              } else {
-                foundListeners.push_back(std::move(foundListener));
-                ++listenerIterator;
-              }
-            }
-          }
-          // We notify the listeners after releasing the mutex. This ensures that a
-          // listener cannot cause a dead lock and also means that we do not need a
-          // recursive mutex.
-          for (auto listenerIterator = foundListeners.begin();
-              listenerIterator != foundListeners.end(); ++listenerIterator) {
-            try {
-              (**listenerIterator)(interruptFlagRegister);
-            } catch (...) {
-              // We do not want an exception caused by a listener to bubble up into
-              // the calling code.
-            }
-          }
+        // If the event flag (bit 3) or the FIFO full flag (bit 1) is set, we
+        // drain the event FIFO. We do this before notifying the interrupt
+        // listeners, so that the entries are already available when records
+        // are processed because of the interrupt. The FIFO full flag means
+        // that events might have been lost. The FIFO is drained even when
+        // the notification of the listeners is deferred, so that it does not
+        // overflow.
+        if (interruptFlagRegister & 0x0a) {
+          ioSuccessful = drainEventFifo(deviceMemory,
+              (interruptFlagRegister & 0x02) != 0);
         }
-        // After handling an interrupt we have to reenable interrupts by using the
-        // respective ioctl() call.
-        try {
-          enableInterrupt(deviceFd);
-        } catch (...) {
-          // If we cannot re-enable interrupts our best option is to close the
-          // device and hope that it will work the next time.
-          ioSuccessful = false;
+        // The listeners are notified right away, unless a hold-off time is
+        // active. In this case, re-enabling interrupts is deferred as well,
+        // so that an interrupt source that fires continuously cannot keep
+        // this thread busy.
+        if (processInterrupt(interruptFlagRegister)) {
+          interruptEnableDeferred = true;
+        } else {
+          // After handling an interrupt we have to reenable interrupts by
+          // using the respective ioctl() call.
+          try {
+            enableInterrupt(deviceFd);
+          } catch (...) {
+            // If we cannot re-enable interrupts our best option is to close the
+            // device and hope that it will work the next time.
+            ioSuccessful = false;
+          }
         }
+      } else {
+        // We could not read the interrupt flags, so we cannot notify the
+        // listeners.
+        interruptsReceived.fetch_add(1, std::memory_order_relaxed);
+        interruptsDropped.fetch_add(1, std::memory_order_relaxed);
       }
+    } else if (haveInjectedInterrupt) {
+      // An injected interrupt does not touch the hardware, so we can notify
+      // the listeners even if the device could not be opened. Injected
+      // interrupts are coalesced just like interrupts generated by the device.
+      processInterrupt(injectedInterruptFlags);
     } else {
       // If we neither have an interrupt nor a request, we sleep waiting for an
       // interrupt to occur or a request to be queued.
       try {
         ::fd_set readFds;
         FD_ZERO(&readFds);
+        int maxFd = signalFd;
         if (signalFd != -1) {
           FD_SET(signalFd, &readFds);
         }
+        // While the device is not open, we also wait for changes of the
+        // device node. We do not do this while the device is open, because
+        // we would not read the events and select(...) would return right
+        // away.
+        if (inotifyFd != -1 && deviceMemory == nullptr) {
+          FD_SET(inotifyFd, &readFds);
+          maxFd = std::max(maxFd, inotifyFd);
+        }
         // We wait for a limited amount of time so that we will try reopening
-        // the device if it is not open, even when there are no I/O requests.
-        // This makes sense because even if there are no I/O requests, we might
-        // be interested in interrupts.
+        // the device if it is not open, even when there are no I/O requests
+        // and the device node is not being watched. This makes sense because
+        // even if there are no I/O requests, we might be interested in
+        // interrupts. If a hold-off time is active, we have to wake up when it
+        // ends.
+        Clock::time_point now = Clock::now();
+        Clock::time_point wakeUpTime = std::min(now + std::chrono::seconds(5),
+            nextInterruptHoldOffDeadline());
+        if (deviceMemory == nullptr && signalFd != -1) {
+          wakeUpTime = std::min(wakeUpTime, nextOpenAttempt);
+        }
+        // We have to avoid calculating the difference to
+        // Clock::time_point::min() because this would overflow.
+        wakeUpTime = std::max(wakeUpTime, now);
+        std::chrono::microseconds waitDuration =
+            std::chrono::duration_cast<std::chrono::microseconds>(
+                wakeUpTime - now);
         struct ::timeval waitTime;
-        waitTime.tv_sec = 5;
-        waitTime.tv_usec = 0;
-        ioThreadFdSelector.select(&readFds, nullptr, nullptr, signalFd,
+        waitTime.tv_sec = waitDuration.count() / 1000000;
+        waitTime.tv_usec = waitDuration.count() % 1000000;
+        ioThreadFdSelector.select(&readFds, nullptr, nullptr, maxFd,
             &waitTime);
+        selectErrorBackoff = minimumSelectErrorBackoff;
         // After waking up, the event will be handled in the next iteration.
       } catch (std::system_error &e) {
         if (e.code().value() == EINTR) {
@@ -875,33 +1823,47 @@ void MrfMmapMemoryAccess::runIoThread() {
           // descriptors and hoping that the error will not happen again after
           // reopening the files.
           ioSuccessful = false;
-          // In addition to closing the files, we add a small delay. This
-          // ensures that we will not occupy a full CPU core when the error
-          // keeps happening again and again.
-          struct ::timespec sleepTime;
-          sleepTime.tv_sec = 0;
-          sleepTime.tv_nsec = 100000000;
-          ::nanosleep(&sleepTime, nullptr);
         }
       } catch (...) {
         // When the exception is not of type std::system_error, we cannot know
         // the reason for the error, so we have to expect the worst.
         ioSuccessful = false;
-        // In addition to closing the files, we add a small delay. This
-        // ensures that we will not occupy a full CPU core when the error
-        // keeps happening again and again.
+      }
+      if (!ioSuccessful) {
+        // In addition to closing the files, we add a delay. This ensures that
+        // we will not occupy a full CPU core when the error keeps happening
+        // again and again. The delay grows with every consecutive error, so
+        // that a transient error only causes a short interruption.
         struct ::timespec sleepTime;
-        sleepTime.tv_sec = 0;
-        sleepTime.tv_nsec = 100000000;
+        sleepTime.tv_sec = selectErrorBackoff.count() / 1000;
+        sleepTime.tv_nsec = (selectErrorBackoff.count() % 1000) * 1000000;
         ::nanosleep(&sleepTime, nullptr);
+        selectErrorBackoff = std::min(selectErrorBackoff * 2,
+            maximumSelectErrorBackoff);
+        // The signal file-descriptor might be the reason for the error, so we
+        // create it again in the next iteration.
+        if (signalFd != -1) {
+          ::close(signalFd);
+          signalFd = -1;
+          signalInfoBytesRead = 0;
+        }
       }
     }
     if (!ioSuccessful) {
       // We close the device so that we get a chance to reopen it for the next
-      // request when it was temporarily removed.
+      // request when it was temporarily removed. The first attempt to reopen
+      // it is made right away.
       if (deviceMemory != nullptr) {
         ::munmap(deviceMemory, memorySize);
         deviceMemory = nullptr;
+        deviceErrorDetails = std::string("The device ") + devicePath
+            + " has been closed after an I/O error.";
+        deviceLostTime = Clock::now();
+        nextOpenAttempt = Clock::time_point::min();
+        openBackoff = minimumOpenBackoff;
+        std::lock_guard<std::mutex> lock(mutex);
+        connectionStatistics.open = false;
+        ++connectionStatistics.lost;
       }
       if (deviceFd != -1) {
         ::close(deviceFd);
@@ -925,6 +1887,10 @@ void MrfMmapMemoryAccess::runIoThread() {
     ::close(signalFd);
     signalFd = -1;
   }
+  if (inotifyFd != -1) {
+    ::close(inotifyFd);
+    inotifyFd = -1;
+  }
   // When we are here, we can access the queue without acquiring the mutex
   // because no requests are added after setting the shutdown flag and this is
   // the only thread that processes the queue.
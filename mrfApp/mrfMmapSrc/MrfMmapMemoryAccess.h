@@ -31,7 +31,9 @@
 #define ANKA_MRF_MMAP_MEMORY_ACCESS_H
 
 #include <atomic>
+#include <chrono>
 #include <condition_variable>
+#include <functional>
 #include <list>
 #include <memory>
 #include <mutex>
@@ -62,6 +64,14 @@ public:
    * the fourth minor device provided by the MRF kernel module (e.g. "/dev/era3"
    * or "/dev/egb3").
    *
+   * For testing and benchmarking without hardware, the path may also point to
+   * a regular file. Such a file is extended to the specified memory size if it
+   * is smaller. If the path is of the form "memfd:<name>", an anonymous memory
+   * file (see memfd_create(2)) is created instead and used as the backing
+   * memory. When the memory is not backed by a device node, the device cannot
+   * generate interrupts on its own, but interrupts can still be simulated by
+   * calling {@link #injectInterrupt(std::uint32_t)}.
+   *
    * The specified memory size represents the number of bytes that can be
    * accessed in the device's memory and depends on the exact device type.
    * Specifying a value that is too large might result in an error when
@@ -125,12 +135,58 @@ public:
   virtual void writeUInt32(std::uint32_t address, std::uint32_t value,
       std::shared_ptr<CallbackUInt32>);
 
+  /**
+   * Reads a block of unsigned 16-bit registers. This method does not block.
+   * The operation is queued and executed asynchronously as a single request.
+   * All registers are read in one go and the byte order of the whole block is
+   * converted afterwards. When the operation finishes, the specified callback
+   * is called.
+   */
+  virtual void readUInt16Block(std::uint32_t address, std::size_t count,
+      std::uint32_t elementDistance,
+      std::shared_ptr<BlockCallbackUInt16> callback);
+
+  /**
+   * Writes a block of unsigned 16-bit registers. This method does not block.
+   * The operation is queued and executed asynchronously as a single request.
+   * All registers are written first and then read back. When the operation
+   * finishes, the specified callback is called.
+   */
+  virtual void writeUInt16Block(std::uint32_t address,
+      const std::vector<std::uint16_t> &values, std::uint32_t elementDistance,
+      std::shared_ptr<BlockCallbackUInt16> callback);
+
+  /**
+   * Reads a block of unsigned 32-bit registers. This method does not block.
+   * The operation is queued and executed asynchronously as a single request.
+   * All registers are read in one go and the byte order of the whole block is
+   * converted afterwards. When the operation finishes, the specified callback
+   * is called.
+   */
+  virtual void readUInt32Block(std::uint32_t address, std::size_t count,
+      std::uint32_t elementDistance,
+      std::shared_ptr<BlockCallbackUInt32> callback);
+
+  /**
+   * Writes a block of unsigned 32-bit registers. This method does not block.
+   * The operation is queued and executed asynchronously as a single request.
+   * All registers are written first and then read back. When the operation
+   * finishes, the specified callback is called.
+   */
+  virtual void writeUInt32Block(std::uint32_t address,
+      const std::vector<std::uint32_t> &values, std::uint32_t elementDistance,
+      std::shared_ptr<BlockCallbackUInt32> callback);
+
   // We want the methods from the base class to participate in overload
   // resolution.
   using MrfMemoryAccess::readUInt16;
   using MrfMemoryAccess::readUInt32;
   using MrfMemoryAccess::writeUInt16;
   using MrfMemoryAccess::writeUInt32;
+  using MrfMemoryAccess::readUInt16Block;
+  using MrfMemoryAccess::readUInt32Block;
+  using MrfMemoryAccess::writeUInt16Block;
+  using MrfMemoryAccess::writeUInt32Block;
 
   /**
    * Tells whether this memory access supports interrupts. The mmap memory
@@ -159,13 +215,246 @@ public:
   virtual void removeInterruptListener(
       std::shared_ptr<InterruptListener> interruptListener);
 
+  /**
+   * Tells whether this memory access can drain the event FIFO of an event
+   * receiver. The mmap memory access always supports this, so this method
+   * always returns {@code true}. However, draining the event FIFO only makes
+   * sense for event receivers, so event FIFO listeners should not be
+   * registered for other devices.
+   */
+  virtual bool supportsEventFifo() const;
+
+  /**
+   * Adds the specified listener to the list of listeners that are notified
+   * when entries have been read from the event FIFO. If the specified listener
+   * has already been registered with this memory access, calling this method
+   * has no effect.
+   *
+   * While at least one listener is registered, the I/O thread drains the
+   * event FIFO each time the device generates an interrupt that has the event
+   * or the FIFO full flag set. All pending entries (up to the size of the
+   * hardware FIFO) are read in a single burst before interrupts are enabled
+   * again, so entries are delivered in batches and do not have to be read
+   * through separately queued requests.
+   *
+   * The listeners are internally kept using weak pointers. This means that a
+   * listener will be destroyed if no other references to it are being hold.
+   */
+  virtual void addEventFifoListener(
+      std::shared_ptr<EventFifoListener> eventFifoListener);
+
+  /**
+   * Removes the specified listener from the list of listeners that are
+   * notified when entries have been read from the event FIFO. If the specified
+   * listener has already been removed (or has never been added), calling this
+   * method has no effect.
+   */
+  virtual void removeEventFifoListener(
+      std::shared_ptr<EventFifoListener> eventFifoListener);
+
+  /**
+   * Simulates an interrupt with the specified interrupt flags. The interrupt
+   * listeners are notified from the I/O thread, just like for an interrupt
+   * that has been generated by the device, but the interrupt flag and enable
+   * registers are neither read nor modified. Interrupts are processed in the
+   * order in which they have been injected. This is mainly intended for
+   * testing and benchmarking when the memory is not backed by an actual
+   * device, but it also works for regular devices.
+   *
+   * Injecting an interrupt with no flags set has no effect, because such an
+   * interrupt would be discarded as a spurious interrupt anyway. The event
+   * FIFO is not drained for an injected interrupt.
+   */
+  void injectInterrupt(std::uint32_t interruptFlags);
+
+  /**
+   * Statistics about the interrupts handled by this memory access.
+   *
+   * @see getInterruptStatistics()
+   */
+  struct InterruptStatistics {
+
+    /**
+     * Number of interrupts that have been received (including injected
+     * interrupts).
+     */
+    std::uint64_t received;
+
+    /**
+     * Number of times the interrupt listeners have been notified.
+     */
+    std::uint64_t notified;
+
+    /**
+     * Number of interrupts that have been merged with other interrupts into a
+     * single notification of the interrupt listeners.
+     */
+    std::uint64_t coalesced;
+
+    /**
+     * Number of interrupts that have not resulted in a notification of the
+     * interrupt listeners, either because no enabled interrupt flag was set
+     * or because the interrupt flags could not be read.
+     */
+    std::uint64_t dropped;
+
+    /**
+     * Number of interrupt storms that have been detected.
+     */
+    std::uint64_t storms;
+
+    /**
+     * Flag indicating whether an interrupt storm is currently in progress.
+     */
+    bool stormActive;
+
+  };
+
+  /**
+   * Type of the function that is called when an interrupt storm starts or
+   * ends. The first argument is {@code true} when a storm has been detected
+   * and {@code false} when it has ended. The second argument is the number of
+   * interrupts that have been received in the current one-second window.
+   */
+  using InterruptStormHandler = std::function<void(bool, std::uint32_t)>;
+
+  /**
+   * Configures the coalescing of interrupts and the detection of interrupt
+   * storms.
+   *
+   * After the interrupt listeners have been notified, interrupts are not
+   * re-enabled until the hold-off time has passed. The flags of all
+   * interrupts that are received during this time (e.g. injected interrupts)
+   * or that are latched by the device are combined and passed to the
+   * listeners in a single notification at the end of the hold-off time. This
+   * limits the rate at which listeners are notified to one notification per
+   * hold-off time. A hold-off time of zero disables coalescing, which is the
+   * default.
+   *
+   * When more than the specified number of interrupts is received within one
+   * second, an interrupt storm is assumed and the storm hold-off time is used
+   * instead of the regular one (if it is longer). The storm ends when no
+   * interrupt has been received for the storm hold-off time after re-enabling
+   * interrupts. A storm threshold of zero disables storm detection, which is
+   * the default.
+   */
+  void setInterruptCoalescing(std::uint32_t holdOffMicroseconds,
+      std::uint32_t stormThreshold, std::uint32_t stormHoldOffMicroseconds);
+
+  /**
+   * Sets the function that is called when an interrupt storm starts or ends.
+   * The function is called from the I/O thread, so it should return quickly
+   * and must not call methods of this memory access that block. Passing an
+   * empty function removes a previously set handler.
+   */
+  void setInterruptStormHandler(InterruptStormHandler handler);
+
+  /**
+   * Returns statistics about the interrupts that have been handled since this
+   * memory access was created.
+   */
+  InterruptStatistics getInterruptStatistics() const;
+
+  /**
+   * Statistics about opening the device and reconnecting to it after it has
+   * been lost.
+   *
+   * @see getConnectionStatistics()
+   */
+  struct ConnectionStatistics {
+
+    /**
+     * Flag indicating whether the device is currently open.
+     */
+    bool open;
+
+    /**
+     * Number of times opening the device has been attempted.
+     */
+    std::uint64_t openAttempts;
+
+    /**
+     * Number of times the device has been opened successfully.
+     */
+    std::uint64_t opened;
+
+    /**
+     * Number of times the device has been closed because of an error.
+     */
+    std::uint64_t lost;
+
+    /**
+     * Number of requests that have failed because the device was not open.
+     */
+    std::uint64_t requestsFailed;
+
+    /**
+     * Time (in microseconds) between the device being lost (or this memory
+     * access being created) and the device being opened successfully the last
+     * time.
+     */
+    std::uint64_t lastOpenDelayMicroseconds;
+
+    /**
+     * Longest time (in microseconds) it has taken to open the device.
+     */
+    std::uint64_t maxOpenDelayMicroseconds;
+
+    /**
+     * Time (in milliseconds) that the I/O thread waits before it tries to
+     * open the device again. This is zero while the device is open.
+     */
+    std::uint64_t currentBackoffMilliseconds;
+
+  };
+
+  /**
+   * Returns statistics about opening the device and reconnecting to it since
+   * this memory access was created.
+   */
+  ConnectionStatistics getConnectionStatistics();
+
 private:
 
+  /**
+   * Clock used for the interrupt coalescing and the reconnect backoff.
+   */
+  using Clock = std::chrono::steady_clock;
+
+  /**
+   * State of the interrupt coalescing and storm detection. This state is only
+   * accessed by the I/O thread, so it does not have to be protected.
+   */
+  struct InterruptCoalescingState {
+    std::uint32_t pendingFlags = 0;
+    std::uint64_t pendingCount = 0;
+    bool holdOffActive = false;
+    Clock::time_point holdOffEnd;
+    Clock::time_point lastActivity;
+    Clock::time_point stormWindowStart;
+    std::uint32_t stormWindowCount = 0;
+  };
+
+  /**
+   * Index of the interrupt listeners by interrupt flag. A table is never
+   * modified after it has been published, so the I/O thread can use it
+   * without holding the mutex. When the listeners change, a new table is
+   * built and replaces the old one.
+   */
+  struct InterruptDispatchTable {
+    std::vector<std::weak_ptr<InterruptListener>> listeners;
+    std::vector<std::uint32_t> masks;
+    // For each bit of the interrupt flag register, the indices of the
+    // listeners that have this bit set in their mask.
+    std::vector<std::size_t> listenersByBit[32];
+  };
+
   /**
    * Type of a queued request.
    */
   enum class MrfIoRequestType {
-    notSpecified, readUInt16, writeUInt16, readUInt32, writeUInt32
+    notSpecified, readUInt16, writeUInt16, readUInt32, writeUInt32,
+    readUInt16Block, writeUInt16Block, readUInt32Block, writeUInt32Block
   };
 
   /**
@@ -184,21 +473,43 @@ private:
     std::uint32_t value32;
     std::shared_ptr<CallbackUInt16> callback16;
     std::shared_ptr<CallbackUInt32> callback32;
+    std::uint32_t elementDistance;
+    std::vector<std::uint16_t> block16;
+    std::vector<std::uint32_t> block32;
+    std::shared_ptr<BlockCallbackUInt16> blockCallback16;
+    std::shared_ptr<BlockCallbackUInt32> blockCallback32;
 
     MrfIoRequest() :
-        type(MrfIoRequestType::notSpecified), address(0), value16(0), value32(0) {
+        type(MrfIoRequestType::notSpecified), address(0), value16(0), value32(
+            0), elementDistance(0) {
     }
 
     MrfIoRequest(MrfIoRequestType type, std::uint32_t address,
         std::uint16_t value, std::shared_ptr<CallbackUInt16> callback) :
         type(type), address(address), value16(value), value32(0), callback16(
-            callback), callback32(nullptr) {
+            callback), callback32(nullptr), elementDistance(0) {
     }
 
     MrfIoRequest(MrfIoRequestType type, std::uint32_t address,
         std::uint32_t value, std::shared_ptr<CallbackUInt32> callback) :
         type(type), address(address), value16(0), value32(value), callback16(
-            nullptr), callback32(callback) {
+            nullptr), callback32(callback), elementDistance(0) {
+    }
+
+    MrfIoRequest(MrfIoRequestType type, std::uint32_t address,
+        std::uint32_t elementDistance, std::vector<std::uint16_t> &&values,
+        std::shared_ptr<BlockCallbackUInt16> callback) :
+        type(type), address(address), value16(0), value32(0), elementDistance(
+            elementDistance), block16(std::move(values)), blockCallback16(
+            callback) {
+    }
+
+    MrfIoRequest(MrfIoRequestType type, std::uint32_t address,
+        std::uint32_t elementDistance, std::vector<std::uint32_t> &&values,
+        std::shared_ptr<BlockCallbackUInt32> callback) :
+        type(type), address(address), value16(0), value32(0), elementDistance(
+            elementDistance), block32(std::move(values)), blockCallback32(
+            callback) {
     }
 
     void fail(ErrorCode errorCode, const std::string& details);
@@ -216,9 +527,28 @@ private:
   bool shutdown = false;
   std::mutex mutex;
   std::list<MrfIoRequest> ioQueue;
+  std::list<std::uint32_t> injectedInterrupts;
   std::thread ioThread;
   MrfFdSelector ioThreadFdSelector;
   std::vector<std::weak_ptr<InterruptListener>> interruptListeners;
+  std::shared_ptr<const InterruptDispatchTable> interruptDispatchTable;
+  std::atomic<bool> interruptDispatchTableChanged;
+  // Only accessed by the I/O thread, so it does not have to be protected.
+  std::shared_ptr<const InterruptDispatchTable> ioThreadInterruptDispatchTable;
+  std::vector<std::weak_ptr<EventFifoListener>> eventFifoListeners;
+  int memoryFd = -1;
+  InterruptStormHandler interruptStormHandler;
+  InterruptCoalescingState interruptCoalescingState;
+  std::atomic<std::uint32_t> interruptHoldOffMicroseconds;
+  std::atomic<std::uint32_t> interruptStormThreshold;
+  std::atomic<std::uint32_t> interruptStormHoldOffMicroseconds;
+  std::atomic<std::uint64_t> interruptsReceived;
+  std::atomic<std::uint64_t> interruptsNotified;
+  std::atomic<std::uint64_t> interruptsCoalesced;
+  std::atomic<std::uint64_t> interruptsDropped;
+  std::atomic<std::uint64_t> interruptStorms;
+  std::atomic<bool> interruptStormActive;
+  ConnectionStatistics connectionStatistics;
 
   /**
    * Adds an I/O request to the queue. This method takes care of waking up the
@@ -229,6 +559,78 @@ private:
    */
   void queueIoRequest(MrfIoRequest &&request);
 
+  /**
+   * Builds a new interrupt dispatch table from the list of listeners and
+   * publishes it to the I/O thread. Listeners that have expired are removed
+   * from the list. This method must only be called while holding the mutex.
+   */
+  void updateInterruptDispatchTable();
+
+  /**
+   * Notifies the registered interrupt listeners of an interrupt with the
+   * specified flags. Only listeners with a mask that has at least one of the
+   * flags set are notified. This method must only be called from the I/O
+   * thread and must not be called while holding the mutex.
+   */
+  void notifyInterruptListeners(std::uint32_t interruptFlags);
+
+  /**
+   * Drains the event FIFO and notifies all registered event FIFO listeners of
+   * the entries that have been read. If no listeners are registered, the FIFO
+   * is not touched. The overflow flag is passed on to the listeners and should
+   * be set if the FIFO full flag was set in the interrupt flag register.
+   * Returns {@code false} if the device memory could not be accessed. This
+   * method must only be called from the I/O thread and must not be called
+   * while holding the mutex.
+   */
+  bool drainEventFifo(void *deviceMemory, bool overflow);
+
+  /**
+   * Handles an interrupt with the specified (already masked) flags. Depending
+   * on the coalescing configuration, the interrupt listeners are notified
+   * right away or the flags are kept until the current hold-off time ends.
+   * Returns {@code true} if re-enabling interrupts has to be deferred until
+   * the hold-off time ends. This method must only be called from the I/O
+   * thread and must not be called while holding the mutex.
+   */
+  bool processInterrupt(std::uint32_t interruptFlags);
+
+  /**
+   * Checks whether the current hold-off time has ended and notifies the
+   * interrupt listeners of pending interrupts if it has. Also checks whether
+   * an interrupt storm has ended. Returns {@code true} if the hold-off time has
+   * ended (or no hold-off time was active), meaning that interrupts that have
+   * been deferred can be re-enabled now. This method must only be called from
+   * the I/O thread and must not be called while holding the mutex.
+   */
+  bool processInterruptHoldOff(Clock::time_point now);
+
+  /**
+   * Returns the point in time at which {@link processInterruptHoldOff} has to
+   * be called next. Returns {@code Clock::time_point::max()} if there is no
+   * such point in time. This method must only be called from the I/O thread.
+   */
+  Clock::time_point nextInterruptHoldOffDeadline() const;
+
+  /**
+   * Starts a new hold-off time if interrupt coalescing is enabled. Returns
+   * {@code true} if a hold-off time has been started.
+   */
+  bool startInterruptHoldOff(Clock::time_point now);
+
+  /**
+   * Returns the hold-off time that is currently in effect, taking an
+   * interrupt storm into account.
+   */
+  std::chrono::microseconds currentInterruptHoldOff() const;
+
+  /**
+   * Calls the interrupt storm handler (if one is set). This method must not
+   * be called while holding the mutex.
+   */
+  void notifyInterruptStormHandler(bool stormActive,
+      std::uint32_t interruptRate);
+
   /**
    * Main function of the I/O thread.
    */
@@ -0,0 +1,147 @@
+/*
+ * Copyright 2026 aquenos GmbH.
+ * Copyright 2026 Karlsruhe Institute of Technology.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * This software has been developed by aquenos GmbH on behalf of the
+ * Karlsruhe Institute of Technology's Institute for Beam Physics and
+ * Technology.
+ *
+ * This software contains code originally developed by aquenos GmbH for
+ * the s7nodave EPICS device support. aquenos GmbH has relicensed the
+ * affected poritions of code from the s7nodave EPICS device support
+ * (originally licensed under the terms of the GNU GPL) under the terms
+ * of the GNU LGPL version 3 or newer.
+ */
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+extern "C" {
+#include <arpa/inet.h>
+#include <netinet/in.h>
+}
+
+#include "MrfUdpIpAddressCache.h"
+
+namespace anka {
+namespace mrf {
+
+MrfUdpIpAddressCache MrfUdpIpAddressCache::instance;
+
+bool MrfUdpIpAddressCache::lookup(const std::string &hostName,
+    std::uint32_t &address) const {
+  std::lock_guard<std::mutex> lock(mutex);
+  auto iterator = addresses.find(hostName);
+  if (iterator == addresses.end()) {
+    return false;
+  }
+  address = iterator->second;
+  return true;
+}
+
+void MrfUdpIpAddressCache::setFileName(const std::string &fileName) {
+  // Each line of the file contains a host name and the address that it has
+  // been resolved to, separated by white space. We read the whole file before
+  // modifying the cache, so that a malformed file does not leave the cache
+  // partially filled.
+  std::map<std::string, std::uint32_t> loadedAddresses;
+  std::ifstream stream(fileName);
+  if (stream) {
+    std::string line;
+    while (std::getline(stream, line)) {
+      std::istringstream lineStream(line);
+      std::string hostName;
+      std::string addressString;
+      if (!(lineStream >> hostName)) {
+        // We ignore empty lines.
+        continue;
+      }
+      ::in_addr address;
+      if (!(lineStream >> addressString)
+          || ::inet_pton(AF_INET, addressString.c_str(), &address) != 1) {
+        throw std::runtime_error(
+            fileName + " is not a valid address cache file.");
+      }
+      loadedAddresses[hostName] = address.s_addr;
+    }
+    if (stream.bad()) {
+      throw std::runtime_error("Could not read " + fileName + ".");
+    }
+  }
+  std::lock_guard<std::mutex> lock(mutex);
+  // Addresses that have been resolved in the meantime are more recent than the
+  // ones from the file, so we do not replace them.
+  addresses.insert(loadedAddresses.begin(), loadedAddresses.end());
+  this->fileName = fileName;
+}
+
+void MrfUdpIpAddressCache::store(const std::string &hostName,
+    std::uint32_t address) {
+  std::lock_guard<std::mutex> lock(mutex);
+  auto iteratorAndInserted = addresses.emplace(hostName, address);
+  if (!iteratorAndInserted.second) {
+    if (iteratorAndInserted.first->second == address) {
+      return;
+    }
+    iteratorAndInserted.first->second = address;
+  }
+  if (!fileName.empty()) {
+    writeFile();
+  }
+}
+
+void MrfUdpIpAddressCache::writeFile() const {
+  // This method is only called while holding the mutex, so concurrent updates
+  // cannot interfere with each other.
+  std::string temporaryFileName = fileName + ".tmp";
+  {
+    std::ofstream stream(temporaryFileName, std::ios::out | std::ios::trunc);
+    if (!stream) {
+      throw std::runtime_error(
+          "Could not open " + temporaryFileName + " for writing.");
+    }
+    for (auto &hostNameAndAddress : addresses) {
+      ::in_addr address;
+      address.s_addr = hostNameAndAddress.second;
+      char addressString[INET_ADDRSTRLEN];
+      if (!::inet_ntop(AF_INET, &address, addressString,
+          sizeof(addressString))) {
+        continue;
+      }
+      stream << hostNameAndAddress.first << ' ' << addressString << '\n';
+    }
+    stream.close();
+    if (!stream) {
+      std::remove(temporaryFileName.c_str());
+      throw std::runtime_error("Could not write " + temporaryFileName + ".");
+    }
+  }
+  if (std::rename(temporaryFileName.c_str(), fileName.c_str())) {
+    int errorNumber = errno;
+    std::remove(temporaryFileName.c_str());
+    throw std::runtime_error(
+        "Could not rename " + temporaryFileName + " to " + fileName + ": "
+            + std::strerror(errorNumber));
+  }
+}
+
+} // namespace mrf
+} // namespace anka
@@ -0,0 +1,115 @@
+/*
+ * Copyright 2026 aquenos GmbH.
+ * Copyright 2026 Karlsruhe Institute of Technology.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * This software has been developed by aquenos GmbH on behalf of the
+ * Karlsruhe Institute of Technology's Institute for Beam Physics and
+ * Technology.
+ *
+ * This software contains code originally developed by aquenos GmbH for
+ * the s7nodave EPICS device support. aquenos GmbH has relicensed the
+ * affected poritions of code from the s7nodave EPICS device support
+ * (originally licensed under the terms of the GNU GPL) under the terms
+ * of the GNU LGPL version 3 or newer.
+ */
+
+#ifndef ANKA_MRF_UDP_IP_ADDRESS_CACHE_H
+#define ANKA_MRF_UDP_IP_ADDRESS_CACHE_H
+
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+
+namespace anka {
+namespace mrf {
+
+/**
+ * Cache for the IPv4 addresses that host names have been resolved to.
+ *
+ * The {@link MrfUdpIpClient} stores each address that it has resolved in this
+ * cache and falls back to the cached address when the host name cannot be
+ * resolved (e.g. because the DNS server is not available). When a file name
+ * has been set, the cache is loaded from this file and the file is updated
+ * each time an address changes, so that the cached addresses are also
+ * available when the IOC is started again.
+ *
+ * This class is a singleton. The only instance can be retrieved through
+ * {@link #getInstance()}.
+ */
+class MrfUdpIpAddressCache {
+
+public:
+
+  /**
+   * Returns the only instance of this class.
+   */
+  inline static MrfUdpIpAddressCache &getInstance() {
+    return instance;
+  }
+
+  /**
+   * Looks up the address for the specified host name. Returns {@code true} and
+   * sets {@code address} (an IPv4 address in network byte order) if an
+   * address is cached. Returns {@code false} otherwise.
+   */
+  bool lookup(const std::string &hostName, std::uint32_t &address) const;
+
+  /**
+   * Sets the file that is used for persisting the cache and loads the
+   * addresses stored in it. Addresses that are already cached are not
+   * replaced. If the file does not exist, it is created when the first address
+   * is stored. Throws an exception if the file exists, but cannot be read or is
+   * malformed. In this case, the file name is not changed. This should be
+   * called before the first client is created.
+   */
+  void setFileName(const std::string &fileName);
+
+  /**
+   * Stores the address (an IPv4 address in network byte order) for the
+   * specified host name. If the address has changed and a file name has been
+   * set, the file is updated. The file is written under a temporary name
+   * (with {@code .tmp} appended) first and then renamed. Throws an exception
+   * if the file cannot be written. The address is stored in memory even in
+   * this case.
+   */
+  void store(const std::string &hostName, std::uint32_t address);
+
+private:
+
+  static MrfUdpIpAddressCache instance;
+
+  std::map<std::string, std::uint32_t> addresses;
+  std::string fileName;
+  mutable std::mutex mutex;
+
+  MrfUdpIpAddressCache() = default;
+
+  // We do not want to allow copy or move construction or assignment.
+  MrfUdpIpAddressCache(const MrfUdpIpAddressCache &) = delete;
+  MrfUdpIpAddressCache(MrfUdpIpAddressCache &&) = delete;
+  MrfUdpIpAddressCache &operator=(const MrfUdpIpAddressCache &) = delete;
+  MrfUdpIpAddressCache &operator=(MrfUdpIpAddressCache &&) = delete;
+
+  void writeFile() const;
+
+};
+
+} // namespace mrf
+} // namespace anka
+
+#endif // ANKA_MRF_UDP_IP_ADDRESS_CACHE_H
@@ -50,6 +50,7 @@ extern "C" {
 
 #include <mrfGaiErrorCategory.h>
 
+#include "MrfUdpIpAddressCache.h"
 #include "MrfUdpIpClient.h"
 
 namespace anka {
@@ -94,104 +95,91 @@ template<class Rep, class Period>
   return converted;
 }
 
-} // anonymous namespace
-
-MrfUdpIpClient::MrfUdpIpClient(
-    const std::string &hostName,
-    const Clock::duration &queueTimeout,
-    const Clock::duration &requestTimeout) :
-    hostName(hostName),
-    queueTimeout(queueTimeout),
-    requestTimeout(requestTimeout),
-    shutdown(false) {
-  if (queueTimeout < Clock::duration::zero()) {
-    throw std::invalid_argument(
-      "The queue timeout must be zero or positive.");
-  }
-  if (requestTimeout <= Clock::duration::zero()) {
-    throw std::invalid_argument(
-      "The request timeout must be strictly positive.");
+/**
+ * Resolves a host name (or an IPv4 address in text form) to a socket address.
+ * Addresses that are resolved successfully are stored in the address cache.
+ * If the name cannot be resolved, the address from the cache is used instead.
+ * Throws an exception if the name cannot be resolved and is not cached either.
+ */
+::sockaddr_in resolveHostName(const std::string &hostName) {
+  ::sockaddr_in socketAddress;
+  std::memset(&socketAddress, 0, sizeof(socketAddress));
+  socketAddress.sin_family = AF_INET;
+  // Numeric addresses do not have to be resolved and there is no point in
+  // caching them.
+  if (::inet_pton(AF_INET, hostName.c_str(), &socketAddress.sin_addr) == 1) {
+    return socketAddress;
   }
-  // Resolve the host name.
   ::addrinfo addrInfoHint = {
     0, PF_INET, SOCK_DGRAM, IPPROTO_UDP, 0, nullptr, nullptr, nullptr};
   ::addrinfo *addrInfo = nullptr;
   int addrInfoStatus = ::getaddrinfo(
     hostName.c_str(), nullptr, &addrInfoHint, &addrInfo);
+  auto &addressCache = MrfUdpIpAddressCache::getInstance();
   if (addrInfoStatus) {
+    std::uint32_t cachedAddress;
+    if (addressCache.lookup(hostName, cachedAddress)) {
+      socketAddress.sin_addr.s_addr = cachedAddress;
+      return socketAddress;
+    }
     throw std::system_error(
       addrInfoStatus,
       mrfGaiErrorCategory(),
       "Could not resolve " + hostName);
   }
-  sockaddr_in socketAddress;
   bool haveSocketAddress = false;
   ::addrinfo *nextAddrInfo = addrInfo;
   while (!haveSocketAddress && nextAddrInfo) {
-    if (addrInfo->ai_addrlen == sizeof(sockaddr_in)) {
+    if (nextAddrInfo->ai_addrlen == sizeof(sockaddr_in)) {
       haveSocketAddress = true;
-      std::memcpy(&socketAddress, addrInfo->ai_addr, sizeof(sockaddr_in));
+      std::memcpy(&socketAddress, nextAddrInfo->ai_addr, sizeof(sockaddr_in));
     }
     nextAddrInfo = nextAddrInfo->ai_next;
   }
   ::freeaddrinfo(addrInfo);
   addrInfo = nullptr;
   if (!haveSocketAddress) {
-    throw new std::runtime_error(
+    throw std::runtime_error(
         "Addressed returned by getaddrinfo had an unexpected size.");
   }
-
-  // Create and connect the socket.
-  this->socketDescriptor = ::socket(PF_INET, SOCK_DGRAM, IPPROTO_UDP);
-  if (this->socketDescriptor == -1) {
-    throw std::system_error(
-      errno,
-      std::generic_category(),
-      "Could not create UDP socket for communication with " + hostName);
-  }
-  if (::fcntl(this->socketDescriptor, F_SETFL, O_NONBLOCK) == -1) {
-    int savedErrorNumber = errno;
-    ::close(this->socketDescriptor);
-    this->socketDescriptor = -1;
-    throw std::system_error(
-      savedErrorNumber,
-      std::generic_category(),
-      "Could not put socket into non-blocking mode");
-  }
-#ifdef __APPLE__
-  // Unlike Linux, macOS may generate a SIGPIPE for a datagram socket, if it is
-  // connected (Linux only does this for stream sockets). Such a signal would
-  // kill the whole process, so we set a flag that keeps the operating system
-  // from generating such a signal. The SO_NOSIGPIPE option is only supported
-  // on macOS and some variants of BSD, so we cannot apply it everywhere.
-  int socketOptNoSigPipe = 1;
-  ::setsockopt(
-    this->socketDescriptor,
-    SOL_SOCKET,
-    SO_NOSIGPIPE,
-    &socketOptNoSigPipe,
-    sizeof(socketOptNoSigPipe));
-#endif // __APPLE__
-  socketAddress.sin_port = htons(2000);
-  if (::connect(this->socketDescriptor,
-      reinterpret_cast<sockaddr *>(&socketAddress), sizeof(sockaddr_in))) {
-    int savedErrorNumber = errno;
-    close(this->socketDescriptor);
-    this->socketDescriptor = -1;
-    throw std::system_error(
-      savedErrorNumber,
-      std::generic_category(),
-      "Could not connect UDP socket for communication with " + hostName);
-  }
-  // Create background threads.
   try {
-    this->receiveThread = std::thread([this]() {runReceiveThread();});
-    this->sendThread = std::thread([this]() {runSendThread();});
+    addressCache.store(hostName, socketAddress.sin_addr.s_addr);
   } catch (...) {
-    close(this->socketDescriptor);
-    this->socketDescriptor = -1;
-    throw;
+    // If the cache file cannot be written, the address is still stored in
+    // memory, and there is no reason why we should not use it.
   }
+  return socketAddress;
+}
+
+/**
+ * Delay after which the client tries again to set up the socket if it could
+ * not be set up (e.g. because the host name could not be resolved).
+ */
+constexpr std::chrono::seconds socketSetUpRetryDelay(10);
+
+} // anonymous namespace
+
+MrfUdpIpClient::MrfUdpIpClient(
+    const std::string &hostName,
+    const Clock::duration &queueTimeout,
+    const Clock::duration &requestTimeout) :
+    hostName(hostName),
+    queueTimeout(queueTimeout),
+    requestTimeout(requestTimeout),
+    shutdown(false) {
+  if (queueTimeout < Clock::duration::zero()) {
+    throw std::invalid_argument(
+      "The queue timeout must be zero or positive.");
+  }
+  if (requestTimeout <= Clock::duration::zero()) {
+    throw std::invalid_argument(
+      "The request timeout must be strictly positive.");
+  }
+  // Resolving the host name and creating the socket is deferred to the send
+  // thread. This way, creating the clients for many devices is not slowed down
+  // by a slow name resolution, and the names are resolved in parallel. The
+  // receive thread is created by the send thread once the socket is ready.
+  this->sendThread = std::thread([this]() {runSendThread();});
 }
 
 MrfUdpIpClient::~MrfUdpIpClient() {
@@ -203,6 +191,8 @@ MrfUdpIpClient::~MrfUdpIpClient() {
       receiveSelector.wakeUp();
       sendSelector.wakeUp();
     }
+    // If the send thread is still resolving the host name, this blocks until
+    // the name resolution has finished, because it cannot be interrupted.
     if (sendThread.joinable()) {
       sendThread.join();
     }
@@ -447,6 +437,61 @@ MrfUdpIpClient::Clock::time_point MrfUdpIpClient::checkSentRequests() {
   return nextCheck;
 }
 
+void MrfUdpIpClient::connectSocket() {
+  auto socketAddress = resolveHostName(hostName);
+  // Create and connect the socket.
+  int newSocketDescriptor = ::socket(PF_INET, SOCK_DGRAM, IPPROTO_UDP);
+  if (newSocketDescriptor == -1) {
+    throw std::system_error(
+      errno,
+      std::generic_category(),
+      "Could not create UDP socket for communication with " + hostName);
+  }
+  if (::fcntl(newSocketDescriptor, F_SETFL, O_NONBLOCK) == -1) {
+    int savedErrorNumber = errno;
+    ::close(newSocketDescriptor);
+    throw std::system_error(
+      savedErrorNumber,
+      std::generic_category(),
+      "Could not put socket into non-blocking mode");
+  }
+#ifdef __APPLE__
+  // Unlike Linux, macOS may generate a SIGPIPE for a datagram socket, if it is
+  // connected (Linux only does this for stream sockets). Such a signal would
+  // kill the whole process, so we set a flag that keeps the operating system
+  // from generating such a signal. The SO_NOSIGPIPE option is only supported
+  // on macOS and some variants of BSD, so we cannot apply it everywhere.
+  int socketOptNoSigPipe = 1;
+  ::setsockopt(
+    newSocketDescriptor,
+    SOL_SOCKET,
+    SO_NOSIGPIPE,
+    &socketOptNoSigPipe,
+    sizeof(socketOptNoSigPipe));
+#endif // __APPLE__
+  socketAddress.sin_port = htons(2000);
+  if (::connect(newSocketDescriptor,
+      reinterpret_cast<sockaddr *>(&socketAddress), sizeof(sockaddr_in))) {
+    int savedErrorNumber = errno;
+    ::close(newSocketDescriptor);
+    throw std::system_error(
+      savedErrorNumber,
+      std::generic_category(),
+      "Could not connect UDP socket for communication with " + hostName);
+  }
+  // The socket descriptor is only set by the send thread, before the receive
+  // thread is created, so neither of the two threads needs a lock for reading
+  // it.
+  this->socketDescriptor = newSocketDescriptor;
+  try {
+    this->receiveThread = std::thread([this]() {runReceiveThread();});
+  } catch (...) {
+    ::close(this->socketDescriptor);
+    this->socketDescriptor = -1;
+    throw;
+  }
+}
+
 bool MrfUdpIpClient::lastReceivedValid() const {
   // This function must only be called while holding a lock on the mutex, so we
   // safely access all data structures but must not do anything that might
@@ -659,6 +704,51 @@ MrfUdpIpClient::Clock::duration MrfUdpIpClient::retransmissionTimeout() const {
     rtoLowerLimit);
 }
 
+bool MrfUdpIpClient::setUpSocket() {
+  while (!shutdown.load(std::memory_order_acquire)) {
+    std::exception_ptr setUpException;
+    try {
+      connectSocket();
+      return true;
+    } catch (...) {
+      setUpException = std::current_exception();
+    }
+    // Until we try again, requests fail immediately with the error that
+    // happened while setting up the socket. Otherwise, code waiting for a
+    // request would be blocked until the socket can be set up, which might
+    // never happen.
+    auto retryTime = Clock::now() + socketSetUpRetryDelay;
+    while (!shutdown.load(std::memory_order_acquire)) {
+      std::list<std::shared_ptr<Request>> failedRequests;
+      {
+        std::lock_guard<std::recursive_mutex> lock(mutex);
+        failedRequests.swap(newRequests);
+      }
+      for (const auto &request : failedRequests) {
+        if (!request->callback) {
+          continue;
+        }
+        try {
+          (*request->callback)(0, 0, setUpException);
+        } catch (...) {
+          // We do not want an exception in the callback to stop the send
+          // thread, so we ignore it.
+        }
+      }
+      auto now = Clock::now();
+      if (now >= retryTime) {
+        break;
+      }
+      // We wait until we should try again or until sendSelector.wakeUp() is
+      // called because a request has been queued or the client is being
+      // destroyed.
+      ::timeval selectTimeout = toTimeval(retryTime - now);
+      sendSelector.select(nullptr, nullptr, nullptr, -1, &selectTimeout);
+    }
+  }
+  return false;
+}
+
 bool MrfUdpIpClient::trySendRequest(
     const std::shared_ptr<Request> &request) {
   request->lastRef = nextRef;
@@ -940,6 +1030,9 @@ void MrfUdpIpClient::runReceiveThread() {
 }
 
 void MrfUdpIpClient::runSendThread() {
+  if (!setUpSocket()) {
+    return;
+  }
   while (!shutdown.load(std::memory_order_acquire)) {
     // There is some information that we have to carry from the block that
     // holds a lock on the mutex to the code that runs after releasing the
@@ -106,11 +106,22 @@ public:
    * is received. Within this time, retransmissions of the request may happen
    * automatically. The request timeout must not be zero.
    *
-   * The constructor creates two background threads that take care of
-   * communicating with the device.
+   * The constructor creates a background thread that resolves the host name,
+   * creates the socket, and then takes care of sending requests to the device.
+   * A second background thread for receiving responses is created once the
+   * socket is ready. This way, the constructor returns quickly, even if the
+   * name resolution is slow, and the clients for several devices are set up in
+   * parallel. Requests that are queued before the socket is ready are sent
+   * once it is. If the socket cannot be set up, these requests fail with the
+   * error that occurred, and so do all requests that are queued until the
+   * next attempt to set up the socket, which is made after ten seconds.
    *
-   * Throws an exception if the socket cannot be initialized, the background
-   * threads cannot be created, or if one of the parameters is invalid.
+   * Host names that have been resolved successfully are stored in the
+   * {@link MrfUdpIpAddressCache}. If a host name cannot be resolved, the
+   * cached address is used instead.
+   *
+   * Throws an exception if the background thread cannot be created or if one
+   * of the parameters is invalid.
    */
   template<typename Rep1, typename Period1, typename Rep2, typename Period2>
   MrfUdpIpClient(
@@ -255,6 +266,15 @@ private:
    */
   Clock::time_point checkSentRequests();
 
+  /**
+   * Resolves the host name, creates and connects the socket, and creates the
+   * receive thread.
+   *
+   * Throws an exception if any of these steps fails. This function must only
+   * be called by the send thread.
+   */
+  void connectSocket();
+
   /**
    * Tells whether the information about the last received packet is valid.
    *
@@ -306,6 +326,17 @@ private:
    */
   void runSendThread();
 
+  /**
+   * Sets up the socket by calling connectSocket(), retrying after a delay if
+   * this fails. While the socket cannot be set up, queued requests fail with
+   * the error that occurred.
+   *
+   * Returns true once the socket has been set up, false if the client is
+   * shutdown before that. This function must only be called by the send
+   * thread.
+   */
+  bool setUpSocket();
+
   /**
    * Try to send a request (in a non-blocking way).
    *
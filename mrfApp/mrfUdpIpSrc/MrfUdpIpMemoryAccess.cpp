@@ -384,5 +384,9 @@ void MrfUdpIpMemoryAccess::writeUInt32(std::uint32_t address,
   client.queueWriteRequest(baseAddress + address, highWord, internalCallback);
 }
 
+std::chrono::nanoseconds MrfUdpIpMemoryAccess::getMinimumWriteInterval() const {
+  return std::chrono::nanoseconds(672);
+}
+
 } // namespace mrf
 } // namespace anka
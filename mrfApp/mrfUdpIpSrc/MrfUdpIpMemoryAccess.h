@@ -164,6 +164,15 @@ public:
   virtual void writeUInt32(std::uint32_t address, std::uint32_t value,
       std::shared_ptr<CallbackUInt32>);
 
+  /**
+   * Returns the minimum time that passes between the execution of two write
+   * operations by the device. Each request is sent as a separate Ethernet
+   * frame, and the shortest possible frame (including the preamble and the
+   * inter-frame gap) takes 672 ns to transmit at 1 Gbit/s. Therefore, two
+   * writes can never be executed more quickly than that.
+   */
+  virtual std::chrono::nanoseconds getMinimumWriteInterval() const;
+
   // We want the methods from the base class to participate in overload
   // resolution.
   using MrfMemoryAccess::readUInt16;
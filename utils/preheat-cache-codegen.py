@@ -60,13 +60,13 @@ def _generate_code(start_address, block_length, section_type):
                     start_address, start_address + block_length
                 )
             )
-            print("      cache->tryCacheUInt16(address);")
+            print("      cache->preheatUInt16(address);")
             print("  }")
         else:
             for address in range(
                 start_address, start_address + block_length, 2
             ):
-                print("  cache->tryCacheUInt16(0x{:08x});".format(address))
+                print("  cache->preheatUInt16(0x{:08x});".format(address))
     elif section_type == _Section.UINT32:
         if block_length > 8:
             print(
@@ -75,13 +75,13 @@ def _generate_code(start_address, block_length, section_type):
                     start_address, start_address + block_length
                 )
             )
-            print("      cache->tryCacheUInt32(address);")
+            print("      cache->preheatUInt32(address);")
             print("  }")
         else:
             for address in range(
                 start_address, start_address + block_length, 4
             ):
-                print("  cache->tryCacheUInt32(0x{:08x});".format(address))
+                print("  cache->preheatUInt32(0x{:08x});".format(address))
 
 
 def main():